@@ -23,6 +23,8 @@
 #include "graph.hh"
 #include "graph_selectors.hh"
 #include "graph_util.hh"
+#include "random.hh"
+#include "graph_betweenness.hh"
 
 using namespace std;
 using namespace boost;
@@ -76,65 +78,18 @@ void normalize_betweenness(const Graph& g,
 
 struct get_betweenness
 {
-    typedef void result_type;
-    template <class Graph, class EdgeBetweenness, class VertexBetweenness>
-    void operator()(Graph& g,
-                    std::vector<size_t>& pivots,
-                    GraphInterface::vertex_index_map_t index_map,
+    template <class Graph, class Weight, class EdgeBetweenness,
+              class VertexBetweenness>
+    void operator()(Graph& g, std::vector<size_t>& pivots, Weight weight,
                     EdgeBetweenness edge_betweenness,
                     VertexBetweenness vertex_betweenness,
-                    bool normalize, size_t n) const
+                    bool normalize, size_t n, size_t max_eindex) const
     {
-        vector<vector<typename graph_traits<Graph>::edge_descriptor> >
-            incoming_map(num_vertices(g));
-        vector<size_t> distance_map(num_vertices(g));
-        vector<typename property_traits<VertexBetweenness>::value_type>
-            dependency_map(num_vertices(g));
-        vector<size_t> path_count_map(num_vertices(g));
-        brandes_betweenness_centrality
-            (g, pivots, vertex_betweenness, edge_betweenness,
-             make_iterator_property_map(incoming_map.begin(), index_map),
-             make_iterator_property_map(distance_map.begin(), index_map),
-             make_iterator_property_map(dependency_map.begin(), index_map),
-             make_iterator_property_map(path_count_map.begin(), index_map),
-             index_map);
+        brandes_betweenness(g, pivots, weight, edge_betweenness,
+                            vertex_betweenness, max_eindex);
         if (normalize)
-            normalize_betweenness(g, pivots, edge_betweenness, vertex_betweenness, n);
-    }
-};
-
-struct get_weighted_betweenness
-{
-    typedef void result_type;
-    template <class Graph, class EdgeBetweenness, class VertexBetweenness,
-              class VertexIndexMap>
-    void operator()(Graph& g, std::vector<size_t>& pivots,
-                    VertexIndexMap vertex_index,
-                    EdgeBetweenness edge_betweenness,
-                    VertexBetweenness vertex_betweenness,
-                    boost::any weight_map, bool normalize,
-                    size_t n, size_t max_eindex) const
-    {
-        vector<vector<typename graph_traits<Graph>::edge_descriptor> >
-            incoming_map(num_vertices(g));
-        vector<typename property_traits<EdgeBetweenness>::value_type>
-            distance_map(num_vertices(g));
-        vector<typename property_traits<VertexBetweenness>::value_type>
-            dependency_map(num_vertices(g));
-        vector<size_t> path_count_map(num_vertices(g));
-
-        typename EdgeBetweenness::checked_t weight =
-            any_cast<typename EdgeBetweenness::checked_t>(weight_map);
-
-        brandes_betweenness_centrality
-            (g, pivots, vertex_betweenness, edge_betweenness,
-             make_iterator_property_map(incoming_map.begin(), vertex_index),
-             make_iterator_property_map(distance_map.begin(), vertex_index),
-             make_iterator_property_map(dependency_map.begin(), vertex_index),
-             make_iterator_property_map(path_count_map.begin(), vertex_index),
-             vertex_index, weight.get_unchecked(max_eindex+1));
-        if (normalize)
-            normalize_betweenness(g, pivots, edge_betweenness, vertex_betweenness, n);
+            normalize_betweenness(g, pivots, edge_betweenness,
+                                  vertex_betweenness, n);
     }
 };
 
@@ -155,13 +110,16 @@ void betweenness(GraphInterface& g, std::vector<size_t>& pivots,
     if (!weight.empty())
     {
         run_action<>()
-            (g, std::bind<>(get_weighted_betweenness(),
-                            std::placeholders::_1,
-                            std::ref(pivots),
-                            g.get_vertex_index(),
-                            std::placeholders::_2,
-                            std::placeholders::_3, weight, normalize,
-                            g.get_num_vertices(), g.get_edge_index_range()),
+            (g, [&](auto& graph, auto eb, auto vb)
+                {
+                    typedef typename decltype(eb)::checked_t weight_t;
+                    weight_t w = any_cast<weight_t>(weight);
+                    get_betweenness()
+                        (graph, pivots,
+                         w.get_unchecked(g.get_edge_index_range()), eb, vb,
+                         normalize, g.get_num_vertices(),
+                         g.get_edge_index_range());
+                },
              edge_floating_properties(),
              vertex_floating_properties())
             (edge_betweenness, vertex_betweenness);
@@ -171,13 +129,91 @@ void betweenness(GraphInterface& g, std::vector<size_t>& pivots,
         run_action<>()
             (g, std::bind<void>(get_betweenness(), std::placeholders::_1,
                                 std::ref(pivots),
-                                g.get_vertex_index(), std::placeholders::_2,
+                                UnityPropertyMap<int, GraphInterface::edge_t>(),
+                                std::placeholders::_2,
                                 std::placeholders::_3, normalize,
-                                g.get_num_vertices()),
+                                g.get_num_vertices(),
+                                g.get_edge_index_range()),
+             edge_floating_properties(),
+             vertex_floating_properties())
+            (edge_betweenness, vertex_betweenness);
+    }
+}
+
+size_t approximate_betweenness(GraphInterface& g, boost::any weight,
+                               boost::any edge_betweenness,
+                               boost::any vertex_betweenness, double epsilon,
+                               double delta, bool normalize, rng_t& rng)
+{
+    if (!belongs<edge_floating_properties>()(edge_betweenness))
+        throw ValueException("edge property must be of floating point value"
+                             " type");
+
+    if (!belongs<vertex_floating_properties>()(vertex_betweenness))
+        throw ValueException("vertex property must be of floating point value"
+                             " type");
+
+    if (epsilon <= 0 || epsilon >= 1)
+        throw ValueException("epsilon must lie in the interval (0, 1)");
+    if (delta <= 0 || delta >= 1)
+        throw ValueException("delta must lie in the interval (0, 1)");
+
+    size_t tau = 0;
+    auto get_approx = [&](auto& graph, auto w, auto eb, auto vb)
+        {
+            tau = graph_tool::approx_betweenness
+                (graph, w, eb, vb, epsilon,
+                 delta, g.get_edge_index_range(), rng);
+
+            // the estimates are the betweenness values divided by n(n-1),
+            // and are rescaled to match betweenness()
+            double n = g.get_num_vertices();
+            double vf, ef;
+            if (normalize)
+            {
+                vf = (n > 2) ? n / (n - 2) : 0;
+                ef = 1;
+            }
+            else
+            {
+                vf = ef = n * (n - 1) *
+                    (graph_tool::is_directed(graph) ? 1 : .5);
+            }
+            parallel_vertex_loop
+                (graph, [&](auto v) { vb[v] *= vf; });
+            parallel_edge_loop
+                (graph, [&](const auto& e) { eb[e] *= ef; });
+        };
+
+    if (!weight.empty())
+    {
+        run_action<>()
+            (g, [&](auto& graph, auto eb, auto vb)
+                {
+                    typedef typename decltype(eb)::checked_t weight_t;
+                    weight_t w = any_cast<weight_t>(weight);
+                    get_approx(graph,
+                               w.get_unchecked(g.get_edge_index_range()),
+                               eb, vb);
+                },
+             edge_floating_properties(),
+             vertex_floating_properties())
+            (edge_betweenness, vertex_betweenness);
+    }
+    else
+    {
+        run_action<>()
+            (g, [&](auto& graph, auto eb, auto vb)
+                {
+                    get_approx(graph,
+                               UnityPropertyMap<int, GraphInterface::edge_t>(),
+                               eb, vb);
+                },
              edge_floating_properties(),
              vertex_floating_properties())
             (edge_betweenness, vertex_betweenness);
     }
+    return tau;
 }
 
 struct get_central_point_dominance
@@ -205,5 +241,6 @@ void export_betweenness()
 {
     using namespace boost::python;
     def("get_betweenness", &betweenness);
+    def("get_approx_betweenness", &approximate_betweenness);
     def("get_central_point_dominance", &central_point);
 }
@@ -0,0 +1,734 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_BETWEENNESS_HH
+#define GRAPH_BETWEENNESS_HH
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "graph.hh"
+#include "graph_util.hh"
+#include "random.hh"
+#include "../inference/support/parallel_rng.hh"
+
+namespace graph_tool
+{
+using namespace std;
+using namespace boost;
+
+// Brandes' betweenness algorithm, parallelized over the source vertices.
+//
+// Each thread owns a workspace which is reused for all its sources, and is
+// reset only at the vertices reached by the previous search. No predecessor
+// lists are kept: the dependencies are pulled from the successors of each
+// vertex in the shortest-path DAG, which are identified by their distances
+// (and, for weighted graphs, by the order in which they were settled). The
+// centralities are accumulated with atomic additions into shared arrays, so
+// that the memory used does not grow with the number of threads.
+
+template <class Dist>
+struct brandes_workspace
+{
+    brandes_workspace(size_t N)
+        : dist(N, numeric_limits<Dist>::max()), sigma(N, 0), delta(N, 0),
+          pos(N, numeric_limits<size_t>::max()), hpos(N)
+    {
+        order.reserve(N);
+    }
+
+    void reset()
+    {
+        for (auto v : order)
+        {
+            dist[v] = numeric_limits<Dist>::max();
+            sigma[v] = 0;
+            delta[v] = 0;
+            pos[v] = numeric_limits<size_t>::max();
+        }
+        order.clear();
+        for (auto v : heap) // left over if the search was stopped early
+        {
+            dist[v] = numeric_limits<Dist>::max();
+            sigma[v] = 0;
+        }
+        heap.clear();
+    }
+
+    vector<Dist> dist;      // distance from the source
+    vector<double> sigma;   // number of shortest paths
+    vector<double> delta;   // dependency
+    vector<size_t> pos;     // position in the settling order
+    vector<size_t> order;   // vertices in the order they are settled
+    vector<size_t> hpos;    // position in the heap
+    vector<size_t> heap;    // indexed 4-ary heap, keyed by dist
+};
+
+// BFS from s, which leaves the reached vertices in ws.order
+template <class Graph, class Dist>
+void brandes_sssp(Graph& g, size_t s, brandes_workspace<Dist>& ws,
+                  UnityPropertyMap<int, GraphInterface::edge_t>)
+{
+    auto& dist = ws.dist;
+    auto& sigma = ws.sigma;
+    auto& order = ws.order;
+
+    dist[s] = 0;
+    sigma[s] = 1;
+    ws.pos[s] = 0;
+    order.push_back(s);
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        size_t v = order[i];
+        Dist d = dist[v] + 1;
+        for (auto w : out_neighbors_range(v, g))
+        {
+            if (dist[w] == numeric_limits<Dist>::max())
+            {
+                dist[w] = d;
+                ws.pos[w] = order.size();
+                order.push_back(w);
+            }
+            if (dist[w] == d)
+                sigma[w] += sigma[v];
+        }
+    }
+}
+
+// Dijkstra from s, which leaves the settled vertices in ws.order. The queue is
+// an indexed 4-ary heap kept in the workspace, so that distances can be
+// decreased in place. If a target is given, the search stops once it is
+// settled.
+template <class Dist>
+void brandes_heap_up(brandes_workspace<Dist>& ws, size_t i)
+{
+    auto& heap = ws.heap;
+    auto& dist = ws.dist;
+    size_t v = heap[i];
+    Dist d = dist[v];
+    while (i > 0)
+    {
+        size_t p = (i - 1) / 4;
+        size_t u = heap[p];
+        if (dist[u] <= d)
+            break;
+        heap[i] = u;
+        ws.hpos[u] = i;
+        i = p;
+    }
+    heap[i] = v;
+    ws.hpos[v] = i;
+}
+
+template <class Dist>
+void brandes_heap_down(brandes_workspace<Dist>& ws, size_t i)
+{
+    auto& heap = ws.heap;
+    auto& dist = ws.dist;
+    size_t v = heap[i];
+    Dist d = dist[v];
+    size_t n = heap.size();
+    while (true)
+    {
+        size_t c = 4 * i + 1;
+        if (c >= n)
+            break;
+        size_t m = c;
+        Dist dm = dist[heap[c]];
+        for (size_t j = c + 1; j < min(c + 4, n); ++j)
+        {
+            Dist dj = dist[heap[j]];
+            if (dj < dm)
+            {
+                m = j;
+                dm = dj;
+            }
+        }
+        if (d <= dm)
+            break;
+        heap[i] = heap[m];
+        ws.hpos[heap[i]] = i;
+        i = m;
+    }
+    heap[i] = v;
+    ws.hpos[v] = i;
+}
+
+template <class Graph, class Dist, class Weight>
+void brandes_sssp(Graph& g, size_t s, brandes_workspace<Dist>& ws,
+                  Weight weight, size_t stop = numeric_limits<size_t>::max())
+{
+    auto& dist = ws.dist;
+    auto& sigma = ws.sigma;
+    auto& pos = ws.pos;
+    auto& order = ws.order;
+    auto& heap = ws.heap;
+
+    dist[s] = 0;
+    sigma[s] = 1;
+    heap.push_back(s);
+    ws.hpos[s] = 0;
+    while (!heap.empty())
+    {
+        size_t v = heap.front();
+        Dist d = dist[v];
+        heap.front() = heap.back();
+        heap.pop_back();
+        if (!heap.empty())
+            brandes_heap_down(ws, 0);
+        pos[v] = order.size();
+        order.push_back(v);
+        if (v == stop)
+            break;
+        for (auto e : out_edges_range(v, g))
+        {
+            size_t w = target(e, g);
+            Dist nd = d + get(weight, e);
+            if (dist[w] == numeric_limits<Dist>::max())
+            {
+                dist[w] = nd;
+                sigma[w] = sigma[v];
+                heap.push_back(w);
+                brandes_heap_up(ws, heap.size() - 1);
+            }
+            else if (nd < dist[w])
+            {
+                dist[w] = nd;
+                sigma[w] = sigma[v];
+                brandes_heap_up(ws, ws.hpos[w]);
+            }
+            else if (nd == dist[w] && pos[w] == numeric_limits<size_t>::max())
+            {
+                // settled vertices can only be reached here via zero-weight
+                // edges, and are skipped
+                sigma[w] += sigma[v];
+            }
+        }
+    }
+}
+
+template <class Graph, class Dist, class Weight>
+bool brandes_is_successor(Graph&, size_t v, size_t w,
+                          const typename graph_traits<Graph>::edge_descriptor& e,
+                          brandes_workspace<Dist>& ws, Weight weight)
+{
+    // the settling order disambiguates zero-weight edges
+    return (Dist(ws.dist[v] + get(weight, e)) == ws.dist[w] &&
+            ws.pos[w] > ws.pos[v]);
+}
+
+template <class Graph, class Dist>
+bool brandes_is_successor(Graph&, size_t v, size_t w,
+                          const typename graph_traits<Graph>::edge_descriptor&,
+                          brandes_workspace<Dist>& ws,
+                          UnityPropertyMap<int, GraphInterface::edge_t>)
+{
+    return ws.dist[w] == ws.dist[v] + 1;
+}
+
+template <class Graph, class Pivots, class Weight, class EdgeBetweenness,
+          class VertexBetweenness>
+void brandes_betweenness(Graph& g, Pivots& pivots, Weight weight,
+                         EdgeBetweenness eb, VertexBetweenness vb,
+                         size_t max_eindex)
+{
+    typedef typename property_traits<Weight>::value_type wval_t;
+    typedef typename std::conditional<std::is_same<Weight,
+                                                   UnityPropertyMap<int, GraphInterface::edge_t>>::value,
+                                      size_t, wval_t>::type dist_t;
+
+    size_t N = num_vertices(g);
+    size_t E = max_eindex;
+    auto eindex = get(edge_index_t(), g);
+
+    size_t nt = (pivots.size() > OPENMP_MIN_THRESH) ? get_openmp_threads() : 1;
+
+    vector<double> vb_acc(N, 0), eb_acc(E, 0);
+
+    #pragma omp parallel num_threads(nt)
+    {
+        brandes_workspace<dist_t> ws(N);
+
+        #pragma omp for schedule(runtime)
+        for (size_t i = 0; i < pivots.size(); ++i)
+        {
+            size_t s = pivots[i];
+            if (s >= N || !is_valid_vertex(vertex(s, g), g))
+                continue;
+
+            brandes_sssp(g, s, ws, weight);
+
+            // back-propagation of dependencies, in reverse settling order
+            auto& order = ws.order;
+            for (auto iter = order.rbegin(); iter != order.rend(); ++iter)
+            {
+                size_t v = *iter;
+                double delta = 0;
+                for (auto e : out_edges_range(v, g))
+                {
+                    size_t w = target(e, g);
+                    if (w == v || !brandes_is_successor(g, v, w, e, ws, weight))
+                        continue;
+                    double c = (ws.sigma[v] / ws.sigma[w]) * (1 + ws.delta[w]);
+                    #pragma omp atomic
+                    eb_acc[eindex[e]] += c;
+                    delta += c;
+                }
+                ws.delta[v] = delta;
+                if (v != s)
+                {
+                    #pragma omp atomic
+                    vb_acc[v] += delta;
+                }
+            }
+
+            ws.reset();
+        }
+    }
+
+    double f = graph_tool::is_directed(g) ? 1 : .5;
+    parallel_vertex_loop
+        (g,
+         [&](auto v)
+         {
+             put(vb, v, f * vb_acc[v]);
+         });
+
+    parallel_edge_loop
+        (g,
+         [&](const auto& e)
+         {
+             put(eb, e, f * eb_acc[eindex[e]]);
+         });
+}
+
+// Approximate betweenness via shortest-path sampling (Riondato & Kornaropoulos
+// 2016; Borassi & Natale 2016). Pairs (s, t) are drawn uniformly, and a single
+// shortest path between them is chosen uniformly at random; the fraction of
+// sampled paths crossing a vertex (or edge) is an unbiased estimator of its
+// betweenness divided by n(n-1).
+//
+// Samples are added in geometrically growing batches. After each batch the
+// run stops if an empirical Bernstein bound guarantees the error on every
+// vertex and edge to be below epsilon, with the failure probability split
+// uniformly between all checkpoints and all elements. The last checkpoint is
+// the sample size of Riondato & Kornaropoulos, based on an upper bound of the
+// vertex diameter, which gives the guarantee independently of the data.
+
+template <class Graph, class Edge>
+size_t bb_other(Graph& g, size_t v, const Edge& e)
+{
+    size_t u = source(e, g);
+    return (u == v) ? target(e, g) : u;
+}
+
+// Chooses an edge from the range with probability proportional to f(e), where
+// the f(e) sum to total.
+template <class Range, class RNG, class F>
+auto bb_choose(Range&& range, double total, RNG& rng, F&& f)
+{
+    uniform_real_distribution<> sample(0, total);
+    double r = sample(rng);
+    auto chosen = *range.begin();
+    for (auto e : range)
+    {
+        double p = f(e);
+        if (p == 0)
+            continue;
+        chosen = e;
+        r -= p;
+        if (r < 0)
+            break;
+    }
+    return chosen;
+}
+
+struct bb_bfs_workspace
+{
+    bb_bfs_workspace(size_t N)
+        : ds(N, numeric_limits<size_t>::max()),
+          dt(N, numeric_limits<size_t>::max()), ss(N, 0), st(N, 0) {}
+
+    void reset()
+    {
+        for (auto v : touched)
+        {
+            ds[v] = dt[v] = numeric_limits<size_t>::max();
+            ss[v] = st[v] = 0;
+        }
+        touched.clear();
+    }
+
+    vector<size_t> ds, dt;  // distances from s and to t
+    vector<double> ss, st;  // number of shortest paths from s and to t
+    vector<size_t> touched, fs, ft, next, meet;
+};
+
+// Balanced bidirectional BFS between s and t, followed by the sampling of a
+// uniformly chosen shortest path. The internal vertices and the edges of the
+// path are passed to visit_v() and visit_e(), respectively.
+template <class Graph, class RNG, class VisitV, class VisitE>
+void bb_sample_path(Graph& g, size_t s, size_t t, bb_bfs_workspace& ws,
+                    UnityPropertyMap<int, GraphInterface::edge_t>, RNG& rng,
+                    VisitV&& visit_v, VisitE&& visit_e)
+{
+    constexpr size_t inf = numeric_limits<size_t>::max();
+    auto& ds = ws.ds;
+    auto& dt = ws.dt;
+    auto& ss = ws.ss;
+    auto& st = ws.st;
+    auto& meet = ws.meet;
+
+    ds[s] = 0;
+    ss[s] = 1;
+    dt[t] = 0;
+    st[t] = 1;
+    ws.touched.push_back(s);
+    ws.touched.push_back(t);
+    ws.fs.assign(1, s);
+    ws.ft.assign(1, t);
+    meet.clear();
+
+    auto expand = [&](auto& front, auto& d, auto& sigma, auto& od,
+                      auto&& edges)
+        {
+            ws.next.clear();
+            for (auto v : front)
+            {
+                for (auto e : edges(v))
+                {
+                    size_t w = bb_other(g, v, e);
+                    if (d[w] == inf)
+                    {
+                        d[w] = d[v] + 1;
+                        ws.next.push_back(w);
+                        ws.touched.push_back(w);
+                        if (od[w] != inf)
+                            meet.push_back(w);
+                    }
+                    if (d[w] == d[v] + 1)
+                        sigma[w] += sigma[v];
+                }
+            }
+            front.swap(ws.next);
+        };
+
+    auto fwd = [&](auto v) { return out_edges_range(v, g); };
+    auto bwd = [&](auto v) { return in_or_out_edges_range(v, g); };
+
+    while (meet.empty())
+    {
+        if (ws.fs.empty() || ws.ft.empty())
+            return;  // t is not reachable from s
+
+        // expand the side with the fewest edges to be visited
+        size_t ks = 0, kt = 0;
+        for (auto v : ws.fs)
+            ks += out_degree(v, g);
+        for (auto v : ws.ft)
+            kt += graph_tool::is_directed(g) ? in_degreeS()(v, g) :
+                out_degree(v, g);
+        if (ks <= kt)
+            expand(ws.fs, ds, ss, dt, fwd);
+        else
+            expand(ws.ft, dt, st, ds, bwd);
+    }
+
+    double sigma_st = 0;
+    for (auto x : meet)
+        sigma_st += ss[x] * st[x];
+
+    // choose the middle vertex of the path
+    uniform_real_distribution<> sample(0, 1);
+    double r = sample(rng) * sigma_st;
+    size_t x = meet.back();
+    for (auto y : meet)
+    {
+        r -= ss[y] * st[y];
+        if (r < 0)
+        {
+            x = y;
+            break;
+        }
+    }
+
+    if (x != s && x != t)
+        visit_v(x);
+
+    // walk back to s
+    size_t v = x;
+    while (v != s)
+    {
+        auto e = bb_choose(in_or_out_edges_range(v, g), ss[v], rng,
+                           [&](const auto& e) -> double
+                           {
+                               size_t u = bb_other(g, v, e);
+                               if (ds[u] == inf || ds[u] + 1 != ds[v])
+                                   return 0;
+                               return ss[u];
+                           });
+        visit_e(e);
+        v = bb_other(g, v, e);
+        if (v != s)
+            visit_v(v);
+    }
+
+    // walk forward to t
+    v = x;
+    while (v != t)
+    {
+        auto e = bb_choose(out_edges_range(v, g), st[v], rng,
+                           [&](const auto& e) -> double
+                           {
+                               size_t w = target(e, g);
+                               if (dt[w] == inf || dt[w] + 1 != dt[v])
+                                   return 0;
+                               return st[w];
+                           });
+        visit_e(e);
+        v = target(e, g);
+        if (v != t)
+            visit_v(v);
+    }
+}
+
+// Dijkstra search from s stopped at t, followed by a backward walk choosing
+// each predecessor with probability proportional to its number of shortest
+// paths.
+template <class Graph, class Dist, class Weight, class RNG, class VisitV,
+          class VisitE>
+void bb_sample_path(Graph& g, size_t s, size_t t, brandes_workspace<Dist>& ws,
+                    Weight weight, RNG& rng, VisitV&& visit_v,
+                    VisitE&& visit_e)
+{
+    constexpr size_t inf = numeric_limits<size_t>::max();
+    brandes_sssp(g, s, ws, weight, t);
+    if (ws.pos[t] == inf)
+        return;
+
+    size_t v = t;
+    while (v != s)
+    {
+        auto e = bb_choose(in_or_out_edges_range(v, g), ws.sigma[v], rng,
+                           [&](const auto& e) -> double
+                           {
+                               size_t u = bb_other(g, v, e);
+                               if (ws.pos[u] == inf ||
+                                   ws.pos[u] >= ws.pos[v] ||
+                                   Dist(ws.dist[u] + get(weight, e)) != ws.dist[v])
+                                   return 0;
+                               return ws.sigma[u];
+                           });
+        visit_e(e);
+        v = bb_other(g, v, e);
+        if (v != s)
+            visit_v(v);
+    }
+}
+
+template <class Graph, class Weight>
+struct bb_workspace
+{
+    typedef brandes_workspace<typename property_traits<Weight>::value_type>
+        type;
+};
+
+template <class Graph>
+struct bb_workspace<Graph, UnityPropertyMap<int, GraphInterface::edge_t>>
+{
+    typedef bb_bfs_workspace type;
+};
+
+// Upper bound on the number of vertices in a shortest path. For undirected
+// unweighted graphs this is twice the eccentricity of any vertex in each
+// component, plus one; otherwise we use the number of vertices.
+template <class Graph, class Weight>
+size_t bb_vertex_diameter(Graph& g, Weight)
+{
+    return num_vertices(g);
+}
+
+template <class Graph>
+size_t bb_vertex_diameter(Graph& g,
+                          UnityPropertyMap<int, GraphInterface::edge_t>)
+{
+    if (graph_tool::is_directed(g))
+        return num_vertices(g);
+
+    size_t N = num_vertices(g);
+    vector<size_t> dist(N, numeric_limits<size_t>::max());
+    vector<size_t> queue;
+    size_t vd = 0;
+    for (auto r : vertices_range(g))
+    {
+        if (dist[r] != numeric_limits<size_t>::max())
+            continue;
+        dist[r] = 0;
+        queue.assign(1, r);
+        size_t ecc = 0;
+        for (size_t i = 0; i < queue.size(); ++i)
+        {
+            size_t v = queue[i];
+            ecc = dist[v];
+            for (auto w : out_neighbors_range(v, g))
+            {
+                if (dist[w] != numeric_limits<size_t>::max())
+                    continue;
+                dist[w] = dist[v] + 1;
+                queue.push_back(w);
+            }
+        }
+        vd = max(vd, 2 * ecc + 1);
+    }
+    return vd;
+}
+
+template <class Graph, class Weight, class EdgeBetweenness,
+          class VertexBetweenness, class RNG>
+size_t approx_betweenness(Graph& g, Weight weight, EdgeBetweenness eb,
+                          VertexBetweenness vb, double epsilon, double delta,
+                          size_t max_eindex, RNG& rng_)
+{
+    typedef typename bb_workspace<Graph, Weight>::type ws_t;
+
+    vector<size_t> vs;
+    for (auto v : vertices_range(g))
+        vs.push_back(v);
+    size_t n = vs.size();
+    size_t E = max_eindex;
+    auto eindex = get(edge_index_t(), g);
+
+    vector<size_t> vcount(num_vertices(g)), ecount(E);
+
+    size_t tau = 0;
+    if (n > 1)
+    {
+        // final sample size, with probability delta/2
+        size_t vd = bb_vertex_diameter(g, weight);
+        double vc = (vd > 3) ? floor(log2(vd - 2)) + 1 : 1;
+        double omega = ceil(.5 / (epsilon * epsilon) *
+                            (vc + log(2 / delta)));
+
+        // intermediate checkpoints, growing by a factor 3/2, with the
+        // remaining delta/2 split between them
+        double M = n + num_edges(g);
+        double tau_min = 7. / 3 * log(4 * M / delta) / epsilon;
+        size_t K = 1;
+        if (omega > tau_min)
+            K = ceil(log(omega / tau_min) / log(1.5)) + 1;
+        double delta_i = delta / (2 * K * M);
+        double log_d = log(4 / delta_i);
+
+        size_t nt = get_openmp_threads();
+        vector<std::shared_ptr<ws_t>> wss(nt);
+        vector<std::shared_ptr<rng_t>> rngs;
+        init_rngs(rngs, rng_);
+
+        for (size_t k = 0; k < K; ++k)
+        {
+            size_t tau_k = ceil(omega * pow(1.5, double(k) - (K - 1)));
+            tau_k = max(tau_k, tau + 1);
+
+            #pragma omp parallel num_threads(nt) \
+                if (tau_k - tau > OPENMP_MIN_THRESH)
+            {
+                size_t tid = 0;
+                #ifdef _OPENMP
+                tid = omp_get_thread_num();
+                #endif
+                if (wss[tid] == nullptr)
+                    wss[tid] = std::make_shared<ws_t>(num_vertices(g));
+                auto& ws = *wss[tid];
+                auto& rng = get_rng(rngs, rng_);
+                uniform_int_distribution<size_t> random_v(0, n - 1);
+
+                #pragma omp for schedule(runtime)
+                for (size_t i = tau; i < tau_k; ++i)
+                {
+                    size_t s = vs[random_v(rng)];
+                    size_t t;
+                    do
+                    {
+                        t = vs[random_v(rng)];
+                    }
+                    while (t == s);
+
+                    bb_sample_path(g, s, t, ws, weight, rng,
+                                   [&](auto v)
+                                   {
+                                       #pragma omp atomic
+                                       vcount[v]++;
+                                   },
+                                   [&](const auto& e)
+                                   {
+                                       #pragma omp atomic
+                                       ecount[eindex[e]]++;
+                                   });
+                    ws.reset();
+                }
+            }
+            tau = tau_k;
+
+            if (k == K - 1)
+                break;
+
+            // the bound increases with the estimate up to 1/2, so it needs
+            // only to be evaluated at the largest count
+            size_t cmax = 0;
+            #pragma omp parallel for reduction(max:cmax) \
+                if (num_vertices(g) > OPENMP_MIN_THRESH)
+            for (size_t i = 0; i < vcount.size(); ++i)
+                cmax = max(cmax, vcount[i]);
+            #pragma omp parallel for reduction(max:cmax) \
+                if (E > OPENMP_MIN_THRESH)
+            for (size_t i = 0; i < ecount.size(); ++i)
+                cmax = max(cmax, ecount[i]);
+
+            double p = min(double(cmax) / tau, .5);
+            double var = p * (1 - p) * tau / (tau - 1);
+            double bound = sqrt(2 * var * log_d / tau) +
+                7 * log_d / (3 * (tau - 1));
+            if (bound <= epsilon)
+                break;
+        }
+    }
+
+    parallel_vertex_loop
+        (g,
+         [&](auto v)
+         {
+             put(vb, v, tau > 0 ? vcount[v] / double(tau) : 0.);
+         });
+
+    parallel_edge_loop
+        (g,
+         [&](const auto& e)
+         {
+             put(eb, e, tau > 0 ? ecount[eindex[e]] / double(tau) : 0.);
+         });
+
+    return tau;
+}
+
+} // graph_tool namespace
+
+#endif // GRAPH_BETWEENNESS_HH
@@ -21,6 +21,7 @@ using namespace boost;
 
 void export_betweenness();
 void export_closeness();
+void export_dynamic_centrality();
 void export_eigentrust();
 void export_eigenvector();
 void export_hits();
@@ -32,6 +33,7 @@ BOOST_PYTHON_MODULE(libgraph_tool_centrality)
 {
     export_betweenness();
     export_closeness();
+    export_dynamic_centrality();
     export_eigentrust();
     export_eigenvector();
     export_hits();
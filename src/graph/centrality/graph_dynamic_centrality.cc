@@ -0,0 +1,140 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "graph_filtering.hh"
+
+#include <boost/python.hpp>
+
+#include "graph.hh"
+#include "graph_selectors.hh"
+#include "graph_properties.hh"
+#include "numpy_bind.hh"
+#include "random.hh"
+
+#include "graph_dynamic_centrality.hh"
+
+using namespace std;
+using namespace boost;
+using namespace graph_tool;
+
+typedef UnityPropertyMap<int,GraphInterface::edge_t> weight_map_t;
+typedef boost::mpl::push_back<edge_scalar_properties, weight_map_t>::type
+    weight_props_t;
+
+DynamicPageRank build_dynamic_pagerank(GraphInterface& gi, boost::any weight,
+                                       boost::any pers, double damping,
+                                       double epsilon)
+{
+    if (!pers.empty() && !belongs<vertex_scalar_properties>()(pers))
+        throw ValueException("personalization vertex property must be of"
+                             " scalar type");
+    if (weight.empty())
+        weight = weight_map_t();
+
+    typedef ConstantPropertyMap<double, GraphInterface::vertex_t> pers_map_t;
+    typedef boost::mpl::push_back<vertex_scalar_properties, pers_map_t>::type
+        pers_props_t;
+
+    bool uniform = pers.empty();
+    if (uniform)
+        pers = pers_map_t(0);
+
+    DynamicPageRank state;
+    run_action<>()
+        (gi, [&](auto& g, auto w, auto&& p)
+             {
+                 state.build(g, w, p, uniform, damping, epsilon);
+             },
+         weight_props_t(), pers_props_t())(weight, pers);
+    return state;
+}
+
+DynamicEigenvector build_dynamic_eigenvector(GraphInterface& gi,
+                                             boost::any weight,
+                                             double epsilon, rng_t& rng)
+{
+    if (weight.empty())
+        weight = weight_map_t();
+
+    DynamicEigenvector state;
+    run_action<>()
+        (gi, [&](auto& g, auto w) { state.build(g, w, epsilon, rng); },
+         weight_props_t())(weight);
+    return state;
+}
+
+edge_delta_t get_edge_delta(python::object oedges, python::object oweights)
+{
+    auto edges = get_array<int64_t, 2>(oedges);
+    auto weights = get_array<double, 1>(oweights);
+    edge_delta_t delta;
+    for (size_t i = 0; i < edges.shape()[0]; ++i)
+    {
+        if (edges[i][0] < 0 || edges[i][1] < 0)
+            throw ValueException("invalid vertex index");
+        delta.emplace_back(edges[i][0], edges[i][1], weights[i]);
+    }
+    return delta;
+}
+
+python::object dynamic_pagerank_update(DynamicPageRank& state,
+                                       python::object oadd,
+                                       python::object oweights,
+                                       python::object oremove,
+                                       python::object oremove_weights,
+                                       size_t N)
+{
+    auto add = get_edge_delta(oadd, oweights);
+    auto remove = get_edge_delta(oremove, oremove_weights);
+    size_t pushes, work, niter;
+    std::tie(pushes, work, niter) = state.update(add, remove, N);
+    return python::make_tuple(pushes, work, niter);
+}
+
+size_t dynamic_eigenvector_update(DynamicEigenvector& state,
+                                  python::object oadd, python::object oweights,
+                                  python::object oremove,
+                                  python::object oremove_weights,
+                                  size_t N, rng_t& rng)
+{
+    auto add = get_edge_delta(oadd, oweights);
+    auto remove = get_edge_delta(oremove, oremove_weights);
+    return state.update(add, remove, N, rng);
+}
+
+void export_dynamic_centrality()
+{
+    using namespace boost::python;
+    class_<DynamicPageRank>("DynamicPageRank", no_init)
+        .def("num_vertices", &DynamicPageRank::num_vertices)
+        .def("get_rank",
+             +[](DynamicPageRank& state)
+              { return wrap_vector_owned(state.get_rank()); })
+        .def("get_residual",
+             +[](DynamicPageRank& state)
+              { return wrap_vector_owned(state.get_residual()); });
+    class_<DynamicEigenvector>("DynamicEigenvector", no_init)
+        .def("num_vertices", &DynamicEigenvector::num_vertices)
+        .def("get_eigenvalue", &DynamicEigenvector::get_eigenvalue)
+        .def("get_eigenvector",
+             +[](DynamicEigenvector& state)
+              { return wrap_vector_owned(state.get_eigenvector()); });
+    def("build_dynamic_pagerank", &build_dynamic_pagerank);
+    def("build_dynamic_eigenvector", &build_dynamic_eigenvector);
+    def("dynamic_pagerank_update", &dynamic_pagerank_update);
+    def("dynamic_eigenvector_update", &dynamic_eigenvector_update);
+}
@@ -0,0 +1,566 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_DYNAMIC_CENTRALITY_HH
+#define GRAPH_DYNAMIC_CENTRALITY_HH
+
+#include <vector>
+#include <deque>
+#include <tuple>
+#include <cmath>
+#include <algorithm>
+
+#include "graph.hh"
+#include "graph_util.hh"
+#include "graph_krylov.hh"
+
+namespace graph_tool
+{
+using namespace std;
+using namespace boost;
+
+// Weighted adjacency lists which can be modified in place, kept separately
+// from the graph. For undirected graphs every edge is stored as two opposing
+// arcs in the out-lists, which then also serve as in-lists.
+
+class dynamic_adjacency
+{
+public:
+    typedef vector<pair<size_t, double>> arc_list_t;
+
+    template <class Graph, class Weight>
+    void build(Graph& g, Weight weight)
+    {
+        size_t N = num_vertices(g);
+        _directed = graph_tool::is_directed(g);
+        _out.clear();
+        _in.clear();
+        _deg.clear();
+        _mask.clear();
+        _E = 0;
+        resize(N);
+        std::fill(_mask.begin(), _mask.end(), 0);
+        _n_valid = 0;
+        for (auto v : vertices_range(g))
+        {
+            _mask[v] = 1;
+            ++_n_valid;
+        }
+        for (auto e : edges_range(g))
+            add_edge(source(e, g), target(e, g), get(weight, e));
+    }
+
+    size_t size() const { return _out.size(); }
+    size_t num_arcs() const { return _directed ? _E : 2 * _E; }
+    bool is_directed() const { return _directed; }
+
+    void resize(size_t N)
+    {
+        if (N <= _out.size())
+            return;
+        _n_valid += N - _out.size();
+        _out.resize(N);
+        if (_directed)
+            _in.resize(N);
+        _deg.resize(N, 0);
+        _mask.resize(N, 1);
+    }
+
+    void add_edge(size_t s, size_t t, double w)
+    {
+        _out[s].emplace_back(t, w);
+        _deg[s] += w;
+        if (_directed)
+        {
+            _in[t].emplace_back(s, w);
+        }
+        else
+        {
+            _out[t].emplace_back(s, w);
+            _deg[t] += w;
+        }
+        ++_E;
+    }
+
+    // Removes one edge s -> t, and returns its weight via w; returns false if
+    // no such edge exists.
+    bool remove_edge(size_t s, size_t t, double& w)
+    {
+        if (s >= size() || t >= size() || !remove_arc(_out[s], t, w))
+            return false;
+        double w2;
+        if (_directed)
+        {
+            remove_arc(_in[t], s, w2);
+        }
+        else
+        {
+            remove_arc(_out[t], s, w2);
+            update_deg(t, w2);
+        }
+        update_deg(s, w);
+        --_E;
+        return true;
+    }
+
+    const arc_list_t& out(size_t v) const { return _out[v]; }
+    const arc_list_t& in(size_t v) const
+    {
+        return _directed ? _in[v] : _out[v];
+    }
+    double deg(size_t v) const { return _deg[v]; }
+    const vector<uint8_t>& mask() const { return _mask; }
+    size_t num_valid() const { return _n_valid; }
+
+private:
+    static bool remove_arc(arc_list_t& arcs, size_t u, double& w)
+    {
+        auto iter = find_if(arcs.begin(), arcs.end(),
+                            [&](auto& a) { return a.first == u; });
+        if (iter == arcs.end())
+            return false;
+        w = iter->second;
+        *iter = arcs.back();
+        arcs.pop_back();
+        return true;
+    }
+
+    void update_deg(size_t v, double w)
+    {
+        // avoid accumulating round-off once the list becomes empty
+        _deg[v] = _out[v].empty() ? 0 : _deg[v] - w;
+    }
+
+    bool _directed = true;
+    size_t _E = 0;
+    size_t _n_valid = 0;
+    vector<arc_list_t> _out, _in;
+    vector<double> _deg;
+    vector<uint8_t> _mask;
+};
+
+typedef vector<std::tuple<size_t, size_t, double>> edge_delta_t;
+
+// PageRank maintained under edge insertions and removals. Together with the
+// ranks r, we keep the residuals
+//
+//     res = (1 - d) p + d A^T D^{-1} r - r,
+//
+// which vanish at the fixed point. An edge update only changes the column of
+// the source vertex u in A^T D^{-1}, so the residuals can be corrected exactly
+// in O(k_u) time. The ranks are then re-converged by pushing the residuals
+// that exceed epsilon/N (Gauss-Southwell iteration), which touches only the
+// region affected by the update. If the pushes exceed the cost estimated for
+// a (warm-started) global iteration, the latter is used instead.
+
+class DynamicPageRank
+{
+public:
+    template <class Graph, class Weight, class Pers>
+    void build(Graph& g, Weight weight, const Pers& pers, bool uniform,
+               double damping, double epsilon)
+    {
+        _adj.build(g, weight);
+        _d = damping;
+        _epsilon = epsilon;
+        _uniform = uniform;
+
+        size_t N = _adj.size();
+        _r.assign(N, 0);
+        _p.assign(N, 0);
+        _res.assign(N, 0);
+        if (_uniform)
+        {
+            set_uniform();
+        }
+        else
+        {
+            for (auto v : vertices_range(g))
+                _res[v] = _p[v] = (1 - _d) * get(pers, v);
+        }
+        _in_queue.assign(N, false);
+        global();
+    }
+
+    // Applies a batch of edge removals followed by insertions, and grows the
+    // number of vertices to at least N. Returns the number of pushes, the
+    // number of arcs traversed by them, and the number of global iterations
+    // performed (zero if the update remained local).
+    std::tuple<size_t, size_t, size_t>
+    update(const edge_delta_t& add, const edge_delta_t& remove, size_t N)
+    {
+        N = std::max(N, _adj.size());
+        for (auto& e : add)
+            N = std::max(N, std::max(std::get<0>(e), std::get<1>(e)) + 1);
+        _touched.clear();
+        if (N > _adj.size())
+            grow(N);
+
+        vector<size_t> us;
+        for (auto* delta : {&add, &remove})
+        {
+            for (auto& e : *delta)
+            {
+                us.push_back(std::get<0>(e));
+                if (!_adj.is_directed())
+                    us.push_back(std::get<1>(e));
+            }
+        }
+        std::sort(us.begin(), us.end());
+        us.erase(std::unique(us.begin(), us.end()), us.end());
+        us.erase(std::remove_if(us.begin(), us.end(),
+                                [&](size_t u) { return u >= _adj.size(); }),
+                 us.end());
+
+        for (auto u : us)
+            contribute(u, -1);
+
+        edge_delta_t removed;
+        for (auto& e : remove)
+        {
+            double w;
+            if (!_adj.remove_edge(std::get<0>(e), std::get<1>(e), w))
+            {
+                // roll back before bailing out
+                for (auto& re : removed)
+                    _adj.add_edge(std::get<0>(re), std::get<1>(re),
+                                  std::get<2>(re));
+                for (auto u : us)
+                    contribute(u, 1);
+                throw ValueException("edge (" +
+                                     lexical_cast<string>(std::get<0>(e)) +
+                                     ", " +
+                                     lexical_cast<string>(std::get<1>(e)) +
+                                     ") does not exist");
+            }
+            removed.emplace_back(std::get<0>(e), std::get<1>(e), w);
+        }
+        for (auto& e : add)
+            _adj.add_edge(std::get<0>(e), std::get<1>(e), std::get<2>(e));
+
+        for (auto u : us)
+            contribute(u, 1);
+
+        return converge();
+    }
+
+    const vector<double>& get_rank() const { return _r; }
+    const vector<double>& get_residual() const { return _res; }
+    size_t num_vertices() const { return _adj.size(); }
+
+private:
+    size_t num_valid() const
+    {
+        return std::max(_adj.num_valid(), size_t(1));
+    }
+
+    double threshold() const { return _epsilon / num_valid(); }
+
+    void set_uniform()
+    {
+        const auto& mask = _adj.mask();
+        double p = (1 - _d) / num_valid();
+        for (size_t v = 0; v < _p.size(); ++v)
+        {
+            double np = mask[v] ? p : 0;
+            _res[v] += np - _p[v];
+            _p[v] = np;
+        }
+    }
+
+    void grow(size_t N)
+    {
+        _adj.resize(N);
+        _r.resize(N, 0);
+        _res.resize(N, 0);
+        _p.resize(N, 0);
+        _in_queue.resize(N, false);
+        if (_uniform)
+        {
+            // the personalization of every vertex changes
+            set_uniform();
+            for (size_t v = 0; v < N; ++v)
+                _touched.push_back(v);
+        }
+    }
+
+    // Adds (sign = 1) or removes (sign = -1) the contribution of vertex u to
+    // the residuals of its out-neighbors.
+    void contribute(size_t u, double sign)
+    {
+        double k = _adj.deg(u);
+        if (k == 0)
+            return;
+        double c = sign * _d * _r[u] / k;
+        for (auto& a : _adj.out(u))
+        {
+            _res[a.first] += c * a.second;
+            _touched.push_back(a.first);
+        }
+    }
+
+    std::tuple<size_t, size_t, size_t> converge()
+    {
+        double tau = threshold();
+        double max_res = 0;
+        for (auto v : _touched)
+        {
+            double r = abs(_res[v]);
+            max_res = std::max(max_res, r);
+            if (r > tau && !_in_queue[v])
+            {
+                _queue.push_back(v);
+                _in_queue[v] = true;
+            }
+        }
+        _touched.clear();
+
+        if (_queue.empty())
+            return std::make_tuple(0, 0, 0);
+
+        // cost of a global iteration started from the current state
+        size_t niter = 1;
+        if (_d > 0)
+            niter += std::max(0., ceil(log(tau / max_res) / log(_d)));
+        size_t budget = niter * (_adj.num_arcs() + _adj.size());
+
+        size_t pushes = 0, work = 0;
+        while (!_queue.empty())
+        {
+            size_t u = _queue.front();
+            _queue.pop_front();
+            _in_queue[u] = false;
+            double rho = _res[u];
+            if (abs(rho) <= tau)
+                continue;
+            _r[u] += rho;
+            _res[u] = 0;
+            ++pushes;
+
+            double k = _adj.deg(u);
+            if (k > 0)
+            {
+                double c = _d * rho / k;
+                for (auto& a : _adj.out(u))
+                {
+                    size_t v = a.first;
+                    _res[v] += c * a.second;
+                    if (abs(_res[v]) > tau && !_in_queue[v])
+                    {
+                        _queue.push_back(v);
+                        _in_queue[v] = true;
+                    }
+                }
+            }
+
+            work += _adj.out(u).size() + 1;
+            if (work > budget)
+            {
+                for (auto v : _queue)
+                    _in_queue[v] = false;
+                _queue.clear();
+                return std::make_tuple(pushes, work, global());
+            }
+        }
+        return std::make_tuple(pushes, work, 0);
+    }
+
+    // Jacobi iteration r <- (1 - d) p + d A^T D^{-1} r, started from the
+    // current values. The difference between successive iterates are exactly
+    // the residuals, which are kept consistent at the end.
+    size_t global()
+    {
+        size_t N = _adj.size();
+        double tau = threshold();
+        vector<double> x(N), r_temp(N);
+        size_t iter = 0;
+        while (true)
+        {
+            double max_res = 0;
+            #pragma omp parallel if (N > OPENMP_MIN_THRESH)
+            {
+                #pragma omp for schedule(static)
+                for (size_t v = 0; v < N; ++v)
+                {
+                    double k = _adj.deg(v);
+                    x[v] = (k > 0) ? _r[v] / k : 0;
+                }
+
+                #pragma omp for schedule(runtime) reduction(max:max_res)
+                for (size_t v = 0; v < N; ++v)
+                {
+                    double y = 0;
+                    for (auto& a : _adj.in(v))
+                        y += x[a.first] * a.second;
+                    r_temp[v] = _p[v] + _d * y;
+                    _res[v] = r_temp[v] - _r[v];
+                    max_res = std::max(max_res, abs(_res[v]));
+                }
+            }
+            ++iter;
+            if (max_res <= tau)
+                break;
+            swap(_r, r_temp);
+        }
+        return iter;
+    }
+
+    dynamic_adjacency _adj;
+    double _d = 0.85;
+    double _epsilon = 1e-6;
+    bool _uniform = true;
+    vector<double> _r, _res, _p;
+    vector<uint8_t> _in_queue;
+    deque<size_t> _queue;
+    vector<size_t> _touched;
+};
+
+// Eigenvector centrality maintained under edge insertions and removals. There
+// is no contracting fixed-point iteration in this case that would allow for
+// local pushes, so after each update the residual of the current eigenpair is
+// evaluated with a single matrix-vector product, and only if it exceeds the
+// tolerance a Krylov solver (Lanczos or Arnoldi) is warm-started from the
+// current eigenvector.
+
+class DynamicEigenvector
+{
+public:
+    template <class Graph, class Weight>
+    void build(Graph& g, Weight weight, double epsilon, rng_t& rng)
+    {
+        _adj.build(g, weight);
+        _epsilon = epsilon;
+        _x.assign(_adj.size(), 0);
+        const auto& mask = _adj.mask();
+        for (size_t v = 0; v < _x.size(); ++v)
+            _x[v] = mask[v];
+        solve(rng);
+    }
+
+    // Applies a batch of edge removals followed by insertions, and grows the
+    // number of vertices to at least N. Returns the number of matrix-vector
+    // products performed.
+    size_t update(const edge_delta_t& add, const edge_delta_t& remove,
+                  size_t N, rng_t& rng)
+    {
+        N = std::max(N, _adj.size());
+        for (auto& e : add)
+            N = std::max(N, std::max(std::get<0>(e), std::get<1>(e)) + 1);
+        _adj.resize(N);
+        _x.resize(N, 0);
+
+        edge_delta_t removed;
+        for (auto& e : remove)
+        {
+            double w;
+            if (!_adj.remove_edge(std::get<0>(e), std::get<1>(e), w))
+            {
+                for (auto& re : removed)
+                    _adj.add_edge(std::get<0>(re), std::get<1>(re),
+                                  std::get<2>(re));
+                throw ValueException("edge (" +
+                                     lexical_cast<string>(std::get<0>(e)) +
+                                     ", " +
+                                     lexical_cast<string>(std::get<1>(e)) +
+                                     ") does not exist");
+            }
+            removed.emplace_back(std::get<0>(e), std::get<1>(e), w);
+        }
+        for (auto& e : add)
+            _adj.add_edge(std::get<0>(e), std::get<1>(e), std::get<2>(e));
+
+        // Rayleigh quotient and residual of the current vector
+        vector<double> y(N);
+        matvec(_x.data(), y.data());
+        double xx = krylov_dot(_x.data(), _x.data(), N);
+        if (xx == 0)
+            return solve(rng) + 1;
+        double lambda = krylov_dot(_x.data(), y.data(), N) / xx;
+        double res = 0;
+        for (size_t v = 0; v < N; ++v)
+            res += pow(y[v] - lambda * _x[v], 2);
+        res = sqrt(res / xx);
+        if (res <= _epsilon * abs(lambda))
+        {
+            _eig = lambda;
+            return 1;
+        }
+        return solve(rng) + 1;
+    }
+
+    const vector<double>& get_eigenvector() const { return _x; }
+    double get_eigenvalue() const { return _eig; }
+    size_t num_vertices() const { return _adj.size(); }
+
+private:
+    void matvec(const double* x, double* y) const
+    {
+        size_t N = _adj.size();
+        #pragma omp parallel for if (N > OPENMP_MIN_THRESH) schedule(runtime)
+        for (size_t v = 0; v < N; ++v)
+        {
+            double r = 0;
+            for (auto& a : _adj.in(v))
+                r += a.second * x[a.first];
+            y[v] = r;
+        }
+    }
+
+    size_t solve(rng_t& rng)
+    {
+        size_t N = _adj.size();
+        krylov_space space(_adj.mask(), rng);
+        if (space.n == 0)
+            return 0;
+        size_t m = std::min(size_t(20), space.n);
+        vector<double> V(N * (m + 1), 0);
+        std::copy(_x.begin(), _x.end(), V.begin());
+
+        auto A = [&](const double* x, double* y) { matvec(x, y); };
+        krylov_info info;
+        vector<double> X;
+        if (_adj.is_directed())
+        {
+            vector<complex<double>> evals;
+            vector<double> Xi;
+            krylov_arnoldi(A, V, N, 1, m, _epsilon, 1000, space, evals, X,
+                           Xi, info);
+            _eig = evals[0].real();
+        }
+        else
+        {
+            vector<double> evals;
+            krylov_schur_sym(A, V, N, 1, m, _epsilon, 1000, space, evals, X,
+                             info);
+            _eig = evals[0];
+        }
+
+        if (std::accumulate(X.begin(), X.end(), 0.) < 0)
+            krylov_scale(X.data(), -1, N);
+        _x = X;
+        return info.nmv;
+    }
+
+    dynamic_adjacency _adj;
+    double _epsilon = 1e-6;
+    double _eig = 0;
+    vector<double> _x;
+};
+
+} // graph_tool namespace
+
+#endif // GRAPH_DYNAMIC_CENTRALITY_HH
@@ -51,9 +51,55 @@ long double eigenvector(GraphInterface& g, boost::any w, boost::any c,
 }
 
 #include <boost/python.hpp>
+#include "numpy_bind.hh"
+#include "random.hh"
+
+python::object eigenvector_krylov(GraphInterface& g, boost::any w,
+                                  boost::any c, size_t k, size_t ncv,
+                                  double epsilon, size_t max_iter,
+                                  rng_t& rng)
+{
+    if (!w.empty() && !belongs<writable_edge_scalar_properties>()(w))
+        throw ValueException("edge property must be writable");
+    if (!belongs<vertex_floating_properties>()(c))
+        throw ValueException("vertex property must be of floating point"
+                             " value type");
+
+    typedef UnityPropertyMap<int,GraphInterface::edge_t> weight_map_t;
+    typedef boost::mpl::push_back<writable_edge_scalar_properties, weight_map_t>::type
+        weight_props_t;
+
+    if(w.empty())
+        w = weight_map_t();
+
+    vector<complex<double>> evals;
+    vector<double> Xr, Xi;
+    krylov_info info;
+    run_action<>()
+        (g, [&](auto& g, auto w, auto c)
+             {
+                 get_eigenvector_krylov()(g, w, c, k, ncv, epsilon, max_iter,
+                                          evals, Xr, Xi, info, rng);
+             },
+         weight_props_t(),
+         vertex_floating_properties())(w, c);
+
+    vector<double> er, ei;
+    for (auto& l : evals)
+    {
+        er.push_back(l.real());
+        ei.push_back(l.imag());
+    }
+    return python::make_tuple(wrap_vector_owned(er), wrap_vector_owned(ei),
+                              wrap_vector_owned(Xr), wrap_vector_owned(Xi),
+                              python::make_tuple(info.nmv, info.restarts,
+                                                 info.converged,
+                                                 wrap_vector_owned(info.residuals)));
+}
 
 void export_eigenvector()
 {
     using namespace boost::python;
     def("get_eigenvector", &eigenvector);
+    def("get_eigenvector_krylov", &eigenvector_krylov);
 }
@@ -21,6 +21,7 @@
 #include "graph.hh"
 #include "graph_filtering.hh"
 #include "graph_util.hh"
+#include "graph_krylov.hh"
 
 #ifndef __clang__
 #include <ext/numeric>
@@ -100,12 +101,83 @@ struct get_eigenvector
         }
 
         if (iter % 2 != 0)
-            parallel_vertex_loop(g, [&](auto v) { c[v] = c_temp[v]; });
+            parallel_vertex_loop(g, [&](auto v) { c_temp[v] = c[v]; });
 
         eig = norm;
     }
 };
 
+// Leading k eigenpairs of the (weighted) adjacency matrix, using thick-restart
+// Lanczos for undirected graphs, and restarted Arnoldi for directed ones. The
+// eigenvectors are returned column-wise in Xr and Xi (real and imaginary
+// parts), and the leading one is also stored in c.
+struct get_eigenvector_krylov
+{
+    template <class Graph, class WeightMap, class CentralityMap>
+    void operator()(Graph& g, WeightMap w, CentralityMap c, size_t k,
+                    size_t ncv, double epsilon, size_t max_iter,
+                    vector<complex<double>>& evals, vector<double>& Xr,
+                    vector<double>& Xi, krylov_info& info, rng_t& rng) const
+    {
+        krylov_space space(g, rng);
+        size_t N = space.N;
+        k = std::min(k, space.n);
+        if (k == 0)
+            return;
+        if (max_iter == 0)
+            max_iter = 1000;
+        size_t m = std::min(std::max(ncv > 0 ? ncv : 20, 2 * k + 1),
+                            space.n);
+
+        krylov_csr A;
+        A.build(g, w, false);
+        auto matvec = [&](const double* x, double* y) { A.matvec(x, y); };
+
+        vector<double> V(N * (m + 1), 0);
+        parallel_vertex_loop(g, [&](auto v) { V[v] = c[v]; });
+        if (k > 1)
+        {
+            // break the symmetries of the initial vector, which would
+            // otherwise hide degenerate eigenvalues
+            vector<double> r(N);
+            space.random(r.data());
+            double vnorm = sqrt(krylov_dot(V.data(), V.data(), N) / space.n);
+            for (size_t i = 0; i < N; ++i)
+                V[i] += 1e-2 * vnorm * r[i];
+        }
+
+        if (graph_tool::is_directed(g))
+        {
+            krylov_arnoldi(matvec, V, N, k, m, epsilon, max_iter, space, evals,
+                           Xr, Xi, info);
+        }
+        else
+        {
+            vector<double> d;
+            krylov_schur_sym(matvec, V, N, k, m, epsilon, max_iter, space, d,
+                             Xr, info);
+            evals.assign(d.begin(), d.end());
+            Xi.assign(N * k, 0);
+        }
+
+        // fix the arbitrary sign, so that the vectors have a positive sum
+        for (size_t l = 0; l < k; ++l)
+        {
+            double s = std::accumulate(Xr.begin() + l * N,
+                                       Xr.begin() + (l + 1) * N, 0.);
+            if (s >= 0)
+                continue;
+            for (size_t i = l * N; i < (l + 1) * N; ++i)
+            {
+                Xr[i] = -Xr[i];
+                Xi[i] = -Xi[i];
+            }
+        }
+
+        parallel_vertex_loop(g, [&](auto v) { c[v] = Xr[v]; });
+    }
+};
+
 }
 
 #endif
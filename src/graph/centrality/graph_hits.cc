@@ -22,6 +22,8 @@
 #include "graph.hh"
 #include "graph_selectors.hh"
 #include "graph_hits.hh"
+#include "numpy_bind.hh"
+#include "random.hh"
 
 using namespace std;
 using namespace boost;
@@ -76,8 +78,56 @@ long double hits(GraphInterface& g, boost::any w, boost::any x, boost::any y,
     return eig;
 }
 
+python::object hits_krylov(GraphInterface& g, boost::any w, boost::any x,
+                           boost::any y, size_t k, size_t ncv, double epsilon,
+                           size_t max_iter, rng_t& rng)
+{
+    if (!w.empty() && !belongs<writable_edge_scalar_properties>()(w))
+        throw ValueException("edge property must be writable");
+    if (!belongs<vertex_floating_properties>()(x))
+        throw ValueException("vertex property must be of floating point"
+                             " value type");
+
+    typedef UnityPropertyMap<int,GraphInterface::edge_t> weight_map_t;
+    typedef boost::mpl::push_back<writable_edge_scalar_properties, weight_map_t>::type
+        weight_props_t;
+
+    if(w.empty())
+        w = weight_map_t();
+
+    vector<double> sigma, X, Y;
+    krylov_info info;
+    run_action<>()
+        (g, [&](auto& g, auto w, auto x)
+             {
+                 typedef decltype(x) map_t;
+                 typename map_t::checked_t cy;
+                 try
+                 {
+                     cy = any_cast<typename map_t::checked_t>(y);
+                 }
+                 catch (bad_any_cast&)
+                 {
+                     throw GraphException("x and y vertex properties must be of"
+                                          " the same type.");
+                 }
+                 get_hits_krylov()(g, w, x, cy.get_unchecked(num_vertices(g)),
+                                   k, ncv, epsilon, max_iter, sigma, X, Y,
+                                   info, rng);
+             },
+         weight_props_t(),
+         vertex_floating_properties())(w, x);
+
+    return python::make_tuple(wrap_vector_owned(sigma), wrap_vector_owned(X),
+                              wrap_vector_owned(Y),
+                              python::make_tuple(info.nmv, info.restarts,
+                                                 info.converged,
+                                                 wrap_vector_owned(info.residuals)));
+}
+
 void export_hits()
 {
     using namespace boost::python;
     def("get_hits", &hits);
+    def("get_hits_krylov", &hits_krylov);
 }
@@ -15,12 +15,13 @@
 // You should have received a copy of the GNU General Public License
 // along with this program. If not, see <http://www.gnu.org/licenses/>.
 
-#ifndef GRAPH_EIGENVECTOR_HH
-#define GRAPH_EIGENVECTOR_HH
+#ifndef GRAPH_HITS_HH
+#define GRAPH_HITS_HH
 
 #include "graph.hh"
 #include "graph_filtering.hh"
 #include "graph_util.hh"
+#include "graph_krylov.hh"
 
 #ifndef __clang__
 #include <ext/numeric>
@@ -127,8 +128,8 @@ struct get_hits
                 (g,
                  [&](auto v)
                  {
-                     x[v] = x_temp[v];
-                     y[v] = y_temp[v];
+                     x_temp[v] = x[v];
+                     y_temp[v] = y[v];
                  });
         }
 
@@ -136,6 +137,82 @@ struct get_hits
     }
 };
 
+// Leading k singular triplets of the (weighted) adjacency matrix, obtained
+// with thick-restart Lanczos on the symmetric matrix A^T A. The authority and
+// hub vectors are returned column-wise in X and Y, and the leading ones are
+// also stored in x and y.
+struct get_hits_krylov
+{
+    template <class Graph, class WeightMap, class CentralityMap>
+    void operator()(Graph& g, WeightMap w, CentralityMap x, CentralityMap y,
+                    size_t k, size_t ncv, double epsilon, size_t max_iter,
+                    vector<double>& sigma, vector<double>& X,
+                    vector<double>& Y, krylov_info& info, rng_t& rng) const
+    {
+        krylov_space space(g, rng);
+        size_t N = space.N;
+        k = std::min(k, space.n);
+        if (k == 0)
+            return;
+        if (max_iter == 0)
+            max_iter = 1000;
+        size_t m = std::min(std::max(ncv > 0 ? ncv : 20, 2 * k + 1),
+                            space.n);
+
+        // P u = A^T u (sum over in-neighbors), Q u = A u (sum over
+        // out-neighbors)
+        krylov_csr P, Q;
+        P.build(g, w, false);
+        if (graph_tool::is_directed(g))
+            Q.build(g, w, true);
+        auto& Qr = graph_tool::is_directed(g) ? Q : P;
+
+        vector<double> temp(N);
+        auto matvec = [&](const double* u, double* r)
+            {
+                Qr.matvec(u, temp.data());
+                P.matvec(temp.data(), r);
+            };
+
+        vector<double> V(N * (m + 1), 0);
+        parallel_vertex_loop(g, [&](auto v) { V[v] = x[v]; });
+        if (k > 1)
+        {
+            vector<double> r(N);
+            space.random(r.data());
+            double vnorm = sqrt(krylov_dot(V.data(), V.data(), N) / space.n);
+            for (size_t i = 0; i < N; ++i)
+                V[i] += 1e-2 * vnorm * r[i];
+        }
+
+        vector<double> d;
+        krylov_schur_sym(matvec, V, N, k, m, epsilon, max_iter, space, d, X,
+                         info);
+
+        sigma.resize(k);
+        Y.resize(N * k);
+        for (size_t l = 0; l < k; ++l)
+        {
+            double* xl = X.data() + l * N;
+            double* yl = Y.data() + l * N;
+            if (std::accumulate(xl, xl + N, 0.) < 0)
+                krylov_scale(xl, -1, N);
+            sigma[l] = sqrt(std::max(d[l], 0.));
+            Qr.matvec(xl, yl);
+            if (sigma[l] > 0)
+                krylov_scale(yl, 1. / sigma[l], N);
+        }
+
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 x[v] = X[v];
+                 y[v] = Y[v];
+             });
+    }
+};
+
 }
 
 #endif
@@ -22,6 +22,8 @@
 #include "graph.hh"
 #include "graph_selectors.hh"
 #include "graph_katz.hh"
+#include "numpy_bind.hh"
+#include "random.hh"
 
 using namespace std;
 using namespace boost;
@@ -61,8 +63,51 @@ void katz(GraphInterface& g, boost::any w, boost::any c, boost::any beta,
                    beta_props_t())(w, c, beta);
 }
 
+python::object katz_krylov(GraphInterface& g, boost::any w, boost::any c,
+                           boost::any beta, long double alpha, double epsilon,
+                           size_t max_iter, size_t ncv, rng_t& rng)
+{
+    if (!w.empty() && !belongs<writable_edge_scalar_properties>()(w))
+        throw ValueException("edge property must be writable");
+    if (!belongs<vertex_floating_properties>()(c))
+        throw ValueException("centrality vertex property must be of floating point"
+                             " value type");
+    if (!beta.empty() && !belongs<vertex_floating_properties>()(beta))
+        throw ValueException("personalization vertex property must be of floating point"
+                             " value type");
+
+    typedef UnityPropertyMap<int,GraphInterface::edge_t> weight_map_t;
+    typedef boost::mpl::push_back<writable_edge_scalar_properties, weight_map_t>::type
+        weight_props_t;
+
+    if(w.empty())
+        w = weight_map_t();
+
+    typedef UnityPropertyMap<int,GraphInterface::vertex_t> beta_map_t;
+    typedef boost::mpl::push_back<vertex_floating_properties, beta_map_t>::type
+        beta_props_t;
+
+    if(beta.empty())
+        beta = beta_map_t();
+
+    krylov_info info;
+    run_action<>()
+        (g, [&](auto& g, auto w, auto c, auto beta)
+             {
+                 get_katz_krylov()(g, w, c, beta, alpha, epsilon, max_iter,
+                                   ncv, info, rng);
+             },
+         weight_props_t(),
+         vertex_floating_properties(),
+         beta_props_t())(w, c, beta);
+
+    return python::make_tuple(info.nmv, info.restarts, info.converged,
+                              wrap_vector_owned(info.residuals));
+}
+
 void export_katz()
 {
     using namespace boost::python;
     def("get_katz", &katz);
+    def("get_katz_krylov", &katz_krylov);
 }
@@ -15,12 +15,13 @@
 // You should have received a copy of the GNU General Public License
 // along with this program. If not, see <http://www.gnu.org/licenses/>.
 
-#ifndef GRAPH_EIGENVECTOR_HH
-#define GRAPH_EIGENVECTOR_HH
+#ifndef GRAPH_KATZ_HH
+#define GRAPH_KATZ_HH
 
 #include "graph.hh"
 #include "graph_filtering.hh"
 #include "graph_util.hh"
+#include "graph_krylov.hh"
 
 #ifndef __clang__
 #include <ext/numeric>
@@ -87,6 +88,57 @@ struct get_katz
     }
 };
 
+// Solves the Katz system (I - alpha A) x = beta directly, using conjugate
+// gradients if the matrix is symmetric (i.e. the graph is undirected), or
+// GMRES otherwise. The latter is also used as a fallback if the symmetric
+// matrix is not positive-definite, i.e. if alpha exceeds the inverse of the
+// largest eigenvalue.
+struct get_katz_krylov
+{
+    template <class Graph, class WeightMap, class CentralityMap,
+              class PersonalizationMap>
+    void operator()(Graph& g, WeightMap w, CentralityMap c,
+                    PersonalizationMap beta, long double alpha,
+                    double epsilon, size_t max_iter, size_t ncv,
+                    krylov_info& info, rng_t& rng) const
+    {
+        krylov_space space(g, rng);
+        size_t N = space.N;
+        if (space.n == 0)
+            return;
+        if (max_iter == 0)
+            max_iter = std::max(size_t(1000), space.n);
+        size_t m = std::min(space.n, ncv > 0 ? ncv : 30);
+
+        krylov_csr A;
+        A.build(g, w, false);
+        double a = alpha;
+        auto matvec = [&](const double* u, double* r)
+            {
+                A.matvec(u, r);
+                #pragma omp parallel for simd if (N > OPENMP_MIN_THRESH) \
+                    schedule(static)
+                for (size_t i = 0; i < N; ++i)
+                    r[i] = u[i] - a * r[i];
+            };
+
+        vector<double> b(N, 0), x(N, 0);
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 b[v] = get(beta, v);
+                 x[v] = c[v];
+             });
+
+        if (graph_tool::is_directed(g) ||
+            !krylov_cg(matvec, b, x, N, epsilon, max_iter, info))
+            krylov_gmres(matvec, b, x, N, m, epsilon, max_iter, space, info);
+
+        parallel_vertex_loop(g, [&](auto v) { c[v] = x[v]; });
+    }
+};
+
 }
 
 #endif
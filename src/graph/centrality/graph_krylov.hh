@@ -0,0 +1,960 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_KRYLOV_HH
+#define GRAPH_KRYLOV_HH
+
+#include <vector>
+#include <complex>
+#include <numeric>
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <cmath>
+
+#include "graph.hh"
+#include "graph_filtering.hh"
+#include "graph_util.hh"
+#include "random.hh"
+
+namespace graph_tool
+{
+using namespace std;
+using namespace boost;
+
+// Krylov subspace solvers used by the spectral centralities. All dense
+// vectors have length num_vertices(g) and are indexed by vertex index; the
+// entries of filtered vertices are kept at zero throughout, so they do not
+// affect any inner product.
+
+// Compressed snapshot of the weighted adjacency matrix. Row v lists the
+// in-neighbors of v (or its out-neighbors, if "transpose" is set), so that
+// matvec() computes y[v] = \sum_u A_{uv} x[u] (or \sum_u A_{vu} x[u]), the
+// same contraction used by the power iterations.
+struct krylov_csr
+{
+    vector<size_t> ptr;
+    vector<size_t> idx;
+    vector<double> w;
+
+    template <class Graph, class WeightMap>
+    void build(Graph& g, WeightMap weight, bool transpose)
+    {
+        size_t N = num_vertices(g);
+        ptr.assign(N + 1, 0);
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 if (transpose || !graph_tool::is_directed(g))
+                     ptr[v + 1] = out_degree(v, g);
+                 else
+                     ptr[v + 1] = in_degreeS()(v, g);
+             });
+        std::partial_sum(ptr.begin(), ptr.end(), ptr.begin());
+
+        idx.resize(ptr[N]);
+        w.resize(ptr[N]);
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 size_t pos = ptr[v];
+                 if (transpose)
+                 {
+                     for (const auto& e : out_edges_range(v, g))
+                     {
+                         idx[pos] = target(e, g);
+                         w[pos++] = get(weight, e);
+                     }
+                 }
+                 else
+                 {
+                     for (const auto& e : in_or_out_edges_range(v, g))
+                     {
+                         if (graph_tool::is_directed(g))
+                             idx[pos] = source(e, g);
+                         else
+                             idx[pos] = target(e, g);
+                         w[pos++] = get(weight, e);
+                     }
+                 }
+             });
+    }
+
+    size_t size() const { return ptr.size() - 1; }
+
+    void matvec(const double* x, double* y) const
+    {
+        size_t N = size();
+        #pragma omp parallel for if (N > OPENMP_MIN_THRESH) schedule(runtime)
+        for (size_t v = 0; v < N; ++v)
+        {
+            double r = 0;
+            for (size_t i = ptr[v]; i < ptr[v + 1]; ++i)
+                r += w[i] * x[idx[i]];
+            y[v] = r;
+        }
+    }
+};
+
+// Bookkeeping of the valid (i.e. unfiltered) vertices, used to generate
+// random vectors supported only on them, drawn from the given RNG.
+struct krylov_space
+{
+    template <class Graph>
+    krylov_space(Graph& g, rng_t& rng)
+        : N(num_vertices(g)), mask(N, 0), rng(rng)
+    {
+        parallel_vertex_loop(g, [&](auto v) { mask[v] = 1; });
+        n = std::accumulate(mask.begin(), mask.end(), size_t(0));
+    }
+
+    krylov_space(vector<uint8_t> valid, rng_t& rng)
+        : N(valid.size()), mask(std::move(valid)), rng(rng)
+    {
+        n = std::accumulate(mask.begin(), mask.end(), size_t(0));
+    }
+
+    void random(double* x)
+    {
+        std::uniform_real_distribution<double> sample(-1, 1);
+        for (size_t i = 0; i < N; ++i)
+            x[i] = mask[i] ? sample(rng) : 0;
+    }
+
+    size_t N;
+    size_t n;
+    vector<uint8_t> mask;
+    rng_t& rng;
+};
+
+// Convergence diagnostics
+struct krylov_info
+{
+    size_t nmv = 0;       // matrix-vector products
+    size_t restarts = 0;  // restarts (eigensolvers) or outer cycles (GMRES)
+    bool converged = false;
+    vector<double> residuals;
+};
+
+// Dense level-1 and level-2 kernels over the (column-major) Krylov basis
+// V = [v_0, ..., v_{n-1}], with columns of length N. The row range is split
+// into tiles, so that each thread streams through contiguous column pieces.
+
+constexpr size_t krylov_tile = 1024;
+
+inline double krylov_dot(const double* x, const double* y, size_t N)
+{
+    double r = 0;
+    #pragma omp parallel for simd if (N > OPENMP_MIN_THRESH) \
+        schedule(static) reduction(+:r)
+    for (size_t i = 0; i < N; ++i)
+        r += x[i] * y[i];
+    return r;
+}
+
+inline void krylov_scale(double* x, double c, size_t N)
+{
+    #pragma omp parallel for simd if (N > OPENMP_MIN_THRESH) schedule(static)
+    for (size_t i = 0; i < N; ++i)
+        x[i] *= c;
+}
+
+// h = V^T w
+inline void krylov_project(const double* V, size_t N, size_t n,
+                           const double* w, double* h)
+{
+    for (size_t j = 0; j < n; ++j)
+        h[j] = 0;
+    size_t nt = (N + krylov_tile - 1) / krylov_tile;
+    #pragma omp parallel if (N > OPENMP_MIN_THRESH)
+    {
+        vector<double> lh(n, 0);
+        #pragma omp for schedule(static)
+        for (size_t t = 0; t < nt; ++t)
+        {
+            size_t lo = t * krylov_tile;
+            size_t hi = std::min(N, lo + krylov_tile);
+            for (size_t j = 0; j < n; ++j)
+            {
+                const double* vj = V + j * N;
+                double r = 0;
+                #pragma omp simd reduction(+:r)
+                for (size_t i = lo; i < hi; ++i)
+                    r += vj[i] * w[i];
+                lh[j] += r;
+            }
+        }
+        #pragma omp critical
+        for (size_t j = 0; j < n; ++j)
+            h[j] += lh[j];
+    }
+}
+
+// w -= V h
+inline void krylov_subtract(const double* V, size_t N, size_t n,
+                            const double* h, double* w)
+{
+    size_t nt = (N + krylov_tile - 1) / krylov_tile;
+    #pragma omp parallel for if (N > OPENMP_MIN_THRESH) schedule(static)
+    for (size_t t = 0; t < nt; ++t)
+    {
+        size_t lo = t * krylov_tile;
+        size_t hi = std::min(N, lo + krylov_tile);
+        for (size_t j = 0; j < n; ++j)
+        {
+            const double* vj = V + j * N;
+            double c = h[j];
+            #pragma omp simd
+            for (size_t i = lo; i < hi; ++i)
+                w[i] -= c * vj[i];
+        }
+    }
+}
+
+// [y_0, ..., y_{p-1}] = V S, where S is a n x p row-major matrix with leading
+// dimension ld. The result may overwrite the first p columns of V itself.
+inline void krylov_combine(double* V, size_t N, size_t n, const double* S,
+                           size_t ld, size_t p, double* Y)
+{
+    size_t nt = (N + krylov_tile - 1) / krylov_tile;
+    #pragma omp parallel if (N > OPENMP_MIN_THRESH)
+    {
+        vector<double> buf(krylov_tile * p);
+        #pragma omp for schedule(static)
+        for (size_t t = 0; t < nt; ++t)
+        {
+            size_t lo = t * krylov_tile;
+            size_t hi = std::min(N, lo + krylov_tile);
+            std::fill(buf.begin(), buf.end(), 0);
+            for (size_t j = 0; j < n; ++j)
+            {
+                const double* vj = V + j * N;
+                for (size_t l = 0; l < p; ++l)
+                {
+                    double c = S[j * ld + l];
+                    if (c == 0)
+                        continue;
+                    double* b = &buf[l * krylov_tile];
+                    #pragma omp simd
+                    for (size_t i = lo; i < hi; ++i)
+                        b[i - lo] += c * vj[i];
+                }
+            }
+            for (size_t l = 0; l < p; ++l)
+                std::copy(buf.begin() + l * krylov_tile,
+                          buf.begin() + l * krylov_tile + (hi - lo),
+                          Y + l * N + lo);
+        }
+    }
+}
+
+// Orthogonalizes w against the first n columns of V with two passes of
+// classical Gram-Schmidt, accumulating the coefficients in h. Returns the
+// norm of the remainder.
+inline double krylov_orthogonalize(const double* V, size_t N, size_t n,
+                                   double* w, double* h)
+{
+    vector<double> h2(n);
+    krylov_project(V, N, n, w, h);
+    krylov_subtract(V, N, n, h, w);
+    krylov_project(V, N, n, w, h2.data());
+    krylov_subtract(V, N, n, h2.data(), w);
+    for (size_t j = 0; j < n; ++j)
+        h[j] += h2[j];
+    return sqrt(krylov_dot(w, w, N));
+}
+
+// Extends an Arnoldi decomposition A V_p = V_{p+1} H_p from column p up to
+// column q, where H is stored row-major with leading dimension ld. On
+// breakdown (an invariant subspace has been found) the basis is continued
+// with a random orthogonal vector, and the corresponding sub-diagonal entry is
+// set to zero.
+template <class MatVec>
+void krylov_expand(MatVec& A, double* V, size_t N, double* H, size_t ld,
+                   size_t p, size_t q, krylov_space& space, krylov_info& info)
+{
+    for (size_t j = p; j < q; ++j)
+    {
+        double* w = V + (j + 1) * N;
+        A(V + j * N, w);
+        info.nmv++;
+
+        vector<double> h(j + 1);
+        double beta = krylov_orthogonalize(V, N, j + 1, w, h.data());
+        double hnorm = beta;
+        for (size_t i = 0; i <= j; ++i)
+        {
+            H[i * ld + j] = h[i];
+            hnorm += abs(h[i]);
+        }
+
+        if (beta > hnorm * 1e3 * numeric_limits<double>::epsilon())
+        {
+            H[(j + 1) * ld + j] = beta;
+            krylov_scale(w, 1. / beta, N);
+            continue;
+        }
+
+        H[(j + 1) * ld + j] = 0;
+        double r = 0;
+        if (j + 1 < space.n)
+        {
+            space.random(w);
+            r = krylov_orthogonalize(V, N, j + 1, w, h.data());
+        }
+        if (r > 0)
+            krylov_scale(w, 1. / r, N);
+        else
+            std::fill(w, w + N, 0);
+    }
+}
+
+// Eigendecomposition T = S diag(d) S^T of a small dense symmetric matrix via
+// cyclic Jacobi rotations. The eigenvalues are returned in decreasing order,
+// and the columns of the row-major matrix S are the eigenvectors.
+inline void krylov_sym_eig(vector<double> T, size_t n, vector<double>& d,
+                           vector<double>& S)
+{
+    vector<double> U(n * n, 0);
+    for (size_t i = 0; i < n; ++i)
+        U[i * n + i] = 1;
+
+    for (size_t sweep = 0; sweep < 100; ++sweep)
+    {
+        double off = 0, tot = 0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            for (size_t j = 0; j < n; ++j)
+            {
+                double a = T[i * n + j] * T[i * n + j];
+                tot += a;
+                if (i != j)
+                    off += a;
+            }
+        }
+        if (off <= tot * 1e-32)
+            break;
+
+        for (size_t p = 0; p < n; ++p)
+        {
+            for (size_t q = p + 1; q < n; ++q)
+            {
+                double apq = T[p * n + q];
+                if (apq == 0)
+                    continue;
+                double theta = (T[q * n + q] - T[p * n + p]) / (2 * apq);
+                double t = 1. / (abs(theta) + sqrt(theta * theta + 1));
+                if (theta < 0)
+                    t = -t;
+                double c = 1. / sqrt(t * t + 1);
+                double s = t * c;
+                for (size_t k = 0; k < n; ++k)
+                {
+                    double akp = T[k * n + p], akq = T[k * n + q];
+                    T[k * n + p] = c * akp - s * akq;
+                    T[k * n + q] = s * akp + c * akq;
+                }
+                for (size_t k = 0; k < n; ++k)
+                {
+                    double apk = T[p * n + k], aqk = T[q * n + k];
+                    T[p * n + k] = c * apk - s * aqk;
+                    T[q * n + k] = s * apk + c * aqk;
+                }
+                for (size_t k = 0; k < n; ++k)
+                {
+                    double ukp = U[k * n + p], ukq = U[k * n + q];
+                    U[k * n + p] = c * ukp - s * ukq;
+                    U[k * n + q] = s * ukp + c * ukq;
+                }
+            }
+        }
+    }
+
+    vector<size_t> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(),
+              [&](size_t i, size_t j)
+              { return T[i * n + i] > T[j * n + j]; });
+    d.resize(n);
+    S.resize(n * n);
+    for (size_t l = 0; l < n; ++l)
+    {
+        d[l] = T[order[l] * n + order[l]];
+        for (size_t i = 0; i < n; ++i)
+            S[i * n + l] = U[i * n + order[l]];
+    }
+}
+
+// Eigenvalues of a small dense upper Hessenberg matrix, via the shifted QR
+// algorithm in complex arithmetic with Wilkinson shifts and deflation.
+inline void krylov_hess_eigvals(vector<complex<double>> H, size_t n,
+                                vector<complex<double>>& ev)
+{
+    typedef complex<double> cplx;
+    ev.resize(n);
+    double eps = numeric_limits<double>::epsilon();
+    size_t hi = n;
+    size_t iter = 0;
+    while (hi > 0)
+    {
+        size_t m = hi - 1;
+        size_t l = m;
+        for (; l > 0; --l)
+        {
+            double s = abs(H[l * n + l]) + abs(H[(l - 1) * n + l - 1]);
+            if (abs(H[l * n + l - 1]) <= eps * s)
+            {
+                H[l * n + l - 1] = 0;
+                break;
+            }
+        }
+
+        if (l == m || iter > 100 * n)
+        {
+            // converged (or stagnated, in which case the diagonal is taken
+            // as is)
+            ev[m] = H[m * n + m];
+            --hi;
+            iter = 0;
+            continue;
+        }
+
+        cplx a = H[(m - 1) * n + m - 1], b = H[(m - 1) * n + m],
+             c = H[m * n + m - 1], d = H[m * n + m];
+        cplx tr = (a + d) / 2.;
+        cplx disc = sqrt(tr * tr - (a * d - b * c));
+        cplx mu = (abs(tr + disc - d) < abs(tr - disc - d)) ?
+            tr + disc : tr - disc;
+        if (iter > 0 && iter % 10 == 0)
+            mu = d + abs(c) * cplx(0.75, 0.5);   // exceptional shift
+        ++iter;
+
+        for (size_t i = l; i <= m; ++i)
+            H[i * n + i] -= mu;
+
+        vector<cplx> gc(m - l), gs(m - l);
+        for (size_t i = l; i < m; ++i)
+        {
+            cplx x = H[i * n + i], y = H[(i + 1) * n + i];
+            double r = sqrt(norm(x) + norm(y));
+            cplx cc = 1, ss = 0;
+            if (r > 0)
+            {
+                cc = x / r;
+                ss = y / r;
+            }
+            for (size_t j = i; j <= m; ++j)
+            {
+                cplx u = H[i * n + j], v = H[(i + 1) * n + j];
+                H[i * n + j] = conj(cc) * u + conj(ss) * v;
+                H[(i + 1) * n + j] = -ss * u + cc * v;
+            }
+            gc[i - l] = cc;
+            gs[i - l] = ss;
+        }
+        for (size_t i = l; i < m; ++i)
+        {
+            cplx cc = gc[i - l], ss = gs[i - l];
+            for (size_t k = l; k <= std::min(i + 1, m); ++k)
+            {
+                cplx u = H[k * n + i], v = H[k * n + i + 1];
+                H[k * n + i] = u * cc + v * ss;
+                H[k * n + i + 1] = -u * conj(ss) + v * conj(cc);
+            }
+        }
+
+        for (size_t i = l; i <= m; ++i)
+            H[i * n + i] += mu;
+    }
+}
+
+// Eigenvalues of a small dense general matrix, via reduction to upper
+// Hessenberg form with Householder reflections.
+inline void krylov_eigvals(vector<complex<double>> H, size_t n,
+                           vector<complex<double>>& ev)
+{
+    vector<complex<double>> v(n);
+    for (size_t k = 0; k + 2 < n; ++k)
+    {
+        double xnorm = 0;
+        for (size_t i = k + 1; i < n; ++i)
+            xnorm += norm(H[i * n + k]);
+        xnorm = sqrt(xnorm);
+        if (xnorm == 0)
+            continue;
+        complex<double> x0 = H[(k + 1) * n + k];
+        complex<double> alpha = (abs(x0) > 0) ? -x0 / abs(x0) * xnorm :
+            complex<double>(-xnorm);
+        double vnorm = 0;
+        for (size_t i = k + 1; i < n; ++i)
+        {
+            v[i] = H[i * n + k];
+            if (i == k + 1)
+                v[i] -= alpha;
+            vnorm += norm(v[i]);
+        }
+        if (vnorm == 0)
+            continue;
+
+        // H <- (I - 2 v v^H / |v|^2) H (I - 2 v v^H / |v|^2)
+        for (size_t j = 0; j < n; ++j)
+        {
+            complex<double> r = 0;
+            for (size_t i = k + 1; i < n; ++i)
+                r += conj(v[i]) * H[i * n + j];
+            r *= 2 / vnorm;
+            for (size_t i = k + 1; i < n; ++i)
+                H[i * n + j] -= v[i] * r;
+        }
+        for (size_t i = 0; i < n; ++i)
+        {
+            complex<double> r = 0;
+            for (size_t j = k + 1; j < n; ++j)
+                r += H[i * n + j] * v[j];
+            r *= 2 / vnorm;
+            for (size_t j = k + 1; j < n; ++j)
+                H[i * n + j] -= r * conj(v[j]);
+        }
+        for (size_t i = k + 2; i < n; ++i)
+            H[i * n + k] = 0;
+    }
+    krylov_hess_eigvals(std::move(H), n, ev);
+}
+
+// Eigenvector of a small dense matrix H for a given eigenvalue, via two steps
+// of inverse iteration. The result is normalized, with its largest component
+// real and positive.
+inline void krylov_eigvec(const vector<complex<double>>& H, size_t n,
+                          complex<double> lambda, vector<complex<double>>& y)
+{
+    typedef complex<double> cplx;
+    double hnorm = 0;
+    for (auto& h : H)
+        hnorm = std::max(hnorm, abs(h));
+    double tiny = std::max(hnorm, 1.) * n * numeric_limits<double>::epsilon();
+
+    vector<cplx> LU(H);
+    for (size_t i = 0; i < n; ++i)
+        LU[i * n + i] -= lambda + tiny;
+    vector<size_t> piv(n);
+    for (size_t k = 0; k < n; ++k)
+    {
+        size_t p = k;
+        for (size_t i = k + 1; i < n; ++i)
+            if (abs(LU[i * n + k]) > abs(LU[p * n + k]))
+                p = i;
+        piv[k] = p;
+        if (p != k)
+            for (size_t j = 0; j < n; ++j)
+                std::swap(LU[k * n + j], LU[p * n + j]);
+        if (abs(LU[k * n + k]) < tiny)
+            LU[k * n + k] = tiny;
+        for (size_t i = k + 1; i < n; ++i)
+        {
+            cplx f = LU[i * n + k] / LU[k * n + k];
+            LU[i * n + k] = f;
+            for (size_t j = k + 1; j < n; ++j)
+                LU[i * n + j] -= f * LU[k * n + j];
+        }
+    }
+
+    y.assign(n, 1);
+    for (size_t it = 0; it < 2; ++it)
+    {
+        for (size_t k = 0; k < n; ++k)
+            std::swap(y[k], y[piv[k]]);
+        for (size_t i = 0; i < n; ++i)
+            for (size_t j = 0; j < i; ++j)
+                y[i] -= LU[i * n + j] * y[j];
+        for (size_t i = n; i-- > 0;)
+        {
+            for (size_t j = i + 1; j < n; ++j)
+                y[i] -= LU[i * n + j] * y[j];
+            y[i] /= LU[i * n + i];
+        }
+
+        double ynorm = 0;
+        size_t imax = 0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            ynorm += norm(y[i]);
+            if (abs(y[i]) > abs(y[imax]))
+                imax = i;
+        }
+        cplx phase = conj(y[imax]) / abs(y[imax]);
+        ynorm = sqrt(ynorm);
+        for (auto& x : y)
+            x *= phase / ynorm;
+    }
+}
+
+// Largest (algebraic) eigenpairs of a symmetric operator, via the Krylov-Schur
+// variant of the thick-restart Lanczos method, with full reorthogonalization.
+//
+// On entry, the first column of V (of size N * (m + 1)) contains the starting
+// vector. On exit, evals contains the k leading eigenvalues, and X (of size N
+// * k) the corresponding orthonormal eigenvectors.
+template <class MatVec>
+void krylov_schur_sym(MatVec&& A, vector<double>& V, size_t N, size_t k,
+                      size_t m, double tol, size_t max_restarts,
+                      krylov_space& space, vector<double>& evals,
+                      vector<double>& X, krylov_info& info)
+{
+    double vnorm = sqrt(krylov_dot(V.data(), V.data(), N));
+    if (vnorm == 0)
+    {
+        space.random(V.data());
+        vnorm = sqrt(krylov_dot(V.data(), V.data(), N));
+    }
+    krylov_scale(V.data(), 1. / vnorm, N);
+
+    vector<double> H((m + 1) * m, 0), T(m * m), d, S;
+    size_t p = 0;
+    while (true)
+    {
+        krylov_expand(A, V.data(), N, H.data(), m, p, m, space, info);
+
+        for (size_t i = 0; i < m; ++i)
+            for (size_t j = 0; j < m; ++j)
+                T[i * m + j] = (H[i * m + j] + H[j * m + i]) / 2;
+        krylov_sym_eig(T, m, d, S);
+
+        double beta = H[m * m + m - 1];
+        info.residuals.resize(k);
+        bool done = true;
+        for (size_t i = 0; i < k; ++i)
+        {
+            info.residuals[i] = abs(beta * S[(m - 1) * m + i]);
+            if (info.residuals[i] > tol * std::max(abs(d[i]), tol))
+                done = false;
+        }
+
+        if (done || info.restarts >= max_restarts)
+        {
+            info.converged = done;
+            break;
+        }
+
+        // thick restart: keep the p leading Ritz vectors and the residual
+        // direction, which yields an "arrowhead" projected matrix
+        p = std::min(m - 1, std::max(k + 1, (m + k) / 2));
+        krylov_combine(V.data(), N, m, S.data(), m, p, V.data());
+        std::copy(V.begin() + m * N, V.begin() + (m + 1) * N,
+                  V.begin() + p * N);
+        std::fill(H.begin(), H.end(), 0);
+        for (size_t i = 0; i < p; ++i)
+        {
+            H[i * m + i] = d[i];
+            H[p * m + i] = beta * S[(m - 1) * m + i];
+        }
+        ++info.restarts;
+    }
+
+    evals.assign(d.begin(), d.begin() + k);
+    X.resize(N * k);
+    krylov_combine(V.data(), N, m, S.data(), m, k, X.data());
+}
+
+// Eigenpairs with largest real part of a general operator, via a
+// thick-restart Arnoldi method: at each restart the decomposition is
+// compressed to a real orthonormal basis W of the invariant subspace of H
+// spanned by the wanted Ritz vectors (closed under conjugation), which
+// yields again a Krylov decomposition A (V W) = (V W) (W^T H W) + v b^T.
+// The eigenvectors are returned separately as real and imaginary parts, in Xr
+// and Xi.
+template <class MatVec>
+void krylov_arnoldi(MatVec&& A, vector<double>& V, size_t N, size_t k,
+                    size_t m, double tol, size_t max_restarts,
+                    krylov_space& space, vector<complex<double>>& evals,
+                    vector<double>& Xr, vector<double>& Xi, krylov_info& info)
+{
+    typedef complex<double> cplx;
+
+    double vnorm = sqrt(krylov_dot(V.data(), V.data(), N));
+    if (vnorm == 0)
+    {
+        space.random(V.data());
+        vnorm = sqrt(krylov_dot(V.data(), V.data(), N));
+    }
+    krylov_scale(V.data(), 1. / vnorm, N);
+
+    vector<double> H((m + 1) * m, 0), W;
+    vector<cplx> Hc(m * m), ev;
+    vector<vector<cplx>> Y(m);
+    size_t p = 0;
+    while (true)
+    {
+        krylov_expand(A, V.data(), N, H.data(), m, p, m, space, info);
+
+        for (size_t i = 0; i < m * m; ++i)
+            Hc[i] = H[i];
+        krylov_eigvals(Hc, m, ev);
+        std::sort(ev.begin(), ev.end(),
+                  [](const cplx& x, const cplx& y)
+                  {
+                      if (x.real() != y.real())
+                          return x.real() > y.real();
+                      return x.imag() > y.imag();
+                  });
+
+        // eigenvalues of the real matrix which are real up to round-off
+        double hnorm = 0;
+        for (auto& h : Hc)
+            hnorm = std::max(hnorm, abs(h));
+        for (auto& l : ev)
+            if (abs(l.imag()) <= 1e3 * numeric_limits<double>::epsilon() * hnorm)
+                l = l.real();
+
+        double beta = H[m * m + m - 1];
+        info.residuals.resize(k);
+        bool done = true;
+        for (size_t i = 0; i < k; ++i)
+        {
+            krylov_eigvec(Hc, m, ev[i], Y[i]);
+            info.residuals[i] = abs(beta) * abs(Y[i][m - 1]);
+            if (info.residuals[i] > tol * std::max(abs(ev[i]), tol))
+                done = false;
+        }
+
+        if (done || info.restarts >= max_restarts)
+        {
+            info.converged = done;
+            break;
+        }
+
+        // wanted subspace, closed under conjugation
+        p = std::min(m - 1, std::max(k + 1, (m + k) / 2));
+        double eps = 1e3 * numeric_limits<double>::epsilon();
+        if (p < m - 1 && abs(ev[p - 1].imag()) > eps * abs(ev[p - 1]) &&
+            abs(ev[p] - conj(ev[p - 1])) <= eps * abs(ev[p]) * 1e3)
+            ++p;
+
+        // real orthonormal basis via modified Gram-Schmidt
+        W.clear();
+        vector<double> u(m);
+        auto push = [&](auto&& f)
+            {
+                for (size_t j = 0; j < m; ++j)
+                    u[j] = f(j);
+                size_t q = W.size() / m;
+                for (size_t l = 0; l < q; ++l)
+                {
+                    double r = 0;
+                    for (size_t j = 0; j < m; ++j)
+                        r += W[l * m + j] * u[j];
+                    for (size_t j = 0; j < m; ++j)
+                        u[j] -= r * W[l * m + j];
+                }
+                double r = 0;
+                for (size_t j = 0; j < m; ++j)
+                    r += u[j] * u[j];
+                r = sqrt(r);
+                if (r < 1e-8 || q == p)
+                    return;
+                for (size_t j = 0; j < m; ++j)
+                    W.push_back(u[j] / r);
+            };
+        for (size_t i = 0; i < p; ++i)
+        {
+            if (i >= k)
+                krylov_eigvec(Hc, m, ev[i], Y[i]);
+            push([&](size_t j) { return Y[i][j].real(); });
+            if (ev[i].imag() > 0)
+                push([&](size_t j) { return Y[i][j].imag(); });
+        }
+        p = W.size() / m;
+
+        // W is stored column-wise; transpose it to the layout expected by
+        // krylov_combine()
+        vector<double> S(m * p);
+        for (size_t l = 0; l < p; ++l)
+            for (size_t j = 0; j < m; ++j)
+                S[j * p + l] = W[l * m + j];
+
+        vector<double> HW(m * p, 0), Hp(p * p, 0);
+        for (size_t i = 0; i < m; ++i)
+            for (size_t j = 0; j < m; ++j)
+                for (size_t l = 0; l < p; ++l)
+                    HW[i * p + l] += H[i * m + j] * S[j * p + l];
+        for (size_t i = 0; i < p; ++i)
+            for (size_t j = 0; j < m; ++j)
+                for (size_t l = 0; l < p; ++l)
+                    Hp[i * p + l] += S[j * p + i] * HW[j * p + l];
+
+        krylov_combine(V.data(), N, m, S.data(), p, p, V.data());
+        std::copy(V.begin() + m * N, V.begin() + (m + 1) * N,
+                  V.begin() + p * N);
+        std::fill(H.begin(), H.end(), 0);
+        for (size_t i = 0; i < p; ++i)
+        {
+            for (size_t l = 0; l < p; ++l)
+                H[i * m + l] = Hp[i * p + l];
+            H[p * m + i] = beta * S[(m - 1) * p + i];
+        }
+        ++info.restarts;
+    }
+
+    evals.assign(ev.begin(), ev.begin() + k);
+    vector<double> Sr(m * k), Si(m * k);
+    for (size_t j = 0; j < m; ++j)
+    {
+        for (size_t i = 0; i < k; ++i)
+        {
+            Sr[j * k + i] = Y[i][j].real();
+            Si[j * k + i] = Y[i][j].imag();
+        }
+    }
+    Xr.resize(N * k);
+    Xi.resize(N * k);
+    krylov_combine(V.data(), N, m, Sr.data(), k, k, Xr.data());
+    krylov_combine(V.data(), N, m, Si.data(), k, k, Xi.data());
+}
+
+// Solves the symmetric positive-definite system A x = b with the conjugate
+// gradient method. Returns false if the operator is found not to be
+// positive-definite, in which case x is left untouched.
+template <class MatVec>
+bool krylov_cg(MatVec&& A, const vector<double>& b, vector<double>& x,
+               size_t N, double tol, size_t max_iter, krylov_info& info)
+{
+    vector<double> r(N), p(N), q(N), x0(x);
+    A(x.data(), q.data());
+    info.nmv++;
+    #pragma omp parallel for simd if (N > OPENMP_MIN_THRESH) schedule(static)
+    for (size_t i = 0; i < N; ++i)
+    {
+        r[i] = b[i] - q[i];
+        p[i] = r[i];
+    }
+
+    double bnorm = sqrt(krylov_dot(b.data(), b.data(), N));
+    double rr = krylov_dot(r.data(), r.data(), N);
+    size_t iter = 0;
+    while (sqrt(rr) > tol * bnorm && iter < max_iter)
+    {
+        A(p.data(), q.data());
+        info.nmv++;
+        double pq = krylov_dot(p.data(), q.data(), N);
+        if (pq <= 0)
+        {
+            x = x0;
+            return false;
+        }
+        double a = rr / pq;
+        #pragma omp parallel for simd if (N > OPENMP_MIN_THRESH) \
+            schedule(static)
+        for (size_t i = 0; i < N; ++i)
+        {
+            x[i] += a * p[i];
+            r[i] -= a * q[i];
+        }
+        double rr_new = krylov_dot(r.data(), r.data(), N);
+        double c = rr_new / rr;
+        #pragma omp parallel for simd if (N > OPENMP_MIN_THRESH) \
+            schedule(static)
+        for (size_t i = 0; i < N; ++i)
+            p[i] = r[i] + c * p[i];
+        rr = rr_new;
+        ++iter;
+    }
+    info.residuals.assign(1, bnorm > 0 ? sqrt(rr) / bnorm : sqrt(rr));
+    info.converged = sqrt(rr) <= tol * bnorm;
+    return true;
+}
+
+// Solves the general system A x = b with restarted GMRES(m).
+template <class MatVec>
+void krylov_gmres(MatVec&& A, const vector<double>& b, vector<double>& x,
+                  size_t N, size_t m, double tol, size_t max_iter,
+                  krylov_space& space, krylov_info& info)
+{
+    vector<double> V(N * (m + 1)), H((m + 1) * m), cs(m), sn(m), g(m + 1),
+        y(m);
+    double bnorm = sqrt(krylov_dot(b.data(), b.data(), N));
+    double res = 0;
+    size_t iter = 0;
+    while (true)
+    {
+        double* r = V.data();
+        A(x.data(), r);
+        info.nmv++;
+        #pragma omp parallel for simd if (N > OPENMP_MIN_THRESH) \
+            schedule(static)
+        for (size_t i = 0; i < N; ++i)
+            r[i] = b[i] - r[i];
+        double beta = sqrt(krylov_dot(r, r, N));
+        res = beta;
+        if (beta <= tol * bnorm || iter >= max_iter)
+            break;
+        krylov_scale(r, 1. / beta, N);
+
+        std::fill(g.begin(), g.end(), 0);
+        g[0] = beta;
+        size_t j = 0;
+        for (; j < m && iter < max_iter; ++j, ++iter)
+        {
+            krylov_expand(A, V.data(), N, H.data(), m, j, j + 1, space, info);
+
+            // apply the previous rotations to the new column
+            for (size_t i = 0; i < j; ++i)
+            {
+                double u = H[i * m + j], v = H[(i + 1) * m + j];
+                H[i * m + j] = cs[i] * u + sn[i] * v;
+                H[(i + 1) * m + j] = -sn[i] * u + cs[i] * v;
+            }
+            double u = H[j * m + j], v = H[(j + 1) * m + j];
+            double rho = sqrt(u * u + v * v);
+            cs[j] = (rho > 0) ? u / rho : 1;
+            sn[j] = (rho > 0) ? v / rho : 0;
+            H[j * m + j] = rho;
+            H[(j + 1) * m + j] = 0;
+            g[j + 1] = -sn[j] * g[j];
+            g[j] = cs[j] * g[j];
+            res = abs(g[j + 1]);
+            if (res <= tol * bnorm)
+            {
+                ++j;
+                ++iter;
+                break;
+            }
+        }
+
+        // x += V y, with H y = g
+        for (size_t i = j; i-- > 0;)
+        {
+            double s = g[i];
+            for (size_t l = i + 1; l < j; ++l)
+                s -= H[i * m + l] * y[l];
+            y[i] = (H[i * m + i] != 0) ? s / H[i * m + i] : 0;
+        }
+        vector<double> dx(N);
+        krylov_combine(V.data(), N, j, y.data(), 1, 1, dx.data());
+        #pragma omp parallel for simd if (N > OPENMP_MIN_THRESH) \
+            schedule(static)
+        for (size_t i = 0; i < N; ++i)
+            x[i] += dx[i];
+        ++info.restarts;
+    }
+    info.residuals.assign(1, bnorm > 0 ? res / bnorm : res);
+    info.converged = res <= tol * bnorm;
+}
+
+} // graph_tool namespace
+
+#endif // GRAPH_KRYLOV_HH
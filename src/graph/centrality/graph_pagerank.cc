@@ -23,6 +23,7 @@
 #include "graph.hh"
 #include "graph_selectors.hh"
 #include "graph_pagerank.hh"
+#include "numpy_bind.hh"
 
 using namespace std;
 using namespace boost;
@@ -65,9 +66,62 @@ size_t pagerank(GraphInterface& g, boost::any rank, boost::any pers,
     return iter;
 }
 
+python::object personalized_pagerank(GraphInterface& g, boost::any weight,
+                                     python::object oseed_ptr,
+                                     python::object oseed_vs, double d,
+                                     double epsilon, size_t max_iter,
+                                     size_t top, bool push, size_t batch_size)
+{
+    typedef UnityPropertyMap<int,GraphInterface::edge_t> weight_map_t;
+    typedef boost::mpl::push_back<edge_scalar_properties, weight_map_t>::type
+        weight_props_t;
+
+    if (!weight.empty() && !belongs<edge_scalar_properties>()(weight))
+        throw ValueException("weight edge property must have a scalar value type");
+
+    if(weight.empty())
+        weight = weight_map_t();
+
+    if (!push && batch_size == 0)
+        throw ValueException("batch size must be positive");
+
+    auto seed_ptr = get_array<int64_t,1>(oseed_ptr);
+    auto seed_vs = get_array<int64_t,1>(oseed_vs);
+
+    vector<ppr_vector_t> ret;
+    run_action<>()
+        (g, [&](auto& graph, auto w)
+            {
+                if (push)
+                    get_ppr_push(graph, w, seed_ptr, seed_vs, d, epsilon, top,
+                                 ret);
+                else
+                    get_ppr_batch(graph, w, seed_ptr, seed_vs, d, epsilon,
+                                  max_iter, top, batch_size, ret);
+            },
+         weight_props_t())(weight);
+
+    // CSR representation of the results
+    vector<int64_t> indptr = {0};
+    vector<int64_t> indices;
+    vector<double> data;
+    for (auto& vec : ret)
+    {
+        for (auto& x : vec)
+        {
+            indices.push_back(x.first);
+            data.push_back(x.second);
+        }
+        indptr.push_back(indices.size());
+    }
+    return python::make_tuple(wrap_vector_owned(data),
+                              wrap_vector_owned(indices),
+                              wrap_vector_owned(indptr));
+}
 
 void export_pagerank()
 {
     using namespace boost::python;
     def("get_pagerank", &pagerank);
+    def("get_personalized_pagerank", &personalized_pagerank);
 }
@@ -22,76 +22,406 @@
 #include "graph_filtering.hh"
 #include "graph_util.hh"
 
+#include <deque>
+
 namespace graph_tool
 {
 using namespace std;
 using namespace boost;
 
+// The iterations are done on contiguous arrays, with the values of
+// rank[s]/deg[s] computed once per iteration. The in-edges are stored in a CSR
+// structure split into segments, each containing only the edges with sources
+// in a contiguous block of vertices, small enough for the values read to
+// remain in cache while the segment is processed. Dangling vertices (with
+// zero out-degree) contribute nothing to their neighbours.
+
+template <class Val>
+struct pagerank_segment
+{
+    vector<size_t> target;  // vertices with in-edges in this segment
+    vector<size_t> pos;     // offsets in source/weight, one past each target
+    vector<size_t> source;
+    vector<Val> weight;
+};
+
 struct get_pagerank
 {
+    // number of source vertices per segment; with double precision this
+    // amounts to 256 KiB of rank values, which fits in the L2 cache
+    static constexpr size_t block_size = 1 << 15;
+
     template <class Graph, class VertexIndex, class RankMap, class PerMap,
               class Weight>
-    void operator()(Graph& g, VertexIndex vertex_index, RankMap rank,
-                    PerMap pers, Weight weight, double damping, double epsilon,
+    void operator()(Graph& g, VertexIndex, RankMap rank, PerMap pers,
+                    Weight weight, double damping, double epsilon,
                     size_t max_iter, size_t& iter) const
     {
         typedef typename property_traits<RankMap>::value_type rank_type;
+        constexpr bool weighted =
+            !std::is_same<Weight,
+                          UnityPropertyMap<int, GraphInterface::edge_t>>::value;
 
-        RankMap r_temp(vertex_index, num_vertices(g));
-        RankMap deg(vertex_index, num_vertices(g));
+        size_t N = num_vertices(g);
+        vector<rank_type> r(N), r_temp(N), x(N), deg(N), p(N);
+        rank_type d = damping;
 
-        // init degs
         parallel_vertex_loop
             (g,
              [&](auto v)
              {
-                 put(deg, v, out_degreeS()(v, g, weight));
+                 deg[v] = out_degreeS()(v, g, weight);
+                 r[v] = get(rank, v);
+                 p[v] = (1.0 - d) * get(pers, v);
              });
 
+        size_t nblocks = (N + block_size - 1) / block_size;
+        vector<pagerank_segment<rank_type>> segs(nblocks);
+        for (auto v : vertices_range(g))
+        {
+            for (const auto& e : in_or_out_edges_range(v, g))
+            {
+                size_t s;
+                if (graph_tool::is_directed(g))
+                    s = source(e, g);
+                else
+                    s = target(e, g);
+                auto& seg = segs[s / block_size];
+                if (seg.target.empty() || seg.target.back() != v)
+                {
+                    seg.target.push_back(v);
+                    seg.pos.push_back(seg.source.size());
+                }
+                seg.source.push_back(s);
+                if (weighted)
+                    seg.weight.push_back(get(weight, e));
+                seg.pos.back() = seg.source.size();
+            }
+        }
+
         rank_type delta = epsilon + 1;
-        rank_type d = damping;
         iter = 0;
         while (delta >= epsilon)
         {
             delta = 0;
-            #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
-                reduction(+:delta)
-            parallel_vertex_loop_no_spawn
-                (g,
-                 [&](auto v)
-                 {
-                     rank_type r = 0;
-                     for (const auto& e : in_or_out_edges_range(v, g))
-                     {
-                         typename graph_traits<Graph>::vertex_descriptor s;
-                         if (graph_tool::is_directed(g))
-                             s = source(e, g);
-                         else
-                             s = target(e, g);
-                         r += (get(rank, s) * get(weight, e)) / get(deg, s);
-                     }
-
-                     put(r_temp, v, (1.0 - d) * get(pers, v) + d * r);
-
-                     delta += abs(get(r_temp, v) - get(rank, v));
-                 });
-            swap(r_temp, rank);
+            #pragma omp parallel if (N > OPENMP_MIN_THRESH)
+            {
+                #pragma omp for schedule(static)
+                for (size_t v = 0; v < N; ++v)
+                {
+                    x[v] = (deg[v] > 0) ? r[v] / deg[v] : 0;
+                    r_temp[v] = 0;
+                }
+
+                for (auto& seg : segs)
+                {
+                    auto& target = seg.target;
+                    auto& pos = seg.pos;
+                    auto& source = seg.source;
+                    auto& w = seg.weight;
+                    #pragma omp for schedule(runtime)
+                    for (size_t i = 0; i < target.size(); ++i)
+                    {
+                        rank_type y = 0;
+                        for (size_t j = (i > 0) ? pos[i - 1] : 0; j < pos[i];
+                             ++j)
+                        {
+                            if (weighted)
+                                y += x[source[j]] * w[j];
+                            else
+                                y += x[source[j]];
+                        }
+                        r_temp[target[i]] += y;
+                    }
+                }
+
+                #pragma omp for simd schedule(static) reduction(+:delta)
+                for (size_t v = 0; v < N; ++v)
+                {
+                    r_temp[v] = p[v] + d * r_temp[v];
+                    delta += abs(r_temp[v] - r[v]);
+                }
+            }
+            swap(r_temp, r);
             ++iter;
             if (max_iter > 0 && iter == max_iter)
                 break;
         }
 
-        if (iter % 2 != 0)
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 put(rank, v, r[v]);
+             });
+    }
+};
+
+// Personalized PageRank for many seed sets. The results are returned as
+// sparse vectors, each with the (vertex, value) pairs sorted by decreasing
+// value, and truncated to the largest top ones (if top > 0).
+
+typedef vector<pair<size_t, double>> ppr_vector_t;
+
+inline void ppr_truncate(ppr_vector_t& vec, size_t top)
+{
+    auto cmp = [](const auto& a, const auto& b)
+        { return a.second > b.second ||
+                (a.second == b.second && a.first < b.first); };
+    if (top > 0 && vec.size() > top)
+    {
+        nth_element(vec.begin(), vec.begin() + top, vec.end(), cmp);
+        vec.resize(top);
+    }
+    sort(vec.begin(), vec.end(), cmp);
+}
+
+template <class Graph, class Weight>
+vector<double> ppr_out_degrees(Graph& g, Weight weight)
+{
+    vector<double> deg(num_vertices(g));
+    parallel_vertex_loop
+        (g,
+         [&](auto v)
+         {
+             deg[v] = out_degreeS()(v, g, weight);
+         });
+    return deg;
+}
+
+// Forward push (Andersen, Chung & Lang 2006): the residual of a vertex is
+// pushed to its out-neighbours until r[v] < epsilon * deg[v] everywhere. Only
+// the vertices reached by the pushes are ever touched, and each seed set is
+// processed independently by a single thread.
+
+struct ppr_push_workspace
+{
+    ppr_push_workspace(size_t N) : p(N), r(N), queued(N, false) {}
+
+    vector<double> p, r;
+    vector<bool> queued;
+    vector<size_t> touched;
+    deque<size_t> queue;
+};
+
+template <class Graph, class Weight, class Seeds>
+void ppr_push(Graph& g, Weight weight, vector<double>& deg, Seeds& seeds,
+              double damping, double epsilon, ppr_push_workspace& ws,
+              ppr_vector_t& out)
+{
+    auto& p = ws.p;
+    auto& r = ws.r;
+    auto& queued = ws.queued;
+    auto& queue = ws.queue;
+    auto& touched = ws.touched;
+
+    auto touch = [&](size_t v)
+        {
+            if (r[v] == 0 && p[v] == 0)
+                touched.push_back(v);
+        };
+
+    auto enqueue = [&](size_t v)
+        {
+            if (!queued[v] && r[v] >= epsilon * deg[v])
+            {
+                queued[v] = true;
+                queue.push_back(v);
+            }
+        };
+
+    for (auto s : seeds)
+    {
+        touch(s);
+        r[s] += 1. / seeds.size();
+    }
+    for (auto s : seeds)
+        enqueue(s);
+
+    while (!queue.empty())
+    {
+        size_t v = queue.front();
+        queue.pop_front();
+        queued[v] = false;
+
+        double rv = r[v];
+        p[v] += (1 - damping) * rv;
+        r[v] = 0;
+        if (deg[v] == 0)
+            continue;  // dangling vertex
+
+        double c = damping * rv / deg[v];
+        for (const auto& e : out_edges_range(v, g))
+        {
+            size_t u = target(e, g);
+            touch(u);
+            r[u] += c * get(weight, e);
+            enqueue(u);
+        }
+    }
+
+    out.clear();
+    for (auto v : touched)
+    {
+        if (p[v] > 0)
+            out.emplace_back(v, p[v]);
+        p[v] = r[v] = 0;
+    }
+    touched.clear();
+}
+
+template <class Graph, class Weight, class SeedPtr, class SeedVertices>
+void get_ppr_push(Graph& g, Weight weight, SeedPtr& seed_ptr,
+                  SeedVertices& seed_vs, double damping, double epsilon,
+                  size_t top, vector<ppr_vector_t>& ret)
+{
+    auto deg = ppr_out_degrees(g, weight);
+    size_t M = seed_ptr.size() - 1;
+    ret.resize(M);
+
+    #pragma omp parallel if (M > 1)
+    {
+        ppr_push_workspace ws(num_vertices(g));
+        vector<size_t> seeds;
+
+        #pragma omp for schedule(runtime)
+        for (size_t i = 0; i < M; ++i)
+        {
+            seeds.clear();
+            for (auto j = seed_ptr[i]; j < seed_ptr[i + 1]; ++j)
+                seeds.push_back(seed_vs[j]);
+            if (seeds.empty())
+                continue;
+            ppr_push(g, weight, deg, seeds, damping, epsilon, ws, ret[i]);
+            ppr_truncate(ret[i], top);
+        }
+    }
+}
+
+// Power iteration for a batch of k personalization vectors at once, stored
+// vertex-major as an N x k dense matrix, so that each in-edge is read once per
+// iteration for all the vectors. The iteration stops when the L1 change of
+// every vector in the batch falls below epsilon, as with get_pagerank.
+
+template <class Graph, class Weight, class SeedPtr, class SeedVertices>
+void get_ppr_batch(Graph& g, Weight weight, SeedPtr& seed_ptr,
+                   SeedVertices& seed_vs, double damping, double epsilon,
+                   size_t max_iter, size_t top, size_t batch_size,
+                   vector<ppr_vector_t>& ret)
+{
+    size_t N = num_vertices(g);
+    size_t M = seed_ptr.size() - 1;
+    auto deg = ppr_out_degrees(g, weight);
+    ret.resize(M);
+
+    // in-edge CSR, with the transition probabilities
+    vector<size_t> pos(N + 1);
+    vector<size_t> src;
+    vector<double> coef;
+    for (auto v : vertices_range(g))
+    {
+        for (const auto& e : in_or_out_edges_range(v, g))
+        {
+            size_t s;
+            if (graph_tool::is_directed(g))
+                s = source(e, g);
+            else
+                s = target(e, g);
+            if (deg[s] == 0)
+                continue;
+            src.push_back(s);
+            coef.push_back(damping * get(weight, e) / deg[s]);
+        }
+        pos[v + 1] = src.size();
+    }
+    for (size_t v = 1; v <= N; ++v)
+        pos[v] = max(pos[v], pos[v - 1]);
+
+    size_t k = min(batch_size, M);
+    vector<double> x(N * k), y(N * k), pers(N * k);
+    vector<double> delta(k);
+    vector<bool> active(k);
+
+    for (size_t b = 0; b < M; b += k)
+    {
+        size_t kb = min(k, M - b);
+
+        fill(x.begin(), x.end(), 0);
+        fill(pers.begin(), pers.end(), 0);
+        for (size_t l = 0; l < kb; ++l)
+        {
+            size_t i = b + l;
+            double n = seed_ptr[i + 1] - seed_ptr[i];
+            for (auto j = seed_ptr[i]; j < seed_ptr[i + 1]; ++j)
+            {
+                size_t v = seed_vs[j];
+                pers[v * k + l] += 1. / n;
+                x[v * k + l] += 1. / n;
+            }
+            active[l] = n > 0;
+        }
+
+        size_t iter = 0;
+        while (true)
+        {
+            fill(delta.begin(), delta.end(), 0);
+
+            #pragma omp parallel if (N > OPENMP_MIN_THRESH)
+            {
+                vector<double> ldelta(k);
+
+                #pragma omp for schedule(runtime)
+                for (size_t v = 0; v < N; ++v)
+                {
+                    double* yv = &y[v * k];
+                    double* pv = &pers[v * k];
+                    for (size_t l = 0; l < k; ++l)
+                        yv[l] = (1 - damping) * pv[l];
+                    for (size_t j = pos[v]; j < pos[v + 1]; ++j)
+                    {
+                        double c = coef[j];
+                        double* xs = &x[src[j] * k];
+                        #pragma omp simd
+                        for (size_t l = 0; l < k; ++l)
+                            yv[l] += c * xs[l];
+                    }
+                    double* xv = &x[v * k];
+                    for (size_t l = 0; l < k; ++l)
+                        ldelta[l] += abs(yv[l] - xv[l]);
+                }
+
+                #pragma omp critical (ppr_batch_delta)
+                for (size_t l = 0; l < k; ++l)
+                    delta[l] += ldelta[l];
+            }
+            swap(x, y);
+            ++iter;
+
+            bool done = true;
+            for (size_t l = 0; l < kb; ++l)
+            {
+                if (delta[l] >= epsilon)
+                    done = false;
+            }
+            if (done || (max_iter > 0 && iter == max_iter))
+                break;
+        }
+
+        #pragma omp parallel for schedule(runtime) if (kb > 1)
+        for (size_t l = 0; l < kb; ++l)
         {
-            parallel_vertex_loop
-                (g,
-                 [&](auto v)
-                 {
-                     put(rank, v, get(r_temp, v));
-                 });
+            auto& out = ret[b + l];
+            if (!active[l])
+                continue;
+            for (auto v : vertices_range(g))
+            {
+                if (x[v * k + l] > 0)
+                    out.emplace_back(v, x[v * k + l]);
+            }
+            ppr_truncate(out, top);
         }
     }
-};
+}
 
 }
 #endif // GRAPH_PAGERANK_HH
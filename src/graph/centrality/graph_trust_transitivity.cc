@@ -21,6 +21,7 @@
 
 #include "graph.hh"
 #include "graph_selectors.hh"
+#include "numpy_bind.hh"
 
 #include "graph_trust_transitivity.hh"
 
@@ -43,8 +44,73 @@ void trust_transitivity(GraphInterface& g, int64_t source, int64_t target,
                    vertex_floating_vector_properties())(c,t);
 }
 
+void trust_transitivity_dense(GraphInterface& gi, boost::any c,
+                              python::object osources, python::object ot)
+{
+    if (!belongs<edge_floating_properties>()(c))
+        throw ValueException("edge property must be of floating point value type");
+
+    auto sources = get_array<int64_t,1>(osources);
+    auto t = get_array<double,2>(ot);
+
+    run_action<>()
+        (gi, [&](auto& g, auto cmap)
+             {
+                 get_trust_transitivity_sources
+                     (g, cmap, sources,
+                      [&](size_t i, auto& ti)
+                      {
+                          for (size_t j = 0; j < ti.size(); ++j)
+                              t[i][j] = ti[j];
+                      });
+             },
+         edge_floating_properties())(c);
+}
+
+python::object trust_transitivity_sparse(GraphInterface& gi, boost::any c,
+                                         python::object osources,
+                                         double threshold, size_t top)
+{
+    if (!belongs<edge_floating_properties>()(c))
+        throw ValueException("edge property must be of floating point value type");
+
+    auto sources = get_array<int64_t,1>(osources);
+
+    vector<trust_vector_t> ret(sources.shape()[0]);
+    run_action<>()
+        (gi, [&](auto& g, auto cmap)
+             {
+                 get_trust_transitivity_sources
+                     (g, cmap, sources,
+                      [&](size_t i, auto& ti)
+                      {
+                          trust_truncate(ti, threshold, top, ret[i]);
+                      });
+             },
+         edge_floating_properties())(c);
+
+    // CSR representation of the results
+    vector<int64_t> indptr = {0};
+    vector<int64_t> indices;
+    vector<double> data;
+    for (auto& vec : ret)
+    {
+        for (auto& x : vec)
+        {
+            indices.push_back(x.first);
+            data.push_back(x.second);
+        }
+        indptr.push_back(indices.size());
+    }
+    return python::make_tuple(wrap_vector_owned(data),
+                              wrap_vector_owned(indices),
+                              wrap_vector_owned(indptr));
+}
+
 void export_trust_transitivity()
 {
     using namespace boost::python;
     def("get_trust_transitivity", &trust_transitivity);
+    def("get_trust_transitivity_dense", &trust_transitivity_dense);
+    def("get_trust_transitivity_sparse", &trust_transitivity_sparse);
 }
@@ -23,6 +23,7 @@
 #include "graph_util.hh"
 
 #include <algorithm>
+#include <limits>
 
 #include <boost/graph/dijkstra_shortest_paths.hpp>
 
@@ -92,6 +93,16 @@ struct filter_vertex_pred
     size_t _v;
 };
 
+// the vertex at the other end of an in-edge of a vertex, or of any of its
+// edges if the graph is undirected
+template <class Graph, class Edge>
+size_t trust_in_neighbor(const Edge& e, const Graph& g)
+{
+    if (graph_tool::is_directed(g))
+        return source(e, g);
+    return target(e, g);
+}
+
 struct get_trust_transitivity
 {
     template <class Graph, class VertexIndex, class TrustMap,
@@ -124,10 +135,12 @@ struct get_trust_transitivity
                 source_map_t;
             source_map_t source_map(vertex_index, num_vertices(g));
 
-            typename in_edge_iteratorS<Graph>::type e, e_end;
-            for (tie(e, e_end) = in_edge_iteratorS<Graph>::get_edges(tgt, g);
-                 e != e_end; ++e)
-                source_map[boost::source(*e,g)] = true;
+            size_t k = 0;
+            for (const auto& e : in_or_out_edges_range(tgt, g))
+            {
+                source_map[trust_in_neighbor(e, g)] = true;
+                k++;
+            }
 
             // filter vertex w out of the graph
             typedef filt_graph<Graph, boost::keep_all, filter_vertex_pred>
@@ -151,7 +164,6 @@ struct get_trust_transitivity
                 // compute the targets weights
                 try
                 {
-                    size_t k = in_degreeS()(tgt, g);
                     source_counter<source_map_t,dist_map_t>
                         visitor(source_map, dist_map, k);
                     dijkstra_shortest_paths(fg, src, weight_map(c).
@@ -168,9 +180,9 @@ struct get_trust_transitivity
 
                 // compute the target's trust
                 t_type sum_w = 0, avg = 0;
-                for (auto e : in_edges_range(tgt, g))
+                for (auto e : in_or_out_edges_range(tgt, g))
                 {
-                    t_type weight = dist_map[boost::source(e, g)];
+                    t_type weight = dist_map[trust_in_neighbor(e, g)];
                     sum_w += weight;
                     avg += c[e]*weight*weight;
                 }
@@ -187,11 +199,11 @@ struct get_trust_transitivity
                              fg_t>::type rg_t;
                 rg_t rg(fg);
                 dist_map_t sum_w(vertex_index, num_vertices(g));
-                for (auto e : in_edges_range(tgt, g))
+                for (auto e : in_or_out_edges_range(tgt, g))
                 {
                     // compute the weights to all sources
                     dijkstra_shortest_paths
-                        (rg, boost::source(e, g), weight_map(c).
+                        (rg, trust_in_neighbor(e, g), weight_map(c).
                          vertex_index_map(vertex_index).
                          color_map(color_map).
                          distance_map(dist_map).
@@ -226,6 +238,350 @@ struct get_trust_transitivity
     }
 };
 
+// Trust from a single source to all targets, with workspaces that are reused
+// across sources. A single maximum-weight path tree from the source is
+// computed in the full graph. The path weight to an in-neighbour m of a
+// target j is only different in G\{j} if m is a descendant of j in that tree,
+// and only the vertices in the subtree of j need to be searched again, seeded
+// from the unchanged weights outside it. This search stops as soon as all
+// in-neighbours of j in the subtree are settled.
+
+typedef vector<pair<size_t, double>> trust_vector_t;
+
+// Indexed 4-ary max-heap of vertices, ordered by the values of an external
+// array, with in-place increase of the keys.
+class trust_heap
+{
+public:
+    trust_heap(size_t N) : _pos(N, _null) {}
+
+    void set_keys(const vector<double>& key) { _key = key.data(); }
+
+    bool empty() const { return _heap.empty(); }
+
+    void push_or_increase(size_t v)
+    {
+        if (_pos[v] == _null)
+        {
+            _pos[v] = _heap.size();
+            _heap.push_back(v);
+        }
+        sift_up(_pos[v]);
+    }
+
+    size_t pop()
+    {
+        size_t v = _heap.front();
+        _pos[v] = _null;
+        size_t u = _heap.back();
+        _heap.pop_back();
+        if (!_heap.empty())
+        {
+            _heap.front() = u;
+            _pos[u] = 0;
+            sift_down(0);
+        }
+        return v;
+    }
+
+    void clear()
+    {
+        for (auto v : _heap)
+            _pos[v] = _null;
+        _heap.clear();
+    }
+
+private:
+    static constexpr size_t _null = numeric_limits<size_t>::max();
+
+    void place(size_t i, size_t v)
+    {
+        _heap[i] = v;
+        _pos[v] = i;
+    }
+
+    void sift_up(size_t i)
+    {
+        size_t v = _heap[i];
+        while (i > 0)
+        {
+            size_t p = (i - 1) / 4;
+            if (_key[_heap[p]] >= _key[v])
+                break;
+            place(i, _heap[p]);
+            i = p;
+        }
+        place(i, v);
+    }
+
+    void sift_down(size_t i)
+    {
+        size_t v = _heap[i];
+        size_t n = _heap.size();
+        while (true)
+        {
+            size_t c = 4 * i + 1;
+            if (c >= n)
+                break;
+            size_t best = c;
+            for (size_t k = c + 1; k < std::min(c + 4, n); ++k)
+                if (_key[_heap[k]] > _key[_heap[best]])
+                    best = k;
+            if (_key[_heap[best]] <= _key[v])
+                break;
+            place(i, _heap[best]);
+            i = best;
+        }
+        place(i, v);
+    }
+
+    vector<size_t> _heap, _pos;
+    const double* _key = nullptr;
+};
+
+class trust_workspace
+{
+public:
+    trust_workspace(size_t N)
+        : _d(N), _d2(N), _pred(N), _pre(N), _last(N), _cpos(N + 1),
+          _need(N), _done(N), _queue(N) {}
+
+    template <class Graph, class TrustMap>
+    void run(Graph& g, TrustMap c, size_t s, vector<double>& t)
+    {
+        size_t N = num_vertices(g);
+        t.assign(N, 0);
+        search(g, c, s);
+        build_tree(g, s);
+
+        for (auto j : vertices_range(g))
+        {
+            if (j == s)
+            {
+                t[j] = 1;
+                continue;
+            }
+
+            size_t pending = 0;
+            ++_tag;
+            for (const auto& e : in_or_out_edges_range(j, g))
+            {
+                size_t m = trust_in_neighbor(e, g);
+                if (m != j && _need[m] != _tag && is_descendant(m, j))
+                {
+                    _need[m] = _tag;
+                    pending++;
+                }
+            }
+            if (pending > 0)
+                replace(g, c, j, pending);
+
+            double sum_w = 0, avg = 0;
+            for (const auto& e : in_or_out_edges_range(j, g))
+            {
+                size_t m = trust_in_neighbor(e, g);
+                double w;
+                if (m == j)
+                    w = 0;
+                else if (_need[m] == _tag)
+                    w = _d2[m];
+                else
+                    w = _d[m];
+                sum_w += w;
+                avg += get(c, e) * w * w;
+            }
+            if (sum_w > 0)
+                t[j] = avg / sum_w;
+        }
+    }
+
+private:
+    static constexpr size_t _null = numeric_limits<size_t>::max();
+
+    bool is_descendant(size_t m, size_t j)
+    {
+        return (_pre[j] != _null && _pre[m] != _null &&
+                _pre[m] > _pre[j] && _pre[m] <= _last[j]);
+    }
+
+    // maximum-weight paths from s in the full graph
+    template <class Graph, class TrustMap>
+    void search(Graph& g, TrustMap c, size_t s)
+    {
+        std::fill(_d.begin(), _d.end(), 0);
+        std::fill(_pred.begin(), _pred.end(), _null);
+        ++_tag;
+        _d[s] = 1;
+        _queue.set_keys(_d);
+        _queue.push_or_increase(s);
+        while (!_queue.empty())
+        {
+            size_t u = _queue.pop();
+            _done[u] = _tag;
+            for (const auto& e : out_edges_range(u, g))
+            {
+                size_t v = target(e, g);
+                double d = _d[u] * get(c, e);
+                if (d > _d[v] && _done[v] != _tag)
+                {
+                    _d[v] = d;
+                    _pred[v] = u;
+                    _queue.push_or_increase(v);
+                }
+            }
+        }
+    }
+
+    // pre-order of the path tree, so that the subtree of v is the range
+    // (_pre[v], _last[v]] of _order
+    template <class Graph>
+    void build_tree(Graph& g, size_t s)
+    {
+        size_t N = num_vertices(g);
+        std::fill(_cpos.begin(), _cpos.end(), 0);
+        for (size_t v = 0; v < N; ++v)
+            if (_pred[v] != _null)
+                _cpos[_pred[v] + 1]++;
+        for (size_t v = 0; v < N; ++v)
+            _cpos[v + 1] += _cpos[v];
+        _children.resize(_cpos[N]);
+        for (size_t v = 0; v < N; ++v)
+            if (_pred[v] != _null)
+                _children[_cpos[_pred[v]]++] = v;
+        for (size_t v = N; v > 0; --v)
+            _cpos[v] = _cpos[v - 1];
+        _cpos[0] = 0;
+
+        std::fill(_pre.begin(), _pre.end(), _null);
+        _order.clear();
+        _stack.clear();
+        _stack.emplace_back(s, _cpos[s]);
+        _pre[s] = _order.size();
+        _order.push_back(s);
+        while (!_stack.empty())
+        {
+            auto& top = _stack.back();
+            size_t v = top.first;
+            if (top.second == _cpos[v + 1])
+            {
+                _last[v] = _order.size() - 1;
+                _stack.pop_back();
+                continue;
+            }
+            size_t u = _children[top.second++];
+            _pre[u] = _order.size();
+            _order.push_back(u);
+            _stack.emplace_back(u, _cpos[u]);
+        }
+    }
+
+    // Maximum-weight paths in G\{j} to the vertices in the subtree of j,
+    // seeded with the (unchanged) weights of the vertices outside of it. The
+    // search stops as soon as all the needed vertices are settled.
+    template <class Graph, class TrustMap>
+    void replace(Graph& g, TrustMap c, size_t j, size_t pending)
+    {
+        size_t begin = _pre[j] + 1, end = _last[j] + 1;
+        auto in_subtree = [&](size_t v)
+            {
+                return _pre[v] != _null && _pre[v] >= _pre[j] &&
+                    _pre[v] < end;
+            };
+
+        _queue.set_keys(_d2);
+        for (size_t i = begin; i < end; ++i)
+        {
+            size_t u = _order[i];
+            double d = 0;
+            for (const auto& e : in_or_out_edges_range(u, g))
+            {
+                size_t x = trust_in_neighbor(e, g);
+                if (in_subtree(x))
+                    continue;
+                double w = _d[x] * get(c, e);
+                if (w > d)
+                    d = w;
+            }
+            _d2[u] = d;
+            if (d > 0)
+                _queue.push_or_increase(u);
+        }
+
+        while (!_queue.empty() && pending > 0)
+        {
+            size_t u = _queue.pop();
+            _done[u] = _tag;
+            if (_need[u] == _tag)
+                pending--;
+            for (const auto& e : out_edges_range(u, g))
+            {
+                size_t v = target(e, g);
+                if (v == j || !in_subtree(v) || _done[v] == _tag)
+                    continue;
+                double d = _d2[u] * get(c, e);
+                if (d > _d2[v])
+                {
+                    _d2[v] = d;
+                    _queue.push_or_increase(v);
+                }
+            }
+        }
+        _queue.clear();
+    }
+
+    vector<double> _d, _d2;
+    vector<size_t> _pred, _pre, _last, _cpos, _children, _order;
+    vector<size_t> _need, _done;
+    size_t _tag = 0;
+    vector<pair<size_t, size_t>> _stack;
+    trust_heap _queue;
+};
+
+// Trust from each of the given sources to all targets, in parallel over the
+// sources. The function f(i, t) is called with the index of the source and
+// the vector of trust values.
+template <class Graph, class TrustMap, class Sources, class F>
+void get_trust_transitivity_sources(Graph& g, TrustMap c, Sources& sources,
+                                    F&& f)
+{
+    size_t M = sources.size();
+    #pragma omp parallel if (M > 1 && num_vertices(g) > OPENMP_MIN_THRESH)
+    {
+        trust_workspace ws(num_vertices(g));
+        vector<double> t;
+
+        #pragma omp for schedule(runtime)
+        for (size_t i = 0; i < M; ++i)
+        {
+            size_t s = sources[i];
+            if (!is_valid_vertex(vertex(s, g), g))
+                continue;
+            ws.run(g, c, s, t);
+            f(i, t);
+        }
+    }
+}
+
+// Keep only the values above the threshold, and of those at most the top
+// largest (if top > 0).
+inline void trust_truncate(vector<double>& t, double threshold, size_t top,
+                           trust_vector_t& ret)
+{
+    ret.clear();
+    for (size_t j = 0; j < t.size(); ++j)
+    {
+        if (t[j] > threshold)
+            ret.emplace_back(j, t[j]);
+    }
+    if (top > 0 && ret.size() > top)
+    {
+        std::nth_element(ret.begin(), ret.begin() + top, ret.end(),
+                         [](auto& a, auto& b) { return a.second > b.second; });
+        ret.resize(top);
+        std::sort(ret.begin(), ret.end());
+    }
+}
+
 }
 
 #endif
@@ -49,17 +49,78 @@ void local_clustering(GraphInterface& g, boost::any prop)
          writable_vertex_scalar_properties())(prop);
 }
 
+boost::python::tuple global_clustering_sampled(GraphInterface& g,
+                                               double epsilon, double delta,
+                                               rng_t& rng)
+{
+    double c, c_err, wedges;
+    run_action<graph_tool::detail::never_directed>()
+        (g, [&](auto&& graph)
+            {
+                get_global_clustering_sampled()
+                    (graph, epsilon, delta, rng, c, c_err, wedges);
+            })();
+    return boost::python::make_tuple(c, c_err, wedges);
+}
+
+boost::python::tuple triangles_edge_sampled(GraphInterface& g, double epsilon,
+                                            double delta, size_t max_samples,
+                                            rng_t& rng)
+{
+    double t, t_err, wedges;
+    size_t n;
+    run_action<graph_tool::detail::never_directed>()
+        (g, [&](auto&& graph)
+            {
+                get_triangles_edge_sampled()
+                    (graph, epsilon, delta, max_samples, rng, t, t_err,
+                     wedges, n);
+            })();
+    return boost::python::make_tuple(t, t_err, wedges, n);
+}
+
+void local_clustering_sampled(GraphInterface& g, boost::any prop,
+                              boost::any err, double epsilon, double delta,
+                              rng_t& rng)
+{
+    run_action<>()
+        (g, [&](auto&& graph, auto&& clust)
+            {
+                typedef typename std::remove_reference<decltype(clust)>::type
+                    cmap_t;
+                typename cmap_t::checked_t cerr;
+                try
+                {
+                    cerr = any_cast<typename cmap_t::checked_t>(err);
+                }
+                catch (bad_any_cast&)
+                {
+                    throw GraphException("clustering and error properties "
+                                         "must be of the same type.");
+                }
+                set_sampled_clustering_to_property()
+                    (graph, clust, cerr.get_unchecked(num_vertices(graph)),
+                     epsilon, delta, rng);
+            },
+         writable_vertex_scalar_properties())(prop);
+}
+
 using namespace boost::python;
 
 void extended_clustering(GraphInterface& g, boost::python::list props);
 void get_motifs(GraphInterface& g, size_t k, boost::python::list subgraph_list,
                 boost::python::list hist, boost::python::list pvmaps, bool collect_vmaps,
                 boost::python::list p, bool comp_iso, bool fill_list, rng_t& rng);
+void export_clustering_stream();
 
 BOOST_PYTHON_MODULE(libgraph_tool_clustering)
 {
     def("global_clustering", &global_clustering);
     def("local_clustering", &local_clustering);
+    def("global_clustering_sampled", &global_clustering_sampled);
+    def("triangles_edge_sampled", &triangles_edge_sampled);
+    def("local_clustering_sampled", &local_clustering_sampled);
     def("extended_clustering", &extended_clustering);
     def("get_motifs", &get_motifs);
+    export_clustering_stream();
 }
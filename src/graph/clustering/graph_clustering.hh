@@ -23,10 +23,19 @@
 #include "hash_map_wrap.hh"
 #include <boost/mpl/if.hpp>
 
+#include "graph_triangles.hh"
+
 #ifdef _OPENMP
 #include "omp.h"
 #endif
 
+#include "random.hh"
+#include "../generation/sampler.hh"
+#include "../inference/support/parallel_rng.hh"
+
+#include <boost/math/distributions/normal.hpp>
+#include <boost/math/distributions/students_t.hpp>
+
 #ifndef __clang__
 #include <ext/numeric>
 using __gnu_cxx::power;
@@ -82,24 +91,37 @@ get_triangles(typename graph_traits<Graph>::vertex_descriptor v, VProp& mark,
 }
 
 
+// normalization of the local clustering coefficient of v, with the same
+// convention as get_triangles()
+template <class Graph>
+size_t get_triangles_norm(typename graph_traits<Graph>::vertex_descriptor v,
+                          const Graph& g)
+{
+    size_t k = out_degree(v, g);
+    if (graph_tool::is_directed(g))
+        return k * (k - 1);
+    else
+        return (k * (k - 1)) / 2;
+}
+
 // retrieves the global clustering coefficient
 struct get_global_clustering
 {
     template <class Graph>
     void operator()(const Graph& g, double& c, double& c_err) const
     {
-        size_t triangles = 0, n = 0;
-        vector<bool> mask(num_vertices(g), false);
+        vector<size_t> tri;
+        get_all_triangles(g, tri);
 
+        size_t triangles = 0, n = 0;
         #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
-            firstprivate(mask) reduction(+:triangles, n)
+            reduction(+:triangles, n)
         parallel_vertex_loop_no_spawn
                 (g,
                  [&](auto v)
                  {
-                     auto temp = get_triangles(v, mask, g);
-                     triangles += temp.first;
-                     n += temp.second;
+                     triangles += tri[v];
+                     n += get_triangles_norm(v, g);
                  });
         c = double(triangles) / n;
 
@@ -107,14 +129,13 @@ struct get_global_clustering
         c_err = 0.0;
         double cerr = 0.0;
         #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
-            firstprivate(mask) reduction(+:cerr)
+            reduction(+:cerr)
         parallel_vertex_loop_no_spawn
                 (g,
                  [&](auto v)
                  {
-                     auto temp = get_triangles(v, mask, g);
-                     double cl = double(triangles - temp.first) /
-                         (n - temp.second);
+                     double cl = double(triangles - tri[v]) /
+                         (n - get_triangles_norm(v, g));
                      cerr += power(c - cl, 2);
                  });
         c_err = sqrt(cerr);
@@ -128,18 +149,15 @@ struct set_clustering_to_property
     void operator()(const Graph& g, ClustMap clust_map) const
     {
         typedef typename property_traits<ClustMap>::value_type c_type;
-        vector<bool> mask(num_vertices(g), false);
+        vector<size_t> tri;
+        get_all_triangles(g, tri);
 
-        #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
-            firstprivate(mask)
-        parallel_vertex_loop_no_spawn
+        parallel_vertex_loop
             (g,
              [&](auto v)
              {
-                 auto triangles = get_triangles(v, mask, g);
-                 double clustering = (triangles.second > 0) ?
-                     double(triangles.first)/triangles.second :
-                     0.0;
+                 size_t n = get_triangles_norm(v, g);
+                 double clustering = (n > 0) ? double(tri[v]) / n : 0.0;
                  clust_map[v] = c_type(clustering);
              });
     }
@@ -155,6 +173,414 @@ struct set_clustering_to_property
     };
 };
 
+
+// number of samples needed for an absolute error of at most epsilon, with
+// probability at least 1 - delta, according to Hoeffding's inequality
+inline size_t hoeffding_samples(double epsilon, double delta)
+{
+    return size_t(ceil(log(2 / delta) / (2 * epsilon * epsilon)));
+}
+
+// Samples a pair of distinct positions (i, j) of the neighbor list ns
+// uniformly, and returns whether the wedge ns[i] - v - ns[j] is closed, i.e.
+// whether ns[i] -> ns[j] is an edge.
+template <class Graph, class RNG>
+bool sample_wedge(typename graph_traits<Graph>::vertex_descriptor v,
+                  const vector<size_t>& ns, const Graph& g, RNG& rng)
+{
+    size_t k = ns.size();
+    uniform_int_distribution<size_t> sample_i(0, k - 1), sample_j(0, k - 2);
+    size_t i = sample_i(rng);
+    size_t j = sample_j(rng);
+    if (j >= i)
+        ++j;
+    size_t u = ns[i], w = ns[j];
+    if (u == v || w == v || u == w)
+        return false;
+    if (!graph_tool::is_directed(g) && out_degree(w, g) < out_degree(u, g))
+        std::swap(u, w);
+    return is_adjacent(u, w, g);
+}
+
+// Estimates the global clustering coefficient by sampling wedges uniformly,
+// choosing their centers with probability proportional to k(k-1)/2, and
+// computing the fraction of them that are closed [seshadhri-wedge-2013]. The
+// returned error is the half-width of the confidence interval with
+// probability 1 - delta.
+struct get_global_clustering_sampled
+{
+    template <class Graph, class RNG>
+    void operator()(const Graph& g, double epsilon, double delta, RNG& rng_,
+                    double& c, double& c_err, double& wedges) const
+    {
+        size_t n = hoeffding_samples(epsilon, delta);
+
+        vector<size_t> vs;
+        vector<double> probs;
+        wedges = 0;
+        for (auto v : vertices_range(g))
+        {
+            size_t k = out_degree(v, g);
+            if (k < 2)
+                continue;
+            vs.push_back(v);
+            probs.push_back((k * (k - 1)) / 2);
+            wedges += probs.back();
+        }
+        if (vs.empty())
+        {
+            c = c_err = 0;
+            return;
+        }
+
+        // number of samples centered at each vertex
+        vector<size_t> count(num_vertices(g), 0);
+        Sampler<size_t> sampler(vs, probs);
+        for (size_t i = 0; i < n; ++i)
+            count[sampler.sample(rng_)]++;
+
+        vector<std::shared_ptr<RNG>> rngs;
+        init_rngs(rngs, rng_);
+
+        size_t closed = 0;
+        vector<size_t> ns;
+        #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
+            firstprivate(ns) reduction(+:closed)
+        parallel_vertex_loop_no_spawn
+            (g,
+             [&](auto v)
+             {
+                 if (count[v] == 0)
+                     return;
+                 auto& rng = get_rng(rngs, rng_);
+                 ns.clear();
+                 for (auto u : out_neighbors_range(v, g))
+                     ns.push_back(u);
+                 for (size_t i = 0; i < count[v]; ++i)
+                     closed += sample_wedge(v, ns, g, rng);
+             });
+
+        c = double(closed) / n;
+        c_err = sqrt(log(2 / delta) / (2 * n));
+    }
+};
+
+// Estimates the number of triangles by sampling edges uniformly, and counting
+// the triangles t_e each one belongs to, via the intersection of the
+// neighborhoods of its endpoints. The total is E<t_e>/3, and the samples are
+// drawn in batches of increasing size, until the confidence interval with
+// probability 1 - delta, given by the central limit theorem, is within a
+// relative error epsilon, or max_samples is reached. The graph is assumed to
+// be undirected, and self-loops and parallel edges are ignored in the
+// intersections.
+struct get_triangles_edge_sampled
+{
+    template <class Graph, class RNG>
+    void operator()(const Graph& g, double epsilon, double delta,
+                    size_t max_samples, RNG& rng_, double& t, double& t_err,
+                    double& wedges, size_t& n) const
+    {
+        vector<size_t> vs;
+        vector<double> probs;
+        double E = 0;
+        wedges = 0;
+        for (auto v : vertices_range(g))
+        {
+            size_t k = out_degree(v, g);
+            if (k == 0)
+                continue;
+            vs.push_back(v);
+            probs.push_back(k);
+            E += k;
+            wedges += (k * (k - 1)) / 2;
+        }
+        E /= 2;
+
+        if (max_samples == 0)
+            max_samples = numeric_limits<size_t>::max();
+
+        t = t_err = 0;
+        n = 0;
+        if (vs.empty())
+            return;
+
+        Sampler<size_t> sampler(vs, probs);
+        vector<std::shared_ptr<RNG>> rngs;
+        init_rngs(rngs, rng_);
+
+        boost::math::normal normal;
+        double z = quantile(normal, 1 - delta / 2);
+
+        // set of distinct neighbors of v, excluding u
+        auto get_neighbors = [&](auto v, auto u, auto& ns)
+            {
+                ns.clear();
+                for (auto w : out_neighbors_range(v, g))
+                {
+                    if (w != v && w != u)
+                        ns.push_back(w);
+                }
+                std::sort(ns.begin(), ns.end());
+                ns.erase(std::unique(ns.begin(), ns.end()), ns.end());
+            };
+
+        vector<size_t> count(num_vertices(g), 0);
+        double sum = 0, sum2 = 0;
+        size_t batch = std::min(size_t(1024), max_samples);
+        while (batch > 0)
+        {
+            // an edge is sampled by choosing an endpoint proportionally to
+            // its degree, and then one of its edges uniformly
+            for (size_t i = 0; i < batch; ++i)
+                count[sampler.sample(rng_)]++;
+
+            vector<size_t> ns, us, es;
+            #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
+                firstprivate(ns, us, es) reduction(+:sum, sum2)
+            parallel_vertex_loop_no_spawn
+                (g,
+                 [&](auto v)
+                 {
+                     if (count[v] == 0)
+                         return;
+                     auto& rng = get_rng(rngs, rng_);
+                     es.clear();
+                     for (auto u : out_neighbors_range(v, g))
+                         es.push_back(u);
+                     get_neighbors(v, v, ns);
+                     for (; count[v] > 0; --count[v])
+                     {
+                         size_t u = uniform_sample(es, rng);
+                         if (u == v)
+                             continue;
+                         get_neighbors(u, v, us);
+                         size_t te = 0;
+                         tri_intersect(ns.data(), ns.size(), us.data(),
+                                       us.size(),
+                                       [&](size_t, size_t) { ++te; });
+                         sum += te;
+                         sum2 += te * te;
+                     }
+                 });
+            n += batch;
+
+            double avg = sum / n;
+            double sd = sqrt(std::max(sum2 / n - avg * avg, 0.) / n);
+            t = E * avg / 3;
+            t_err = z * E * sd / 3;
+            if (t_err <= epsilon * t)
+                break;
+            batch = std::min(n, max_samples - n);
+        }
+    }
+};
+
+// Estimates the local clustering coefficient of every vertex by sampling
+// wedges centered on it. Vertices with fewer wedges than the number of
+// samples required for an absolute error epsilon with probability 1 - delta
+// are computed exactly, and get a zero error.
+struct set_sampled_clustering_to_property
+{
+    template <class Graph, class ClustMap, class RNG>
+    void operator()(const Graph& g, ClustMap clust_map, ClustMap err_map,
+                    double epsilon, double delta, RNG& rng_) const
+    {
+        typedef typename property_traits<ClustMap>::value_type c_type;
+        size_t n = hoeffding_samples(epsilon, delta);
+        c_type err = sqrt(log(2 / delta) / (2 * n));
+
+        vector<std::shared_ptr<RNG>> rngs;
+        init_rngs(rngs, rng_);
+
+        vector<bool> mask(num_vertices(g), false);
+        vector<size_t> ns;
+        #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
+            firstprivate(mask, ns)
+        parallel_vertex_loop_no_spawn
+            (g,
+             [&](auto v)
+             {
+                 size_t norm = get_triangles_norm(v, g);
+                 if (norm <= n)
+                 {
+                     auto tri = get_triangles(v, mask, g);
+                     clust_map[v] = (norm > 0) ?
+                         c_type(double(tri.first) / norm) : c_type(0);
+                     err_map[v] = 0;
+                     return;
+                 }
+                 auto& rng = get_rng(rngs, rng_);
+                 ns.clear();
+                 for (auto u : out_neighbors_range(v, g))
+                     ns.push_back(u);
+                 size_t closed = 0;
+                 for (size_t i = 0; i < n; ++i)
+                     closed += sample_wedge(v, ns, g, rng);
+                 clust_map[v] = c_type(double(closed) / n);
+                 err_map[v] = err;
+             });
+    }
+};
+
+// Single-pass estimation of the number of triangles and wedges in a stream of
+// undirected edges, with a fixed amount of memory. The triangles are counted
+// with several independent copies of the TRIEST-IMPR reservoir sampler
+// [destefani-triest-2016], which share the memory budget, and the spread of
+// their estimates gives the confidence interval. The number of wedges is
+// obtained exactly from the degrees. Self-loops are skipped, and each edge
+// should appear only once in the stream, otherwise it is counted as a parallel
+// edge.
+class TriangleStream
+{
+public:
+    TriangleStream(size_t memory, size_t copies, rng_t& rng)
+        : _m(std::max(memory / std::max(copies, size_t(1)), size_t(2)))
+    {
+        for (size_t i = 0; i < std::max(copies, size_t(1)); ++i)
+        {
+            std::array<int, rng_t::state_size> seed_data;
+            std::generate_n(seed_data.data(), seed_data.size(), std::ref(rng));
+            std::seed_seq seq(std::begin(seed_data), std::end(seed_data));
+            _copies.emplace_back(seq);
+        }
+    }
+
+    // Adds the edges es[i][0] -> es[i][1]
+    template <class Edges>
+    void add_edges(const Edges& es)
+    {
+        size_t E = es.size();
+        _edges.clear();
+        for (size_t i = 0; i < E; ++i)
+        {
+            size_t u = es[i][0], v = es[i][1];
+            if (u == v)
+                continue;
+            _edges.emplace_back(u, v);
+            for (auto w : {u, v})
+            {
+                if (w >= _degree.size())
+                    _degree.resize(w + 1, 0);
+                _wedges += _degree[w]++;
+            }
+        }
+
+        size_t t = _t;
+        #pragma omp parallel for schedule(runtime) \
+            if (_edges.size() * _copies.size() > OPENMP_MIN_THRESH)
+        for (size_t i = 0; i < _copies.size(); ++i)
+            _copies[i].add_edges(_edges, t, _m);
+        _t += _edges.size();
+    }
+
+    size_t get_num_edges() { return _t; }
+    double get_wedges() { return _wedges; }
+
+    // Returns the estimated number of triangles, and the half-width of its
+    // confidence interval with probability 1 - delta.
+    pair<double, double> get_triangles(double delta)
+    {
+        size_t B = _copies.size();
+        double avg = 0, var = 0;
+        for (auto& c : _copies)
+            avg += c._tau;
+        avg /= B;
+        if (B < 2)
+            return {avg, numeric_limits<double>::infinity()};
+        for (auto& c : _copies)
+            var += power(c._tau - avg, 2);
+        var /= B - 1;
+        boost::math::students_t dist(B - 1);
+        return {avg, quantile(dist, 1 - delta / 2) * sqrt(var / B)};
+    }
+
+private:
+    typedef pair<size_t, size_t> edge_t;
+
+    struct triest
+    {
+        triest(std::seed_seq& seq) : _rng(seq) {}
+
+        void add_edges(const vector<edge_t>& edges, size_t t, size_t m)
+        {
+            for (auto& e : edges)
+            {
+                ++t;
+                size_t u = e.first, v = e.second;
+
+                // the triangles closed by the edge are counted before it is
+                // (possibly) sampled, weighted by the inverse probability that
+                // both other edges are in the sample
+                double eta = std::max(1., (double(t) - 1) * (double(t) - 2) /
+                                          (double(m) * (m - 1)));
+                auto iu = _adj.find(u);
+                auto iv = _adj.find(v);
+                if (iu != _adj.end() && iv != _adj.end())
+                {
+                    auto* a = &iu->second;
+                    auto* b = &iv->second;
+                    if (a->size() > b->size())
+                        std::swap(a, b);
+                    size_t c = 0;
+                    for (auto& w : *a)
+                        c += b->count(w.first);
+                    _tau += eta * c;
+                }
+
+                if (t <= m)
+                {
+                    insert(u, v);
+                    _sample.push_back(e);
+                    continue;
+                }
+
+                std::bernoulli_distribution coin(m / double(t));
+                if (!coin(_rng))
+                    continue;
+                std::uniform_int_distribution<size_t> pos(0, m - 1);
+                auto& old = _sample[pos(_rng)];
+                remove(old.first, old.second);
+                old = e;
+                insert(u, v);
+            }
+        }
+
+        // the sampled adjacency keeps the multiplicity of repeated edges,
+        // so that they can be removed independently
+        void insert(size_t u, size_t v)
+        {
+            _adj[u][v]++;
+            _adj[v][u]++;
+        }
+
+        void remove(size_t u, size_t v)
+        {
+            for (auto x : {make_pair(u, v), make_pair(v, u)})
+            {
+                auto iter = _adj.find(x.first);
+                auto& ns = iter->second;
+                auto niter = ns.find(x.second);
+                if (--niter->second == 0)
+                    ns.erase(niter);
+                if (ns.empty())
+                    _adj.erase(iter);
+            }
+        }
+
+        rng_t _rng;
+        vector<edge_t> _sample;
+        gt_hash_map<size_t, gt_hash_map<size_t, size_t>> _adj;
+        double _tau = 0;
+    };
+
+    size_t _m;
+    vector<triest> _copies;
+    vector<edge_t> _edges;
+    vector<size_t> _degree;
+    size_t _t = 0;
+    double _wedges = 0;
+};
+
 } //graph-tool namespace
 
 #endif // GRAPH_CLUSTERING_HH
@@ -0,0 +1,160 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "graph_filtering.hh"
+
+#include "graph.hh"
+#include "graph_properties.hh"
+
+#include "graph_clustering.hh"
+#include "numpy_bind.hh"
+
+#include <fstream>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/python.hpp>
+
+using namespace std;
+using namespace boost;
+using namespace graph_tool;
+
+// defined in graph_io.cc
+namespace boost
+{
+template <>
+string lexical_cast<string,python::object>(const python::object & o);
+}
+
+#include "graph_io_binary.hh"
+
+// defined in graph_io.cc
+void build_stream(boost::iostreams::filtering_stream<boost::iostreams::input>& stream,
+                  const string& file, boost::python::object& pfile,
+                  std::ifstream& file_stream);
+
+void triangle_stream_add_edges(TriangleStream& ts, python::object oedges)
+{
+    auto edges = get_array<int64_t,2>(oedges);
+    for (size_t i = 0; i < edges.shape()[0]; ++i)
+    {
+        if (edges[i][0] < 0 || edges[i][1] < 0)
+            throw ValueException("invalid vertex index: " +
+                                 lexical_cast<string>(std::min(edges[i][0],
+                                                               edges[i][1])));
+    }
+    ts.add_edges(edges);
+}
+
+python::tuple triangle_stream_get_triangles(TriangleStream& ts, double delta)
+{
+    auto t = ts.get_triangles(delta);
+    return python::make_tuple(t.first, t.second);
+}
+
+// Feeds the edges of a graph stored in the binary format to the stream,
+// directly as they are read from the adjacency lists, without constructing the
+// graph.
+template <bool BE, class Vint>
+void triangle_stream_read_adjacency(TriangleStream& ts, size_t N,
+                                    std::istream& s)
+{
+    constexpr size_t chunk = 1 << 16;
+    vector<std::array<size_t, 2>> edges;
+    for (size_t v = 0; v < N; ++v)
+    {
+        std::vector<Vint> us;
+        read<BE>(s, us);
+        for (size_t u : us)
+        {
+            if (u >= N)
+                throw IOException("error reading graph: vertex index not in range");
+            edges.push_back({v, u});
+        }
+        if (edges.size() >= chunk)
+        {
+            ts.add_edges(edges);
+            edges.clear();
+        }
+    }
+    ts.add_edges(edges);
+}
+
+template <bool BE>
+void triangle_stream_read_graph(TriangleStream& ts, std::istream& s)
+{
+    uint8_t directed = false;
+    read<BE>(s, directed);
+
+    uint64_t N = 0;
+    read<BE>(s, N);
+
+    if (N <= numeric_limits<uint8_t>::max())
+        triangle_stream_read_adjacency<BE, uint8_t>(ts, N, s);
+    else if (N <= numeric_limits<uint16_t>::max())
+        triangle_stream_read_adjacency<BE, uint16_t>(ts, N, s);
+    else if (N <= numeric_limits<uint32_t>::max())
+        triangle_stream_read_adjacency<BE, uint32_t>(ts, N, s);
+    else
+        triangle_stream_read_adjacency<BE, uint64_t>(ts, N, s);
+}
+
+void triangle_stream_read(TriangleStream& ts, string file,
+                          python::object pfile)
+{
+    try
+    {
+        boost::iostreams::filtering_stream<boost::iostreams::input> stream;
+        std::ifstream file_stream;
+        build_stream(stream, file, pfile, file_stream);
+
+        char magic[_magic_length];
+        stream.read(magic, _magic_length);
+        if (strncmp(magic, _magic, _magic_length) != 0)
+            throw IOException("Error reading graph: Invalid magic number");
+        uint8_t version = 0;
+        read<false>(stream, version);
+        if (version != _version)
+            throw IOException("Error reading graph: Invalid format version " +
+                              boost::lexical_cast<std::string>(version));
+        uint8_t big_end = 0;
+        read<false>(stream, big_end);
+        string comment;
+        read<false>(stream, comment);
+
+        if (big_end)
+            triangle_stream_read_graph<true>(ts, stream);
+        else
+            triangle_stream_read_graph<false>(ts, stream);
+    }
+    catch (ios_base::failure &e)
+    {
+        throw IOException("error reading from file '" + file + "':" + e.what());
+    }
+}
+
+using namespace boost::python;
+
+void export_clustering_stream()
+{
+    class_<TriangleStream>("TriangleStream",
+                           init<size_t, size_t, rng_t&>())
+        .def("add_edges", &triangle_stream_add_edges)
+        .def("read", &triangle_stream_read)
+        .def("get_num_edges", &TriangleStream::get_num_edges)
+        .def("get_wedges", &TriangleStream::get_wedges)
+        .def("get_triangles", &triangle_stream_get_triangles);
+}
@@ -21,6 +21,7 @@
 #define GRAPH_EXTENDED_CLUSTERING_HH
 
 #include "hash_map_wrap.hh"
+#include "graph_triangles.hh"
 
 #include <boost/graph/breadth_first_search.hpp>
 
@@ -113,6 +114,37 @@ struct get_extended_clustering
     {
         typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
 
+        // If only the first order is requested, the number of connected pairs
+        // u -> t, with u an out-neighbor and t an in-neighbor of v, is given
+        // directly by the triangles to which v belongs, and no search is
+        // necessary.
+        vector<size_t> c1;
+        if (cmaps.size() == 1)
+        {
+            c1.resize(num_vertices(g), 0);
+            with_triangle_csr
+                (g,
+                 [&](auto& csr)
+                 {
+                     csr.for_each_triangle
+                         ([&](size_t u, size_t v, size_t w, const tri_arc& uv,
+                              const tri_arc& uw, const tri_arc& vw)
+                          {
+                              bool cw = uv.out && vw.out && uw.in;
+                              bool ccw = uw.out && vw.in && uv.in;
+                              size_t k = size_t(cw) + size_t(ccw);
+                              if (k == 0)
+                                  return;
+                              #pragma omp atomic
+                              c1[u] += k;
+                              #pragma omp atomic
+                              c1[v] += k;
+                              #pragma omp atomic
+                              c1[w] += k;
+                          });
+                 });
+        }
+
         parallel_vertex_loop
             (g,
              [&](auto v)
@@ -146,6 +178,13 @@ struct get_extended_clustering
                  k_out = neighbors.size();
                  z = (k_in * k_out) - k_inter;
 
+                 if (!c1.empty())
+                 {
+                     if (c1[v] > 0)
+                         cmaps[0][v] += c1[v] / double(z);
+                     return;
+                 }
+
                  // And now we setup and start the BFS bonanza
                  for (auto u : neighbors)
                  {
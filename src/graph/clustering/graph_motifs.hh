@@ -22,9 +22,15 @@
 #include <boost/functional/hash.hpp>
 #include <algorithm>
 #include <vector>
+#include <array>
+
+#ifdef _OPENMP
+#include "omp.h"
+#endif
 
 #include "random.hh"
 #include "hash_map_wrap.hh"
+#include "../inference/support/parallel_rng.hh"
 
 namespace graph_tool
 {
@@ -139,6 +145,8 @@ struct sample_all
 {
     template <class val_type>
     void operator()(std::vector<val_type>&, size_t) {}
+
+    void set_rng(rng_t&) {}
 };
 
 struct sample_some
@@ -156,11 +164,7 @@ struct sample_some
         size_t nc = extend.size();
         double u = nc*pd - floor(nc*pd);
         size_t n;
-        double r;
-        #pragma omp critical (random)
-        {
-            r = random();
-        }
+        double r = random();
         if (r < u)
             n = size_t(ceil(nc*pd));
         else
@@ -179,21 +183,256 @@ struct sample_some
         {
             auto random_v = std::bind(idist_t(0, extend.size()-i-1),
                                       std::ref(*_rng));
-            size_t j;
-            #pragma omp critical (random)
-            {
-                j = i + random_v();
-            }
+            size_t j = i + random_v();
             std::swap(extend[i], extend[j]);
         }
         extend.resize(n);
     }
 
+    // each thread must use its own generator, since the sampler is called
+    // concurrently
+    void set_rng(rng_t& rng) { _rng = &rng; }
+
     std::vector<double>* _p;
     rng_t* _rng;
 };
 
 
+// Canonical labelling of subgraphs with at most motif_max_canon vertices. The
+// certificate is the adjacency matrix (with edge multiplicities) that is
+// lexicographically smallest among the vertex orderings compatible with an
+// equitable coloring, obtained by iterated degree refinement, as in nauty.
+// Two subgraphs are isomorphic if and only if their certificates are equal,
+// so that they can be identified by hashing, without pairwise comparisons.
+// Only the permutations within the color classes are enumerated, which for
+// small subgraphs are usually very few.
+constexpr size_t motif_max_canon = 8;
+
+typedef std::array<uint8_t, motif_max_canon * motif_max_canon> motif_cert_t;
+
+struct motif_cert_hash
+{
+    size_t operator()(const motif_cert_t& c) const
+    {
+        return boost::hash_range(c.begin(), c.end());
+    }
+};
+
+class motif_canon
+{
+public:
+    // sets the subgraph of g induced by the sorted vertex list vlist, with the
+    // same convention as make_subgraph()
+    template <class Graph>
+    void set_subgraph
+        (const std::vector<typename boost::graph_traits<Graph>::vertex_descriptor>& vlist,
+         Graph& g)
+    {
+        init(vlist.size());
+        for (size_t i = 0; i < _k; ++i)
+        {
+            auto ov = vlist[i];
+            for (auto ot : out_neighbors_range(ov, g))
+            {
+                auto viter = lower_bound(vlist.begin(), vlist.end(), ot);
+                if (viter == vlist.end() || *viter != ot)
+                    continue;
+                size_t j = viter - vlist.begin();
+                if (graph_tool::is_directed(g))
+                    add(i, j);
+                else if (ot < ov)
+                    add_undirected(i, j);
+            }
+        }
+    }
+
+    // sets a whole (small) graph
+    template <class Graph>
+    void set_graph(Graph& g)
+    {
+        init(num_vertices(g));
+        for (auto v : vertices_range(g))
+        {
+            for (auto u : out_neighbors_range(v, g))
+            {
+                if (graph_tool::is_directed(g))
+                    add(v, u);
+                else if (u < v)
+                    add_undirected(v, u);
+            }
+        }
+    }
+
+    // computes the certificate, and the permutation that maps each canonical
+    // position to the vertex placed there; if labelled == true, the identity
+    // is used instead, so that only identically labelled subgraphs are
+    // identified
+    void canonicalize(bool labelled)
+    {
+        if (labelled)
+        {
+            _cert = _adj;
+            for (size_t i = 0; i < _k; ++i)
+                _perm[i] = i;
+            return;
+        }
+
+        refine();
+
+        // the vertices sorted by color; each class is a contiguous cell
+        for (size_t i = 0; i < _k; ++i)
+            _order[i] = i;
+        std::sort(_order.begin(), _order.begin() + _k,
+                  [&](size_t u, size_t v)
+                  { return std::make_pair(_color[u], u) <
+                           std::make_pair(_color[v], v); });
+        _cells.clear();
+        for (size_t i = 0; i < _k; ++i)
+        {
+            if (i == 0 || _color[_order[i]] != _color[_order[i - 1]])
+                _cells.emplace_back(i, i + 1);
+            else
+                _cells.back().second = i + 1;
+        }
+
+        bool first = true;
+        while (true)
+        {
+            try_order(first);
+            first = false;
+
+            // advance to the next ordering, cell by cell
+            size_t c = 0;
+            for (; c < _cells.size(); ++c)
+            {
+                if (std::next_permutation(_order.begin() + _cells[c].first,
+                                          _order.begin() + _cells[c].second))
+                    break;
+            }
+            if (c == _cells.size())
+                break;
+        }
+    }
+
+    const motif_cert_t& get_cert() const { return _cert; }
+    const std::array<size_t, motif_max_canon>& get_perm() const { return _perm; }
+
+private:
+    void init(size_t k)
+    {
+        _k = k;
+        _adj.fill(0);
+        _cert.fill(0);
+    }
+
+    void add(size_t i, size_t j)
+    {
+        auto& a = _adj[i * _k + j];
+        if (a < std::numeric_limits<uint8_t>::max())
+            ++a;
+    }
+
+    void add_undirected(size_t i, size_t j)
+    {
+        add(i, j);
+        add(j, i);
+    }
+
+    // equitable coloring: the vertices are initially colored by their
+    // self-loops and in- and out-degrees, and then repeatedly by the multiset
+    // of colors of their neighbors, until the number of colors stabilizes
+    void refine()
+    {
+        for (size_t i = 0; i < _k; ++i)
+        {
+            auto& sig = _sig[i];
+            sig.assign({_adj[i * _k + i], 0, 0});
+            for (size_t j = 0; j < _k; ++j)
+            {
+                if (j == i)
+                    continue;
+                sig[1] += _adj[i * _k + j];
+                sig[2] += _adj[j * _k + i];
+            }
+        }
+        size_t ncolors = rank();
+
+        while (ncolors < _k)
+        {
+            for (size_t i = 0; i < _k; ++i)
+            {
+                auto& sig = _sig[i];
+                sig.clear();
+                for (size_t j = 0; j < _k; ++j)
+                {
+                    if (j == i)
+                        continue;
+                    size_t out = _adj[i * _k + j], in = _adj[j * _k + i];
+                    if (out + in > 0)
+                        sig.push_back((_color[j] << 16) | (out << 8) | in);
+                }
+                std::sort(sig.begin(), sig.end());
+                sig.push_back(_color[i]);
+            }
+            size_t n = rank();
+            if (n == ncolors)
+                break;
+            ncolors = n;
+        }
+    }
+
+    // replaces the colors by the rank of the signatures, and returns the
+    // number of distinct ones
+    size_t rank()
+    {
+        for (size_t i = 0; i < _k; ++i)
+            _order[i] = i;
+        std::sort(_order.begin(), _order.begin() + _k,
+                  [&](size_t u, size_t v) { return _sig[u] < _sig[v]; });
+        size_t c = 0;
+        for (size_t i = 0; i < _k; ++i)
+        {
+            if (i > 0 && _sig[_order[i]] != _sig[_order[i - 1]])
+                ++c;
+            _color[_order[i]] = c;
+        }
+        return c + 1;
+    }
+
+    // compares the adjacency matrix permuted by _order with the current
+    // certificate, and replaces it if it is smaller, stopping as soon as it
+    // is found to be larger
+    void try_order(bool first)
+    {
+        bool smaller = first;
+        for (size_t i = 0; i < _k; ++i)
+        {
+            for (size_t j = 0; j < _k; ++j)
+            {
+                size_t idx = i * _k + j;
+                uint8_t x = _adj[_order[i] * _k + _order[j]];
+                if (!smaller)
+                {
+                    if (x > _cert[idx])
+                        return;
+                    if (x == _cert[idx])
+                        continue;
+                    smaller = true;
+                }
+                _cert[idx] = x;
+            }
+        }
+        if (smaller)
+            _perm = _order;
+    }
+
+    size_t _k = 0;
+    motif_cert_t _adj, _cert;
+    std::array<size_t, motif_max_canon> _perm, _order, _color;
+    std::array<std::vector<size_t>, motif_max_canon> _sig;
+    std::vector<std::pair<size_t, size_t>> _cells;
+};
+
 // build the actual induced subgraph from the vertex list
 template <class Graph, class GraphSG>
 void make_subgraph
@@ -312,24 +551,6 @@ struct get_all_motifs
                     std::vector<size_t>& hist, std::vector<std::vector<VMap> >& vmaps,
                     Sampler sampler) const
     {
-        // this hashes subgraphs according to their signature
-        gt_hash_map<std::vector<size_t>,
-                    std::vector<std::pair<size_t, d_graph_t> >,
-                    std::hash<std::vector<size_t>>> sub_list;
-        std::vector<size_t> sig; // current signature
-
-        for (size_t i = 0; i < subgraph_list.size(); ++i)
-        {
-            auto& sub = subgraph_list[i];
-            typename wrap_directed::apply<Graph,d_graph_t>::type
-                usub(sub);
-            get_sig(usub, sig);
-            sub_list[sig].emplace_back(i, sub);
-        }
-
-        // the subgraph count
-        hist.resize(subgraph_list.size());
-
         typedef std::uniform_real_distribution<double> rdist_t;
         auto random = std::bind(rdist_t(), std::ref(rng));
 
@@ -357,90 +578,328 @@ struct get_all_motifs
             V.resize(n);
         }
 
-        size_t N = (p < 1) ? V.size() : num_vertices(g);
-        #pragma omp parallel for if (num_vertices(g) > OPENMP_MIN_THRESH) \
-            private(sig)
-        for (size_t i = 0; i < N; ++i)
+        std::vector<std::shared_ptr<rng_t>> rngs;
+        init_rngs(rngs, rng);
+
+        if (k <= motif_max_canon)
+            canonical_census(g, k, V, subgraph_list, hist, vmaps, sampler,
+                             rngs);
+        else
+            iso_census(g, k, V, subgraph_list, hist, vmaps, sampler, rngs);
+    }
+
+    // Identifies the subgraphs via their canonical certificates. Each thread
+    // keeps its own counts, vertex maps and table of newly found motifs,
+    // which are merged at the end.
+    template <class Graph, class Sampler, class VMap>
+    void canonical_census(Graph& g, size_t k, std::vector<size_t>& V,
+                          std::vector<d_graph_t>& subgraph_list,
+                          std::vector<size_t>& hist,
+                          std::vector<std::vector<VMap> >& vmaps,
+                          Sampler& sampler,
+                          std::vector<std::shared_ptr<rng_t>>& rngs) const
+    {
+        typedef typename boost::graph_traits<Graph>::vertex_descriptor vertex_t;
+        typedef std::array<size_t, motif_max_canon> perm_t;
+
+        // certificates of the motifs already in the list, and the
+        // permutations that map their canonical positions to their vertices
+        gt_hash_map<motif_cert_t, size_t, motif_cert_hash> known;
+        std::vector<perm_t> known_perm(subgraph_list.size());
+        motif_canon canon;
+        for (size_t i = 0; i < subgraph_list.size(); ++i)
         {
-            std::vector<std::vector<typename boost::graph_traits<Graph>::vertex_descriptor> >
-                subgraphs;
-            typename boost::graph_traits<Graph>::vertex_descriptor v =
-                (p < 1) ? V[i] : vertex(i, g);
-            if (!is_valid_vertex(v, g))
+            typename wrap_directed::apply<Graph,d_graph_t>::type
+                usub(subgraph_list[i]);
+            if (num_vertices(usub) != k)
                 continue;
+            canon.set_graph(usub);
+            canon.canonicalize(!comp_iso);
+            known.emplace(canon.get_cert(), i);
+            known_perm[i] = canon.get_perm();
+        }
+
+        // the subgraph count
+        hist.resize(subgraph_list.size());
 
-            typename wrap_undirected::apply<Graph>::type ug(g);
-            get_subgraphs(ug, v, k, subgraphs, sampler);
+        // vertex maps are stored as the graph vertices at each position of
+        // the motif
+        typedef std::vector<std::vector<size_t>> maps_t;
+        struct census_t
+        {
+            std::vector<size_t> hist;
+            std::vector<maps_t> maps;
+
+            // motifs not in the list
+            gt_hash_map<motif_cert_t, size_t, motif_cert_hash> index;
+            std::vector<motif_cert_t> certs;
+            std::vector<std::vector<vertex_t>> first;
+            std::vector<perm_t> perm;
+            std::vector<size_t> new_hist;
+            std::vector<maps_t> new_maps;
+        };
+
+        size_t nt = (num_vertices(g) > OPENMP_MIN_THRESH) ?
+            get_openmp_threads() : 1;
+        std::vector<census_t> census(nt);
 
-            for (size_t j = 0; j < subgraphs.size(); ++j)
+        size_t N = (p < 1) ? V.size() : num_vertices(g);
+        #pragma omp parallel num_threads(nt)
+        {
+            size_t tid = 0;
+            #ifdef _OPENMP
+            tid = omp_get_thread_num();
+            #endif
+            auto& lc = census[tid];
+            lc.hist.resize(known_perm.size());
+            if (collect_vmaps)
+                lc.maps.resize(known_perm.size());
+
+            Sampler tsampler = sampler;
+            tsampler.set_rng(get_rng(rngs, rng));
+            motif_canon tcanon;
+            std::vector<std::vector<vertex_t>> subgraphs;
+            std::vector<size_t> vmap(k);
+
+            #pragma omp for schedule(runtime)
+            for (size_t i = 0; i < N; ++i)
             {
-                d_graph_t sub;
-                typename wrap_directed::apply<Graph,d_graph_t>::type
-                    usub(sub);
-                make_subgraph(subgraphs[j], g, usub);
-                get_sig(usub, sig);
+                vertex_t v = (p < 1) ? V[i] : vertex(i, g);
+                if (!is_valid_vertex(v, g))
+                    continue;
+
+                subgraphs.clear();
+                typename wrap_undirected::apply<Graph>::type ug(g);
+                get_subgraphs(ug, v, k, subgraphs, tsampler);
 
-                #pragma omp critical (gather)
+                for (auto& vlist : subgraphs)
                 {
-                    bool skip = false;
-                    auto iter = sub_list.find(sig);
-                    if(iter == sub_list.end())
+                    tcanon.set_subgraph(vlist, g);
+                    tcanon.canonicalize(!comp_iso);
+                    auto& cert = tcanon.get_cert();
+
+                    const perm_t* mperm;
+                    maps_t* maps = nullptr;
+                    auto iter = known.find(cert);
+                    if (iter != known.end())
+                    {
+                        size_t pos = iter->second;
+                        lc.hist[pos]++;
+                        mperm = &known_perm[pos];
+                        if (collect_vmaps)
+                            maps = &lc.maps[pos];
+                    }
+                    else
                     {
                         if (!fill_list)
-                            skip = true; // avoid inserting an element in sub_list
-                        sub_list[sig].clear();
+                            continue;
+                        size_t pos;
+                        auto liter = lc.index.find(cert);
+                        if (liter == lc.index.end())
+                        {
+                            pos = lc.certs.size();
+                            lc.index[cert] = pos;
+                            lc.certs.push_back(cert);
+                            lc.first.push_back(vlist);
+                            lc.perm.push_back(tcanon.get_perm());
+                            lc.new_hist.push_back(0);
+                            if (collect_vmaps)
+                                lc.new_maps.emplace_back();
+                        }
+                        else
+                        {
+                            pos = liter->second;
+                        }
+                        lc.new_hist[pos]++;
+                        mperm = &lc.perm[pos];
+                        if (collect_vmaps)
+                            maps = &lc.new_maps[pos];
                     }
 
-                    if (!skip)
+                    if (maps != nullptr)
                     {
-                        bool found = false;
-                        size_t pos;
-                        auto sl = sub_list.find(sig);
-                        if (sl != sub_list.end())
+                        auto& perm = tcanon.get_perm();
+                        for (size_t c = 0; c < k; ++c)
+                            vmap[(*mperm)[c]] = vlist[perm[c]];
+                        maps->push_back(vmap);
+                    }
+                }
+            }
+        }
+
+        // relabels the vertex maps given w.r.t. the canonical permutation
+        // `from` to the labelling of the motif at position pos
+        auto add_maps = [&](size_t pos, maps_t& maps, const perm_t& from)
+            {
+                if (pos >= vmaps.size())
+                    vmaps.resize(pos + 1);
+                const auto& to = known_perm[pos];
+                auto& sub = subgraph_list[pos];
+                for (auto& m : maps)
+                {
+                    vmaps[pos].push_back(VMap(get(boost::vertex_index, sub)));
+                    auto& vm = vmaps[pos].back();
+                    for (size_t c = 0; c < k; ++c)
+                        vm[vertex(to[c], sub)] = m[from[c]];
+                }
+            };
+
+        for (auto& lc : census)
+        {
+            for (size_t pos = 0; pos < lc.hist.size(); ++pos)
+            {
+                hist[pos] += lc.hist[pos];
+                if (collect_vmaps)
+                    add_maps(pos, lc.maps[pos], known_perm[pos]);
+            }
+
+            for (size_t i = 0; i < lc.certs.size(); ++i)
+            {
+                size_t pos;
+                auto iter = known.find(lc.certs[i]);
+                if (iter == known.end())
+                {
+                    pos = subgraph_list.size();
+                    subgraph_list.emplace_back();
+                    typename wrap_directed::apply<Graph,d_graph_t>::type
+                        usub(subgraph_list.back());
+                    make_subgraph(lc.first[i], g, usub);
+                    known[lc.certs[i]] = pos;
+                    known_perm.push_back(lc.perm[i]);
+                    hist.push_back(0);
+                }
+                else
+                {
+                    pos = iter->second;
+                }
+                hist[pos] += lc.new_hist[i];
+                if (collect_vmaps)
+                    add_maps(pos, lc.new_maps[i], lc.perm[i]);
+            }
+        }
+        if (collect_vmaps)
+            vmaps.resize(subgraph_list.size());
+    }
+
+    // Identifies the subgraphs by pairwise isomorphism tests against the
+    // motifs with the same degree signature. This is used only for subgraphs
+    // that are too large for canonical labelling.
+    template <class Graph, class Sampler, class VMap>
+    void iso_census(Graph& g, size_t k, std::vector<size_t>& V,
+                    std::vector<d_graph_t>& subgraph_list,
+                    std::vector<size_t>& hist,
+                    std::vector<std::vector<VMap> >& vmaps,
+                    Sampler& sampler,
+                    std::vector<std::shared_ptr<rng_t>>& rngs) const
+    {
+        // this hashes subgraphs according to their signature
+        gt_hash_map<std::vector<size_t>,
+                    std::vector<std::pair<size_t, d_graph_t> >,
+                    std::hash<std::vector<size_t>>> sub_list;
+        std::vector<size_t> sig; // current signature
+
+        for (size_t i = 0; i < subgraph_list.size(); ++i)
+        {
+            auto& sub = subgraph_list[i];
+            typename wrap_directed::apply<Graph,d_graph_t>::type
+                usub(sub);
+            get_sig(usub, sig);
+            sub_list[sig].emplace_back(i, sub);
+        }
+
+        // the subgraph count
+        hist.resize(subgraph_list.size());
+
+        size_t N = (p < 1) ? V.size() : num_vertices(g);
+        #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
+            firstprivate(sig)
+        {
+            Sampler tsampler = sampler;
+            tsampler.set_rng(get_rng(rngs, rng));
+
+            #pragma omp for schedule(runtime)
+            for (size_t i = 0; i < N; ++i)
+            {
+                std::vector<std::vector<typename boost::graph_traits<Graph>::vertex_descriptor> >
+                    subgraphs;
+                typename boost::graph_traits<Graph>::vertex_descriptor v =
+                    (p < 1) ? V[i] : vertex(i, g);
+                if (!is_valid_vertex(v, g))
+                    continue;
+
+                typename wrap_undirected::apply<Graph>::type ug(g);
+                get_subgraphs(ug, v, k, subgraphs, tsampler);
+
+                for (size_t j = 0; j < subgraphs.size(); ++j)
+                {
+                    d_graph_t sub;
+                    typename wrap_directed::apply<Graph,d_graph_t>::type
+                        usub(sub);
+                    make_subgraph(subgraphs[j], g, usub);
+                    get_sig(usub, sig);
+
+                    #pragma omp critical (gather)
+                    {
+                        bool skip = false;
+                        auto iter = sub_list.find(sig);
+                        if(iter == sub_list.end())
+                        {
+                            if (!fill_list)
+                                skip = true; // avoid inserting an element in sub_list
+                            sub_list[sig].clear();
+                        }
+
+                        if (!skip)
                         {
-                            for (auto& mpos : sl->second)
+                            bool found = false;
+                            size_t pos;
+                            auto sl = sub_list.find(sig);
+                            if (sl != sub_list.end())
                             {
-                                d_graph_t& motif = mpos.second;
-                                typename wrap_directed::apply<Graph,d_graph_t>::type
-                                    umotif(motif);
-                                if (comp_iso)
+                                for (auto& mpos : sl->second)
                                 {
-                                    if (isomorphism(umotif, usub,
-                                                    vertex_index1_map(get(boost::vertex_index, umotif)).
-                                                    vertex_index2_map(get(boost::vertex_index, usub))))
-                                        found = true;
-                                }
-                                else
-                                {
-                                    if (graph_cmp(umotif, usub))
-                                        found = true;
-                                }
-                                if (found)
-                                {
-                                    pos = mpos.first;
-                                    hist[pos]++;
-                                    break;
+                                    d_graph_t& motif = mpos.second;
+                                    typename wrap_directed::apply<Graph,d_graph_t>::type
+                                        umotif(motif);
+                                    if (comp_iso)
+                                    {
+                                        if (isomorphism(umotif, usub,
+                                                        vertex_index1_map(get(boost::vertex_index, umotif)).
+                                                        vertex_index2_map(get(boost::vertex_index, usub))))
+                                            found = true;
+                                    }
+                                    else
+                                    {
+                                        if (graph_cmp(umotif, usub))
+                                            found = true;
+                                    }
+                                    if (found)
+                                    {
+                                        pos = mpos.first;
+                                        hist[pos]++;
+                                        break;
+                                    }
                                 }
                             }
-                        }
 
-                        if (found == false && fill_list)
-                        {
-                            subgraph_list.push_back(sub);
-                            sub_list[sig].emplace_back(subgraph_list.size() - 1,
-                                                       sub);
-                            hist.push_back(1);
-                            pos = hist.size() - 1;
-                            found = true;
-                        }
+                            if (found == false && fill_list)
+                            {
+                                subgraph_list.push_back(sub);
+                                sub_list[sig].emplace_back(subgraph_list.size() - 1,
+                                                           sub);
+                                hist.push_back(1);
+                                pos = hist.size() - 1;
+                                found = true;
+                            }
 
-                        if (found && collect_vmaps)
-                        {
-                            if (pos >= vmaps.size())
-                                vmaps.resize(pos + 1);
-                            vmaps[pos].push_back(VMap(get(boost::vertex_index,sub)));
-                            for (size_t vi = 0; vi < num_vertices(sub); ++vi)
-                                vmaps[pos].back()[vertex(vi, sub)] = subgraphs[j][vi];
+                            if (found && collect_vmaps)
+                            {
+                                if (pos >= vmaps.size())
+                                    vmaps.resize(pos + 1);
+                                vmaps[pos].push_back(VMap(get(boost::vertex_index,sub)));
+                                for (size_t vi = 0; vi < num_vertices(sub); ++vi)
+                                    vmaps[pos].back()[vertex(vi, sub)] = subgraphs[j][vi];
+                            }
                         }
                     }
                 }
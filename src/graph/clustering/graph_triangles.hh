@@ -0,0 +1,356 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_TRIANGLES_HH
+#define GRAPH_TRIANGLES_HH
+
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <cstdint>
+
+#include "graph_util.hh"
+
+namespace graph_tool
+{
+using namespace std;
+using namespace boost;
+
+// Number of parallel edges between two adjacent vertices u and v, in the
+// direction u -> v (out) and v -> u (in). For undirected graphs both are the
+// same.
+struct tri_arc
+{
+    uint32_t out;
+    uint32_t in;
+};
+
+// Calls f(i, j) for every pair of positions with a[i] == b[j], where a and b
+// are sorted without repetitions. If the lengths are very different, each
+// element of the shorter list is searched in the longer one with galloping,
+// otherwise the lists are merged in blocks of W elements, which are compared
+// all against all in a branch-free loop that the compiler vectorizes. A
+// block is skipped entirely if its last element is smaller than that of the
+// other block.
+template <class Index, class F>
+void tri_intersect(const Index* a, size_t na, const Index* b, size_t nb,
+                   F&& f)
+{
+    if (na == 0 || nb == 0)
+        return;
+
+    if (na * 32 < nb || nb * 32 < na)
+    {
+        bool swapped = na > nb;
+        if (swapped)
+        {
+            std::swap(a, b);
+            std::swap(na, nb);
+        }
+        size_t j = 0;
+        for (size_t i = 0; i < na && j < nb; ++i)
+        {
+            Index x = a[i];
+            size_t step = 1, hi = j;
+            while (hi < nb && b[hi] < x)
+            {
+                j = hi + 1;
+                hi += step;
+                step *= 2;
+            }
+            j = std::lower_bound(b + j, b + std::min(hi + 1, nb), x) - b;
+            if (j < nb && b[j] == x)
+            {
+                if (swapped)
+                    f(j, i);
+                else
+                    f(i, j);
+                ++j;
+            }
+        }
+        return;
+    }
+
+    constexpr size_t W = 32 / sizeof(Index);
+    size_t i = 0, j = 0;
+    while (i + W <= na && j + W <= nb)
+    {
+        uint64_t mask = 0;
+        for (size_t k = 0; k < W; ++k)
+            for (size_t l = 0; l < W; ++l)
+                mask |= uint64_t(a[i + k] == b[j + l]) << (k * W + l);
+        while (mask != 0)
+        {
+            size_t pos = __builtin_ctzll(mask);
+            f(i + pos / W, j + pos % W);
+            mask &= mask - 1;
+        }
+        Index la = a[i + W - 1], lb = b[j + W - 1];
+        if (la <= lb)
+            i += W;
+        if (lb <= la)
+            j += W;
+    }
+
+    while (i < na && j < nb)
+    {
+        if (a[i] < b[j])
+        {
+            ++i;
+        }
+        else if (b[j] < a[i])
+        {
+            ++j;
+        }
+        else
+        {
+            f(i, j);
+            ++i;
+            ++j;
+        }
+    }
+}
+
+// Adjacency of the graph without self-loops and parallel edges, where the
+// vertices are relabeled by increasing degree (ties broken by index), and
+// only the neighbors with larger label are stored, in sorted arrays. Every
+// triangle is then found exactly once, at its vertex with smallest label, as
+// the intersection of two of these lists, which are short even for the hubs,
+// so that the whole listing takes time O(E^{3/2}). Each entry also keeps the
+// number of parallel edges in both directions, so that the counts of the
+// original (multi)graph can be recovered.
+template <class Index>
+class triangle_csr
+{
+public:
+    template <class Graph>
+    void build(const Graph& g)
+    {
+        size_t N = num_vertices(g);
+
+        // relabel by degree with a counting sort
+        vector<size_t> deg(N, 0);
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 deg[v] = out_degree(v, g) + in_degreeS()(v, g);
+             });
+        size_t max_deg = 0;
+        for (auto k : deg)
+            max_deg = std::max(max_deg, k);
+        vector<size_t> count(max_deg + 2, 0);
+        for (auto k : deg)
+            count[k + 1]++;
+        for (size_t k = 0; k <= max_deg; ++k)
+            count[k + 1] += count[k];
+        _vertex.resize(N);
+        _rank.resize(N);
+        for (size_t v = 0; v < N; ++v)
+        {
+            size_t r = count[deg[v]]++;
+            _vertex[r] = v;
+            _rank[v] = r;
+        }
+
+        // neighbors with larger label, with repetitions
+        _pos.assign(N + 1, 0);
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 size_t r = _rank[v], k = 0;
+                 for (auto u : out_neighbors_range(v, g))
+                     if (_rank[u] > r)
+                         ++k;
+                 for (const auto& e : in_edges_range(v, g))
+                     if (_rank[source(e, g)] > r)
+                         ++k;
+                 _pos[r + 1] = k;
+             });
+        for (size_t r = 0; r < N; ++r)
+            _pos[r + 1] += _pos[r];
+
+        bool directed = graph_tool::is_directed(g);
+        vector<pair<Index, tri_arc>> entries(_pos[N]);
+        vector<size_t> len(N, 0);
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 size_t r = _rank[v];
+                 auto pos = entries.begin() + _pos[r];
+                 auto end = pos;
+                 for (auto u : out_neighbors_range(v, g))
+                 {
+                     if (_rank[u] > r)
+                         *(end++) = {Index(_rank[u]),
+                                     {1, uint32_t(directed ? 0 : 1)}};
+                 }
+                 for (const auto& e : in_edges_range(v, g))
+                 {
+                     size_t u = source(e, g);
+                     if (_rank[u] > r)
+                         *(end++) = {Index(_rank[u]), {0, 1}};
+                 }
+                 std::sort(pos, end,
+                           [](auto& x, auto& y) { return x.first < y.first; });
+
+                 // merge parallel edges
+                 auto last = pos;
+                 for (auto iter = pos; iter != end; ++iter)
+                 {
+                     if (iter != pos && iter->first == (last - 1)->first)
+                     {
+                         (last - 1)->second.out += iter->second.out;
+                         (last - 1)->second.in += iter->second.in;
+                         continue;
+                     }
+                     *(last++) = *iter;
+                 }
+                 len[r] = last - pos;
+             });
+
+        vector<size_t> pos(N + 1, 0);
+        for (size_t r = 0; r < N; ++r)
+            pos[r + 1] = pos[r] + len[r];
+        _nbr.resize(pos[N]);
+        _arc.resize(pos[N]);
+        #pragma omp parallel for schedule(runtime) if (N > OPENMP_MIN_THRESH)
+        for (size_t r = 0; r < N; ++r)
+        {
+            for (size_t i = 0; i < len[r]; ++i)
+            {
+                auto& x = entries[_pos[r] + i];
+                _nbr[pos[r] + i] = x.first;
+                _arc[pos[r] + i] = x.second;
+            }
+        }
+        _pos.swap(pos);
+    }
+
+    // Calls f(u, v, w, uv, uw, vw) for every triangle (u, v, w), where uv, uw
+    // and vw are the tri_arc values of the corresponding pairs, oriented as
+    // given. This is done in parallel, so f must be thread-safe.
+    template <class F>
+    void for_each_triangle(F&& f) const
+    {
+        size_t N = _vertex.size();
+        #pragma omp parallel for schedule(runtime) if (N > OPENMP_MIN_THRESH)
+        for (size_t r = 0; r < N; ++r)
+        {
+            size_t u = _vertex[r];
+            // the last neighbor cannot close any triangle
+            for (size_t i = _pos[r]; i + 1 < _pos[r + 1]; ++i)
+            {
+                size_t s = _nbr[i];
+                size_t v = _vertex[s];
+                const auto& uv = _arc[i];
+
+                // only the neighbors of u ranked above v can close a triangle
+                size_t a = i + 1, b = _pos[s];
+                tri_intersect(_nbr.data() + a, _pos[r + 1] - a,
+                              _nbr.data() + b, _pos[s + 1] - b,
+                              [&](size_t j, size_t k)
+                              {
+                                  f(u, v, _vertex[_nbr[a + j]], uv,
+                                    _arc[a + j], _arc[b + k]);
+                              });
+            }
+        }
+    }
+
+private:
+    vector<size_t> _vertex, _rank, _pos;
+    vector<Index> _nbr;
+    vector<tri_arc> _arc;
+};
+
+// Runs f(csr) with the triangle adjacency of g, using 32-bit labels whenever
+// possible.
+template <class Graph, class F>
+void with_triangle_csr(const Graph& g, F&& f)
+{
+    if (num_vertices(g) <= numeric_limits<uint32_t>::max())
+    {
+        triangle_csr<uint32_t> csr;
+        csr.build(g);
+        f(csr);
+    }
+    else
+    {
+        triangle_csr<uint64_t> csr;
+        csr.build(g);
+        f(csr);
+    }
+}
+
+// Number of triangles to which each vertex belongs, with the same convention
+// as get_triangles(): For every vertex v, the number of paths v -> u -> w,
+// with w also an out-neighbor of v, counting the parallel edges of the first
+// two hops. For undirected graphs this is halved, so that for simple graphs
+// each triangle is counted once.
+template <class Graph>
+void get_all_triangles(const Graph& g, vector<size_t>& tri)
+{
+    tri.assign(num_vertices(g), 0);
+    with_triangle_csr
+        (g,
+         [&](auto& csr)
+         {
+             csr.for_each_triangle
+                 ([&](size_t u, size_t v, size_t w, const tri_arc& uv,
+                      const tri_arc& uw, const tri_arc& vw)
+                  {
+                      size_t tu = size_t(uv.out) * vw.out * (uw.out > 0) +
+                          size_t(uw.out) * vw.in * (uv.out > 0);
+                      size_t tv = size_t(uv.in) * uw.out * (vw.out > 0) +
+                          size_t(vw.out) * uw.in * (uv.in > 0);
+                      size_t tw = size_t(uw.in) * uv.out * (vw.in > 0) +
+                          size_t(vw.in) * uv.in * (uw.in > 0);
+                      if (tu > 0)
+                      {
+                          #pragma omp atomic
+                          tri[u] += tu;
+                      }
+                      if (tv > 0)
+                      {
+                          #pragma omp atomic
+                          tri[v] += tv;
+                      }
+                      if (tw > 0)
+                      {
+                          #pragma omp atomic
+                          tri[w] += tw;
+                      }
+                  });
+         });
+
+    if (!graph_tool::is_directed(g))
+    {
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 tri[v] /= 2;
+             });
+    }
+}
+
+} // graph_tool namespace
+
+#endif // GRAPH_TRIANGLES_HH
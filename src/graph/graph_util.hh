@@ -38,6 +38,11 @@ namespace boost { namespace python { namespace detail {
 #include <boost/algorithm/string/trim.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/type_traits/is_convertible.hpp>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #include <string>
 
 #include <boost/functional/hash.hpp>
@@ -183,6 +188,23 @@ void graph_copy(const GraphOrig& g, GraphTarget& gt)
 // Parallel loops
 // ==============
 
+// Number of threads that will be used in the next parallel region.
+inline size_t get_openmp_threads()
+{
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+// Whether the parallel variant of an algorithm should be used for a problem
+// of size n, instead of a sequential one that is faster on a single thread.
+inline bool use_parallel(size_t n)
+{
+    return get_openmp_threads() > 1 && n > OPENMP_MIN_THRESH;
+}
+
 template <class Graph, class F, size_t thres = OPENMP_MIN_THRESH>
 void parallel_vertex_loop_no_spawn(const Graph& g, F&& f)
 {
@@ -31,10 +31,10 @@ struct get_adjacency
     template <class Graph, class Index, class Weight>
     void operator()(Graph& g, Index index, Weight weight,
                     multi_array_ref<double,1>& data,
-                    multi_array_ref<int,1>& i,
-                    multi_array_ref<int,1>& j) const
+                    multi_array_ref<int64_t,1>& i,
+                    multi_array_ref<int64_t,1>& j) const
     {
-        int pos = 0;
+        size_t pos = 0;
         for (const auto& e : edges_range(g))
         {
             data[pos] = get(weight, e);
@@ -53,6 +53,42 @@ struct get_adjacency
     }
 };
 
+// Matrix-free products ret += A x (or A^T x), where x and ret hold a block of
+// k column vectors, computed in parallel over the rows.
+
+template <class Graph, class Index, class Weight, class Mat>
+void adj_matmat(Graph& g, Index index, Weight w, Mat& x, Mat& ret,
+                bool transpose)
+{
+    size_t k = x.shape()[1];
+    parallel_vertex_loop
+        (g,
+         [&](auto v)
+         {
+             auto y = ret[get(index, v)];
+             auto add = [&](auto u, auto we)
+                 {
+                     auto xu = x[get(index, u)];
+                     for (size_t l = 0; l < k; ++l)
+                         y[l] += we * xu[l];
+                 };
+             if (!transpose || !graph_tool::is_directed(g))
+             {
+                 for (const auto& e : in_or_out_edges_range(v, g))
+                 {
+                     auto u = graph_tool::is_directed(g) ?
+                         source(e, g) : target(e, g);
+                     add(u, get(w, e));
+                 }
+             }
+             else
+             {
+                 for (const auto& e : out_edges_range(v, g))
+                     add(target(e, g), get(w, e));
+             }
+         });
+}
+
 } // namespace graph_tool
 
 #endif // GRAPH_ADJACENCY_MATRIX_HH
@@ -40,8 +40,8 @@ void incidence(GraphInterface& g, boost::any vindex, boost::any eindex,
         throw ValueException("index edge property must have a scalar value type");
 
     multi_array_ref<double,1> data = get_array<double,1>(odata);
-    multi_array_ref<int32_t,1> i = get_array<int32_t,1>(oi);
-    multi_array_ref<int32_t,1> j = get_array<int32_t,1>(oj);
+    multi_array_ref<int64_t,1> i = get_array<int64_t,1>(oi);
+    multi_array_ref<int64_t,1> j = get_array<int64_t,1>(oj);
     run_action<>()
         (g, std::bind(get_incidence(),
                       std::placeholders::_1,  std::placeholders::_2,  std::placeholders::_3,
@@ -50,3 +50,22 @@ void incidence(GraphInterface& g, boost::any vindex, boost::any eindex,
          edge_scalar_properties())(vindex, eindex);
 
 }
+
+void incidence_matmat(GraphInterface& g, boost::any vindex, boost::any eindex,
+                      python::object ox, python::object oret, bool transpose)
+{
+    if (!belongs<vertex_scalar_properties>()(vindex))
+        throw ValueException("index vertex property must have a scalar value type");
+    if (!belongs<edge_scalar_properties>()(eindex))
+        throw ValueException("index edge property must have a scalar value type");
+
+    multi_array_ref<double,2> x = get_array<double,2>(ox);
+    multi_array_ref<double,2> ret = get_array<double,2>(oret);
+    run_action<>()
+        (g, [&](auto& graph, auto vi, auto ei)
+            {
+                inc_matmat(graph, vi, ei, x, ret, transpose);
+            },
+         vertex_scalar_properties(),
+         edge_scalar_properties())(vindex, eindex);
+}
@@ -31,10 +31,10 @@ struct get_incidence
     template <class Graph, class VIndex, class EIndex>
     void operator()(Graph& g, VIndex vindex, EIndex eindex,
                     multi_array_ref<double,1>& data,
-                    multi_array_ref<int32_t,1>& i,
-                    multi_array_ref<int32_t,1>& j) const
+                    multi_array_ref<int64_t,1>& i,
+                    multi_array_ref<int64_t,1>& j) const
     {
-        int pos = 0;
+        size_t pos = 0;
         for (auto v : vertices_range(g))
         {
             for (const auto& e : out_edges_range(v, g))
@@ -59,6 +59,68 @@ struct get_incidence
     }
 };
 
+// Matrix-free products ret += B x, where B is the V x E incidence matrix, and
+// ret += B^T x. In the first case the rows are the vertices, and in the
+// second the edges, which are processed in parallel.
+
+template <class Graph, class VIndex, class EIndex, class Mat>
+void inc_matmat(Graph& g, VIndex vindex, EIndex eindex, Mat& x, Mat& ret,
+                bool transpose)
+{
+    size_t k = x.shape()[1];
+    if (!transpose)
+    {
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 auto y = ret[get(vindex, v)];
+                 for (const auto& e : out_edges_range(v, g))
+                 {
+                     auto xe = x[get(eindex, e)];
+                     if (graph_tool::is_directed(g))
+                     {
+                         for (size_t l = 0; l < k; ++l)
+                             y[l] -= xe[l];
+                     }
+                     else
+                     {
+                         for (size_t l = 0; l < k; ++l)
+                             y[l] += xe[l];
+                     }
+                 }
+
+                 for (const auto& e : in_edges_range(v, g))
+                 {
+                     auto xe = x[get(eindex, e)];
+                     for (size_t l = 0; l < k; ++l)
+                         y[l] += xe[l];
+                 }
+             });
+    }
+    else
+    {
+        parallel_edge_loop
+            (g,
+             [&](const auto& e)
+             {
+                 auto y = ret[get(eindex, e)];
+                 auto xs = x[get(vindex, source(e, g))];
+                 auto xt = x[get(vindex, target(e, g))];
+                 if (graph_tool::is_directed(g))
+                 {
+                     for (size_t l = 0; l < k; ++l)
+                         y[l] += xt[l] - xs[l];
+                 }
+                 else
+                 {
+                     for (size_t l = 0; l < k; ++l)
+                         y[l] += xt[l] + xs[l];
+                 }
+             });
+    }
+}
+
 } // namespace graph_tool
 
 #endif // GRAPH_INCIDENCE_HH
@@ -57,8 +57,8 @@ void laplacian(GraphInterface& g, boost::any index, boost::any weight,
         deg = TOTAL_DEG;
 
     multi_array_ref<double,1> data = get_array<double,1>(odata);
-    multi_array_ref<int32_t,1> i = get_array<int32_t,1>(oi);
-    multi_array_ref<int32_t,1> j = get_array<int32_t,1>(oj);
+    multi_array_ref<int64_t,1> i = get_array<int64_t,1>(oi);
+    multi_array_ref<int64_t,1> j = get_array<int64_t,1>(oj);
     run_action<>()
         (g, std::bind(get_laplacian(),
                       std::placeholders::_1,  std::placeholders::_2,  std::placeholders::_3,
@@ -67,3 +67,64 @@ void laplacian(GraphInterface& g, boost::any index, boost::any weight,
          weight_props_t())(index, weight);
 
 }
+
+void laplacian_degrees(GraphInterface& g, boost::any index, boost::any weight,
+                       string sdeg, python::object od)
+{
+    if (!belongs<vertex_scalar_properties>()(index))
+        throw ValueException("index vertex property must have a scalar value type");
+
+    typedef UnityPropertyMap<double, GraphInterface::edge_t> weight_map_t;
+    typedef mpl::push_back<edge_scalar_properties, weight_map_t>::type
+        weight_props_t;
+
+    if (!weight.empty() && !belongs<edge_scalar_properties>()(weight))
+        throw ValueException("weight edge property must have a scalar value type");
+
+    if(weight.empty())
+        weight = weight_map_t();
+
+    deg_t deg = TOTAL_DEG;
+    if (sdeg == "in")
+        deg = IN_DEG;
+    if (sdeg == "out")
+        deg = OUT_DEG;
+
+    multi_array_ref<double,1> d = get_array<double,1>(od);
+    run_action<>()
+        (g, [&](auto& graph, auto vi, auto w)
+            {
+                get_degrees(graph, vi, w, deg, d);
+            },
+         vertex_scalar_properties(),
+         weight_props_t())(index, weight);
+}
+
+void laplacian_matmat(GraphInterface& g, boost::any index, boost::any weight,
+                      python::object od, python::object ox,
+                      python::object oret, bool transpose)
+{
+    if (!belongs<vertex_scalar_properties>()(index))
+        throw ValueException("index vertex property must have a scalar value type");
+
+    typedef UnityPropertyMap<double, GraphInterface::edge_t> weight_map_t;
+    typedef mpl::push_back<edge_scalar_properties, weight_map_t>::type
+        weight_props_t;
+
+    if (!weight.empty() && !belongs<edge_scalar_properties>()(weight))
+        throw ValueException("weight edge property must have a scalar value type");
+
+    if(weight.empty())
+        weight = weight_map_t();
+
+    multi_array_ref<double,1> d = get_array<double,1>(od);
+    multi_array_ref<double,2> x = get_array<double,2>(ox);
+    multi_array_ref<double,2> ret = get_array<double,2>(oret);
+    run_action<>()
+        (g, [&](auto& graph, auto vi, auto w)
+            {
+                lap_matmat(graph, vi, w, d, x, ret, transpose);
+            },
+         vertex_scalar_properties(),
+         weight_props_t())(index, weight);
+}
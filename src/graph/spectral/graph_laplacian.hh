@@ -74,10 +74,10 @@ struct get_laplacian
     template <class Graph, class Index, class Weight>
     void operator()(const Graph& g, Index index, Weight weight, deg_t deg,
                     multi_array_ref<double,1>& data,
-                    multi_array_ref<int32_t,1>& i,
-                    multi_array_ref<int32_t,1>& j) const
+                    multi_array_ref<int64_t,1>& i,
+                    multi_array_ref<int64_t,1>& j) const
     {
-        int pos = 0;
+        size_t pos = 0;
         for (const auto& e : edges_range(g))
         {
             if (source(e, g) == target(e, g))
@@ -126,10 +126,10 @@ struct get_norm_laplacian
     template <class Graph, class Index, class Weight>
     void operator()(const Graph& g, Index index, Weight weight, deg_t deg,
                     multi_array_ref<double,1>& data,
-                    multi_array_ref<int32_t,1>& i,
-                    multi_array_ref<int32_t,1>& j) const
+                    multi_array_ref<int64_t,1>& i,
+                    multi_array_ref<int64_t,1>& j) const
     {
-        int pos = 0;
+        size_t pos = 0;
         for (auto v : vertices_range(g))
         {
             double ks = 0;
@@ -181,6 +181,126 @@ struct get_norm_laplacian
 };
 
 
+template <class Graph, class Weight>
+double get_degree(Graph& g, typename graph_traits<Graph>::vertex_descriptor v,
+                  Weight weight, deg_t deg)
+{
+    switch (deg)
+    {
+    case OUT_DEG:
+        return sum_degree(g, v, weight, out_edge_iteratorS<Graph>());
+    case IN_DEG:
+        return sum_degree(g, v, weight, in_edge_iteratorS<Graph>());
+    case TOTAL_DEG:
+        return sum_degree(g, v, weight, all_edges_iteratorS<Graph>());
+    }
+    return 0;
+}
+
+template <class Graph, class Index, class Weight>
+void get_degrees(Graph& g, Index index, Weight weight, deg_t deg,
+                 multi_array_ref<double,1>& d)
+{
+    parallel_vertex_loop
+        (g,
+         [&](auto v)
+         {
+             d[get(index, v)] = get_degree(g, v, weight, deg);
+         });
+}
+
+// Matrix-free products ret += L x (or L^T x), where x and ret hold a block of
+// k column vectors, computed in parallel over the rows. The degrees d are
+// computed beforehand with get_degrees().
+
+template <class Graph, class Index, class Weight, class Mat>
+void lap_matmat(Graph& g, Index index, Weight w,
+                multi_array_ref<double,1>& d, Mat& x, Mat& ret,
+                bool transpose)
+{
+    size_t k = x.shape()[1];
+    parallel_vertex_loop
+        (g,
+         [&](auto v)
+         {
+             auto i = get(index, v);
+             auto y = ret[i];
+             auto xv = x[i];
+             auto add = [&](auto u, double we)
+                 {
+                     if (u == v)
+                         return;
+                     auto xu = x[get(index, u)];
+                     for (size_t l = 0; l < k; ++l)
+                         y[l] -= we * xu[l];
+                 };
+             for (size_t l = 0; l < k; ++l)
+                 y[l] += d[i] * xv[l];
+             if (!transpose || !graph_tool::is_directed(g))
+             {
+                 for (const auto& e : in_or_out_edges_range(v, g))
+                 {
+                     auto u = graph_tool::is_directed(g) ?
+                         source(e, g) : target(e, g);
+                     add(u, get(w, e));
+                 }
+             }
+             else
+             {
+                 for (const auto& e : out_edges_range(v, g))
+                     add(target(e, g), get(w, e));
+             }
+         });
+}
+
+template <class Graph, class Index, class Weight, class Mat>
+void nlap_matmat(Graph& g, Index index, Weight w,
+                 multi_array_ref<double,1>& d, Mat& x, Mat& ret,
+                 bool transpose)
+{
+    size_t k = x.shape()[1];
+    parallel_vertex_loop
+        (g,
+         [&](auto v)
+         {
+             auto i = get(index, v);
+             auto y = ret[i];
+             auto xv = x[i];
+             auto add = [&](auto u, double we)
+                 {
+                     if (u == v)
+                         return;
+                     auto j = get(index, u);
+                     double kk = d[i] * d[j];
+                     if (kk <= 0)
+                         return;
+                     we /= sqrt(kk);
+                     auto xu = x[j];
+                     for (size_t l = 0; l < k; ++l)
+                         y[l] -= we * xu[l];
+                 };
+             if (d[i] > 0)
+             {
+                 for (size_t l = 0; l < k; ++l)
+                     y[l] += xv[l];
+             }
+             if (!transpose || !graph_tool::is_directed(g))
+             {
+                 for (const auto& e : in_or_out_edges_range(v, g))
+                 {
+                     auto u = graph_tool::is_directed(g) ?
+                         source(e, g) : target(e, g);
+                     add(u, get(w, e));
+                 }
+             }
+             else
+             {
+                 for (const auto& e : out_edges_range(v, g))
+                     add(target(e, g), get(w, e));
+             }
+         });
+}
+
 } // namespace graph_tool
 
 #endif // GRAPH_LAPLACIAN_HH
@@ -46,6 +46,28 @@ void transition(GraphInterface& g, boost::any index, boost::any weight,
                 python::object odata, python::object oi,
                 python::object oj);
 
+void adjacency_matmat(GraphInterface& g, boost::any index, boost::any weight,
+                      python::object ox, python::object oret, bool transpose);
+
+void laplacian_degrees(GraphInterface& g, boost::any index, boost::any weight,
+                       string sdeg, python::object od);
+
+void laplacian_matmat(GraphInterface& g, boost::any index, boost::any weight,
+                      python::object od, python::object ox,
+                      python::object oret, bool transpose);
+
+void norm_laplacian_matmat(GraphInterface& g, boost::any index,
+                           boost::any weight, python::object od,
+                           python::object ox, python::object oret,
+                           bool transpose);
+
+void incidence_matmat(GraphInterface& g, boost::any vindex, boost::any eindex,
+                      python::object ox, python::object oret, bool transpose);
+
+void transition_matmat(GraphInterface& g, boost::any index, boost::any weight,
+                       python::object od, python::object ox,
+                       python::object oret, bool transpose);
+
 BOOST_PYTHON_MODULE(libgraph_tool_spectral)
 {
     using namespace boost::python;
@@ -54,4 +76,10 @@ BOOST_PYTHON_MODULE(libgraph_tool_spectral)
     def("norm_laplacian", &norm_laplacian);
     def("incidence", &incidence);
     def("transition", &transition);
+    def("adjacency_matmat", &adjacency_matmat);
+    def("laplacian_degrees", &laplacian_degrees);
+    def("laplacian_matmat", &laplacian_matmat);
+    def("norm_laplacian_matmat", &norm_laplacian_matmat);
+    def("incidence_matmat", &incidence_matmat);
+    def("transition_matmat", &transition_matmat);
 }
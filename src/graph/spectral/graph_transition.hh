@@ -51,10 +51,10 @@ struct get_transition
     template <class Graph, class Index, class Weight>
     void operator()(const Graph& g, Index index, Weight weight,
                     multi_array_ref<double,1>& data,
-                    multi_array_ref<int32_t,1>& i,
-                    multi_array_ref<int32_t,1>& j) const
+                    multi_array_ref<int64_t,1>& i,
+                    multi_array_ref<int64_t,1>& j) const
     {
-        int pos = 0;
+        size_t pos = 0;
         for (auto v: vertices_range(g))
         {
             auto k = sum_degree(g, v, weight);
@@ -69,6 +69,48 @@ struct get_transition
     }
 };
 
+// Matrix-free products ret += T x (or T^T x), where x and ret hold a block of
+// k column vectors, computed in parallel over the rows. The (weighted)
+// out-degrees are given by d.
+
+template <class Graph, class Index, class Weight, class Mat>
+void trans_matmat(Graph& g, Index index, Weight w,
+                  multi_array_ref<double,1>& d, Mat& x, Mat& ret,
+                  bool transpose)
+{
+    size_t k = x.shape()[1];
+    parallel_vertex_loop
+        (g,
+         [&](auto v)
+         {
+             auto i = get(index, v);
+             auto y = ret[i];
+             if (!transpose)
+             {
+                 for (const auto& e : in_or_out_edges_range(v, g))
+                 {
+                     auto u = graph_tool::is_directed(g) ?
+                         source(e, g) : target(e, g);
+                     auto j = get(index, u);
+                     double we = double(get(w, e)) / d[j];
+                     auto xu = x[j];
+                     for (size_t l = 0; l < k; ++l)
+                         y[l] += we * xu[l];
+                 }
+             }
+             else
+             {
+                 for (const auto& e : out_edges_range(v, g))
+                 {
+                     double we = double(get(w, e)) / d[i];
+                     auto xu = x[get(index, target(e, g))];
+                     for (size_t l = 0; l < k; ++l)
+                         y[l] += we * xu[l];
+                 }
+             }
+         });
+}
+
 } // namespace graph_tool
 
 #endif // GRAPH_TRANSITION_HH
@@ -22,6 +22,12 @@
 #include <boost/graph/strong_components.hpp>
 #include <boost/graph/biconnected_components.hpp>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "graph_union_find.hh"
+
 namespace graph_tool
 {
 template <class PropertyMap>
@@ -96,6 +102,520 @@ void put(HistogramPropertyMap<PropertyMap> pmap,
 }
 
 
+// Connected components of an undirected graph, computed in parallel with the
+// Afforest algorithm [sutton-optimizing-2018]: First, only a couple of edges
+// of each vertex are joined in a concurrent union-find structure, which is
+// usually enough to reveal most of the largest component. This component is
+// then identified from a sample of the vertices, and the remaining edges are
+// processed only for the vertices outside of it, which skips most of the
+// edges of the graph. The components are labeled from 0, in the order of their
+// vertex with smallest index, which is the same labeling as a sequential
+// traversal of the vertices.
+template <class Graph, class CompMap>
+void parallel_connected_components(Graph& g, CompMap comp_map,
+                                   vector<size_t>& hist)
+{
+    constexpr size_t neighbor_rounds = 2;
+    constexpr size_t num_samples = 1024;
+
+    size_t N = num_vertices(g);
+    concurrent_union_find uf(N);
+
+    for (size_t r = 0; r < neighbor_rounds; ++r)
+    {
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 size_t i = 0;
+                 for (auto u : out_neighbors_range(v, g))
+                 {
+                     if (i++ < r)
+                         continue;
+                     uf.unite(v, u);
+                     break;
+                 }
+             });
+        uf.compress();
+    }
+
+    // most frequent set in a sample of the vertices (filtered out vertices
+    // are singletons, and will not be chosen unless most of the graph is
+    // filtered)
+    size_t c = numeric_limits<size_t>::max();
+    if (N > 0)
+    {
+        vector<size_t> sample;
+        size_t n = std::min(num_samples, N);
+        for (size_t i = 0; i < n; ++i)
+            sample.push_back(uf.find((i * N) / n));
+        std::sort(sample.begin(), sample.end());
+        size_t best = 0;
+        for (size_t i = 0; i < sample.size();)
+        {
+            size_t j = i;
+            while (j < sample.size() && sample[j] == sample[i])
+                ++j;
+            if (j - i > best)
+            {
+                best = j - i;
+                c = sample[i];
+            }
+            i = j;
+        }
+    }
+
+    parallel_vertex_loop
+        (g,
+         [&](auto v)
+         {
+             if (uf.find(v) == c)
+                 return;
+             size_t i = 0;
+             for (auto u : out_neighbors_range(v, g))
+             {
+                 if (i++ < neighbor_rounds)
+                     continue;
+                 uf.unite(v, u);
+             }
+         });
+    uf.compress();
+
+    // the roots are the smallest vertices of each component
+    vector<size_t> label(N);
+    hist.clear();
+    for (auto v : vertices_range(g))
+    {
+        if (uf.is_root(v))
+        {
+            label[v] = hist.size();
+            hist.push_back(0);
+        }
+        hist[label[uf.find(v)]]++;
+    }
+    parallel_vertex_loop
+        (g,
+         [&](auto v)
+         {
+             put(comp_map, v, label[uf.find(v)]);
+         });
+}
+
+// Level-synchronous parallel BFS from s, along the out-edges (or the in-edges,
+// if backward == true), restricted to the vertices w for which pred(w) is
+// true. All visited vertices get mark[w] = 1.
+template <class Graph, class Pred>
+void scc_bfs(Graph& g, size_t s, bool backward, vector<uint8_t>& mark,
+             Pred&& pred)
+{
+    vector<size_t> frontier = {s}, next;
+    mark[s] = 1;
+    while (!frontier.empty())
+    {
+        next.clear();
+        #pragma omp parallel if (frontier.size() > OPENMP_MIN_THRESH)
+        {
+            vector<size_t> local;
+            auto visit = [&](size_t w)
+                {
+                    if (!pred(w))
+                        return;
+                    uint8_t old;
+                    #pragma omp atomic capture
+                    {
+                        old = mark[w];
+                        mark[w] = 1;
+                    }
+                    if (old == 0)
+                        local.push_back(w);
+                };
+
+            #pragma omp for schedule(runtime) nowait
+            for (size_t i = 0; i < frontier.size(); ++i)
+            {
+                size_t v = frontier[i];
+                if (backward)
+                {
+                    for (const auto& e : in_edges_range(v, g))
+                        visit(source(e, g));
+                }
+                else
+                {
+                    for (auto w : out_neighbors_range(v, g))
+                        visit(w);
+                }
+            }
+
+            #pragma omp critical (scc_bfs)
+            next.insert(next.end(), local.begin(), local.end());
+        }
+        frontier.swap(next);
+    }
+}
+
+// Strongly connected components of a directed graph, computed in parallel
+// with the Multistep method [slota-bfs-2014]:
+//
+//  1. Vertices without incoming or outgoing edges (ignoring self-loops) are
+//     singleton components, and are removed ("trimmed"), which is repeated
+//     until no such vertices remain.
+//
+//  2. The component containing the vertex with the largest product of in- and
+//     out-degrees, which is very likely the giant component, is found as the
+//     intersection of its forward and backward reachability sets, both
+//     obtained with parallel BFS.
+//
+//  3. The remaining vertices are colored by propagating the largest vertex
+//     index along the edges, so that every vertex gets the largest index
+//     among those that reach it. The vertices whose color is their own index
+//     are roots, and their components are the vertices of the same color
+//     reached backwards from them, which are found in parallel for all roots.
+//     This step and the trimming are repeated until all vertices are assigned.
+//
+// When few vertices remain, or the coloring stops making progress, the rest is
+// done with a non-recursive version of Tarjan's algorithm.
+//
+// The components are labeled from 0, in the order of their vertex with
+// smallest index.
+template <class Graph, class CompMap>
+void parallel_strong_components(Graph& g, CompMap comp_map,
+                                vector<size_t>& hist)
+{
+    constexpr size_t unassigned = numeric_limits<size_t>::max();
+    constexpr size_t max_color_rounds = 64;
+
+    size_t N = num_vertices(g);
+
+    // scc[v] is the representative vertex of the component of v
+    vector<size_t> scc(N, unassigned);
+    vector<uint8_t> active(N, 0);
+    parallel_vertex_loop
+        (g,
+         [&](auto v)
+         {
+             active[v] = 1;
+         });
+
+    vector<size_t> kin(N), kout(N);
+    auto trim = [&]()
+        {
+            vector<size_t> frontier;
+            #pragma omp parallel if (N > OPENMP_MIN_THRESH)
+            {
+                vector<size_t> local;
+                parallel_vertex_loop_no_spawn
+                    (g,
+                     [&](auto v)
+                     {
+                         if (!active[v])
+                             return;
+                         kin[v] = kout[v] = 0;
+                         for (auto w : out_neighbors_range(v, g))
+                         {
+                             if (w != v && active[w])
+                                 kout[v]++;
+                         }
+                         for (const auto& e : in_edges_range(v, g))
+                         {
+                             auto w = source(e, g);
+                             if (w != v && active[w])
+                                 kin[v]++;
+                         }
+                         if (kin[v] == 0 || kout[v] == 0)
+                             local.push_back(v);
+                     });
+                #pragma omp critical (scc_trim)
+                frontier.insert(frontier.end(), local.begin(), local.end());
+            }
+            for (auto v : frontier)
+                active[v] = 0;
+
+            vector<size_t> next;
+            while (!frontier.empty())
+            {
+                next.clear();
+                #pragma omp parallel if (frontier.size() > OPENMP_MIN_THRESH)
+                {
+                    vector<size_t> local;
+                    auto dec = [&](size_t w, vector<size_t>& k)
+                        {
+                            if (!active[w])
+                                return;
+                            size_t x;
+                            #pragma omp atomic capture
+                            x = --k[w];
+                            if (x > 0)
+                                return;
+                            uint8_t old;
+                            #pragma omp atomic capture
+                            {
+                                old = active[w];
+                                active[w] = 0;
+                            }
+                            if (old == 1)
+                                local.push_back(w);
+                        };
+
+                    #pragma omp for schedule(runtime) nowait
+                    for (size_t i = 0; i < frontier.size(); ++i)
+                    {
+                        size_t v = frontier[i];
+                        scc[v] = v;
+                        for (auto w : out_neighbors_range(v, g))
+                        {
+                            if (w != v)
+                                dec(w, kin);
+                        }
+                        for (const auto& e : in_edges_range(v, g))
+                        {
+                            size_t w = source(e, g);
+                            if (w != v)
+                                dec(w, kout);
+                        }
+                    }
+
+                    #pragma omp critical (scc_trim)
+                    next.insert(next.end(), local.begin(), local.end());
+                }
+                frontier.swap(next);
+            }
+        };
+
+    auto remaining = [&]()
+        {
+            size_t R = 0;
+            #pragma omp parallel for schedule(runtime) reduction(+:R) \
+                if (N > OPENMP_MIN_THRESH)
+            for (size_t v = 0; v < N; ++v)
+                R += active[v];
+            return R;
+        };
+
+    trim();
+
+    // forward-backward search from the likely giant component
+    {
+        size_t pivot = unassigned, kmax = 0;
+        for (auto v : vertices_range(g))
+        {
+            if (!active[v])
+                continue;
+            size_t k = (kin[v] + 1) * (kout[v] + 1);
+            if (pivot == unassigned || k > kmax)
+            {
+                pivot = v;
+                kmax = k;
+            }
+        }
+
+        if (pivot != unassigned)
+        {
+            vector<uint8_t> fw(N, 0), bw(N, 0);
+            scc_bfs(g, pivot, false, fw,
+                    [&](size_t w) { return active[w]; });
+            scc_bfs(g, pivot, true, bw,
+                    [&](size_t w) { return bool(active[w] && fw[w]); });
+            parallel_vertex_loop
+                (g,
+                 [&](auto v)
+                 {
+                     if (bw[v])
+                     {
+                         scc[v] = pivot;
+                         active[v] = 0;
+                     }
+                 });
+        }
+    }
+
+    vector<std::atomic<size_t>> color(N);
+    vector<uint8_t> queued(N, 0);
+    size_t round = 0;
+    while (true)
+    {
+        trim();
+        size_t R = remaining();
+        if (R <= OPENMP_MIN_THRESH || round++ == max_color_rounds)
+            break;
+
+        // propagate the largest index forward
+        vector<size_t> frontier, next;
+        for (auto v : vertices_range(g))
+        {
+            if (!active[v])
+                continue;
+            color[v].store(v, std::memory_order_relaxed);
+            frontier.push_back(v);
+        }
+        while (!frontier.empty())
+        {
+            next.clear();
+            #pragma omp parallel if (frontier.size() > OPENMP_MIN_THRESH)
+            {
+                vector<size_t> local;
+                #pragma omp for schedule(runtime) nowait
+                for (size_t i = 0; i < frontier.size(); ++i)
+                {
+                    size_t v = frontier[i];
+                    #pragma omp atomic write
+                    queued[v] = 0;
+                    size_t c = color[v].load(std::memory_order_relaxed);
+                    for (auto w : out_neighbors_range(v, g))
+                    {
+                        if (!active[w])
+                            continue;
+                        size_t cw = color[w].load(std::memory_order_relaxed);
+                        bool changed = false;
+                        while (cw < c)
+                        {
+                            if (color[w].compare_exchange_weak(cw, c))
+                            {
+                                changed = true;
+                                break;
+                            }
+                        }
+                        if (!changed)
+                            continue;
+                        uint8_t old;
+                        #pragma omp atomic capture
+                        {
+                            old = queued[w];
+                            queued[w] = 1;
+                        }
+                        if (old == 0)
+                            local.push_back(w);
+                    }
+                }
+
+                #pragma omp critical (scc_color)
+                next.insert(next.end(), local.begin(), local.end());
+            }
+            frontier.swap(next);
+        }
+
+        // backward search from the roots, within their colors
+        vector<size_t> roots;
+        for (auto v : vertices_range(g))
+        {
+            if (active[v] && color[v].load(std::memory_order_relaxed) == v)
+                roots.push_back(v);
+        }
+
+        #pragma omp parallel if (roots.size() > 1)
+        {
+            vector<size_t> queue;
+            #pragma omp for schedule(dynamic)
+            for (size_t i = 0; i < roots.size(); ++i)
+            {
+                size_t r = roots[i];
+                queue.clear();
+                queue.push_back(r);
+                scc[r] = r;
+                while (!queue.empty())
+                {
+                    size_t v = queue.back();
+                    queue.pop_back();
+                    for (const auto& e : in_edges_range(v, g))
+                    {
+                        size_t w = source(e, g);
+                        // the color is tested first, so that only the
+                        // entries of this root are touched
+                        if (!active[w] ||
+                            color[w].load(std::memory_order_relaxed) != r ||
+                            scc[w] == r)
+                            continue;
+                        scc[w] = r;
+                        queue.push_back(w);
+                    }
+                }
+            }
+        }
+
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 if (active[v] && scc[v] != unassigned)
+                     active[v] = 0;
+             });
+    }
+
+    // the remaining vertices with Tarjan's algorithm, without recursion
+    {
+        typedef typename graph_traits<Graph>::adjacency_iterator ait_t;
+        vector<size_t> index(N, unassigned), low(N), stack;
+        vector<std::tuple<size_t, ait_t, ait_t>> call;
+        size_t idx = 0;
+        auto visit = [&](size_t v)
+            {
+                index[v] = low[v] = idx++;
+                stack.push_back(v);
+                auto r = adjacent_vertices(v, g);
+                call.emplace_back(v, r.first, r.second);
+            };
+        for (auto s : vertices_range(g))
+        {
+            if (!active[s] || index[s] != unassigned)
+                continue;
+            visit(s);
+            while (!call.empty())
+            {
+                size_t v = get<0>(call.back());
+                auto& iter = get<1>(call.back());
+                if (iter != get<2>(call.back()))
+                {
+                    size_t w = *iter;
+                    ++iter;
+                    if (!active[w])
+                        continue;
+                    if (index[w] == unassigned)
+                        visit(w);
+                    else if (scc[w] == unassigned)
+                        low[v] = std::min(low[v], index[w]);
+                    continue;
+                }
+
+                call.pop_back();
+                if (!call.empty())
+                {
+                    size_t u = get<0>(call.back());
+                    low[u] = std::min(low[u], low[v]);
+                }
+                if (low[v] == index[v])
+                {
+                    size_t w;
+                    do
+                    {
+                        w = stack.back();
+                        stack.pop_back();
+                        scc[w] = v;
+                    }
+                    while (w != v);
+                }
+            }
+        }
+    }
+
+    vector<size_t> label(N, unassigned);
+    hist.clear();
+    for (auto v : vertices_range(g))
+    {
+        size_t r = scc[v];
+        if (label[r] == unassigned)
+        {
+            label[r] = hist.size();
+            hist.push_back(0);
+        }
+        hist[label[r]]++;
+    }
+    parallel_vertex_loop
+        (g,
+         [&](auto v)
+         {
+             put(comp_map, v, label[scc[v]]);
+         });
+}
+
 // this will label the components of a graph to a given vertex property, from
 // [0, number of components - 1], and keep an histogram. If the graph is
 // directed the strong components are used.
@@ -107,24 +627,39 @@ struct label_components
     {
         typedef typename graph_traits<Graph>::directed_category
             directed_category;
-        HistogramPropertyMap<CompMap> cm(comp_map, num_vertices(g), hist);
-        get_components(g, cm,
+        get_components(g, comp_map, hist,
                        typename std::is_convertible<directed_category,
                                                     directed_tag>::type());
     }
 
     template <class Graph, class CompMap>
-    void get_components(Graph& g, CompMap comp_map,
+    void get_components(Graph& g, CompMap comp_map, vector<size_t>& hist,
                         std::true_type) const
     {
-        boost::strong_components(g, comp_map);
+        if (use_parallel(num_vertices(g)))
+        {
+            parallel_strong_components(g, comp_map, hist);
+        }
+        else
+        {
+            HistogramPropertyMap<CompMap> cm(comp_map, num_vertices(g), hist);
+            boost::strong_components(g, cm);
+        }
     }
 
     template <class Graph, class CompMap>
-    void get_components(Graph& g, CompMap comp_map,
+    void get_components(Graph& g, CompMap comp_map, vector<size_t>& hist,
                         std::false_type) const
     {
-        boost::connected_components(g, comp_map);
+        if (use_parallel(num_vertices(g)))
+        {
+            parallel_connected_components(g, comp_map, hist);
+        }
+        else
+        {
+            HistogramPropertyMap<CompMap> cm(comp_map, num_vertices(g), hist);
+            boost::connected_components(g, cm);
+        }
     }
 };
 
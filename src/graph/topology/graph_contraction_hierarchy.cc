@@ -0,0 +1,107 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "graph.hh"
+#include "graph_filtering.hh"
+#include "graph_properties.hh"
+#include "graph_selectors.hh"
+#include "graph_python_interface.hh"
+#include "numpy_bind.hh"
+
+#include "graph_contraction_hierarchy.hh"
+
+#include <boost/python.hpp>
+
+using namespace std;
+using namespace boost;
+using namespace graph_tool;
+
+ContractionHierarchy build_contraction_hierarchy(GraphInterface& gi,
+                                                 boost::any weight,
+                                                 size_t max_settled)
+{
+    typedef UnityPropertyMap<int,GraphInterface::edge_t> weight_map_t;
+    typedef boost::mpl::push_back<edge_scalar_properties, weight_map_t>::type
+        weight_props_t;
+
+    if (weight.empty())
+        weight = weight_map_t();
+
+    ContractionHierarchy ch;
+    run_action<>()
+        (gi, [&](auto& g, auto w) { ch.build(g, w, max_settled); },
+         weight_props_t())(weight);
+    return ch;
+}
+
+double ch_distance(ContractionHierarchy& ch, size_t s, size_t t)
+{
+    return ch.query(s, t);
+}
+
+void ch_distance_pairs(ContractionHierarchy& ch, python::object osources,
+                       python::object otargets, python::object odist)
+{
+    auto sources = get_array<int64_t, 1>(osources);
+    auto targets = get_array<int64_t, 1>(otargets);
+    auto dist = get_array<double, 1>(odist);
+    ch.query_pairs(sources, targets, dist);
+}
+
+void ch_distance_many(ContractionHierarchy& ch, size_t s,
+                      python::object otargets, python::object odist)
+{
+    auto targets = get_array<int64_t, 1>(otargets);
+    auto dist = get_array<double, 1>(odist);
+    ch.query_many(s, targets, dist);
+}
+
+python::object ch_path(GraphInterface& gi, ContractionHierarchy& ch, size_t s,
+                       size_t t)
+{
+    vector<size_t> vs;
+    vector<ContractionHierarchy::edge_t> es;
+    ch.query_path(s, t, vs, es);
+
+    python::list elist;
+    run_action<>()
+        (gi, [&](auto& g)
+             {
+                 typedef typename std::remove_reference<decltype(g)>::type g_t;
+                 auto gp = retrieve_graph_view<g_t>(gi, g);
+                 for (auto& e : es)
+                     elist.append(PythonEdge<g_t>(gp, e));
+             })();
+    return python::make_tuple(wrap_vector_owned(vs), elist);
+}
+
+void export_contraction_hierarchy()
+{
+    using namespace boost::python;
+    class_<ContractionHierarchy>("ContractionHierarchy", no_init)
+        .def("num_vertices", &ContractionHierarchy::get_num_vertices)
+        .def("num_arcs", &ContractionHierarchy::get_num_arcs)
+        .def("num_shortcuts", &ContractionHierarchy::get_num_shortcuts)
+        .def("get_rank",
+             +[](ContractionHierarchy& ch)
+              { return wrap_vector_owned(ch.get_rank()); });
+    def("build_contraction_hierarchy", &build_contraction_hierarchy);
+    def("ch_distance", &ch_distance);
+    def("ch_distance_pairs", &ch_distance_pairs);
+    def("ch_distance_many", &ch_distance_many);
+    def("ch_path", &ch_path);
+};
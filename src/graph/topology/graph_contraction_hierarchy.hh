@@ -0,0 +1,814 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_CONTRACTION_HIERARCHY_HH
+#define GRAPH_CONTRACTION_HIERARCHY_HH
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <functional>
+#include <tuple>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "graph.hh"
+#include "graph_util.hh"
+
+namespace graph_tool
+{
+using namespace std;
+using namespace boost;
+
+// Contraction hierarchy (Geisberger et al., 2008) built on top of a static
+// graph. Vertices are contracted in rounds of independent sets, chosen in
+// parallel according to the edge-difference heuristic. The upward arcs (the
+// original edges plus the shortcuts) are kept in a separate CSR structure, so
+// the graph itself is never modified, and every shortcut remembers the two
+// arcs it bypasses, so that paths can be unpacked into the original edges.
+
+class ContractionHierarchy
+{
+public:
+    typedef GraphInterface::edge_t edge_t;
+
+    ContractionHierarchy() : _N(0), _n_orig(0) {}
+
+    template <class Graph, class Weight>
+    void build(Graph& g, Weight weight, size_t max_settled)
+    {
+        _N = num_vertices(g);
+        _arc_tail.clear();
+        _arc_head.clear();
+        _arc_w.clear();
+        _arc_edge.clear();
+        _shortcut.clear();
+
+        vector<vector<pair<size_t, size_t>>> out(_N), in(_N);
+
+        // original arcs; parallel edges are collapsed into the lightest one,
+        // where last_arc[u] is the arc from the current vertex to u, if
+        // last_tail[u] is that vertex
+        vector<size_t> last_tail(_N, numeric_limits<size_t>::max()),
+            last_arc(_N);
+        for (auto v : vertices_range(g))
+        {
+            for (auto e : out_edges_range(v, g))
+            {
+                size_t u = target(e, g);
+                if (u == size_t(v))
+                    continue;
+                double w = get(weight, e);
+                if (w < 0)
+                    throw ValueException("contraction hierarchies require "
+                                         "non-negative edge weights");
+                if (last_tail[u] == size_t(v))
+                {
+                    size_t a = last_arc[u];
+                    if (w < _arc_w[a])
+                    {
+                        _arc_w[a] = w;
+                        _arc_edge[a] = e;
+                    }
+                    continue;
+                }
+                size_t a = _arc_tail.size();
+                last_tail[u] = v;
+                last_arc[u] = a;
+                _arc_tail.push_back(v);
+                _arc_head.push_back(u);
+                _arc_w.push_back(w);
+                _arc_edge.push_back(e);
+                out[v].emplace_back(u, a);
+                in[u].emplace_back(v, a);
+            }
+        }
+        _n_orig = _arc_tail.size();
+
+        vector<uint8_t> contracted(_N, false), mark(_N, false);
+        vector<size_t> remaining;
+        for (auto v : vertices_range(g))
+            remaining.push_back(v);
+
+        size_t nt = get_openmp_threads();
+        vector<workspace> ws(nt);
+        for (auto& w : ws)
+            w.init(_N);
+
+        // The priority of a vertex is given by its level in the hierarchy
+        // plus the ratios of added/removed arcs and hops (i.e. original
+        // edges represented by the arcs), as in RoutingKit.
+        vector<double> prio(_N, 0);
+        vector<size_t> level(_N, 0);
+        vector<size_t> hops(_n_orig, 1);
+        vector<vector<size_t>> up_out(_N), up_in(_N);
+
+        auto get_ws = [&]() -> workspace&
+            {
+                size_t tid = 0;
+                #ifdef _OPENMP
+                tid = omp_get_thread_num();
+                #endif
+                return ws[tid];
+            };
+
+        auto get_prio = [&](size_t v)
+            {
+                size_t n_added = 0, h_added = 0;
+                contract(v, out, in, mark, max_settled, get_ws(),
+                         [&](size_t, size_t, double, size_t a_in,
+                             size_t a_out)
+                         {
+                             ++n_added;
+                             h_added += hops[a_in] + hops[a_out];
+                         });
+                size_t n_removed = out[v].size() + in[v].size();
+                size_t h_removed = 0;
+                for (auto& a : out[v])
+                    h_removed += hops[a.second];
+                for (auto& a : in[v])
+                    h_removed += hops[a.second];
+                return level[v] +
+                    n_added / double(std::max(n_removed, size_t(1))) +
+                    h_added / double(std::max(h_removed, size_t(1)));
+            };
+
+        #pragma omp parallel if (_N > OPENMP_MIN_THRESH)
+        parallel_loop_no_spawn
+            (remaining,
+             [&](size_t, size_t v) { prio[v] = get_prio(v); });
+
+        _rank.clear();
+        _rank.resize(_N, numeric_limits<size_t>::max());
+
+        // ties are broken by a hash of the vertex index, to avoid long
+        // chains of dependencies in regular structures
+        auto less_prio = [&](size_t u, size_t v)
+            {
+                if (prio[u] != prio[v])
+                    return prio[u] < prio[v];
+                size_t hu = std::hash<size_t>()(u * 0x9e3779b97f4a7c15);
+                size_t hv = std::hash<size_t>()(v * 0x9e3779b97f4a7c15);
+                if (hu != hv)
+                    return hu < hv;
+                return u < v;
+            };
+
+        typedef std::tuple<size_t, size_t, double, size_t, size_t> shortcut_t;
+        vector<vector<shortcut_t>> tshortcuts(nt);
+        vector<size_t> selected, touched;
+        size_t rank = 0;
+        while (!remaining.empty())
+        {
+            // select the vertices which are local priority minima
+            selected.clear();
+            #pragma omp parallel if (remaining.size() > OPENMP_MIN_THRESH)
+            {
+                vector<size_t> sel;
+                parallel_loop_no_spawn
+                    (remaining,
+                     [&](size_t, size_t v)
+                     {
+                         for (auto& a : out[v])
+                             if (less_prio(a.first, v))
+                                 return;
+                         for (auto& a : in[v])
+                             if (less_prio(a.first, v))
+                                 return;
+                         sel.push_back(v);
+                     });
+                #pragma omp critical (select)
+                selected.insert(selected.end(), sel.begin(), sel.end());
+            }
+            sort(selected.begin(), selected.end());
+
+            for (auto v : selected)
+                mark[v] = true;
+
+            // witness searches for all the selected vertices, in parallel
+            #pragma omp parallel if (selected.size() > OPENMP_MIN_THRESH)
+            {
+                size_t tid = 0;
+                #ifdef _OPENMP
+                tid = omp_get_thread_num();
+                #endif
+                auto& shortcuts = tshortcuts[tid];
+                parallel_loop_no_spawn
+                    (selected,
+                     [&](size_t, size_t v)
+                     {
+                         contract(v, out, in, mark, max_settled, ws[tid],
+                                  [&](size_t u, size_t x, double w,
+                                      size_t a_in, size_t a_out)
+                                  {
+                                      shortcuts.emplace_back(u, x, w, a_in,
+                                                             a_out);
+                                  });
+                         for (auto& a : out[v])
+                             up_out[v].push_back(a.second);
+                         for (auto& a : in[v])
+                             up_in[v].push_back(a.second);
+                     });
+            }
+
+            // remove the contracted vertices, and insert the shortcuts
+            touched.clear();
+            for (auto v : selected)
+            {
+                _rank[v] = rank++;
+                contracted[v] = true;
+                for (auto& a : out[v])
+                {
+                    remove_arc(in[a.first], v);
+                    level[a.first] = std::max(level[a.first], level[v] + 1);
+                    touched.push_back(a.first);
+                }
+                for (auto& a : in[v])
+                {
+                    remove_arc(out[a.first], v);
+                    level[a.first] = std::max(level[a.first], level[v] + 1);
+                    touched.push_back(a.first);
+                }
+                out[v].clear();
+                out[v].shrink_to_fit();
+                in[v].clear();
+                in[v].shrink_to_fit();
+            }
+
+            for (auto& shortcuts : tshortcuts)
+            {
+                for (auto& s : shortcuts)
+                    add_shortcut(std::get<0>(s), std::get<1>(s), std::get<2>(s),
+                                 std::get<3>(s), std::get<4>(s), out, in, hops);
+                shortcuts.clear();
+            }
+
+            for (auto v : selected)
+                mark[v] = false;
+
+            // update priorities of the neighbors
+            sort(touched.begin(), touched.end());
+            touched.erase(unique(touched.begin(), touched.end()),
+                          touched.end());
+            #pragma omp parallel if (touched.size() > OPENMP_MIN_THRESH)
+            parallel_loop_no_spawn
+                (touched,
+                 [&](size_t, size_t v) { prio[v] = get_prio(v); });
+
+            remaining.erase(remove_if(remaining.begin(), remaining.end(),
+                                      [&](size_t v) { return contracted[v]; }),
+                            remaining.end());
+        }
+
+        // upward CSR, in both directions
+        auto build_csr = [&](auto& adj, auto& idx, auto& arcs)
+            {
+                idx.clear();
+                idx.resize(_N + 1, 0);
+                for (size_t v = 0; v < _N; ++v)
+                    idx[v + 1] = idx[v] + adj[v].size();
+                arcs.resize(idx[_N]);
+                for (size_t v = 0; v < _N; ++v)
+                {
+                    copy(adj[v].begin(), adj[v].end(), arcs.begin() + idx[v]);
+                    adj[v].clear();
+                    adj[v].shrink_to_fit();
+                }
+            };
+        build_csr(up_out, _up_out_idx, _up_out);
+        build_csr(up_in, _up_in_idx, _up_in);
+
+        _ws.clear();
+    }
+
+    size_t get_num_vertices() const { return _N; }
+    size_t get_num_arcs() const { return _n_orig; }
+    size_t get_num_shortcuts() const { return _shortcut.size(); }
+    const vector<size_t>& get_rank() const { return _rank; }
+
+    // point-to-point distance, via bidirectional upward search
+    double query(size_t s, size_t t) const
+    {
+        auto& ws = get_workspace();
+        double d;
+        size_t m;
+        std::tie(d, m) = bidirectional_search(s, t, ws);
+        ws.reset();
+        return d;
+    }
+
+    // many independent point-to-point queries, in parallel
+    template <class Sources, class Targets, class Dists>
+    void query_pairs(Sources& sources, Targets& targets, Dists& dist) const
+    {
+        size_t N = sources.size();
+        for (size_t i = 0; i < N; ++i)
+        {
+            check_vertex(sources[i]);
+            check_vertex(targets[i]);
+        }
+        get_workspace();
+        #pragma omp parallel for default(shared) schedule(runtime) \
+            if (N > OPENMP_MIN_THRESH)
+        for (size_t i = 0; i < N; ++i)
+        {
+            auto& ws = get_workspace();
+            double d;
+            size_t m;
+            std::tie(d, m) = bidirectional_search(sources[i], targets[i], ws);
+            ws.reset();
+            dist[i] = d;
+        }
+    }
+
+    // one-to-many distances: a single exhaustive upward search from the
+    // source, followed by pruned backward upward searches from each target,
+    // run in parallel
+    template <class Targets, class Dists>
+    void query_many(size_t s, Targets& targets, Dists& dist) const
+    {
+        size_t N = targets.size();
+        check_vertex(s);
+        for (size_t i = 0; i < N; ++i)
+            check_vertex(targets[i]);
+        auto& ws_f = get_workspace();
+        upward_search(s, ws_f.dist_f, ws_f.pred_f, ws_f.heap_f, ws_f.touched_f,
+                      _up_out_idx, _up_out, _arc_head,
+                      numeric_limits<double>::infinity());
+        const auto& dist_f = ws_f.dist_f;
+
+        #pragma omp parallel for default(shared) schedule(runtime) \
+            if (N > OPENMP_MIN_THRESH)
+        for (size_t i = 0; i < N; ++i)
+        {
+            size_t t = targets[i];
+            auto& ws = get_workspace();
+            double best = numeric_limits<double>::infinity();
+            auto& heap = ws.heap_b;
+            ws.dist_b[t] = 0;
+            ws.touched_b.push_back(t);
+            heap.emplace_back(0, t);
+            while (!heap.empty())
+            {
+                pop_heap(heap.begin(), heap.end(), heap_cmp());
+                double d;
+                size_t v;
+                std::tie(d, v) = heap.back();
+                heap.pop_back();
+                if (d >= best)
+                    break;
+                if (d > ws.dist_b[v])
+                    continue;
+                best = std::min(best, d + dist_f[v]);
+                if (stalled(v, d, ws.dist_b, _up_out_idx, _up_out, _arc_head))
+                    continue;
+                relax(v, d, ws.dist_b, ws.pred_b, heap, ws.touched_b,
+                      _up_in_idx, _up_in, _arc_tail);
+            }
+            heap.clear();
+            dist[i] = best;
+            ws.reset_b();
+        }
+        ws_f.reset_f();
+    }
+
+    // shortest path from s to t, as a sequence of original edges; the
+    // vertex sequence is written in 'vs'
+    double query_path(size_t s, size_t t, vector<size_t>& vs,
+                      vector<edge_t>& es) const
+    {
+        auto& ws = get_workspace();
+        double d;
+        size_t m;
+        std::tie(d, m) = bidirectional_search(s, t, ws);
+
+        vs.clear();
+        es.clear();
+        if (m != numeric_limits<size_t>::max())
+        {
+            vector<size_t> arcs;
+            for (size_t v = m; v != s; v = _arc_tail[ws.pred_f[v]])
+                arcs.push_back(ws.pred_f[v]);
+            reverse(arcs.begin(), arcs.end());
+            for (size_t v = m; v != t; v = _arc_head[ws.pred_b[v]])
+                arcs.push_back(ws.pred_b[v]);
+
+            vs.push_back(s);
+            vector<size_t> stack;
+            for (auto a : arcs)
+            {
+                stack.push_back(a);
+                while (!stack.empty())
+                {
+                    size_t b = stack.back();
+                    stack.pop_back();
+                    if (b < _n_orig)
+                    {
+                        vs.push_back(_arc_head[b]);
+                        es.push_back(_arc_edge[b]);
+                    }
+                    else
+                    {
+                        auto& sc = _shortcut[b - _n_orig];
+                        stack.push_back(sc.second);
+                        stack.push_back(sc.first);
+                    }
+                }
+            }
+        }
+        ws.reset();
+        return d;
+    }
+
+private:
+    typedef pair<double, size_t> heap_item_t;
+
+    struct heap_cmp
+    {
+        bool operator()(const heap_item_t& a, const heap_item_t& b) const
+        {
+            return a.first > b.first;
+        }
+    };
+
+    struct workspace
+    {
+        void init(size_t N)
+        {
+            dist_f.resize(N, numeric_limits<double>::infinity());
+            dist_b.resize(N, numeric_limits<double>::infinity());
+            pred_f.resize(N, numeric_limits<size_t>::max());
+            pred_b.resize(N, numeric_limits<size_t>::max());
+            is_target.resize(N, false);
+        }
+
+        void reset_f()
+        {
+            for (auto v : touched_f)
+            {
+                dist_f[v] = numeric_limits<double>::infinity();
+                pred_f[v] = numeric_limits<size_t>::max();
+            }
+            touched_f.clear();
+            heap_f.clear();
+        }
+
+        void reset_b()
+        {
+            for (auto v : touched_b)
+            {
+                dist_b[v] = numeric_limits<double>::infinity();
+                pred_b[v] = numeric_limits<size_t>::max();
+            }
+            touched_b.clear();
+            heap_b.clear();
+        }
+
+        void reset()
+        {
+            reset_f();
+            reset_b();
+        }
+
+        vector<double> dist_f, dist_b;
+        vector<size_t> pred_f, pred_b;
+        vector<uint8_t> is_target;
+        vector<size_t> touched_f, touched_b;
+        vector<heap_item_t> heap_f, heap_b;
+    };
+
+    void check_vertex(size_t v) const
+    {
+        if (v >= _N || _rank[v] == numeric_limits<size_t>::max())
+            throw ValueException("invalid vertex: " +
+                                 boost::lexical_cast<string>(v));
+    }
+
+    // Workspace of the calling thread. Outside of parallel regions, there is
+    // one workspace allocated for every thread that may be used next, so
+    // this must be called once before entering a parallel region.
+    workspace& get_workspace() const
+    {
+        size_t tid = 0;
+        #ifdef _OPENMP
+        tid = omp_get_thread_num();
+        if (!omp_in_parallel())
+        {
+            size_t nt = omp_get_max_threads();
+            if (_ws.size() < nt)
+            {
+                size_t n = _ws.size();
+                _ws.resize(nt);
+                for (size_t i = n; i < nt; ++i)
+                    _ws[i].init(_N);
+            }
+        }
+        #endif
+        if (_ws.empty())
+        {
+            _ws.resize(1);
+            _ws[0].init(_N);
+        }
+        return _ws[tid];
+    }
+
+    static void remove_arc(vector<pair<size_t, size_t>>& adj, size_t v)
+    {
+        auto iter = find_if(adj.begin(), adj.end(),
+                            [&](auto& a) { return a.first == v; });
+        if (iter == adj.end())
+            return;
+        *iter = adj.back();
+        adj.pop_back();
+    }
+
+    void add_shortcut(size_t u, size_t x, double w, size_t a_in, size_t a_out,
+                      vector<vector<pair<size_t, size_t>>>& out,
+                      vector<vector<pair<size_t, size_t>>>& in,
+                      vector<size_t>& hops)
+    {
+        auto iter = find_if(out[u].begin(), out[u].end(),
+                            [&](auto& a) { return a.first == x; });
+        if (iter != out[u].end() && _arc_w[iter->second] <= w)
+            return;
+
+        size_t a = _arc_tail.size();
+        _arc_tail.push_back(u);
+        _arc_head.push_back(x);
+        _arc_w.push_back(w);
+        _arc_edge.emplace_back();
+        _shortcut.emplace_back(a_in, a_out);
+        hops.push_back(hops[a_in] + hops[a_out]);
+
+        if (iter != out[u].end())
+        {
+            iter->second = a;
+            for (auto& b : in[x])
+            {
+                if (b.first == u)
+                    b.second = a;
+            }
+        }
+        else
+        {
+            out[u].emplace_back(x, a);
+            in[x].emplace_back(u, a);
+        }
+    }
+
+    // Simulates the contraction of vertex v, calling f(u, x, w, a_in, a_out)
+    // for every shortcut u -> x that would be necessary. Vertices marked in
+    // 'mark' (i.e. the ones being contracted concurrently) are avoided by the
+    // witness searches.
+    template <class F>
+    void contract(size_t v, vector<vector<pair<size_t, size_t>>>& out,
+                  vector<vector<pair<size_t, size_t>>>& in,
+                  vector<uint8_t>& mark, size_t max_settled, workspace& ws,
+                  F&& f) const
+    {
+        if (out[v].empty() || in[v].empty())
+            return;
+
+        double max_out = 0;
+        for (auto& a : out[v])
+            max_out = std::max(max_out, _arc_w[a.second]);
+
+        auto& dist = ws.dist_f;
+        auto& heap = ws.heap_f;
+        auto& touched = ws.touched_f;
+        auto& is_target = ws.is_target;
+        for (auto& ao : out[v])
+            is_target[ao.first] = true;
+
+        for (auto& ai : in[v])
+        {
+            size_t u = ai.first;
+            double w_in = _arc_w[ai.second];
+            double max_d = w_in + max_out;
+
+            // bounded local Dijkstra from u, avoiding v, which stops as soon
+            // as all the targets are settled
+            size_t n_targets = out[v].size() - (is_target[u] ? 1 : 0);
+            dist[u] = 0;
+            touched.push_back(u);
+            heap.emplace_back(0, u);
+            size_t n_settled = 0;
+            while (!heap.empty() && n_targets > 0)
+            {
+                pop_heap(heap.begin(), heap.end(), heap_cmp());
+                double d;
+                size_t y;
+                std::tie(d, y) = heap.back();
+                heap.pop_back();
+                if (d > dist[y])
+                    continue;
+                if (d > max_d || ++n_settled > max_settled)
+                    break;
+                if (is_target[y] && y != u && --n_targets == 0)
+                    break;
+                for (auto& a : out[y])
+                {
+                    size_t z = a.first;
+                    if (z == v || mark[z])
+                        continue;
+                    double nd = d + _arc_w[a.second];
+                    if (nd < dist[z])
+                    {
+                        if (dist[z] == numeric_limits<double>::infinity())
+                            touched.push_back(z);
+                        dist[z] = nd;
+                        heap.emplace_back(nd, z);
+                        push_heap(heap.begin(), heap.end(), heap_cmp());
+                    }
+                }
+            }
+
+            for (auto& ao : out[v])
+            {
+                size_t x = ao.first;
+                if (x == u)
+                    continue;
+                double w = w_in + _arc_w[ao.second];
+                if (dist[x] > w)
+                    f(u, x, w, ai.second, ao.second);
+            }
+
+            for (auto y : touched)
+                dist[y] = numeric_limits<double>::infinity();
+            touched.clear();
+            heap.clear();
+        }
+
+        for (auto& ao : out[v])
+            is_target[ao.first] = false;
+    }
+
+    template <class Heap>
+    void relax(size_t v, double d, vector<double>& dist, vector<size_t>& pred,
+               Heap& heap, vector<size_t>& touched, const vector<size_t>& idx,
+               const vector<size_t>& arcs, const vector<size_t>& ends) const
+    {
+        for (size_t i = idx[v]; i < idx[v + 1]; ++i)
+        {
+            size_t a = arcs[i];
+            size_t u = ends[a];
+            double nd = d + _arc_w[a];
+            if (nd < dist[u])
+            {
+                if (dist[u] == numeric_limits<double>::infinity())
+                    touched.push_back(u);
+                dist[u] = nd;
+                pred[u] = a;
+                heap.emplace_back(nd, u);
+                push_heap(heap.begin(), heap.end(), heap_cmp());
+            }
+        }
+    }
+
+    // Stall-on-demand: v does not need to be expanded if it can be reached
+    // with a shorter distance via a higher-ranked vertex, using the arcs of
+    // the opposite direction.
+    bool stalled(size_t v, double d, const vector<double>& dist,
+                 const vector<size_t>& idx, const vector<size_t>& arcs,
+                 const vector<size_t>& ends) const
+    {
+        for (size_t i = idx[v]; i < idx[v + 1]; ++i)
+        {
+            size_t a = arcs[i];
+            if (dist[ends[a]] + _arc_w[a] < d)
+                return true;
+        }
+        return false;
+    }
+
+    template <class Heap>
+    void upward_search(size_t s, vector<double>& dist, vector<size_t>& pred,
+                       Heap& heap, vector<size_t>& touched,
+                       const vector<size_t>& idx, const vector<size_t>& arcs,
+                       const vector<size_t>& ends, double max_d) const
+    {
+        dist[s] = 0;
+        touched.push_back(s);
+        heap.emplace_back(0, s);
+        while (!heap.empty())
+        {
+            pop_heap(heap.begin(), heap.end(), heap_cmp());
+            double d;
+            size_t v;
+            std::tie(d, v) = heap.back();
+            heap.pop_back();
+            if (d > dist[v])
+                continue;
+            if (d >= max_d)
+                break;
+            relax(v, d, dist, pred, heap, touched, idx, arcs, ends);
+        }
+        heap.clear();
+    }
+
+    // Returns the distance and the meeting vertex (the highest-ranked vertex
+    // in the path).
+    pair<double, size_t> bidirectional_search(size_t s, size_t t,
+                                              workspace& ws) const
+    {
+        check_vertex(s);
+        check_vertex(t);
+
+        double best = numeric_limits<double>::infinity();
+        size_t meet = numeric_limits<size_t>::max();
+
+        ws.dist_f[s] = 0;
+        ws.touched_f.push_back(s);
+        ws.heap_f.emplace_back(0, s);
+        ws.dist_b[t] = 0;
+        ws.touched_b.push_back(t);
+        ws.heap_b.emplace_back(0, t);
+
+        bool forward = true;
+        while (!ws.heap_f.empty() || !ws.heap_b.empty())
+        {
+            if (ws.heap_f.empty())
+                forward = false;
+            else if (ws.heap_b.empty())
+                forward = true;
+
+            auto& heap = forward ? ws.heap_f : ws.heap_b;
+            auto& dist = forward ? ws.dist_f : ws.dist_b;
+            auto& odist = forward ? ws.dist_b : ws.dist_f;
+
+            pop_heap(heap.begin(), heap.end(), heap_cmp());
+            double d;
+            size_t v;
+            std::tie(d, v) = heap.back();
+            heap.pop_back();
+
+            if (d >= best)
+            {
+                heap.clear();   // this direction is done
+            }
+            else if (d <= dist[v])
+            {
+                if (d + odist[v] < best)
+                {
+                    best = d + odist[v];
+                    meet = v;
+                }
+                if (forward)
+                {
+                    if (!stalled(v, d, ws.dist_f, _up_in_idx, _up_in,
+                                 _arc_tail))
+                        relax(v, d, ws.dist_f, ws.pred_f, heap, ws.touched_f,
+                              _up_out_idx, _up_out, _arc_head);
+                }
+                else
+                {
+                    if (!stalled(v, d, ws.dist_b, _up_out_idx, _up_out,
+                                 _arc_head))
+                        relax(v, d, ws.dist_b, ws.pred_b, heap, ws.touched_b,
+                              _up_in_idx, _up_in, _arc_tail);
+                }
+            }
+            forward = !forward;
+        }
+        return {best, meet};
+    }
+
+    size_t _N;
+    size_t _n_orig;
+    vector<size_t> _rank;
+
+    // arcs: ids below _n_orig are original edges, the remaining ones are
+    // shortcuts
+    vector<size_t> _arc_tail;
+    vector<size_t> _arc_head;
+    vector<double> _arc_w;
+    vector<edge_t> _arc_edge;
+    vector<pair<size_t, size_t>> _shortcut;
+
+    // upward CSR: _up_out contains the arcs leaving each vertex towards a
+    // higher rank, and _up_in the arcs arriving from a higher rank
+    vector<size_t> _up_out_idx, _up_out;
+    vector<size_t> _up_in_idx, _up_in;
+
+    mutable vector<workspace> _ws;
+};
+
+} // graph_tool namespace
+
+#endif // GRAPH_CONTRACTION_HIERARCHY_HH
@@ -19,6 +19,9 @@
 #include "graph_filtering.hh"
 #include "graph_properties.hh"
 #include "graph_selectors.hh"
+#include "numpy_bind.hh"
+
+#include "graph_diameter.hh"
 
 #include <boost/graph/breadth_first_search.hpp>
 #include <boost/graph/dijkstra_shortest_paths.hpp>
@@ -163,7 +166,56 @@ python::object get_diam(GraphInterface& gi, size_t source, boost::any weight)
     return python::make_tuple(target, max_dist);
 }
 
+python::object get_exact_diameter(GraphInterface& gi, boost::any weight,
+                                  bool all)
+{
+    python::object ret;
+    if (weight.empty())
+    {
+        run_action<>()
+            (gi, [&](auto& g)
+             {
+                 vector<size_t> ecc;
+                 size_t diam, radius;
+                 bounding_eccentricities<vector<std::atomic<size_t>>>
+                     (g, all, 1,
+                      [&](size_t s, auto& dist, auto& reached)
+                      { return ecc_bfs(g, s, dist, reached); },
+                      ecc, diam, radius);
+                 vector<int64_t> ecc_out(ecc.begin(), ecc.end());
+                 ret = python::make_tuple(diam, radius,
+                                          wrap_vector_owned(ecc_out));
+             })();
+    }
+    else
+    {
+        size_t nt = get_openmp_threads();
+        run_action<>()
+            (gi, [&](auto& g, auto weight)
+             {
+                 typedef typename property_traits<decltype(weight)>::value_type
+                     val_t;
+                 typedef typename std::conditional<std::is_floating_point<val_t>::value,
+                                                   val_t, int64_t>::type
+                     dist_t;
+                 vector<dist_t> ecc;
+                 dist_t diam, radius;
+                 bounding_eccentricities<vector<dist_t>>
+                     (g, all, nt,
+                      [&](size_t s, auto& dist, auto& reached)
+                      { return ecc_dijkstra(g, s, weight, dist, reached); },
+                      ecc, diam, radius);
+                 vector<double> ecc_out(ecc.begin(), ecc.end());
+                 ret = python::make_tuple(diam, radius,
+                                          wrap_vector_owned(ecc_out));
+             },
+             edge_scalar_properties())(weight);
+    }
+    return ret;
+}
+
 void export_diam()
 {
     python::def("get_diam", &get_diam);
+    python::def("get_exact_diameter", &get_exact_diameter);
 };
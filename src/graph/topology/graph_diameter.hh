@@ -0,0 +1,273 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+#ifndef GRAPH_DIAMETER_HH
+#define GRAPH_DIAMETER_HH
+
+#include <vector>
+#include <atomic>
+#include <queue>
+#include <limits>
+#include <algorithm>
+
+#include "graph_util.hh"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace graph_tool
+{
+using namespace std;
+using namespace boost;
+
+// Unweighted distances from s, with a level-synchronous BFS where each level
+// is expanded in parallel. The reached vertices are appended to `reached`, in
+// order of distance, and the eccentricity of s is returned. The entries of
+// dist must be initialized to the maximum value, and only the reached ones
+// are modified.
+template <class Graph>
+size_t ecc_bfs(const Graph& g, size_t s, vector<std::atomic<size_t>>& dist,
+               vector<size_t>& reached)
+{
+    constexpr size_t inf = numeric_limits<size_t>::max();
+    reached.clear();
+    reached.push_back(s);
+    dist[s].store(0, std::memory_order_relaxed);
+    size_t begin = 0, d = 0;
+    while (begin < reached.size())
+    {
+        size_t end = reached.size();
+        #pragma omp parallel if (end - begin > OPENMP_MIN_THRESH)
+        {
+            vector<size_t> local;
+            #pragma omp for schedule(runtime) nowait
+            for (size_t i = begin; i < end; ++i)
+            {
+                auto v = reached[i];
+                for (auto e : out_edges_range(v, g))
+                {
+                    size_t u = target(e, g);
+                    size_t x = inf;
+                    if (dist[u].load(std::memory_order_relaxed) == inf &&
+                        dist[u].compare_exchange_strong(x, d + 1,
+                                                        std::memory_order_relaxed))
+                        local.push_back(u);
+                }
+            }
+            #pragma omp critical (ecc_bfs)
+            reached.insert(reached.end(), local.begin(), local.end());
+        }
+        begin = end;
+        if (begin < reached.size())
+            ++d;
+    }
+    return d;
+}
+
+// Weighted distances from s, with Dijkstra's algorithm, with the same
+// conventions as ecc_bfs(). This is sequential, but several searches are run
+// at the same time by bounding_eccentricities().
+template <class Graph, class WeightMap, class Dist>
+Dist ecc_dijkstra(const Graph& g, size_t s, WeightMap weight,
+                  vector<Dist>& dist, vector<size_t>& reached)
+{
+    typedef pair<Dist, size_t> item_t;
+    std::priority_queue<item_t, vector<item_t>, std::greater<item_t>> queue;
+    reached.clear();
+    dist[s] = 0;
+    queue.emplace(0, s);
+    Dist ecc = 0;
+    while (!queue.empty())
+    {
+        Dist d = queue.top().first;
+        size_t v = queue.top().second;
+        queue.pop();
+        if (d > dist[v])
+            continue;
+        reached.push_back(v);
+        ecc = d;
+        for (auto e : out_edges_range(v, g))
+        {
+            size_t u = target(e, g);
+            Dist nd = d + get(weight, e);
+            if (nd < dist[u])
+            {
+                dist[u] = nd;
+                queue.emplace(nd, u);
+            }
+        }
+    }
+    return ecc;
+}
+
+// Whether lower >= upper, up to the rounding errors of the distances, if
+// they are floating point.
+template <class Dist>
+bool ecc_resolved(Dist lower, Dist upper)
+{
+    if (std::is_floating_point<Dist>::value)
+        return upper - lower <= upper * numeric_limits<Dist>::epsilon() * 1024;
+    return lower >= upper;
+}
+
+// Exact eccentricities, diameter and radius of an undirected graph, with the
+// bounding algorithm of Takes and Kosters. After a search from v, with
+// eccentricity e(v), the eccentricity of every reached vertex w is bounded by
+//
+//     max(d(v, w), e(v) - d(v, w)) <= e(w) <= e(v) + d(v, w),
+//
+// and the vertices are removed from the candidate set as soon as their
+// eccentricity is known. The next sources are chosen alternately as the
+// candidates with the smallest lower and the largest upper bound, which are
+// typically central and peripheral vertices, so that only a handful of
+// searches are needed for real-world graphs. If all == false, also the
+// vertices that can no longer affect the diameter or the radius are removed,
+// i.e. those with an upper bound not above the largest lower bound, and a
+// lower bound not below the smallest upper bound. The eccentricity of a
+// vertex is taken within its own component.
+//
+// The search(s, dist, reached) function computes the distances from s, as
+// ecc_bfs() and ecc_dijkstra(), and batch is the number of searches done at
+// the same time.
+template <class DistVec, class Graph, class Dist, class Search>
+void bounding_eccentricities(const Graph& g, bool all, size_t batch,
+                             Search&& search, vector<Dist>& ecc, Dist& diam,
+                             Dist& radius)
+{
+    constexpr Dist inf = numeric_limits<Dist>::max();
+    size_t N = num_vertices(g);
+    vector<Dist> lower(N, 0), upper(N, inf);
+
+    // isolated vertices are trivial
+    vector<size_t> cand;
+    for (auto v : vertices_range(g))
+    {
+        if (out_degree(v, g) == 0)
+            upper[v] = 0;
+        else
+            cand.push_back(v);
+    }
+
+    size_t nt = get_openmp_threads();
+    batch = std::max(std::min(batch, nt), size_t(1));
+    vector<DistVec> dists(batch);
+    for (auto& dist : dists)
+        dist = DistVec(N);
+    for (auto& dist : dists)
+        for (auto& d : dist)
+            d = inf;
+
+    vector<vector<size_t>> reached(batch);
+    vector<size_t> sources;
+    vector<Dist> source_ecc(batch);
+    bool high = false;
+    while (!cand.empty())
+    {
+        // pick the next sources, alternating between the smallest lower and
+        // the largest upper bound, with ties broken by the largest degree
+        sources.clear();
+        while (sources.size() < std::min(batch, cand.size()))
+        {
+            size_t best = numeric_limits<size_t>::max();
+            for (auto v : cand)
+            {
+                if (std::find(sources.begin(), sources.end(), v) !=
+                    sources.end())
+                    continue;
+                if (best == numeric_limits<size_t>::max())
+                {
+                    best = v;
+                    continue;
+                }
+                auto kv = out_degree(v, g);
+                auto kb = out_degree(best, g);
+                if (high ?
+                    (upper[v] > upper[best] ||
+                     (upper[v] == upper[best] && kv > kb)) :
+                    (lower[v] < lower[best] ||
+                     (lower[v] == lower[best] && kv > kb)))
+                    best = v;
+            }
+            sources.push_back(best);
+            high = !high;
+        }
+
+        size_t ns = sources.size();
+        #pragma omp parallel for schedule(dynamic, 1) num_threads(ns) \
+            if (ns > 1)
+        for (size_t i = 0; i < ns; ++i)
+        {
+            size_t tid = 0;
+            #ifdef _OPENMP
+            tid = omp_get_thread_num();
+            #endif
+            source_ecc[i] = search(sources[i], dists[tid], reached[i]);
+
+            // the bounds are updated sequentially per search, since the
+            // searches of the same batch touch the same vertices
+            #pragma omp critical (bounding_eccentricities)
+            {
+                Dist e = source_ecc[i];
+                auto& dist = dists[tid];
+                for (auto w : reached[i])
+                {
+                    Dist d = dist[w];
+                    lower[w] = std::max(lower[w], std::max(d, Dist(e - d)));
+                    upper[w] = std::min(upper[w], Dist(e + d));
+                }
+                lower[sources[i]] = upper[sources[i]] = e;
+            }
+
+            for (auto w : reached[i])
+                dists[tid][w] = inf;
+        }
+
+        Dist dlow = 0, rup = inf;
+        for (auto v : vertices_range(g))
+        {
+            dlow = std::max(dlow, lower[v]);
+            rup = std::min(rup, upper[v]);
+        }
+
+        auto iter = std::remove_if(cand.begin(), cand.end(),
+                                   [&](auto v)
+                                   {
+                                       if (ecc_resolved(lower[v], upper[v]))
+                                           return true;
+                                       return (!all &&
+                                               ecc_resolved(dlow, upper[v]) &&
+                                               ecc_resolved(lower[v], rup));
+                                   });
+        cand.erase(iter, cand.end());
+    }
+
+    ecc.resize(N);
+    diam = 0;
+    radius = inf;
+    for (auto v : vertices_range(g))
+    {
+        ecc[v] = lower[v];
+        diam = std::max(diam, lower[v]);
+        radius = std::min(radius, upper[v]);
+    }
+    if (radius == inf)
+        radius = 0;
+}
+
+} // graph_tool namespace
+
+#endif // GRAPH_DIAMETER_HH
@@ -21,6 +21,7 @@
 #include "graph_selectors.hh"
 
 #include "graph_kcore.hh"
+#include "numpy_bind.hh"
 
 #include <boost/python.hpp>
 
@@ -33,13 +34,51 @@ void do_kcore_decomposition(GraphInterface& gi, boost::any prop)
     gt_dispatch<>()
         ([](auto& g, auto core)
          {
-             kcore_decomposition(g, core);
+             // the sequential peeling is faster on a single thread
+             if (use_parallel(num_vertices(g)))
+                 parallel_kcore_decomposition(g, core);
+             else
+                 kcore_decomposition(g, core);
          },
          all_graph_views(), writable_vertex_scalar_properties())
         (gi.get_graph_view(), prop);
 }
 
+DynamicKCore build_dynamic_kcore(GraphInterface& gi)
+{
+    DynamicKCore state;
+    run_action<>()
+        (gi, [&](auto& g) { state.build(g); })();
+    return state;
+}
+
+python::object dynamic_kcore_update(DynamicKCore& state, python::object oadd,
+                                    python::object oremove, size_t N)
+{
+    auto add = get_array<int64_t, 2>(oadd);
+    auto remove = get_array<int64_t, 2>(oremove);
+    for (auto edges : {&add, &remove})
+    {
+        for (size_t i = 0; i < edges->shape()[0]; ++i)
+        {
+            if ((*edges)[i][0] < 0 || (*edges)[i][1] < 0 ||
+                size_t((*edges)[i][0]) >= N || size_t((*edges)[i][1]) >= N)
+                throw ValueException("invalid vertex index");
+        }
+    }
+    auto ret = state.update(add, remove, N);
+    return python::make_tuple(ret.first, ret.second);
+}
+
 void export_kcore()
 {
-    python::def("kcore_decomposition", &do_kcore_decomposition);
+    using namespace boost::python;
+    def("kcore_decomposition", &do_kcore_decomposition);
+    class_<DynamicKCore>("DynamicKCore", no_init)
+        .def("num_vertices", &DynamicKCore::num_vertices)
+        .def("get_core",
+             +[](DynamicKCore& state)
+              { return wrap_vector_owned(state.get_core()); });
+    def("build_dynamic_kcore", &build_dynamic_kcore);
+    def("dynamic_kcore_update", &dynamic_kcore_update);
 };
@@ -18,6 +18,19 @@
 #ifndef GRAPH_KCORE_HH
 #define GRAPH_KCORE_HH
 
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <array>
+
+#include <boost/lexical_cast.hpp>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "graph_util.hh"
+
 namespace graph_tool
 {
 using namespace std;
@@ -80,6 +93,444 @@ void kcore_decomposition(Graph& g, CoreMap core_map)
     }
 }
 
+// Parallel version of the above, by peeling all the vertices of each core
+// level at the same time [kabir-parallel-2017]: At level k, all remaining
+// vertices with degree k or smaller are removed together, and the degrees of
+// their neighbors are decremented atomically. Those that drop to k are
+// removed next, in the same level, until no more remain. The list of
+// remaining vertices is compacted as it shrinks, and empty levels are
+// skipped, so that the whole procedure takes O(V + E) work, plus O(V) per
+// nonempty level.
+//
+// The vertices to be peeled are given in remaining, with their degrees in deg,
+// and neighbors(v, f) must call f(u) for every neighbor u of v (with
+// repetitions for parallel edges).
+template <class Neighbors, class CoreMap>
+void parallel_kcore_peel(vector<size_t>& remaining, vector<size_t>& deg,
+                         Neighbors&& neighbors, CoreMap&& core_map)
+{
+    vector<uint8_t> removed(deg.size(), 1);
+    for (auto v : remaining)
+        removed[v] = 0;
+
+    size_t k = 0;
+    vector<size_t> frontier, next;
+    while (!remaining.empty())
+    {
+        // vertices with degree at most k, or the next nonempty level
+        size_t kmin = numeric_limits<size_t>::max();
+        frontier.clear();
+        #pragma omp parallel if (remaining.size() > OPENMP_MIN_THRESH) \
+            reduction(min:kmin)
+        {
+            vector<size_t> local;
+            #pragma omp for schedule(runtime) nowait
+            for (size_t i = 0; i < remaining.size(); ++i)
+            {
+                size_t v = remaining[i];
+                if (deg[v] <= k)
+                    local.push_back(v);
+                else
+                    kmin = std::min(kmin, deg[v]);
+            }
+            #pragma omp critical (kcore_frontier)
+            frontier.insert(frontier.end(), local.begin(), local.end());
+        }
+
+        if (frontier.empty())
+        {
+            k = kmin;
+            continue;
+        }
+
+        size_t nremoved = 0;
+        while (!frontier.empty())
+        {
+            nremoved += frontier.size();
+            for (auto v : frontier)
+                removed[v] = 1;
+            next.clear();
+            #pragma omp parallel if (frontier.size() > OPENMP_MIN_THRESH)
+            {
+                vector<size_t> local;
+                #pragma omp for schedule(runtime) nowait
+                for (size_t i = 0; i < frontier.size(); ++i)
+                {
+                    size_t v = frontier[i];
+                    core_map[v] = k;
+                    neighbors
+                        (v,
+                         [&](size_t u)
+                         {
+                             if (u == v || removed[u])
+                                 return;
+                             size_t x;
+                             #pragma omp atomic capture
+                             x = deg[u]--;
+                             if (x == k + 1)
+                                 local.push_back(u);
+                         });
+                }
+                #pragma omp critical (kcore_frontier)
+                next.insert(next.end(), local.begin(), local.end());
+            }
+            frontier.swap(next);
+        }
+
+        // compact the remaining vertices
+        if (nremoved > 0)
+        {
+            auto iter = std::remove_if(remaining.begin(), remaining.end(),
+                                       [&](size_t v) { return removed[v]; });
+            remaining.erase(iter, remaining.end());
+        }
+        ++k;
+    }
+}
+
+template <class Graph, class CoreMap>
+void parallel_kcore_decomposition(Graph& g, CoreMap core_map)
+{
+    size_t N = num_vertices(g);
+    vector<size_t> deg(N, 0);
+    vector<size_t> remaining;
+    for (auto v : vertices_range(g))
+        remaining.push_back(v);
+    parallel_vertex_loop
+        (g,
+         [&](auto v)
+         {
+             deg[v] = degree(v, g);
+         });
+    parallel_kcore_peel(remaining, deg,
+                        [&](size_t v, auto&& f)
+                        {
+                            for (auto u : all_neighbors_range(v, g))
+                                f(u);
+                        },
+                        core_map);
+}
+
+// Core numbers maintained under edge insertions and removals
+// [sariyuce-streaming-2013]. When an edge (u, v) is inserted or removed, with
+// r = min(k_u, k_v), only the core numbers of the vertices with k = r that are
+// connected to the endpoints with k = r via other vertices with k = r (the
+// "subcore") can change, and only by one. For these vertices, the number of
+// neighbors with core number at least r is computed, and the vertices which
+// cannot have (or keep) a larger core number are evicted iteratively, as in
+// the static peeling. The work done is proportional to the size of the
+// subcores, which is typically much smaller than the graph.
+//
+// As in kcore_decomposition(), the degrees are the total degrees, counting
+// parallel edges and self-loops.
+class DynamicKCore
+{
+public:
+    template <class Graph>
+    void build(Graph& g)
+    {
+        size_t N = boost::num_vertices(g);
+        _adj.clear();
+        _adj.resize(N);
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 for (auto u : all_neighbors_range(v, g))
+                     _adj[v].push_back(u);
+             });
+        _num_arcs = 0;
+        for (auto& us : _adj)
+            _num_arcs += us.size();
+        _cd.resize(N, 0);
+        _mark.resize(N, 0);
+        recompute();
+    }
+
+    size_t num_vertices() const { return _adj.size(); }
+    const vector<size_t>& get_core() const { return _core; }
+
+    // Removes and inserts the given edges, in this order. Returns the total
+    // number of vertices and edges visited, and whether the core numbers had to be
+    // recomputed from scratch, which is done if the work exceeds that of a
+    // full decomposition.
+    template <class Edges>
+    pair<size_t, bool> update(const Edges& add, const Edges& remove, size_t N)
+    {
+        if (N > _adj.size())
+        {
+            _adj.resize(N);
+            _core.resize(N, 0);
+            _cd.resize(N, 0);
+            _mark.resize(N, 0);
+        }
+
+        check_removals(remove);
+
+        // A self-loop contributes two to the degree, and hence can change the
+        // core number by two, so its two ends are processed separately.
+        size_t work = 0;
+        size_t budget = _num_arcs + _adj.size();
+        for (const auto& e : remove)
+        {
+            size_t u = e[0], v = e[1];
+            remove_arc(u, v);
+            if (u == v && work <= budget)
+                work += update_edge(u, v, false);
+            remove_arc(v, u);
+            if (work <= budget)
+                work += update_edge(u, v, false);
+        }
+        for (const auto& e : add)
+        {
+            size_t u = e[0], v = e[1];
+            _adj[u].push_back(v);
+            _num_arcs++;
+            if (u == v && work <= budget)
+                work += update_edge(u, v, true);
+            _adj[v].push_back(u);
+            _num_arcs++;
+            if (work <= budget)
+                work += update_edge(u, v, true);
+        }
+
+        bool global = work > budget;
+        if (global)
+            recompute();
+        return {work, global};
+    }
+
+private:
+    // Throws if any of the edges to be removed does not exist, before
+    // anything is modified. Since the adjacency is symmetric, the edges are
+    // compared as unordered pairs, with their multiplicities, and each
+    // self-loop appears twice in the list of its vertex.
+    template <class Edges>
+    void check_removals(const Edges& remove) const
+    {
+        vector<std::array<size_t, 2>> es;
+        for (const auto& e : remove)
+        {
+            size_t u = e[0], v = e[1];
+            if (u >= _adj.size() || v >= _adj.size())
+                throw ValueException("edge (" + lexical_cast<string>(u) +
+                                     ", " + lexical_cast<string>(v) +
+                                     ") does not exist");
+            es.push_back({std::min(u, v), std::max(u, v)});
+        }
+        std::sort(es.begin(), es.end());
+        for (size_t i = 0; i < es.size();)
+        {
+            size_t j = i;
+            while (j < es.size() && es[j] == es[i])
+                ++j;
+            size_t u = es[i][0], v = es[i][1];
+            size_t k = std::count(_adj[u].begin(), _adj[u].end(), v);
+            if (u == v)
+                k /= 2;
+            if (k < j - i)
+                throw ValueException("edge (" + lexical_cast<string>(u) +
+                                     ", " + lexical_cast<string>(v) +
+                                     ") does not exist");
+            i = j;
+        }
+    }
+
+    bool remove_arc(size_t u, size_t v)
+    {
+        auto& us = _adj[u];
+        auto iter = std::find(us.begin(), us.end(), v);
+        if (iter == us.end())
+            return false;
+        *iter = us.back();
+        us.pop_back();
+        _num_arcs--;
+        return true;
+    }
+
+    void recompute()
+    {
+        size_t N = _adj.size();
+        vector<size_t> deg(N), remaining(N);
+        for (size_t v = 0; v < N; ++v)
+        {
+            deg[v] = _adj[v].size();
+            remaining[v] = v;
+        }
+        _core.resize(N);
+        parallel_kcore_peel(remaining, deg,
+                            [&](size_t v, auto&& f)
+                            {
+                                for (auto u : _adj[v])
+                                    f(u);
+                            },
+                            _core);
+    }
+
+    size_t update_edge(size_t u, size_t v, bool insert)
+    {
+        size_t r = std::min(_core[u], _core[v]);
+        if (!insert && r == 0)
+            return 0;
+        size_t work = insert ? insert_edge(u, v, r) : remove_edge(u, v, r);
+        _touched.clear();
+        return work;
+    }
+
+    // After an insertion, only the vertices with core number r that are
+    // connected to an endpoint via vertices with core number r, and that have
+    // more than r neighbors with core number r or larger, can move to the
+    // (r + 1)-core. These candidates are found by a traversal from the
+    // endpoints, and peeled as in the static algorithm.
+    size_t insert_edge(size_t u, size_t v, size_t r)
+    {
+        // _mark: 1 = candidate, 2 = evicted, 3 = rejected
+        auto visit = [&](size_t w)
+            {
+                size_t m = 0;
+                for (auto x : _adj[w])
+                {
+                    if (_core[x] >= r)
+                        ++m;
+                }
+                _mark[w] = (m > r) ? 1 : 3;
+                _touched.push_back(w);
+            };
+
+        for (auto w : {u, v})
+        {
+            if (_core[w] == r && _mark[w] == 0)
+                visit(w);
+        }
+        for (size_t i = 0; i < _touched.size(); ++i)
+        {
+            size_t w = _touched[i];
+            if (_mark[w] != 1)
+                continue;
+            for (auto x : _adj[w])
+            {
+                if (_core[x] == r && _mark[x] == 0)
+                    visit(x);
+            }
+        }
+
+        _queue.clear();
+        for (auto w : _touched)
+        {
+            if (_mark[w] != 1)
+                continue;
+            size_t cd = 0;
+            for (auto x : _adj[w])
+            {
+                if (_core[x] > r || _mark[x] == 1)
+                    ++cd;
+            }
+            _cd[w] = cd;
+        }
+        for (auto w : _touched)
+        {
+            if (_mark[w] == 1 && _cd[w] <= r)
+            {
+                _mark[w] = 2;
+                _queue.push_back(w);
+            }
+        }
+        while (!_queue.empty())
+        {
+            size_t w = _queue.back();
+            _queue.pop_back();
+            for (auto x : _adj[w])
+            {
+                if (x == w || _mark[x] != 1)
+                    continue;
+                if (--_cd[x] == r)
+                {
+                    _mark[x] = 2;
+                    _queue.push_back(x);
+                }
+            }
+        }
+
+        size_t work = 0;
+        for (auto w : _touched)
+        {
+            if (_mark[w] == 1)
+                _core[w] = r + 1;
+            _mark[w] = 0;
+            work += _adj[w].size() + 1;
+        }
+        return work;
+    }
+
+    // After a removal, the vertices with core number r that drop to r - 1 are
+    // found by peeling lazily from the endpoints: the number of remaining
+    // neighbors with core number r or larger is only computed for the
+    // vertices adjacent to those that were already evicted.
+    size_t remove_edge(size_t u, size_t v, size_t r)
+    {
+        // _mark: 1 = counted, 2 = evicted, 3 = evicted and propagated
+        auto count = [&](size_t w)
+            {
+                size_t cd = 0;
+                for (auto x : _adj[w])
+                {
+                    if (_core[x] >= r && _mark[x] != 3)
+                        ++cd;
+                }
+                _cd[w] = cd;
+                _mark[w] = 1;
+                _touched.push_back(w);
+            };
+
+        _queue.clear();
+        for (auto w : {u, v})
+        {
+            if (_core[w] != r)
+                continue;
+            if (_mark[w] == 0)
+                count(w);
+            if (_mark[w] == 1 && _cd[w] < r)
+            {
+                _mark[w] = 2;
+                _queue.push_back(w);
+            }
+        }
+        while (!_queue.empty())
+        {
+            size_t w = _queue.back();
+            _queue.pop_back();
+            for (auto x : _adj[w])
+            {
+                if (x == w || _core[x] != r)
+                    continue;
+                if (_mark[x] == 0)
+                    count(x);
+                if (_mark[x] == 1 && --_cd[x] < r)
+                {
+                    _mark[x] = 2;
+                    _queue.push_back(x);
+                }
+            }
+            _mark[w] = 3;
+        }
+
+        size_t work = 0;
+        for (auto w : _touched)
+        {
+            if (_mark[w] == 3)
+                _core[w] = r - 1;
+            _mark[w] = 0;
+            work += _adj[w].size() + 1;
+        }
+        return work;
+    }
+
+    vector<vector<size_t>> _adj;
+    vector<size_t> _core, _cd, _touched, _queue;
+    size_t _num_arcs = 0;
+    vector<uint8_t> _mark;
+};
+
 } // graph_tool namespace
 
 #endif // GRAPH_KCORE_HH
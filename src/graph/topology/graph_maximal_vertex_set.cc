@@ -23,150 +23,147 @@
 
 #include "random.hh"
 
+#include <atomic>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #include <boost/python.hpp>
 
 using namespace std;
 using namespace boost;
 using namespace graph_tool;
 
-struct do_maximal_vertex_set
+// Appends to out the elements of in for which pred is true, keeping their
+// order. Each thread filters a contiguous block, and the blocks are then
+// written at the offsets given by the prefix sum of their sizes.
+template <class Pred>
+void ordered_filter(const vector<size_t>& in, vector<size_t>& out, Pred&& pred)
 {
-    template <class Graph, class VertexIndex, class VertexSet,
-              class RNG>
-    void operator()(const Graph& g, VertexIndex vertex_index, VertexSet mvs,
-                    bool high_deg, RNG& rng) const
+    size_t N = in.size();
+    vector<size_t> offset;
+    out.clear();
+    #pragma omp parallel if (N > OPENMP_MIN_THRESH)
     {
-        typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+        size_t tid = 0, nt = 1;
+        #ifdef _OPENMP
+        tid = omp_get_thread_num();
+        nt = omp_get_num_threads();
+        #endif
+
+        #pragma omp single
+        offset.assign(nt + 1, 0);
+
+        vector<size_t> local;
+        #pragma omp for schedule(static)
+        for (size_t i = 0; i < N; ++i)
+        {
+            if (pred(in[i]))
+                local.push_back(in[i]);
+        }
+        offset[tid + 1] = local.size();
 
-        VertexSet marked(vertex_index, num_vertices(g));
-        vector<vertex_t> vlist;
-        double max_deg = 0, tmp_max_deg = 0;
-        typename graph_traits<Graph>::vertex_iterator v, v_end;
-        for (tie(v, v_end) = vertices(g); v != v_end; ++v)
+        #pragma omp barrier
+        #pragma omp single
         {
-            vlist.push_back(*v);
-            mvs[*v] = marked[*v] = false;
-            max_deg = max(out_degree(*v, g), max_deg);
+            for (size_t j = 0; j < nt; ++j)
+                offset[j + 1] += offset[j];
+            out.resize(offset[nt]);
         }
 
-        vector<vertex_t> selected, tmp;
-        tmp.reserve(vlist.size());
-        selected.reserve(vlist.size());
-        while (!vlist.empty())
+        std::copy(local.begin(), local.end(), out.begin() + offset[tid]);
+    }
+}
+
+// Random-priority variant of Luby's algorithm: In every round, the undecided
+// vertices with higher priority than all their undecided neighbors join the
+// set, and their neighbors are excluded. The priorities are given by the
+// degree (larger or smaller first) and by random numbers drawn sequentially,
+// so that the result is the greedy independent set in that order,
+// independently of the number of threads.
+struct do_maximal_vertex_set
+{
+    enum : uint8_t { undecided, in_set, excluded };
+
+    template <class Graph, class VertexSet, class RNG>
+    void operator()(const Graph& g, VertexSet mvs, bool high_deg,
+                    RNG& rng) const
+    {
+        size_t N = num_vertices(g);
+        vector<uint64_t> r(N);
+        vector<size_t> vlist, tmp;
+        vlist.reserve(N);
+        for (auto v : vertices_range(g))
         {
-            selected.clear();
-            tmp.clear();
-            tmp_max_deg = 0;
+            r[v] = rng();
+            vlist.push_back(v);
+        }
+
+        // true if u is selected before v
+        auto before = [&](auto u, auto v)
+            {
+                auto ku = out_degree(u, g), kv = out_degree(v, g);
+                if (ku != kv)
+                    return high_deg ? ku > kv : ku < kv;
+                if (r[u] != r[v])
+                    return r[u] > r[v];
+                return u < v;
+            };
+
+        vector<std::atomic<uint8_t>> state(N);
+        for (auto v : vlist)
+            state[v].store(undecided, std::memory_order_relaxed);
 
+        while (!vlist.empty())
+        {
+            // a vertex that joins the set concurrently has priority over all
+            // its undecided neighbors, so that these are not affected by
+            // whether the change is already visible or not
             parallel_loop
                 (vlist,
                  [&](size_t, auto v)
                  {
-                     marked[v] = false;
-                     bool include = true;
-                     for (auto u : adjacent_vertices_range(v, g))
-                     {
-                         if (mvs[u])
-                         {
-                             include = false;
-                             break;
-                         }
-                     }
-                     if (!include)
-                         return;
-
-                     include = false;
-                     if (out_degree(v, g) > 0)
-                     {
-                         double p, r;
-                         if (high_deg)
-                             p = out_degree(v, g) / max_deg;
-                         else
-                             p = 1. / (2 * out_degree(v, g));
-
-
-                         uniform_real_distribution<> sample(0, 1);
-                         auto& rng_ = rng; // workaround clang
-                         #pragma omp critical
-                         {
-                             r = sample(rng_);
-                         }
-                         if (r < p)
-                             include = true;
-                     }
-                     else
-                     {
-                         include = true;
-                     }
-
-                     if (include)
+                     for (auto u : out_neighbors_range(v, g))
                      {
-                         marked[v] = true;
-                         auto& selected_ = selected; // workaround clang
-                         #pragma omp critical (selected)
-                         {
-                             selected_.push_back(v);
-                         }
-                     }
-                     else
-                     {
-                         auto& tmp_ = tmp;                 // workaround clang
-                         auto& tmp_max_deg_ = tmp_max_deg;
-                         #pragma omp critical (tmp)
-                         {
-                             tmp_.push_back(v);
-                             tmp_max_deg_ = max(tmp_max_deg_, out_degree(v, g));
-                         }
+                         if (u == v)
+                             continue;
+                         auto s = state[u].load(std::memory_order_relaxed);
+                         if (s == in_set || (s == undecided && before(u, v)))
+                             return;
                      }
+                     state[v].store(in_set, std::memory_order_relaxed);
                  });
 
             parallel_loop
-                (selected,
+                (vlist,
                  [&](size_t, auto v)
                  {
-                     bool include = true;
-                     for (auto u : adjacent_vertices_range(v, g))
-                     {
-                         if (u == v)  //skip self-loops
-                             continue;
-                         if (mvs[u])
-                         {
-                             include = false;
-                             break;
-                         }
-
-                         if (marked[u])
-                         {
-                             bool inc = ((high_deg && (out_degree(v, g) >
-                                                       out_degree(u, g))) ||
-                                         (!high_deg && (out_degree(v, g) <
-                                                   out_degree(u, g))));
-                             if (out_degree(v, g) == out_degree(u, g))
-                                 inc = v < u;
-                             include = include && inc;
-                         }
-                     }
-
-                     if (include)
-                     {
-                         mvs[v] = true;
-                     }
-                     else
+                     if (state[v].load(std::memory_order_relaxed) != in_set)
+                         return;
+                     for (auto u : out_neighbors_range(v, g))
                      {
-                         auto& tmp_ = tmp;                 // workaround clang
-                         auto& tmp_max_deg_ = tmp_max_deg;
-                         #pragma omp critical (tmp)
-                         {
-                             tmp_.push_back(v);
-                             tmp_max_deg_ = max(tmp_max_deg_, out_degree(v, g));
-                         }
+                         if (u != v)
+                             state[u].store(excluded,
+                                            std::memory_order_relaxed);
                      }
-                     marked[v] = false;
                  });
 
-            vlist = tmp;
-            max_deg = tmp_max_deg;
+            ordered_filter(vlist, tmp,
+                           [&](auto v)
+                           {
+                               return (state[v].load(std::memory_order_relaxed)
+                                       == undecided);
+                           });
+            vlist.swap(tmp);
         }
+
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 mvs[v] = state[v].load(std::memory_order_relaxed) == in_set;
+             });
     }
 };
 
@@ -174,7 +171,7 @@ void maximal_vertex_set(GraphInterface& gi, boost::any mvs, bool high_deg,
                         rng_t& rng)
 {
     run_action<>()
-        (gi, std::bind(do_maximal_vertex_set(), std::placeholders::_1, gi.get_vertex_index(),
+        (gi, std::bind(do_maximal_vertex_set(), std::placeholders::_1,
                        std::placeholders::_2, high_deg, std::ref(rng)),
          writable_vertex_scalar_properties())(mvs);
 }
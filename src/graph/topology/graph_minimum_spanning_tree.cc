@@ -19,46 +19,14 @@
 #include "graph.hh"
 #include "graph_properties.hh"
 
-#include <boost/graph/kruskal_min_spanning_tree.hpp>
 #include <boost/graph/prim_minimum_spanning_tree.hpp>
 
+#include "graph_minimum_spanning_tree.hh"
+
 using namespace std;
 using namespace boost;
 using namespace graph_tool;
 
-struct get_kruskal_min_span_tree
-{
-    template <class TreeMap>
-    class tree_inserter
-    {
-    public:
-        tree_inserter(TreeMap tree_map): _tree_map(tree_map) {}
-
-        tree_inserter& operator++() { return *this; }
-        tree_inserter& operator++(int) { return *this; }
-        tree_inserter& operator*() { return *this; }
-
-        tree_inserter& operator=
-        (const typename property_traits<TreeMap>::key_type& e)
-        {
-            _tree_map[e] = 1;
-            return *this;
-        }
-
-    private:
-        TreeMap _tree_map;
-    };
-
-    template <class Graph, class IndexMap, class WeightMap, class TreeMap>
-    void operator()(const Graph& g, IndexMap vertex_index, WeightMap weights,
-                    TreeMap tree_map) const
-    {
-        kruskal_minimum_spanning_tree(g, tree_inserter<TreeMap>(tree_map),
-                                      weight_map(weights).
-                                      vertex_index_map(vertex_index));
-    }
-};
-
 struct get_prim_min_span_tree
 {
     template <class Graph, class IndexMap, class WeightMap, class TreeMap>
@@ -107,10 +75,9 @@ typedef property_map_types::apply<mpl::vector<uint8_t>,
                                   mpl::bool_<false> >::type
     tree_properties;
 
-void get_kruskal_spanning_tree(GraphInterface& gi, boost::any weight_map,
+void get_boruvka_spanning_tree(GraphInterface& gi, boost::any weight_map,
                                boost::any tree_map)
 {
-
     typedef UnityPropertyMap<size_t,GraphInterface::edge_t> cweight_t;
 
     if (weight_map.empty())
@@ -120,8 +87,10 @@ void get_kruskal_spanning_tree(GraphInterface& gi, boost::any weight_map,
         weight_maps;
 
     run_action<graph_tool::detail::never_directed>()
-        (gi, std::bind(get_kruskal_min_span_tree(), std::placeholders::_1, gi.get_vertex_index(),
-                       std::placeholders::_2, std::placeholders::_3),
+        (gi, [&](auto& g, auto weights, auto tree)
+             {
+                 boruvka_min_span_tree(g, weights, tree);
+             },
          weight_maps(), writable_edge_scalar_properties())(weight_map, tree_map);
 }
 
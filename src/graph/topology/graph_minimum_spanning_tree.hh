@@ -0,0 +1,138 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+#ifndef GRAPH_MINIMUM_SPANNING_TREE_HH
+#define GRAPH_MINIMUM_SPANNING_TREE_HH
+
+#include <vector>
+#include <atomic>
+#include <limits>
+
+#include "graph_util.hh"
+#include "graph_union_find.hh"
+
+namespace graph_tool
+{
+using namespace std;
+using namespace boost;
+
+// Minimum spanning forest with Borůvka's algorithm. In each round, every
+// remaining edge is offered to the two components it connects, each of which
+// keeps its lightest edge with an atomic compare-and-swap. All these edges
+// belong to the forest, and are contracted at once with a concurrent
+// union-find structure. The edges inside a single component are dropped as
+// they are found, so that the edge list shrinks from round to round, and the
+// number of components at least halves, hence there are at most log2(V)
+// rounds. Ties are broken by the position of the edge in the graph, so that
+// the forest is unique, and does not depend on the number of threads.
+template <class Graph, class WeightMap, class TreeMap>
+void boruvka_min_span_tree(const Graph& g, WeightMap weights, TreeMap tree_map)
+{
+    typedef typename graph_traits<Graph>::edge_descriptor edge_t;
+    constexpr size_t null = numeric_limits<size_t>::max();
+
+    vector<edge_t> edges;
+    for (auto e : edges_range(g))
+        edges.push_back(e);
+
+    auto lighter = [&](size_t i, size_t j)
+        {
+            auto wi = weights[edges[i]];
+            auto wj = weights[edges[j]];
+            return wi < wj || (wi == wj && i < j);
+        };
+
+    size_t N = num_vertices(g);
+    concurrent_union_find uf(N);
+    vector<std::atomic<size_t>> best(N);
+    for (auto& b : best)
+        b.store(null, std::memory_order_relaxed);
+
+    auto offer = [&](size_t r, size_t i)
+        {
+            size_t j = best[r].load(std::memory_order_relaxed);
+            while ((j == null || lighter(i, j)) &&
+                   !best[r].compare_exchange_weak(j, i,
+                                                  std::memory_order_relaxed))
+            {}
+        };
+
+    vector<size_t> active(edges.size());
+    for (size_t i = 0; i < edges.size(); ++i)
+        active[i] = i;
+
+    size_t nt = get_openmp_threads();
+
+    while (!active.empty())
+    {
+        // each thread compacts its own chunk of the edge list in place, while
+        // offering the surviving edges
+        size_t M = active.size();
+        size_t nchunks = (M > OPENMP_MIN_THRESH) ? nt : 1;
+        vector<size_t> count(nchunks);
+        #pragma omp parallel for schedule(static) if (nchunks > 1)
+        for (size_t c = 0; c < nchunks; ++c)
+        {
+            size_t begin = (M * c) / nchunks;
+            size_t end = (M * (c + 1)) / nchunks;
+            size_t pos = begin;
+            for (size_t k = begin; k < end; ++k)
+            {
+                size_t i = active[k];
+                auto& e = edges[i];
+                size_t r = uf.find(source(e, g));
+                size_t s = uf.find(target(e, g));
+                if (r == s)
+                    continue;
+                offer(r, i);
+                offer(s, i);
+                active[pos++] = i;
+            }
+            count[c] = pos - begin;
+        }
+
+        size_t pos = 0;
+        for (size_t c = 0; c < nchunks; ++c)
+        {
+            size_t begin = (M * c) / nchunks;
+            std::move(active.begin() + begin, active.begin() + begin + count[c],
+                      active.begin() + pos);
+            pos += count[c];
+        }
+        active.resize(pos);
+        if (active.empty())
+            break;
+
+        // contract the lightest edges; the same edge may be chosen by both of
+        // its components, but only one of them will succeed in the union
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 size_t i = best[v].load(std::memory_order_relaxed);
+                 if (i == null)
+                     return;
+                 best[v].store(null, std::memory_order_relaxed);
+                 auto& e = edges[i];
+                 if (uf.unite(source(e, g), target(e, g)))
+                     tree_map[e] = 1;
+             });
+    }
+}
+
+} // graph_tool namespace
+
+#endif // GRAPH_MINIMUM_SPANNING_TREE_HH
@@ -0,0 +1,316 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_PARALLEL_COLOR_HH
+#define GRAPH_PARALLEL_COLOR_HH
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+
+#include "graph_util.hh"
+
+namespace graph_tool
+{
+using namespace std;
+using namespace boost;
+
+enum class color_priority
+{
+    random,
+    largest_first,
+    smallest_last
+};
+
+// Calls f(u) for every vertex u that must get a color different from v: its
+// neighbors and, if distance2 is true, also the neighbors of its neighbors.
+// Self-loops are ignored, and the vertices are visited once for every path
+// leading to them, so that u is visited from v exactly as many times as v is
+// visited from u.
+template <class Graph, class F>
+void for_each_color_conflict(const Graph& g, size_t v, bool distance2, F&& f)
+{
+    for (auto u : out_neighbors_range(v, g))
+    {
+        if (size_t(u) == v)
+            continue;
+        f(u);
+        if (!distance2)
+            continue;
+        for (auto w : out_neighbors_range(u, g))
+        {
+            if (size_t(w) == v || w == u)
+                continue;
+            f(w);
+        }
+    }
+}
+
+// Strict total order of the vertices used to decide which of them are
+// colored first (larger values first): A random permutation, the vertices
+// sorted by decreasing degree with random tie-breaking, or the smallest-last
+// order, where the vertices are repeatedly removed with the smallest remaining
+// degree, and colored in the reverse order of removal.
+template <class Graph, class RNG>
+void get_color_priority(const Graph& g, color_priority kind,
+                        vector<size_t>& prio, RNG& rng)
+{
+    size_t N = num_vertices(g);
+    vector<size_t> vs;
+    vs.reserve(N);
+    for (auto v : vertices_range(g))
+        vs.push_back(v);
+    std::shuffle(vs.begin(), vs.end(), rng);
+
+    prio.assign(N, 0);
+    if (kind == color_priority::random)
+    {
+        for (size_t i = 0; i < vs.size(); ++i)
+            prio[vs[i]] = i;
+        return;
+    }
+
+    vector<size_t> deg(N, 0);
+    parallel_vertex_loop
+        (g,
+         [&](auto v)
+         {
+             size_t k = 0;
+             for (auto u : out_neighbors_range(v, g))
+             {
+                 if (u != v)
+                     ++k;
+             }
+             deg[v] = k;
+         });
+
+    // counting sort by degree, keeping the random order among ties
+    size_t max_deg = 0;
+    for (auto v : vs)
+        max_deg = std::max(max_deg, deg[v]);
+    vector<size_t> bin(max_deg + 2, 0);
+    for (auto v : vs)
+        bin[deg[v] + 1]++;
+    for (size_t k = 0; k <= max_deg; ++k)
+        bin[k + 1] += bin[k];
+    vector<size_t> vert(vs.size()), pos(N);
+    for (auto v : vs)
+    {
+        pos[v] = bin[deg[v]]++;
+        vert[pos[v]] = v;
+    }
+
+    if (kind == color_priority::largest_first)
+    {
+        for (size_t i = 0; i < vert.size(); ++i)
+            prio[vert[i]] = i;
+        return;
+    }
+
+    // smallest-last: bucket peeling as in the core decomposition, but with the
+    // degrees allowed to decrease below the current core, where bin[k] is the
+    // first position of the vertices with remaining degree k
+    for (size_t k = max_deg + 1; k > 0; --k)
+        bin[k] = bin[k - 1];
+    bin[0] = 0;
+    vector<bool> removed(N, false);
+    for (size_t i = 0; i < vert.size(); ++i)
+    {
+        auto v = vert[i];
+        prio[v] = i;
+        removed[v] = true;
+        for (auto u : out_neighbors_range(v, g))
+        {
+            if (removed[u])
+                continue;
+            size_t du = deg[u];
+            size_t pu = pos[u];
+            size_t pw = std::max(bin[du], i + 1);
+            auto w = vert[pw];
+            if (u != w)
+            {
+                pos[u] = pw;
+                vert[pu] = w;
+                pos[w] = pu;
+                vert[pw] = u;
+            }
+            bin[du] = pw + 1;
+            deg[u]--;
+        }
+    }
+}
+
+// Smallest color not taken by the conflicting vertices of v, which are marked
+// with the stamp v + 1. Uncolored vertices have the maximum color value.
+template <class Graph, class ColorVec>
+size_t first_free_color(const Graph& g, size_t v, bool distance2,
+                        const ColorVec& c, vector<size_t>& mark)
+{
+    constexpr size_t none = numeric_limits<size_t>::max();
+    for_each_color_conflict
+        (g, v, distance2,
+         [&](auto u)
+         {
+             size_t k;
+             #pragma omp atomic read
+             k = c[u];
+             if (k == none)
+                 return;
+             if (k >= mark.size())
+                 mark.resize(k + 1, 0);
+             mark[k] = v + 1;
+         });
+    size_t k = 0;
+    while (k < mark.size() && mark[k] == v + 1)
+        ++k;
+    return k;
+}
+
+// Jones-Plassmann coloring: A vertex is colored as soon as all the
+// conflicting vertices with higher priority are, with the smallest color not
+// used by them. The vertices that become ready at the same time are pairwise
+// non-conflicting, and are colored in parallel. The result is identical to the
+// sequential greedy coloring in order of priority, obtained in as many rounds
+// as the longest chain of decreasing priorities.
+template <class Graph>
+void jones_plassmann_coloring(const Graph& g, const vector<size_t>& prio,
+                              bool distance2, vector<size_t>& c)
+{
+    size_t N = num_vertices(g);
+    c.assign(N, numeric_limits<size_t>::max());
+
+    vector<size_t> count(N, 0), frontier, next;
+    #pragma omp parallel if (N > OPENMP_MIN_THRESH)
+    {
+        vector<size_t> local;
+        #pragma omp for schedule(runtime) nowait
+        for (size_t v = 0; v < N; ++v)
+        {
+            if (!is_valid_vertex(v, g))
+                continue;
+            size_t k = 0;
+            for_each_color_conflict(g, v, distance2,
+                                    [&](auto u)
+                                    {
+                                        if (prio[u] > prio[v])
+                                            ++k;
+                                    });
+            count[v] = k;
+            if (k == 0)
+                local.push_back(v);
+        }
+        #pragma omp critical (jones_plassmann)
+        frontier.insert(frontier.end(), local.begin(), local.end());
+    }
+
+    while (!frontier.empty())
+    {
+        next.clear();
+        #pragma omp parallel if (frontier.size() > OPENMP_MIN_THRESH)
+        {
+            vector<size_t> mark, local;
+            #pragma omp for schedule(runtime)
+            for (size_t i = 0; i < frontier.size(); ++i)
+            {
+                auto v = frontier[i];
+                c[v] = first_free_color(g, v, distance2, c, mark);
+            }
+
+            #pragma omp for schedule(runtime) nowait
+            for (size_t i = 0; i < frontier.size(); ++i)
+            {
+                auto v = frontier[i];
+                for_each_color_conflict
+                    (g, v, distance2,
+                     [&](auto u)
+                     {
+                         if (prio[u] > prio[v])
+                             return;
+                         size_t k;
+                         #pragma omp atomic capture
+                         k = --count[u];
+                         if (k == 0)
+                             local.push_back(u);
+                     });
+            }
+            #pragma omp critical (jones_plassmann)
+            next.insert(next.end(), local.begin(), local.end());
+        }
+        frontier.swap(next);
+    }
+}
+
+// Speculative coloring (Gebremedhin-Manne): All uncolored vertices are given
+// the smallest color not used by their conflicting vertices in parallel,
+// reading the colors as they are being written. The conflicts introduced in
+// this way are then detected, also in parallel, and the vertex with lower
+// priority of every conflicting pair is colored again in the next round. The
+// vertex with highest priority is never recolored, so that this terminates.
+template <class Graph>
+void speculative_coloring(const Graph& g, const vector<size_t>& prio,
+                          bool distance2, vector<size_t>& c)
+{
+    size_t N = num_vertices(g);
+    c.assign(N, numeric_limits<size_t>::max());
+
+    vector<size_t> work, next;
+    for (auto v : vertices_range(g))
+        work.push_back(v);
+    auto cmp = [&](auto u, auto v) { return prio[u] > prio[v]; };
+
+    while (!work.empty())
+    {
+        // colored in order of priority, as far as the threads allow
+        std::sort(work.begin(), work.end(), cmp);
+        next.clear();
+        #pragma omp parallel if (work.size() > OPENMP_MIN_THRESH)
+        {
+            vector<size_t> mark, local;
+            #pragma omp for schedule(runtime)
+            for (size_t i = 0; i < work.size(); ++i)
+            {
+                auto v = work[i];
+                size_t k = first_free_color(g, v, distance2, c, mark);
+                #pragma omp atomic write
+                c[v] = k;
+            }
+
+            #pragma omp for schedule(runtime) nowait
+            for (size_t i = 0; i < work.size(); ++i)
+            {
+                auto v = work[i];
+                bool conflict = false;
+                for_each_color_conflict(g, v, distance2,
+                                        [&](auto u)
+                                        {
+                                            if (c[u] == c[v] &&
+                                                prio[u] > prio[v])
+                                                conflict = true;
+                                        });
+                if (conflict)
+                    local.push_back(v);
+            }
+            #pragma omp critical (speculative_coloring)
+            next.insert(next.end(), local.begin(), local.end());
+        }
+        work.swap(next);
+    }
+}
+
+} // graph_tool namespace
+
+#endif // GRAPH_PARALLEL_COLOR_HH
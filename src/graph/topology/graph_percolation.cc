@@ -19,6 +19,7 @@
 #include "numpy_bind.hh"
 
 #include "graph_percolation.hh"
+#include "random.hh"
 
 using namespace std;
 using namespace boost;
@@ -54,7 +55,13 @@ void percolate_edge(GraphInterface& gi, boost::any tree, boost::any size,
     multi_array_ref<uint64_t, 1> ms = get_array<uint64_t, 1>(max_size);
 
     run_action<graph_tool::detail::never_directed>()
-        (gi, [&](auto& g){ edge_percolate(g, tree_map, size_map, ms, es); })();
+        (gi, [&](auto& g)
+             {
+                 if (use_parallel(es.shape()[0]))
+                     parallel_edge_percolate(g, tree_map, size_map, ms, es);
+                 else
+                     edge_percolate(g, tree_map, size_map, ms, es);
+             })();
 }
 
 
@@ -103,8 +110,42 @@ void percolate_vertex(GraphInterface& gi, boost::any tree, boost::any size,
     multi_array_ref<uint64_t, 1> ms = get_array<uint64_t, 1>(max_size);
 
     run_action<graph_tool::detail::never_directed>()
-        (gi, [&](auto& g){ vertex_percolate(g, tree_map, size_map, visited_map,
-                                            ms, vs); })();
+        (gi, [&](auto& g)
+             {
+                 if (use_parallel(vs.shape()[0]))
+                     parallel_vertex_percolate(g, tree_map, size_map, ms, vs);
+                 else
+                     vertex_percolate(g, tree_map, size_map, visited_map,
+                                      ms, vs);
+             })();
+}
+
+void percolate_edge_batch(GraphInterface& gi, python::object orders,
+                          python::object max_size, bool random, rng_t& rng)
+{
+    multi_array_ref<uint64_t, 2> os = get_array<uint64_t, 2>(orders);
+    multi_array_ref<uint64_t, 2> ms = get_array<uint64_t, 2>(max_size);
+
+    run_action<graph_tool::detail::never_directed>()
+        (gi, [&](auto& g)
+             {
+                 edge_percolate_batch(g, gi.get_edge_index(),
+                                      gi.get_edge_index_range(), os, ms,
+                                      random, rng);
+             })();
+}
+
+void percolate_vertex_batch(GraphInterface& gi, python::object orders,
+                            python::object max_size, bool random, rng_t& rng)
+{
+    multi_array_ref<uint64_t, 2> os = get_array<uint64_t, 2>(orders);
+    multi_array_ref<uint64_t, 2> ms = get_array<uint64_t, 2>(max_size);
+
+    run_action<graph_tool::detail::never_directed>()
+        (gi, [&](auto& g)
+             {
+                 vertex_percolate_batch(g, os, ms, random, rng);
+             })();
 }
 
 #include <boost/python.hpp>
@@ -115,4 +156,6 @@ void export_percolation()
 
     def("percolate_edge", percolate_edge);
     def("percolate_vertex", percolate_vertex);
+    def("percolate_edge_batch", percolate_edge_batch);
+    def("percolate_vertex_batch", percolate_vertex_batch);
 };
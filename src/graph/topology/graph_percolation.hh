@@ -18,6 +18,15 @@
 #ifndef GRAPH_PERCOLATION_HH
 #define GRAPH_PERCOLATION_HH
 
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <limits>
+#include <boost/lexical_cast.hpp>
+
+#include "graph_util.hh"
+#include "graph_union_find.hh"
+
 namespace graph_tool
 {
 using namespace std;
@@ -123,6 +132,318 @@ void vertex_percolate(Graph& g, TreeMap tree, SizeMap size, VisitedMap visited,
     }
 }
 
+// Percolation of a single sequence of S steps, where step j inserts the
+// edges edge(i) for off(j) <= i < off(j + 1), and max_size[j] is the size of
+// the largest cluster afterwards, with the same conventions as above. The
+// edges are processed in consecutive batches: First, the edges of a batch
+// whose endpoints already belong to the same cluster are discarded in
+// parallel, since they cannot change anything, and then only the remaining
+// ones are inserted in order. The result is the same as that of the
+// sequential algorithm, but the serial part involves at most N - 1 merges,
+// plus the few edges that close a cycle inside the same batch.
+template <class Offset, class Edge, class Valid, class MaxSize>
+void parallel_percolate(concurrent_union_find& uf, vector<size_t>& size,
+                        size_t S, Offset&& off, Edge&& edge, Valid&& valid,
+                        MaxSize& max_size)
+{
+    constexpr size_t batch = 1 << 14;
+    size_t M = off(S);
+    vector<uint8_t> candidate(std::min(M, batch));
+    size_t ms = 0, j = 0;
+
+    auto finish_step = [&](size_t j)
+        {
+            max_size[j] = valid(j) ? std::max(ms, size_t(1)) : ms;
+        };
+
+    for (size_t a = 0; a < M; a += batch)
+    {
+        size_t b = std::min(a + batch, M);
+
+        #pragma omp parallel for schedule(runtime) \
+            if (b - a > OPENMP_MIN_THRESH)
+        for (size_t i = a; i < b; ++i)
+        {
+            auto e = edge(i);
+            candidate[i - a] = uf.find(e[0]) != uf.find(e[1]);
+        }
+
+        for (size_t i = a; i < b; ++i)
+        {
+            for (; off(j + 1) <= i; ++j)
+                finish_step(j);
+            if (!candidate[i - a])
+                continue;
+            auto e = edge(i);
+            size_t r = uf.find(e[0]);
+            size_t s = uf.find(e[1]);
+            if (r == s)
+                continue;
+            uf.unite(r, s);
+            size_t t = std::min(r, s);  // the new root
+            size[t] = size[r] + size[s];
+            ms = std::max(ms, size[t]);
+        }
+    }
+
+    for (; j < S; ++j)
+        finish_step(j);
+}
+
+template <class Graph, class TreeMap, class SizeMap>
+void percolate_flatten(Graph& g, concurrent_union_find& uf,
+                       vector<size_t>& csize, TreeMap tree, SizeMap size)
+{
+    parallel_vertex_loop
+        (g,
+         [&](auto v)
+         {
+             size_t r = uf.find(v);
+             tree[v] = r;
+             size[v] = csize[r];
+         });
+}
+
+template <class Graph, class TreeMap, class SizeMap, class MaxSize,
+          class Edges>
+void parallel_edge_percolate(Graph& g, TreeMap tree, SizeMap size,
+                             MaxSize& max_size, Edges& edges)
+{
+    size_t N = num_vertices(g);
+    for (size_t i = 0; i < edges.shape()[0]; ++i)
+    {
+        for (size_t j = 0; j < 2; ++j)
+        {
+            if (size_t(edges[i][j]) >= N)
+                throw ValueException("invalid vertex index: " +
+                                     lexical_cast<string>(edges[i][j]));
+        }
+    }
+
+    concurrent_union_find uf(N);
+    vector<size_t> csize(N, 1);
+    parallel_percolate(uf, csize, edges.shape()[0],
+                       [](size_t j) { return j; },
+                       [&](size_t i)
+                       {
+                           return std::array<size_t, 2>{{size_t(edges[i][0]),
+                                                    size_t(edges[i][1])}};
+                       },
+                       [](size_t) { return true; },
+                       max_size);
+    percolate_flatten(g, uf, csize, tree, size);
+}
+
+// The vertex percolation is turned into an edge percolation, where vertex v
+// in position j inserts the edges to its neighbors that appear earlier in the
+// order.
+template <class Graph, class TreeMap, class SizeMap, class MaxSize,
+          class Vertices>
+void parallel_vertex_percolate(Graph& g, TreeMap tree, SizeMap size,
+                               MaxSize& max_size, Vertices& vertices)
+{
+    size_t N = num_vertices(g);
+    size_t S = vertices.size();
+    auto is_valid = [&](size_t j)
+        {
+            size_t v = vertices[j];
+            return (v < N &&
+                    vertex(v, g) != graph_traits<Graph>::null_vertex());
+        };
+
+    // position of the first appearance of each vertex
+    vector<size_t> pos(N, numeric_limits<size_t>::max());
+    for (size_t j = S; j > 0; --j)
+    {
+        if (is_valid(j - 1))
+            pos[vertices[j - 1]] = j - 1;
+    }
+
+    vector<size_t> off(S + 1, 0);
+    #pragma omp parallel for schedule(runtime) if (S > OPENMP_MIN_THRESH)
+    for (size_t j = 0; j < S; ++j)
+    {
+        if (!is_valid(j))
+            continue;
+        size_t k = 0;
+        for (auto a : adjacent_vertices_range(vertex(vertices[j], g), g))
+        {
+            if (pos[a] < j)
+                ++k;
+        }
+        off[j + 1] = k;
+    }
+    for (size_t j = 0; j < S; ++j)
+        off[j + 1] += off[j];
+
+    vector<std::array<size_t, 2>> es(off[S]);
+    #pragma omp parallel for schedule(runtime) if (S > OPENMP_MIN_THRESH)
+    for (size_t j = 0; j < S; ++j)
+    {
+        if (!is_valid(j))
+            continue;
+        size_t v = vertices[j];
+        size_t i = off[j];
+        for (auto a : adjacent_vertices_range(vertex(v, g), g))
+        {
+            if (pos[a] < j)
+                es[i++] = {{v, size_t(a)}};
+        }
+    }
+
+    concurrent_union_find uf(N);
+    vector<size_t> csize(N, 1);
+    parallel_percolate(uf, csize, S,
+                       [&](size_t j) { return off[j]; },
+                       [&](size_t i) { return es[i]; },
+                       is_valid, max_size);
+    percolate_flatten(g, uf, csize, tree, size);
+}
+
+// Edge percolation of many orders at once, given as the rows of an (R, M)
+// array of edge indexes, or, if random == true, R uniformly random orders of
+// all the edges. The orders are distributed among the threads, each of which
+// processes them sequentially, reusing the same workspace. The value of
+// max_size[r][i] is the size of the largest cluster after the first i + 1
+// edges of order r are inserted.
+template <class Graph, class EdgeIndex, class Orders, class MaxSize,
+          class RNG>
+void edge_percolate_batch(Graph& g, EdgeIndex eindex, size_t E,
+                          Orders& orders, MaxSize& max_size, bool random,
+                          RNG& rng)
+{
+    size_t N = num_vertices(g);
+    vector<std::array<size_t, 2>> es(E, {{N, N}});
+    vector<size_t> all;
+    for (auto e : edges_range(g))
+    {
+        es[eindex[e]] = {{size_t(source(e, g)), size_t(target(e, g))}};
+        all.push_back(eindex[e]);
+    }
+
+    size_t R = max_size.shape()[0];
+    size_t M = max_size.shape()[1];
+    if (random)
+    {
+        if (M > all.size())
+            throw ValueException("too many edges per order");
+    }
+    else
+    {
+        for (size_t r = 0; r < R; ++r)
+        {
+            for (size_t i = 0; i < M; ++i)
+            {
+                size_t ei = orders[r][i];
+                if (ei >= E || es[ei][0] == N)
+                    throw ValueException("invalid edge index: " +
+                                         lexical_cast<string>(ei));
+            }
+        }
+    }
+
+    vector<typename RNG::result_type> seeds(R);
+    for (auto& seed : seeds)
+        seed = rng();
+
+    #pragma omp parallel if (R > 1 && R * M > OPENMP_MIN_THRESH)
+    {
+        union_find uf;
+        vector<size_t> order;
+        #pragma omp for schedule(runtime)
+        for (size_t r = 0; r < R; ++r)
+        {
+            uf.reset(N);
+            if (random)
+            {
+                order = all;
+                RNG rng_r(seeds[r]);
+                std::shuffle(order.begin(), order.end(), rng_r);
+            }
+            size_t ms = 0;
+            for (size_t i = 0; i < M; ++i)
+            {
+                auto& e = es[random ? order[i] : size_t(orders[r][i])];
+                ms = std::max(ms, uf.unite(e[0], e[1]));
+                max_size[r][i] = ms;
+            }
+        }
+    }
+}
+
+// Vertex percolation of many orders at once, analogous to
+// edge_percolate_batch().
+template <class Graph, class Orders, class MaxSize, class RNG>
+void vertex_percolate_batch(Graph& g, Orders& orders, MaxSize& max_size,
+                            bool random, RNG& rng)
+{
+    size_t N = num_vertices(g);
+    vector<size_t> all;
+    for (auto v : vertices_range(g))
+        all.push_back(v);
+
+    size_t R = max_size.shape()[0];
+    size_t M = max_size.shape()[1];
+    if (random)
+    {
+        if (M > all.size())
+            throw ValueException("too many vertices per order");
+    }
+    else
+    {
+        for (size_t r = 0; r < R; ++r)
+        {
+            for (size_t i = 0; i < M; ++i)
+            {
+                if (size_t(orders[r][i]) >= N)
+                    throw ValueException("invalid vertex index: " +
+                                         lexical_cast<string>(orders[r][i]));
+            }
+        }
+    }
+
+    vector<typename RNG::result_type> seeds(R);
+    for (auto& seed : seeds)
+        seed = rng();
+
+    #pragma omp parallel if (R > 1 && R * M > OPENMP_MIN_THRESH)
+    {
+        union_find uf;
+        vector<uint8_t> visited;
+        vector<size_t> order;
+        #pragma omp for schedule(runtime)
+        for (size_t r = 0; r < R; ++r)
+        {
+            uf.reset(N);
+            visited.assign(N, false);
+            if (random)
+            {
+                order = all;
+                RNG rng_r(seeds[r]);
+                std::shuffle(order.begin(), order.end(), rng_r);
+            }
+            size_t ms = 0;
+            for (size_t i = 0; i < M; ++i)
+            {
+                auto v = vertex(random ? order[i] : size_t(orders[r][i]), g);
+                if (v == graph_traits<Graph>::null_vertex())
+                {
+                    max_size[r][i] = ms;
+                    continue;
+                }
+                for (auto a : adjacent_vertices_range(v, g))
+                {
+                    if (!visited[a])
+                        continue;
+                    ms = std::max(ms, uf.unite(v, a));
+                }
+                max_size[r][i] = std::max(ms, size_t(1));
+                visited[v] = true;
+            }
+        }
+    }
+}
+
 } // graph_tool namespace
 
 #endif // GRAPH_PERCOLATION_HH
@@ -20,76 +20,121 @@
 #include "graph_properties.hh"
 
 #include "random.hh"
+#include "numpy_bind.hh"
 
-#include <boost/graph/random_spanning_tree.hpp>
+#include "graph_random_spanning_tree.hh"
 
 using namespace std;
 using namespace boost;
 using namespace graph_tool;
 
-struct get_random_span_tree
-{
-    template <class Graph, class IndexMap, class WeightMap, class TreeMap,
-              class RNG>
-    void operator()(const Graph& g, size_t root, IndexMap vertex_index,
-                    WeightMap weights, TreeMap tree_map, RNG& rng) const
-    {
-        typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
-        typedef typename graph_traits<Graph>::edge_descriptor edge_t;
-
-        unchecked_vector_property_map<vertex_t,IndexMap>
-            pred_map(vertex_index, num_vertices(g));
-        random_spanning_tree(g, rng, predecessor_map(pred_map).
-                             root_vertex(vertex(root, g)).
-                             weight_map(weights).
-                             vertex_index_map(vertex_index));
-
-        // convert the predecessor map to a tree map, and avoid trouble with
-        // parallel edges
-        parallel_vertex_loop
-                (g,
-                 [&](auto v)
-                 {
-                     vector<edge_t> edges;
-                     vector<typename property_traits<WeightMap>::value_type> ws;
-                     for (auto e : out_edges_range(v, g))
-                     {
-                         if (target(e,g) == pred_map[v])
-                         {
-                             edges.push_back(e);
-                             ws.push_back(weights[e]);
-                         }
-                     }
-                     if (!edges.empty())
-                     {
-                         edge_t e = *(edges.begin() +
-                                      size_t(min_element(ws.begin(),
-                                                         ws.end()) - ws.begin()));
-                         tree_map[e] = 1;
-                     }
-                 });
-    }
-};
-
 typedef property_map_types::apply<mpl::vector<uint8_t>,
                                   GraphInterface::edge_index_map_t,
                                   mpl::bool_<false> >::type
     tree_properties;
 
+typedef UnityPropertyMap<size_t,GraphInterface::edge_t> cweight_t;
+
+typedef mpl::push_back<writable_edge_scalar_properties, cweight_t>::type
+    weight_maps;
+
 void get_random_spanning_tree(GraphInterface& gi, size_t root,
                               boost::any weight_map, boost::any tree_map,
                               rng_t& rng)
 {
-    typedef UnityPropertyMap<size_t,GraphInterface::edge_t> cweight_t;
+    if (weight_map.empty())
+        weight_map = cweight_t();
+
+    run_action<>()
+        (gi, [&](auto& g, auto weights, auto tree)
+             {
+                 WilsonSampler sampler;
+                 sampler.build(g, gi.get_edge_index(), weights, root);
+                 vector<size_t> succ, mark;
+                 sampler.sample(succ, mark, 1, rng);
+
+                 // find the descriptors of the chosen edges
+                 parallel_vertex_loop
+                     (g,
+                      [&](auto v)
+                      {
+                          if (v == root)
+                              return;
+                          size_t i = succ[v] - sampler.position(v);
+                          for (auto e : out_edges_range(v, g))
+                          {
+                              if (i-- == 0)
+                              {
+                                  tree[e] = 1;
+                                  break;
+                              }
+                          }
+                      });
+             },
+         weight_maps(), tree_properties())(weight_map, tree_map);
+}
 
+void get_random_spanning_trees(GraphInterface& gi, size_t root,
+                               boost::any weight_map, python::object otrees,
+                               rng_t& rng)
+{
     if (weight_map.empty())
         weight_map = cweight_t();
 
-    typedef mpl::push_back<writable_edge_scalar_properties, cweight_t>::type
-        weight_maps;
+    multi_array_ref<int64_t, 2> trees = get_array<int64_t, 2>(otrees);
 
     run_action<>()
-        (gi, std::bind(get_random_span_tree(), std::placeholders::_1, root, gi.get_vertex_index(),
-            std::placeholders::_2, std::placeholders::_3, std::ref(rng)),
-         weight_maps(), tree_properties())(weight_map, tree_map);
+        (gi, [&](auto& g, auto weights)
+             {
+                 WilsonSampler sampler;
+                 sampler.build(g, gi.get_edge_index(), weights, root);
+                 if (trees.shape()[1] != sampler.num_tree_edges())
+                     throw ValueException("invalid shape of tree array");
+                 auto& vs = sampler.vertices();
+                 sampler.sample_batch
+                     (trees.shape()[0], rng,
+                      [&](size_t i, auto& succ)
+                      {
+                          size_t j = 0;
+                          for (auto v : vs)
+                          {
+                              if (v != root)
+                                  trees[i][j++] = sampler.edge_index(succ[v]);
+                          }
+                      });
+             },
+         weight_maps())(weight_map);
+}
+
+void get_random_spanning_tree_counts(GraphInterface& gi, size_t root,
+                                     boost::any weight_map, size_t n,
+                                     python::object ocounts, rng_t& rng)
+{
+    if (weight_map.empty())
+        weight_map = cweight_t();
+
+    multi_array_ref<int64_t, 1> counts = get_array<int64_t, 1>(ocounts);
+    if (counts.shape()[0] < gi.get_edge_index_range())
+        throw ValueException("invalid size of count array");
+
+    run_action<>()
+        (gi, [&](auto& g, auto weights)
+             {
+                 WilsonSampler sampler;
+                 sampler.build(g, gi.get_edge_index(), weights, root);
+                 auto& vs = sampler.vertices();
+                 sampler.sample_batch
+                     (n, rng,
+                      [&](size_t, auto& succ)
+                      {
+                          for (auto v : vs)
+                          {
+                              if (v == root)
+                                  continue;
+                              #pragma omp atomic
+                              counts[sampler.edge_index(succ[v])]++;
+                          }
+                      });
+             },
+         weight_maps())(weight_map);
 }
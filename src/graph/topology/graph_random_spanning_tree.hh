@@ -0,0 +1,239 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_RANDOM_SPANNING_TREE_HH
+#define GRAPH_RANDOM_SPANNING_TREE_HH
+
+#include <vector>
+#include <random>
+#include <limits>
+
+#include "graph_util.hh"
+
+namespace graph_tool
+{
+using namespace std;
+using namespace boost;
+
+// Samples random spanning trees with Wilson's algorithm, i.e. by adding to the
+// tree the loop-erased random walks from every vertex until they hit it. The
+// trees are rooted at a given vertex, and contain the edges that lead each
+// vertex towards the root, so that for directed graphs these are in-trees.
+// The walks are done on a compact copy of the out-edges, where the weighted
+// steps are chosen in constant time with an alias table per vertex.
+class WilsonSampler
+{
+public:
+    template <class Graph, class EdgeIndex, class WeightMap>
+    void build(const Graph& g, EdgeIndex eindex, WeightMap weight, size_t root)
+    {
+        size_t N = num_vertices(g);
+        _root = root;
+
+        _vs.clear();
+        _pos.assign(N + 1, 0);
+        for (auto v : vertices_range(g))
+        {
+            _vs.push_back(v);
+            _pos[v + 1] = out_degree(v, g);
+        }
+        for (size_t v = 0; v < N; ++v)
+            _pos[v + 1] += _pos[v];
+
+        size_t E = _pos[N];
+        _target.resize(E);
+        _edge.resize(E);
+        _prob.resize(E);
+        _alias.resize(E);
+
+        bool negative = false, stuck = false;
+        #pragma omp parallel for schedule(runtime) if (N > OPENMP_MIN_THRESH) \
+            reduction(||:negative, stuck)
+        for (size_t i = 0; i < _vs.size(); ++i)
+        {
+            auto v = _vs[i];
+            size_t p = _pos[v];
+            double W = 0;
+            for (auto e : out_edges_range(v, g))
+            {
+                double w = get(weight, e);
+                negative = negative || w < 0;
+                _target[p] = target(e, g);
+                _edge[p] = eindex[e];
+                _prob[p] = w;
+                W += w;
+                ++p;
+            }
+            if (W <= 0 && v != root)
+                stuck = true;
+        }
+
+        // the alias tables are not needed if all weights are the same
+        bool uniform = true;
+        #pragma omp parallel for schedule(runtime) if (E > OPENMP_MIN_THRESH) \
+            reduction(&&:uniform)
+        for (size_t p = 0; p < E; ++p)
+            uniform = uniform && _prob[p] == _prob[0];
+        _uniform = uniform;
+
+        if (!_uniform && !negative)
+        {
+            #pragma omp parallel if (N > OPENMP_MIN_THRESH)
+            {
+                vector<size_t> small, large;
+                #pragma omp for schedule(runtime)
+                for (size_t i = 0; i < _vs.size(); ++i)
+                    build_alias(_vs[i], small, large);
+            }
+        }
+
+        if (negative)
+            throw ValueException("edge weights must be non-negative");
+        if (stuck)
+            throw ValueException("all vertices except the root must have at "
+                                 "least one out-edge with positive weight");
+    }
+
+    size_t num_tree_edges() const
+    {
+        return _vs.empty() ? 0 : _vs.size() - 1;
+    }
+
+    // Samples a tree, where succ[v] is set to the adjacency position of the
+    // edge going out of v in the tree, for every vertex v other than the root.
+    // The vertices marked with stamp are those already in the tree, so that
+    // mark needs no initialization between samples with different stamps.
+    template <class RNG>
+    void sample(vector<size_t>& succ, vector<size_t>& mark, size_t stamp,
+                RNG& rng) const
+    {
+        size_t N = _pos.size() - 1;
+        succ.resize(N);
+        mark.resize(N, 0);
+        mark[_root] = stamp;
+        for (auto v : _vs)
+        {
+            size_t u = v;
+            while (mark[u] != stamp)
+            {
+                size_t p = step(u, rng);
+                succ[u] = p;
+                u = _target[p];
+            }
+            u = v;
+            while (mark[u] != stamp)
+            {
+                mark[u] = stamp;
+                u = _target[succ[u]];
+            }
+        }
+    }
+
+    // Samples n trees in parallel, and calls f(i, succ) for each of them,
+    // concurrently. Every tree uses its own random stream, seeded in order from
+    // rng, so that the trees do not depend on the number of threads.
+    template <class RNG, class F>
+    void sample_batch(size_t n, RNG& rng, F&& f) const
+    {
+        vector<typename RNG::result_type> seeds(n);
+        for (auto& seed : seeds)
+            seed = rng();
+
+        #pragma omp parallel if (n > 1 && _vs.size() > OPENMP_MIN_THRESH)
+        {
+            vector<size_t> succ, mark;
+            #pragma omp for schedule(runtime)
+            for (size_t i = 0; i < n; ++i)
+            {
+                RNG rng_i(seeds[i]);
+                sample(succ, mark, i + 1, rng_i);
+                f(i, succ);
+            }
+        }
+    }
+
+    const vector<size_t>& vertices() const { return _vs; }
+    size_t root() const { return _root; }
+    size_t edge_index(size_t p) const { return _edge[p]; }
+    size_t position(size_t v) const { return _pos[v]; }
+
+private:
+    // Vose's alias method, with the entries given relative to the beginning
+    // of the adjacency of v
+    void build_alias(size_t v, vector<size_t>& small, vector<size_t>& large)
+    {
+        size_t begin = _pos[v], k = _pos[v + 1] - begin;
+        double W = 0;
+        for (size_t j = 0; j < k; ++j)
+            W += _prob[begin + j];
+        if (W <= 0)
+            return;
+
+        small.clear();
+        large.clear();
+        for (size_t j = 0; j < k; ++j)
+        {
+            auto& q = _prob[begin + j];
+            q *= k / W;
+            _alias[begin + j] = j;
+            if (q < 1)
+                small.push_back(j);
+            else
+                large.push_back(j);
+        }
+        while (!small.empty() && !large.empty())
+        {
+            size_t s = small.back(), l = large.back();
+            small.pop_back();
+            auto& ql = _prob[begin + l];
+            _alias[begin + s] = l;
+            ql -= 1 - _prob[begin + s];
+            if (ql < 1)
+            {
+                large.pop_back();
+                small.push_back(l);
+            }
+        }
+        for (auto j : small)
+            _prob[begin + j] = 1;
+        for (auto j : large)
+            _prob[begin + j] = 1;
+    }
+
+    template <class RNG>
+    size_t step(size_t v, RNG& rng) const
+    {
+        size_t k = _pos[v + 1] - _pos[v];
+        std::uniform_int_distribution<size_t> sample(0, k - 1);
+        size_t p = _pos[v] + sample(rng);
+        if (_uniform)
+            return p;
+        std::uniform_real_distribution<> coin;
+        if (coin(rng) < _prob[p])
+            return p;
+        return _pos[v] + _alias[p];
+    }
+
+    size_t _root = 0;
+    bool _uniform = true;
+    vector<size_t> _vs, _pos, _target, _edge, _alias;
+    vector<double> _prob;
+};
+
+} // graph_tool namespace
+
+#endif // GRAPH_RANDOM_SPANNING_TREE_HH
@@ -0,0 +1,65 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+#include "graph.hh"
+#include "graph_filtering.hh"
+#include "graph_properties.hh"
+#include "numpy_bind.hh"
+#include "random.hh"
+
+#include "graph_reachability.hh"
+
+#include <boost/python.hpp>
+
+using namespace std;
+using namespace boost;
+using namespace graph_tool;
+
+ReachabilityIndex build_reachability_index(GraphInterface& gi, size_t k,
+                                           size_t max_closure_bytes,
+                                           rng_t& rng)
+{
+    ReachabilityIndex idx;
+    run_action<>()
+        (gi, [&](auto& g) { idx.build(g, k, max_closure_bytes, rng); })();
+    return idx;
+}
+
+bool reachability_query(ReachabilityIndex& idx, size_t u, size_t v)
+{
+    return idx.query(u, v);
+}
+
+void reachability_query_pairs(ReachabilityIndex& idx, python::object osources,
+                              python::object otargets, python::object oresult)
+{
+    auto sources = get_array<int64_t, 1>(osources);
+    auto targets = get_array<int64_t, 1>(otargets);
+    auto result = get_array<uint8_t, 1>(oresult);
+    idx.query_pairs(sources, targets, result);
+}
+
+void export_reachability()
+{
+    using namespace boost::python;
+    class_<ReachabilityIndex>("ReachabilityIndex", no_init)
+        .def("num_components", &ReachabilityIndex::num_components)
+        .def("num_arcs", &ReachabilityIndex::num_arcs)
+        .def("has_closure", &ReachabilityIndex::has_closure);
+    def("build_reachability_index", &build_reachability_index);
+    def("reachability_query", &reachability_query);
+    def("reachability_query_pairs", &reachability_query_pairs);
+};
@@ -0,0 +1,371 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+#ifndef GRAPH_REACHABILITY_HH
+#define GRAPH_REACHABILITY_HH
+
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <cstdint>
+
+#include "graph_util.hh"
+#include "graph_components.hh"
+
+namespace graph_tool
+{
+using namespace std;
+using namespace boost;
+
+// Index that answers reachability queries, i.e. whether there is a directed
+// path from u to v, without materializing the transitive closure.
+//
+// The strong components are contracted first, which results in a DAG with C
+// nodes. If its closure fits in the given memory budget, it is stored as one
+// bitset per node, which is computed by sweeping the DAG in reverse
+// topological order, in parallel for independent chunks of target nodes.
+// Each query then takes O(1) time.
+//
+// Otherwise, k GRAIL labels are computed for each node, from independent
+// randomized depth-first traversals: the label of c is the interval
+// [low(c), post(c)], where post(c) is the post-order rank of c, and low(c) is
+// the smallest rank among its descendants. If u reaches v, the label of v is
+// contained in the label of u, and the same holds for the topological levels,
+// so most negative queries are answered immediately. The remaining ones are
+// answered with a depth-first search from u which is pruned with the same
+// criteria, and typically visits only a small part of the DAG.
+class ReachabilityIndex
+{
+public:
+    template <class Graph, class RNG>
+    void build(Graph& g, size_t k, size_t max_closure_bytes, RNG& rng)
+    {
+        size_t N = num_vertices(g);
+
+        // contract the strong components (or the connected components, if
+        // the graph is undirected)
+        typedef typed_identity_property_map<size_t> vindex_t;
+        unchecked_vector_property_map<int64_t, vindex_t> comp(vindex_t(), N);
+        for (size_t v = 0; v < N; ++v)
+            comp[v] = -1;
+        vector<size_t> hist;
+        label_components()(g, comp, hist);
+        size_t C = hist.size();
+
+        _comp.resize(N);
+        for (size_t v = 0; v < N; ++v)
+            _comp[v] = (comp[v] < 0) ? null : size_t(comp[v]);
+
+        // arcs between the components, without repetitions
+        _pos.assign(C + 1, 0);
+        parallel_vertex_loop
+            (g,
+             [&](auto u)
+             {
+                 size_t cu = _comp[u];
+                 for (auto w : out_neighbors_range(u, g))
+                 {
+                     if (_comp[w] == cu)
+                         continue;
+                     #pragma omp atomic
+                     _pos[cu + 1]++;
+                 }
+             });
+        for (size_t c = 0; c < C; ++c)
+            _pos[c + 1] += _pos[c];
+        _arcs.resize(_pos[C]);
+        vector<size_t> fill(_pos.begin(), _pos.end() - 1);
+        parallel_vertex_loop
+            (g,
+             [&](auto u)
+             {
+                 size_t cu = _comp[u];
+                 for (auto w : out_neighbors_range(u, g))
+                 {
+                     if (_comp[w] == cu)
+                         continue;
+                     size_t i;
+                     #pragma omp atomic capture
+                     i = fill[cu]++;
+                     _arcs[i] = _comp[w];
+                 }
+             });
+        vector<size_t> len(C);
+        #pragma omp parallel for schedule(runtime) if (C > OPENMP_MIN_THRESH)
+        for (size_t c = 0; c < C; ++c)
+        {
+            auto begin = _arcs.begin() + _pos[c];
+            auto end = _arcs.begin() + _pos[c + 1];
+            std::sort(begin, end);
+            len[c] = std::unique(begin, end) - begin;
+        }
+        size_t pos = 0;
+        for (size_t c = 0; c < C; ++c)
+        {
+            std::move(_arcs.begin() + _pos[c], _arcs.begin() + _pos[c] + len[c],
+                      _arcs.begin() + pos);
+            _pos[c] = pos;
+            pos += len[c];
+        }
+        _pos[C] = pos;
+        _arcs.resize(pos);
+        _arcs.shrink_to_fit();
+
+        // topological order and levels, i.e. the length of the longest path
+        // from a source node
+        vector<size_t> indeg(C, 0), order;
+        order.reserve(C);
+        for (auto c : _arcs)
+            indeg[c]++;
+        for (size_t c = 0; c < C; ++c)
+        {
+            if (indeg[c] == 0)
+                order.push_back(c);
+        }
+        _level.assign(C, 0);
+        for (size_t i = 0; i < order.size(); ++i)
+        {
+            size_t c = order[i];
+            for (size_t j = _pos[c]; j < _pos[c + 1]; ++j)
+            {
+                size_t d = _arcs[j];
+                _level[d] = std::max(_level[d], _level[c] + 1);
+                if (--indeg[d] == 0)
+                    order.push_back(d);
+            }
+        }
+
+        _W = (C + 63) / 64;
+        _closure.clear();
+        _low.clear();
+        _post.clear();
+        _k = 0;
+        if (C > 0 && _W <= max_closure_bytes / (8 * C))
+            build_closure(order);
+        else
+            build_labels(order, k, rng);
+    }
+
+    size_t num_components() const { return _level.size(); }
+    size_t num_arcs() const { return _arcs.size(); }
+    bool has_closure() const { return !_closure.empty(); }
+
+    bool query(size_t u, size_t v, vector<size_t>& mark, size_t& stamp,
+               vector<size_t>& stack) const
+    {
+        if (u >= _comp.size() || v >= _comp.size() ||
+            _comp[u] == null || _comp[v] == null)
+            return false;
+        size_t cu = _comp[u];
+        size_t cv = _comp[v];
+        if (cu == cv)
+            return true;
+        if (_level[cu] >= _level[cv])
+            return false;
+        if (!_closure.empty())
+            return (_closure[cu * _W + cv / 64] >> (cv % 64)) & 1;
+        if (!contains(cu, cv))
+            return false;
+
+        // pruned depth-first search
+        if (mark.size() != _level.size())
+        {
+            mark.assign(_level.size(), 0);
+            stamp = 0;
+        }
+        ++stamp;
+        stack.clear();
+        stack.push_back(cu);
+        mark[cu] = stamp;
+        while (!stack.empty())
+        {
+            size_t c = stack.back();
+            stack.pop_back();
+            for (size_t j = _pos[c]; j < _pos[c + 1]; ++j)
+            {
+                size_t d = _arcs[j];
+                if (d == cv)
+                    return true;
+                if (mark[d] == stamp || _level[d] >= _level[cv] ||
+                    !contains(d, cv))
+                    continue;
+                mark[d] = stamp;
+                stack.push_back(d);
+            }
+        }
+        return false;
+    }
+
+    bool query(size_t u, size_t v)
+    {
+        return query(u, v, _mark, _stamp, _stack);
+    }
+
+    template <class Sources, class Targets, class Result>
+    void query_pairs(Sources& sources, Targets& targets, Result& result) const
+    {
+        size_t M = sources.size();
+        #pragma omp parallel if (M > OPENMP_MIN_THRESH)
+        {
+            vector<size_t> mark, stack;
+            size_t stamp = 0;
+            #pragma omp for schedule(runtime)
+            for (size_t i = 0; i < M; ++i)
+                result[i] = query(sources[i], targets[i], mark, stamp, stack);
+        }
+    }
+
+private:
+    static constexpr size_t null = numeric_limits<size_t>::max();
+
+    bool contains(size_t c, size_t d) const
+    {
+        for (size_t i = 0; i < _k; ++i)
+        {
+            size_t a = i * _level.size();
+            if (_low[a + d] < _low[a + c] || _post[a + d] > _post[a + c])
+                return false;
+        }
+        return true;
+    }
+
+    void build_closure(const vector<size_t>& order)
+    {
+        constexpr size_t chunk = 64;
+        size_t C = _level.size();
+        size_t nchunks = (_W + chunk - 1) / chunk;
+        _closure.assign(C * _W, 0);
+        #pragma omp parallel for schedule(runtime) if (nchunks > 1)
+        for (size_t k = 0; k < nchunks; ++k)
+        {
+            size_t w0 = k * chunk;
+            size_t w1 = std::min(w0 + chunk, _W);
+            for (size_t i = C; i > 0; --i)
+            {
+                size_t c = order[i - 1];
+                uint64_t* x = &_closure[c * _W];
+                for (size_t j = _pos[c]; j < _pos[c + 1]; ++j)
+                {
+                    const uint64_t* y = &_closure[_arcs[j] * _W];
+                    for (size_t w = w0; w < w1; ++w)
+                        x[w] |= y[w];
+                }
+                if (c / 64 >= w0 && c / 64 < w1)
+                    x[c / 64] |= uint64_t(1) << (c % 64);
+            }
+        }
+    }
+
+    template <class RNG>
+    void build_labels(const vector<size_t>& order, size_t k, RNG& rng)
+    {
+        size_t C = _level.size();
+        _k = k;
+        _low.resize(k * C);
+        _post.resize(k * C);
+
+        vector<size_t> roots;
+        for (auto c : order)
+        {
+            if (_level[c] == 0)
+                roots.push_back(c);
+        }
+
+        vector<typename RNG::result_type> seeds(k);
+        for (auto& seed : seeds)
+            seed = rng();
+
+        #pragma omp parallel if (k > 1 && C > OPENMP_MIN_THRESH)
+        {
+            vector<uint8_t> visited;
+            vector<size_t> rs;
+            vector<pair<size_t, size_t>> stack;
+            #pragma omp for schedule(runtime)
+            for (size_t i = 0; i < k; ++i)
+            {
+                RNG rng_i(seeds[i]);
+                auto low = _low.begin() + i * C;
+                auto post = _post.begin() + i * C;
+                visited.assign(C, false);
+                rs = roots;
+                std::shuffle(rs.begin(), rs.end(), rng_i);
+
+                // the children are visited cyclically from a random offset
+                auto child = [&](size_t c, size_t j)
+                    {
+                        size_t deg = _pos[c + 1] - _pos[c];
+                        size_t o = (c * 0x9e3779b97f4a7c15 + seeds[i]) % deg;
+                        return _arcs[_pos[c] + (o + j) % deg];
+                    };
+
+                size_t rank = 0;
+                for (auto r : rs)
+                {
+                    stack.clear();
+                    stack.emplace_back(r, 0);
+                    visited[r] = true;
+                    low[r] = numeric_limits<size_t>::max();
+                    while (!stack.empty())
+                    {
+                        size_t c = stack.back().first;
+                        size_t& j = stack.back().second;
+                        if (j < _pos[c + 1] - _pos[c])
+                        {
+                            size_t d = child(c, j++);
+                            if (!visited[d])
+                            {
+                                visited[d] = true;
+                                low[d] = numeric_limits<size_t>::max();
+                                stack.emplace_back(d, 0);
+                            }
+                            else
+                            {
+                                low[c] = std::min(low[c], size_t(low[d]));
+                            }
+                            continue;
+                        }
+                        post[c] = rank++;
+                        low[c] = std::min(low[c], size_t(post[c]));
+                        stack.pop_back();
+                        if (!stack.empty())
+                        {
+                            size_t p = stack.back().first;
+                            low[p] = std::min(low[p], size_t(low[c]));
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    vector<size_t> _comp;    // component of each vertex
+    vector<size_t> _pos;     // CSR offsets of the component DAG
+    vector<size_t> _arcs;    // CSR targets of the component DAG
+    vector<size_t> _level;   // topological level of each component
+    size_t _W = 0;           // 64-bit words per closure row
+    vector<uint64_t> _closure;
+    size_t _k = 0;           // number of GRAIL labels
+    vector<size_t> _low, _post;
+
+    // workspace for single queries
+    vector<size_t> _mark, _stack;
+    size_t _stamp = 0;
+};
+
+} // graph_tool namespace
+
+#endif // GRAPH_REACHABILITY_HH
@@ -18,6 +18,9 @@
 #include "graph_filtering.hh"
 #include "graph.hh"
 #include "graph_properties.hh"
+#include "random.hh"
+
+#include "graph_parallel_color.hh"
 
 #include <boost/graph/sequential_vertex_coloring.hpp>
 
@@ -49,3 +52,39 @@ size_t sequential_coloring(GraphInterface& gi, boost::any order,
          vertex_integer_properties(), int_properties())(order, color);
     return nc;
 }
+
+size_t parallel_coloring(GraphInterface& gi, boost::any color, string method,
+                         string priority, bool distance2, rng_t& rng)
+{
+    color_priority kind;
+    if (priority == "random")
+        kind = color_priority::random;
+    else if (priority == "largest_first")
+        kind = color_priority::largest_first;
+    else if (priority == "smallest_last")
+        kind = color_priority::smallest_last;
+    else
+        throw ValueException("invalid priority: " + priority);
+    if (method != "speculative" && method != "jones_plassmann")
+        throw ValueException("invalid method: " + method);
+
+    size_t nc = 0;
+    run_action<graph_tool::detail::never_directed>()
+        (gi,
+         [&](auto& g, auto c)
+         {
+             vector<size_t> prio, col;
+             get_color_priority(g, kind, prio, rng);
+             if (method == "speculative")
+                 speculative_coloring(g, prio, distance2, col);
+             else
+                 jones_plassmann_coloring(g, prio, distance2, col);
+             for (auto v : vertices_range(g))
+             {
+                 c[v] = col[v];
+                 nc = std::max(nc, col[v] + 1);
+             }
+         },
+         int_properties())(color);
+    return nc;
+}
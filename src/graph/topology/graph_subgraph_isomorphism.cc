@@ -20,7 +20,7 @@
 #include "random.hh"
 #include "coroutine.hh"
 
-#include <boost/graph/vf2_sub_graph_iso.hpp>
+#include "graph_subgraph_isomorphism.hh"
 #include <graph_python_interface.hh>
 
 using namespace graph_tool;
@@ -29,47 +29,20 @@ using namespace std;
 
 struct ListMatch
 {
-    template <class Graph1, class Graph2, class VertexMap>
-    struct GetMatch
+    template <class Graph1, class Match, class VertexMap>
+    void operator()(const Graph1& sub, Match& match, vector<VertexMap>& vmaps,
+                    size_t max_n) const
     {
-        GetMatch(const Graph1& sub, const Graph2& g, vector<VertexMap>& vmaps,
-                 size_t max_n) : _sub(sub), _g(g), _vmaps(vmaps), _max_n(max_n)
-        {}
-
-        template <class CorrespondenceMap1To2,
-                  class CorrespondenceMap2To1>
-        bool operator()(const CorrespondenceMap1To2& f,
-                        const CorrespondenceMap2To1&)
+        vector<vector<size_t>> matches;
+        match.search_parallel(max_n, matches);
+        for (auto& m : matches)
         {
-            VertexMap c_vmap(get(vertex_index, _sub));
-            auto vmap = c_vmap.get_unchecked(num_vertices(_sub));
-            for (auto v : vertices_range(_sub))
-            {
-                auto w = f[v];
-                if (w == graph_traits<Graph2>::null_vertex())
-                    return true;
-                vmap[v] = w;
-            }
-            _vmaps.push_back(c_vmap);
-            if (_max_n > 0 && _vmaps.size() >= _max_n)
-                return false;
-            return true;
+            VertexMap c_vmap(get(vertex_index, sub));
+            auto vmap = c_vmap.get_unchecked(num_vertices(sub));
+            for (auto v : vertices_range(sub))
+                vmap[v] = m[v];
+            vmaps.push_back(c_vmap);
         }
-
-        const Graph1& _sub;
-        const Graph2& _g;
-
-        vector<VertexMap>& _vmaps;
-        size_t _max_n;
-    };
-
-    template <class Graph1, class Graph2, class VertexMap>
-    GetMatch<Graph1, Graph2, VertexMap> get_match(const Graph1& sub,
-                                                  const Graph2& g,
-                                                  vector<VertexMap>& vmaps,
-                                                  size_t max_n)
-    {
-        return GetMatch<Graph1, Graph2, VertexMap>(sub, g, vmaps, max_n);
     }
 };
 
@@ -77,48 +50,25 @@ struct ListMatch
 
 typedef graph_tool::coroutines::asymmetric_coroutine<boost::python::object> coro_t;
 
+// the matches are yielded as they are found, hence the search is not done in
+// parallel in this case
 struct GenMatch
 {
     GenMatch(coro_t::push_type& yield): _yield(yield) {}
 
-    template <class Graph1, class Graph2, class VertexMap>
-    struct GetMatch
-    {
-        GetMatch(const Graph1& sub, const Graph2& g,
-                 coro_t::push_type& yield)
-            : _sub(sub), _g(g), _yield(yield)
-        {}
-
-        template <class CorrespondenceMap1To2,
-                  class CorrespondenceMap2To1>
-        bool operator()(const CorrespondenceMap1To2& f,
-                        const CorrespondenceMap2To1&)
-        {
-            VertexMap c_vmap(get(vertex_index, _sub));
-            auto vmap = c_vmap.get_unchecked(num_vertices(_sub));
-            for (auto v : vertices_range(_sub))
-            {
-                auto w = f[v];
-                if (w == graph_traits<Graph2>::null_vertex())
-                    return true;
-                vmap[v] = w;
-            }
-            _yield(boost::python::object(PythonPropertyMap<VertexMap>(c_vmap)));
-            return true;
-        }
-
-        const Graph1& _sub;
-        const Graph2& _g;
-        coro_t::push_type& _yield;
-    };
-
-    template <class Graph1, class Graph2, class VertexMap>
-    GetMatch<Graph1, Graph2, VertexMap> get_match(const Graph1& sub,
-                                                  const Graph2& g,
-                                                  vector<VertexMap>&,
-                                                  size_t)
+    template <class Graph1, class Match, class VertexMap>
+    void operator()(const Graph1& sub, Match& match, vector<VertexMap>&,
+                    size_t) const
     {
-        return GetMatch<Graph1, Graph2, VertexMap>(sub, g, _yield);
+        match.search([&](auto& m)
+                     {
+                         VertexMap c_vmap(get(vertex_index, sub));
+                         auto vmap = c_vmap.get_unchecked(num_vertices(sub));
+                         for (auto v : vertices_range(sub))
+                             vmap[v] = m[v];
+                         _yield(boost::python::object(PythonPropertyMap<VertexMap>(c_vmap)));
+                         return true;
+                     });
     }
 
     coro_t::push_type& _yield;
@@ -139,39 +89,12 @@ struct get_subgraphs
         VertexLabel vertex_label2 = any_cast<VertexLabel>(avertex_label2);
         EdgeLabel edge_label2 = any_cast<EdgeLabel>(aedge_label2);
 
-        auto matcher = m.get_match(sub, g, vmaps,max_n);
-
-        typedef typename graph_traits<Graph1>::vertex_descriptor vertex_t;
-        vector<vertex_t> vorder;
-        std::copy(vertices(sub).first, vertices(sub).second, std::back_inserter(vorder));
-        auto cmp = [&](vertex_t u, vertex_t v) -> bool
-            {return make_pair(in_degree(u, sub), out_degree(u, sub)) <
-                    make_pair(in_degree(v, sub), out_degree(v, sub));};
-        std::sort(vorder.begin(), vorder.end(), cmp);
-
-        if (iso)
-        {
-            vf2_graph_iso(sub, g, matcher, vorder,
-                          edges_equivalent(make_property_map_equivalent(edge_label1, edge_label2)).
-                          vertices_equivalent(make_property_map_equivalent(vertex_label1, vertex_label2)));
-        }
-        else
-        {
-            if (induced)
-            {
-                vf2_subgraph_iso(sub, g, matcher, vorder,
-                                 edges_equivalent(make_property_map_equivalent(edge_label1, edge_label2)).
-                                 vertices_equivalent(make_property_map_equivalent(vertex_label1, vertex_label2)));
-            }
-            else
-            {
-                vf2_subgraph_mono(sub, g, matcher, vorder,
-                                  edges_equivalent(make_property_map_equivalent(edge_label1, edge_label2)).
-                                  vertices_equivalent(make_property_map_equivalent(vertex_label1, vertex_label2)));
-            }
-        }
+        subgraph_match<Graph1, Graph2, VertexLabel, VertexLabel, EdgeLabel,
+                       EdgeLabel>
+            match(sub, g, vertex_label1, vertex_label2, edge_label1,
+                  edge_label2, induced, iso);
+        m(sub, match, vmaps, max_n);
     }
-
 };
 
 boost::python::object
@@ -0,0 +1,560 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_SUBGRAPH_ISOMORPHISM_HH
+#define GRAPH_SUBGRAPH_ISOMORPHISM_HH
+
+#include <vector>
+#include <tuple>
+#include <atomic>
+#include <algorithm>
+
+#include "graph_util.hh"
+
+#ifdef _OPENMP
+#include "omp.h"
+#endif
+
+namespace graph_tool
+{
+using namespace std;
+using namespace boost;
+
+// Search for the subgraphs of g that match a pattern graph, in the spirit of
+// the RI and VF3 algorithms [bonnici-subgraph-2013, carletti-vf3-2018]:
+//
+// 1. The candidates of each pattern vertex are computed up front, as the
+//    target vertices with the same label, large enough degrees, and a
+//    multiset of neighbor labels that contains the one of the pattern vertex.
+//
+// 2. The pattern vertices are ordered so that each one is as constrained as
+//    possible by the previous ones: Each next vertex is the one with most
+//    edges to those already ordered, with ties broken by the number of
+//    candidates. The candidates of a vertex are then generated from the
+//    neighbors of the image of one of its previously matched neighbors (its
+//    "parent").
+//
+// 3. A partial match is extended by checking that the edges (and their
+//    labels) between the new vertex and the previously matched ones are
+//    present in the target, and, for induced matches, that no others are.
+//
+// The search tree is explored in parallel, by first expanding it breadth-first
+// until there are enough partial matches, which are then extended
+// depth-first, with dynamic scheduling.
+template <class Graph1, class Graph2, class VLabel1, class VLabel2,
+          class ELabel1, class ELabel2>
+class subgraph_match
+{
+public:
+    typedef std::tuple<size_t, uint8_t, int64_t> key_t;
+
+    subgraph_match(const Graph1& sub, const Graph2& g, VLabel1 vlabel1,
+                   VLabel2 vlabel2, ELabel1 elabel1, ELabel2 elabel2,
+                   bool induced, bool iso)
+        : _sub(sub), _g(g), _vlabel1(vlabel1), _vlabel2(vlabel2),
+          _elabel1(elabel1), _elabel2(elabel2), _induced(induced || iso),
+          _iso(iso), _empty(false)
+    {
+        for (auto u : vertices_range(sub))
+            _pverts.push_back(u);
+        _n = _pverts.size();
+
+        if (_iso)
+        {
+            size_t N = 0, E1 = 0, E2 = 0;
+            for (auto v : vertices_range(g))
+            {
+                (void) v;
+                ++N;
+            }
+            for (auto e : edges_range(sub))
+            {
+                (void) e;
+                ++E1;
+            }
+            for (auto e : edges_range(g))
+            {
+                (void) e;
+                ++E2;
+            }
+            if (N != _n || E1 != E2)
+            {
+                _empty = true;
+                return;
+            }
+        }
+
+        build_candidates();
+        if (!_empty)
+            build_order();
+    }
+
+    // Calls f(m) for every match, where m[u] is the target vertex matched to
+    // pattern vertex u, until it returns false.
+    template <class F>
+    void search(F&& f)
+    {
+        if (_empty)
+            return;
+        workspace ws(*this);
+        bool stop = false;
+        extend(ws, 0,
+               [&](auto& m)
+               {
+                   if (!f(m))
+                       stop = true;
+                   return !stop;
+               });
+    }
+
+    // Collects the matches in parallel, up to max_n of them, if max_n > 0.
+    // They are returned in the same order as search() would find them,
+    // unless the search is interrupted.
+    void search_parallel(size_t max_n, vector<vector<size_t>>& matches)
+    {
+        if (_empty)
+            return;
+
+        size_t nt = get_openmp_threads();
+
+        // breadth-first expansion of the search tree
+        vector<vector<size_t>> frontier(1), next;
+        size_t depth = 0;
+        workspace ws(*this);
+        while (depth < _n && frontier.size() < 16 * nt && !frontier.empty())
+        {
+            next.clear();
+            for (auto& pm : frontier)
+            {
+                ws.set(pm);
+                candidates(ws, depth,
+                           [&](size_t v)
+                           {
+                               next.push_back(pm);
+                               next.back().push_back(v);
+                           });
+            }
+            frontier.swap(next);
+            ++depth;
+        }
+
+        vector<vector<vector<size_t>>> found(frontier.size());
+        std::atomic<size_t> count(0);
+        std::atomic<bool> stop(false);
+
+        #pragma omp parallel if (nt > 1 && frontier.size() > 1)
+        {
+            workspace tws(*this);
+            #pragma omp for schedule(dynamic, 1)
+            for (size_t i = 0; i < frontier.size(); ++i)
+            {
+                if (stop)
+                    continue;
+                tws.set(frontier[i]);
+                auto& lfound = found[i];
+                extend(tws, depth,
+                       [&](auto& m)
+                       {
+                           if (stop)
+                               return false;
+                           lfound.push_back(m);
+                           if (max_n > 0 && ++count >= max_n)
+                               stop = true;
+                           return !stop;
+                       });
+            }
+        }
+
+        for (auto& lfound : found)
+        {
+            for (auto& m : lfound)
+            {
+                if (max_n > 0 && matches.size() >= max_n)
+                    return;
+                matches.push_back(std::move(m));
+            }
+        }
+    }
+
+private:
+    // the state of a partial match
+    struct workspace
+    {
+        workspace(subgraph_match& s)
+            : _m(s._n), _match(num_vertices(s._sub)), _cands(s._n) {}
+
+        void set(const vector<size_t>& pm)
+        {
+            _mapped.clear();
+            for (size_t i = 0; i < pm.size(); ++i)
+                push(i, pm[i]);
+        }
+
+        void push(size_t i, size_t v)
+        {
+            _m[i] = v;
+            _mapped.insert(std::upper_bound(_mapped.begin(), _mapped.end(),
+                                            make_pair(v, i)),
+                           make_pair(v, i));
+        }
+
+        void pop(size_t i)
+        {
+            auto iter = std::lower_bound(_mapped.begin(), _mapped.end(),
+                                         make_pair(_m[i], i));
+            _mapped.erase(iter);
+        }
+
+        // position in the pattern order of the matched target vertex v, or
+        // numeric_limits<size_t>::max() if it is not matched
+        size_t pos(size_t v) const
+        {
+            auto iter = std::lower_bound(_mapped.begin(), _mapped.end(),
+                                         make_pair(v, size_t(0)));
+            if (iter == _mapped.end() || iter->first != v)
+                return numeric_limits<size_t>::max();
+            return iter->second;
+        }
+
+        vector<size_t> _m;                       // position -> target vertex
+        vector<size_t> _match;                   // pattern vertex -> target
+        vector<pair<size_t, size_t>> _mapped;    // sorted (target, position)
+        vector<vector<size_t>> _cands;           // candidates at each depth
+        vector<key_t> _found;
+    };
+
+    bool is_cand(size_t i, size_t v) const
+    {
+        return (_cand[i][v / 64] >> (v % 64)) & 1;
+    }
+
+    // Edges between v, placed at position i, and the previously matched
+    // vertices, as sorted (position, direction, label) tuples. The same
+    // function is used for the pattern and the target, so that self-loops and
+    // parallel edges are treated consistently.
+    template <class Graph, class ELabel, class Pos>
+    void get_keys(const Graph& g, size_t v, size_t i, ELabel& elabel,
+                  Pos&& pos, vector<key_t>& keys) const
+    {
+        keys.clear();
+        for (const auto& e : out_edges_range(v, g))
+        {
+            size_t u = target(e, g);
+            size_t j = (u == v) ? i : pos(u);
+            if (j <= i)
+                keys.emplace_back(j, 0, int64_t(get(elabel, e)));
+        }
+        if (graph_tool::is_directed(g))
+        {
+            for (const auto& e : in_edges_range(v, g))
+            {
+                size_t u = source(e, g);
+                size_t j = (u == v) ? i : pos(u);
+                if (j <= i)
+                    keys.emplace_back(j, 1, int64_t(get(elabel, e)));
+            }
+        }
+        std::sort(keys.begin(), keys.end());
+    }
+
+    // checks whether v can be matched at position i
+    bool is_feasible(workspace& ws, size_t i, size_t v) const
+    {
+        if (!is_cand(i, v) || ws.pos(v) != numeric_limits<size_t>::max())
+            return false;
+
+        auto& req = _req[i];
+        get_keys(_g, v, i, _elabel2, [&](size_t u) { return ws.pos(u); },
+                 ws._found);
+        auto& found = ws._found;
+        if (_induced)
+            return found == req;
+        return std::includes(found.begin(), found.end(), req.begin(),
+                             req.end());
+    }
+
+    // calls f(v) for every target vertex v that can extend the partial match
+    // in ws at position i
+    template <class F>
+    void candidates(workspace& ws, size_t i, F&& f) const
+    {
+        auto& cands = ws._cands[i];
+        cands.clear();
+        if (_parent[i] == numeric_limits<size_t>::max())
+        {
+            for (auto v : _cand_list[i])
+            {
+                if (is_feasible(ws, i, v))
+                    f(v);
+            }
+            return;
+        }
+
+        size_t w = ws._m[_parent[i]];
+        if (_pdir[i] == 0)
+        {
+            for (auto v : out_neighbors_range(w, _g))
+            {
+                if (is_cand(i, v))
+                    cands.push_back(v);
+            }
+        }
+        else
+        {
+            for (const auto& e : in_edges_range(w, _g))
+            {
+                size_t v = source(e, _g);
+                if (is_cand(i, v))
+                    cands.push_back(v);
+            }
+        }
+
+        // parallel edges would yield repeated candidates
+        std::sort(cands.begin(), cands.end());
+        cands.erase(std::unique(cands.begin(), cands.end()), cands.end());
+
+        for (auto v : cands)
+        {
+            if (is_feasible(ws, i, v))
+                f(v);
+        }
+    }
+
+    // depth-first extension of the partial match in ws
+    template <class F>
+    bool extend(workspace& ws, size_t i, F&& f) const
+    {
+        if (i == _n)
+        {
+            for (size_t j = 0; j < _n; ++j)
+                ws._match[_order[j]] = ws._m[j];
+            return f(ws._match);
+        }
+
+        bool cont = true;
+        candidates(ws, i,
+                   [&](size_t v)
+                   {
+                       if (!cont)
+                           return;
+                       ws.push(i, v);
+                       cont = extend(ws, i + 1, f);
+                       ws.pop(i);
+                   });
+        return cont;
+    }
+
+    // Candidate sets of the pattern vertices, filtered by label, degree and
+    // neighbor labels.
+    void build_candidates()
+    {
+        size_t N = num_vertices(_g);
+        size_t W = (N + 63) / 64;
+        size_t NS = num_vertices(_sub);
+        _cand_u.assign(NS, vector<uint64_t>(W, 0));
+
+        // sorted labels of the neighbors of each pattern vertex
+        vector<vector<int64_t>> nlabels(NS);
+        vector<size_t> kout(NS), kin(NS);
+        for (auto u : _pverts)
+        {
+            kout[u] = out_degree(u, _sub);
+            kin[u] = in_degreeS()(u, _sub);
+            get_nlabels(_sub, u, _vlabel1, nlabels[u]);
+        }
+
+        vector<int64_t> vnlabels;
+        #pragma omp parallel for schedule(runtime) if (N > OPENMP_MIN_THRESH) \
+            firstprivate(vnlabels)
+        for (size_t w = 0; w < W; ++w)
+        {
+            for (size_t v = w * 64; v < std::min((w + 1) * 64, N); ++v)
+            {
+                auto vv = vertex(v, _g);
+                if (!is_valid_vertex(vv, _g))
+                    continue;
+                size_t vout = out_degree(vv, _g);
+                size_t vin = in_degreeS()(vv, _g);
+                bool has_nlabels = false;
+                for (auto u : _pverts)
+                {
+                    if (int64_t(get(_vlabel1, u)) != int64_t(get(_vlabel2, vv)))
+                        continue;
+                    if (_iso)
+                    {
+                        if (vout != kout[u] || vin != kin[u])
+                            continue;
+                    }
+                    else
+                    {
+                        if (vout < kout[u] || vin < kin[u])
+                            continue;
+                    }
+                    if (!has_nlabels)
+                    {
+                        get_nlabels(_g, vv, _vlabel2, vnlabels);
+                        has_nlabels = true;
+                    }
+                    if (!std::includes(vnlabels.begin(), vnlabels.end(),
+                                       nlabels[u].begin(), nlabels[u].end()))
+                        continue;
+                    _cand_u[u][w] |= uint64_t(1) << (v % 64);
+                }
+            }
+        }
+
+        _ncand.assign(NS, 0);
+        for (auto u : _pverts)
+        {
+            for (auto x : _cand_u[u])
+                _ncand[u] += __builtin_popcountll(x);
+            if (_ncand[u] == 0)
+                _empty = true;
+        }
+    }
+
+    template <class Graph, class VLabel>
+    void get_nlabels(const Graph& g, size_t v, VLabel& vlabel,
+                     vector<int64_t>& labels) const
+    {
+        labels.clear();
+        if (std::is_same<VLabel, UnityPropertyMap<bool, GraphInterface::vertex_t>>::value)
+            return;
+        for (auto u : out_neighbors_range(v, g))
+            labels.push_back(get(vlabel, u));
+        if (graph_tool::is_directed(g))
+        {
+            for (const auto& e : in_edges_range(v, g))
+                labels.push_back(get(vlabel, source(e, g)));
+        }
+        std::sort(labels.begin(), labels.end());
+    }
+
+    // Matching order of the pattern vertices, their parents, and the edges
+    // that each one has to the previous ones.
+    void build_order()
+    {
+        size_t NS = num_vertices(_sub);
+        vector<size_t> order_pos(NS, numeric_limits<size_t>::max());
+        vector<size_t> nconn(NS, 0);
+        vector<size_t> deg(NS, 0);
+        for (auto u : _pverts)
+            deg[u] = out_degree(u, _sub) + in_degreeS()(u, _sub);
+
+        auto neighbors = [&](size_t u, auto&& f)
+            {
+                for (auto w : out_neighbors_range(u, _sub))
+                    f(w, 0);
+                if (graph_tool::is_directed(_sub))
+                {
+                    for (const auto& e : in_edges_range(u, _sub))
+                        f(source(e, _sub), 1);
+                }
+            };
+
+        for (size_t i = 0; i < _n; ++i)
+        {
+            size_t best = numeric_limits<size_t>::max();
+            for (auto u : _pverts)
+            {
+                if (order_pos[u] != numeric_limits<size_t>::max())
+                    continue;
+                if (best == numeric_limits<size_t>::max() ||
+                    std::make_tuple(nconn[u], -double(_ncand[u]), deg[u]) >
+                    std::make_tuple(nconn[best], -double(_ncand[best]), deg[best]))
+                    best = u;
+            }
+            order_pos[best] = i;
+            _order.push_back(best);
+            neighbors(best,
+                      [&](size_t w, int)
+                      {
+                          if (w != best)
+                              ++nconn[w];
+                      });
+        }
+
+        _parent.assign(_n, numeric_limits<size_t>::max());
+        _pdir.assign(_n, 0);
+        _req.resize(_n);
+        _cand.resize(_n);
+        _cand_list.resize(_n);
+        for (size_t i = 0; i < _n; ++i)
+        {
+            size_t u = _order[i];
+
+            // the parent is the earliest matched neighbor; the candidates are
+            // its out-neighbors if u is one of them, otherwise its
+            // in-neighbors
+            neighbors(u,
+                      [&](size_t w, int dir)
+                      {
+                          size_t j = order_pos[w];
+                          if (j >= i)
+                              return;
+                          if (_parent[i] == numeric_limits<size_t>::max() ||
+                              j < _parent[i] ||
+                              (j == _parent[i] && dir == 1))
+                          {
+                              _parent[i] = j;
+                              _pdir[i] = (dir == 1 ||
+                                          !graph_tool::is_directed(_sub)) ? 0 : 1;
+                          }
+                      });
+
+            get_keys(_sub, u, i, _elabel1,
+                     [&](size_t w) { return order_pos[w]; }, _req[i]);
+
+            _cand[i].swap(_cand_u[u]);
+            if (_parent[i] == numeric_limits<size_t>::max())
+            {
+                for (size_t w = 0; w < _cand[i].size(); ++w)
+                {
+                    for (uint64_t x = _cand[i][w]; x != 0; x &= x - 1)
+                        _cand_list[i].push_back(w * 64 + __builtin_ctzll(x));
+                }
+            }
+        }
+        _cand_u.clear();
+    }
+
+    const Graph1& _sub;
+    const Graph2& _g;
+    VLabel1 _vlabel1;
+    VLabel2 _vlabel2;
+    ELabel1 _elabel1;
+    ELabel2 _elabel2;
+    bool _induced;
+    bool _iso;
+    bool _empty;
+
+    size_t _n;
+    vector<size_t> _pverts;
+    vector<vector<uint64_t>> _cand_u;  // candidates of each pattern vertex
+    vector<size_t> _ncand;
+
+    vector<size_t> _order;             // position -> pattern vertex
+    vector<size_t> _parent;            // position -> position of the parent
+    vector<uint8_t> _pdir;             // 0: out-neighbor of the parent
+    vector<vector<key_t>> _req;        // edges to previous positions
+    vector<vector<uint64_t>> _cand;    // candidates at each position
+    vector<vector<size_t>> _cand_list; // same, for positions without parent
+};
+
+} // graph_tool namespace
+
+#endif // GRAPH_SUBGRAPH_ISOMORPHISM_HH
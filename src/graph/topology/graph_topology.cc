@@ -28,7 +28,7 @@ using namespace std;
 bool check_isomorphism(GraphInterface& gi1, GraphInterface& gi2,
                        boost::any ainv_map1, boost::any ainv_map2,
                        int64_t max_inv, boost::any aiso_map);
-void get_kruskal_spanning_tree(GraphInterface& gi, boost::any weight_map,
+void get_boruvka_spanning_tree(GraphInterface& gi, boost::any weight_map,
                                boost::any tree_map);
 void get_prim_spanning_tree(GraphInterface& gi, size_t root,
                             boost::any weight_map, boost::any tree_map);
@@ -46,11 +46,19 @@ python::object subgraph_isomorphism(GraphInterface& gi1, GraphInterface& gi2,
 double reciprocity(GraphInterface& gi);
 size_t sequential_coloring(GraphInterface& gi, boost::any order,
                            boost::any color);
+size_t parallel_coloring(GraphInterface& gi, boost::any color, string method,
+                         string priority, bool distance2, rng_t& rng);
 bool is_bipartite(GraphInterface& gi, boost::any part_map, bool find_cycle,
                   boost::python::list cycle);
 void get_random_spanning_tree(GraphInterface& gi, size_t root,
                               boost::any weight_map, boost::any tree_map,
                               rng_t& rng);
+void get_random_spanning_trees(GraphInterface& gi, size_t root,
+                               boost::any weight_map, python::object otrees,
+                               rng_t& rng);
+void get_random_spanning_tree_counts(GraphInterface& gi, size_t root,
+                                     boost::any weight_map, size_t n,
+                                     python::object ocounts, rng_t& rng);
 vector<int32_t> get_tsp(GraphInterface& gi, size_t src, boost::any weight_map);
 
 void export_components();
@@ -64,13 +72,15 @@ void export_diam();
 void export_random_matching();
 void export_maximal_vertex_set();
 void export_vertex_similarity();
+void export_contraction_hierarchy();
+void export_reachability();
 
 
 BOOST_PYTHON_MODULE(libgraph_tool_topology)
 {
     def("check_isomorphism", &check_isomorphism);
     def("subgraph_isomorphism", &subgraph_isomorphism);
-    def("get_kruskal_spanning_tree", &get_kruskal_spanning_tree);
+    def("get_boruvka_spanning_tree", &get_boruvka_spanning_tree);
     def("get_prim_spanning_tree", &get_prim_spanning_tree);
     def("topological_sort", &topological_sort);
     def("dominator_tree", &dominator_tree);
@@ -79,8 +89,11 @@ BOOST_PYTHON_MODULE(libgraph_tool_topology)
     def("maximal_planar", &maximal_planar);
     def("reciprocity", &reciprocity);
     def("sequential_coloring", &sequential_coloring);
+    def("parallel_coloring", &parallel_coloring);
     def("is_bipartite", &is_bipartite);
     def("random_spanning_tree", &get_random_spanning_tree);
+    def("random_spanning_trees", &get_random_spanning_trees);
+    def("random_spanning_tree_counts", &get_random_spanning_tree_counts);
     def("get_tsp", &get_tsp);
     export_components();
     export_kcore();
@@ -93,4 +106,6 @@ BOOST_PYTHON_MODULE(libgraph_tool_topology)
     export_random_matching();
     export_maximal_vertex_set();
     export_vertex_similarity();
+    export_contraction_hierarchy();
+    export_reachability();
 }
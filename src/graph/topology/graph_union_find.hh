@@ -0,0 +1,160 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef GRAPH_UNION_FIND_HH
+#define GRAPH_UNION_FIND_HH
+
+#include <vector>
+#include <atomic>
+#include <utility>
+
+#include "graph_util.hh"
+
+namespace graph_tool
+{
+using namespace std;
+
+// Disjoint-set forest over the integers [0, N), which can be used by many
+// threads at the same time, without locks. A tree is only ever hooked at its
+// root, with a compare-and-swap, and always below a root with a smaller
+// index. Hence the root of every tree is its smallest element, and the final
+// partition and roots do not depend on the order in which the unions were
+// made. Paths are shortened by halving during find(), which is safe to do
+// concurrently, since parents only move towards the root.
+class concurrent_union_find
+{
+public:
+    concurrent_union_find(size_t N = 0) { reset(N); }
+
+    // Turns every element into a singleton, reusing the memory if possible.
+    void reset(size_t N)
+    {
+        if (N != _parent.size())
+            vector<std::atomic<size_t>>(N).swap(_parent);
+        #pragma omp parallel for schedule(runtime) if (N > OPENMP_MIN_THRESH)
+        for (size_t v = 0; v < N; ++v)
+            _parent[v].store(v, std::memory_order_relaxed);
+    }
+
+    size_t size() const { return _parent.size(); }
+
+    size_t find(size_t v)
+    {
+        while (true)
+        {
+            size_t p = _parent[v].load(std::memory_order_relaxed);
+            if (p == v)
+                return v;
+            size_t gp = _parent[p].load(std::memory_order_relaxed);
+            if (gp != p)
+                _parent[v].store(gp, std::memory_order_relaxed);
+            v = gp;
+        }
+    }
+
+    // Joins the sets of u and v, returning true if they were different.
+    bool unite(size_t u, size_t v)
+    {
+        while (true)
+        {
+            u = find(u);
+            v = find(v);
+            if (u == v)
+                return false;
+            if (u < v)
+                std::swap(u, v);
+            size_t r = u;
+            if (_parent[u].compare_exchange_weak(r, v,
+                                                 std::memory_order_acq_rel))
+                return true;
+        }
+    }
+
+    bool is_root(size_t v) const
+    {
+        return _parent[v].load(std::memory_order_relaxed) == v;
+    }
+
+    // Points every element directly to its root. This should not be called
+    // concurrently with unite().
+    void compress()
+    {
+        size_t N = _parent.size();
+        #pragma omp parallel for schedule(runtime) if (N > OPENMP_MIN_THRESH)
+        for (size_t v = 0; v < N; ++v)
+            _parent[v].store(find(v), std::memory_order_relaxed);
+    }
+
+private:
+    vector<std::atomic<size_t>> _parent;
+};
+
+// Disjoint-set forest over the integers [0, N) for a single thread, with
+// union by size and path halving, which also keeps track of the size of
+// every set. Its memory is reused by reset(), so that the same instance can
+// serve many consecutive runs.
+class union_find
+{
+public:
+    union_find(size_t N = 0) { reset(N); }
+
+    void reset(size_t N)
+    {
+        _parent.resize(N);
+        _size.resize(N);
+        for (size_t v = 0; v < N; ++v)
+        {
+            _parent[v] = v;
+            _size[v] = 1;
+        }
+    }
+
+    size_t find(size_t v)
+    {
+        while (_parent[v] != v)
+        {
+            _parent[v] = _parent[_parent[v]];
+            v = _parent[v];
+        }
+        return v;
+    }
+
+    // Joins the sets of u and v, returning the size of the resulting set.
+    size_t unite(size_t u, size_t v)
+    {
+        u = find(u);
+        v = find(v);
+        if (u == v)
+            return _size[u];
+        if (_size[u] < _size[v])
+            std::swap(u, v);
+        _parent[v] = u;
+        _size[u] += _size[v];
+        return _size[u];
+    }
+
+    size_t set_size(size_t v) { return _size[find(v)]; }
+
+private:
+    vector<size_t> _parent;
+    vector<size_t> _size;
+};
+
+} // graph_tool namespace
+
+#endif // GRAPH_UNION_FIND_HH
@@ -20,6 +20,7 @@
 #include "graph_tool.hh"
 #include "graph_vertex_similarity.hh"
 #include "numpy_bind.hh"
+#include "random.hh"
 
 using namespace std;
 using namespace boost;
@@ -128,6 +129,164 @@ void get_inv_log_weight_similarity_pairs(GraphInterface& gi,
         (gi.get_graph_view());
 }
 
+// CSR representation of the sparse similarities
+python::object wrap_similarity_rows(vector<sim_row_t>& rows)
+{
+    vector<int64_t> indptr = {0};
+    vector<int64_t> indices;
+    vector<double> data;
+    for (auto& row : rows)
+    {
+        for (auto& x : row)
+        {
+            indices.push_back(x.first);
+            data.push_back(x.second);
+        }
+        indptr.push_back(indices.size());
+    }
+    return python::make_tuple(wrap_vector_owned(data),
+                              wrap_vector_owned(indices),
+                              wrap_vector_owned(indptr));
+}
+
+python::object get_dice_similarity_sparse(GraphInterface& gi, bool self_loop,
+                                          double threshold, size_t top)
+{
+    vector<sim_row_t> rows;
+    gt_dispatch<>()
+        ([&](auto& g)
+         {
+             if (threshold > 0 &&
+                 sparse_similarity_prefix
+                     (g, self_loop, threshold / (2 - threshold),
+                      [&](auto u, auto v, auto& mask)
+                      {
+                          return dice(u, v, self_loop, mask, g);
+                      },
+                      threshold, top, rows))
+                 return;
+             sparse_similarity_2hop
+                 (g, self_loop, [](auto) { return 1.; },
+                  [&](auto u, auto v, double c)
+                  {
+                      return 2 * c / double(out_degree(u, g) +
+                                            out_degree(v, g));
+                  },
+                  threshold, top, rows);
+         },
+         all_graph_views())
+        (gi.get_graph_view());
+    return wrap_similarity_rows(rows);
+}
+
+python::object get_jaccard_similarity_sparse(GraphInterface& gi,
+                                             bool self_loop, double threshold,
+                                             size_t top)
+{
+    vector<sim_row_t> rows;
+    gt_dispatch<>()
+        ([&](auto& g)
+         {
+             if (threshold > 0 &&
+                 sparse_similarity_prefix
+                     (g, self_loop, threshold,
+                      [&](auto u, auto v, auto& mask)
+                      {
+                          return jaccard(u, v, self_loop, mask, g);
+                      },
+                      threshold, top, rows))
+                 return;
+             sparse_similarity_2hop
+                 (g, self_loop, [](auto) { return 1.; },
+                  [&](auto u, auto v, double c)
+                  {
+                      return c / double(out_degree(u, g) + out_degree(v, g)
+                                        - c);
+                  },
+                  threshold, top, rows);
+         },
+         all_graph_views())
+        (gi.get_graph_view());
+    return wrap_similarity_rows(rows);
+}
+
+python::object get_inv_log_weight_similarity_sparse(GraphInterface& gi,
+                                                    double threshold,
+                                                    size_t top)
+{
+    vector<sim_row_t> rows;
+    gt_dispatch<>()
+        ([&](auto& g)
+         {
+             sparse_similarity_2hop
+                 (g, false,
+                  [&](auto w)
+                  {
+                      if (graph_tool::is_directed(g))
+                          return 1. / log(in_degreeS()(w, g));
+                      else
+                          return 1. / log(out_degree(w, g));
+                  },
+                  [&](auto, auto, double c) { return c; },
+                  threshold, top, rows);
+         },
+         all_graph_views())
+        (gi.get_graph_view());
+    return wrap_similarity_rows(rows);
+}
+
+typedef vprop_map_t<vector<int64_t>>::type sketch_map_t;
+
+void get_vertex_minhash(GraphInterface& gi, boost::any asketch, size_t k,
+                        size_t b, bool self_loop, rng_t& rng)
+{
+    auto sketch = any_cast<sketch_map_t>(asketch).get_unchecked();
+    uint64_t seed = std::uniform_int_distribution<uint64_t>()(rng);
+    gt_dispatch<>()
+        ([&](auto& g)
+         {
+             get_minhash(g, sketch, k, b, self_loop, seed);
+         },
+         all_graph_views())
+        (gi.get_graph_view());
+}
+
+void get_minhash_similarity_pairs(GraphInterface& gi, boost::any asketch,
+                                  size_t k, size_t b, python::object opairs,
+                                  python::object osim)
+{
+    auto sketch = any_cast<sketch_map_t>(asketch);
+    multi_array_ref<int64_t,2> pairs = get_array<int64_t,2>(opairs);
+    multi_array_ref<double,1> sim = get_array<double,1>(osim);
+
+    gt_dispatch<>()
+        ([&](auto& g)
+         {
+             minhash_pairs_similarity(g,
+                                      sketch.get_unchecked(num_vertices(g)),
+                                      k, b, pairs, sim);
+         },
+         all_graph_views())
+        (gi.get_graph_view());
+}
+
+python::object get_minhash_candidates(GraphInterface& gi, boost::any asketch,
+                                      size_t k, size_t b, size_t bands,
+                                      size_t max_bucket)
+{
+    auto sketch = any_cast<sketch_map_t>(asketch);
+    vector<std::array<int64_t, 2>> pairs;
+    gt_dispatch<>()
+        ([&](auto& g)
+         {
+             minhash_candidates(g, sketch.get_unchecked(num_vertices(g)), k,
+                                b, bands, max_bucket, pairs);
+         },
+         all_graph_views())
+        (gi.get_graph_view());
+    return wrap_vector_owned(pairs);
+}
+
 
 void export_vertex_similarity()
 {
@@ -138,4 +297,11 @@ void export_vertex_similarity()
     python::def("inv_log_weight_similarity", &get_inv_log_weight_similarity);
     python::def("inv_log_weight_similarity_pairs",
                 &get_inv_log_weight_similarity_pairs);
+    python::def("dice_similarity_sparse", &get_dice_similarity_sparse);
+    python::def("jaccard_similarity_sparse", &get_jaccard_similarity_sparse);
+    python::def("inv_log_weight_similarity_sparse",
+                &get_inv_log_weight_similarity_sparse);
+    python::def("vertex_minhash", &get_vertex_minhash);
+    python::def("minhash_similarity_pairs", &get_minhash_similarity_pairs);
+    python::def("minhash_candidates", &get_minhash_candidates);
 };
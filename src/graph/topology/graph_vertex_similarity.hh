@@ -18,6 +18,16 @@
 #ifndef GRAPH_VERTEX_SIMILARITY_HH
 #define GRAPH_VERTEX_SIMILARITY_HH
 
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <array>
+#include <limits>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #include "graph_util.hh"
 
 namespace graph_tool
@@ -127,6 +137,509 @@ void some_pairs_similarity(Graph& g, Vlist& vlist, Slist& slist, Sim&& f)
          });
 }
 
+// Sparse similarities: only the pairs of vertices that share at least one
+// neighbor can have a nonzero similarity, so instead of comparing every vertex
+// against all others, the candidates are generated from the 2-hop
+// neighborhoods, and only the best (or above-threshold) values are kept for
+// each vertex.
+
+typedef vector<pair<size_t, double>> sim_row_t;
+
+// Keeps only the entries with similarity larger or equal to threshold, and at
+// most the top of those with largest similarity (if top > 0), ordered by
+// vertex.
+inline void similarity_truncate(sim_row_t& row, double threshold, size_t top)
+{
+    auto iter = std::remove_if(row.begin(), row.end(),
+                               [&](auto& x) { return x.second < threshold; });
+    row.erase(iter, row.end());
+    if (top > 0 && row.size() > top)
+    {
+        std::nth_element(row.begin(), row.begin() + top - 1, row.end(),
+                         [](auto& x, auto& y)
+                         {
+                             if (x.second != y.second)
+                                 return x.second > y.second;
+                             return x.first < y.first;
+                         });
+        row.resize(top);
+    }
+    std::sort(row.begin(), row.end());
+}
+
+// For every vertex v != u that shares a neighbor with u, accumulates in
+// count[v] the sum of weight(w) over the common neighbors w, and puts v in
+// touched. The common neighbors are counted with the same multiplicities as in
+// dice() and jaccard(), i.e. w is counted for each time it appears in the
+// adjacency of v, and u is considered a neighbor of itself if self_loop ==
+// true.
+template <class Graph, class Weight>
+void get_common_neighbors(Graph& g, size_t u, bool self_loop, Weight&& weight,
+                          vector<double>& count, vector<size_t>& touched,
+                          vector<bool>& mark, vector<size_t>& ws)
+{
+    for (auto w : adjacent_vertices_range(u, g))
+    {
+        if (mark[w])
+            continue;
+        mark[w] = true;
+        ws.push_back(w);
+    }
+    if (self_loop && !mark[u])
+    {
+        mark[u] = true;
+        ws.push_back(u);
+    }
+
+    for (auto w : ws)
+    {
+        double x = weight(w);
+        for (auto e : in_or_out_edges_range(w, g))
+        {
+            size_t v = graph_tool::is_directed(g) ? source(e, g) :
+                target(e, g);
+            if (v == u)
+                continue;
+            if (count[v] == 0)
+                touched.push_back(v);
+            count[v] += x;
+        }
+        mark[w] = false;
+    }
+    ws.clear();
+}
+
+// Similarities of every vertex u to the vertices in its 2-hop neighborhood,
+// where f(u, v, c) computes the similarity from the accumulated weight c of
+// the common neighbors, obtained with get_common_neighbors().
+template <class Graph, class Weight, class Sim>
+void sparse_similarity_2hop(Graph& g, bool self_loop, Weight&& weight,
+                            Sim&& f, double threshold, size_t top,
+                            vector<sim_row_t>& ret)
+{
+    size_t N = num_vertices(g);
+    ret.resize(N);
+    vector<double> count(N, 0);
+    vector<bool> mark(N, false);
+    vector<size_t> touched, ws;
+    #pragma omp parallel if (N > OPENMP_MIN_THRESH) \
+        firstprivate(count, mark, touched, ws)
+    parallel_vertex_loop_no_spawn
+        (g,
+         [&](auto u)
+         {
+             get_common_neighbors(g, u, self_loop, weight, count, touched,
+                                  mark, ws);
+             auto& row = ret[u];
+             for (auto v : touched)
+             {
+                 double x = f(u, v, count[v]);
+                 if (x >= threshold)
+                     row.emplace_back(v, x);
+                 count[v] = 0;
+             }
+             touched.clear();
+             similarity_truncate(row, threshold, top);
+         });
+}
+
+// Similarities above a threshold with prefix filtering [bayardo-scaling-2007].
+// The neighborhoods are seen as sets sorted by a global order of increasing
+// neighbor frequency. If the similarity of u and v is above the threshold,
+// the number of common neighbors must be at least some minimum overlap
+// c >= gamma * (k - s), which depends only on the degree k of either vertex
+// (with s = 0 for u, and s = self_loop for v, since u itself is counted as a
+// neighbor of u). In this case, the first common neighbor must appear among
+// the first |N(x)| - c + 1 neighbors of both vertices, so that only these
+// "prefixes" need to be indexed and probed. Since the frequent neighbors are
+// placed last, the hubs are mostly left out of the prefixes, and the number
+// of candidates is a small fraction of the 2-hop neighborhood. The candidates
+// are then verified exactly with f(u, v, mark).
+//
+// The bound assumes that the neighborhoods are sets. If parallel edges are
+// found, nothing is done and false is returned.
+template <class Graph, class Sim>
+bool sparse_similarity_prefix(Graph& g, bool self_loop, double gamma,
+                              Sim&& f, double threshold, size_t top,
+                              vector<sim_row_t>& ret)
+{
+    size_t N = num_vertices(g);
+
+    auto min_overlap = [&](size_t k) -> size_t
+        {
+            double c = std::ceil(gamma * k - 1e-10);
+            return std::max(c, 1.);
+        };
+
+    vector<size_t> freq(N, 0);
+    parallel_vertex_loop
+        (g,
+         [&](auto v)
+         {
+             if (graph_tool::is_directed(g))
+                 freq[v] = in_degreeS()(v, g);
+             else
+                 freq[v] = out_degree(v, g);
+         });
+    auto cmp = [&](size_t w, size_t x)
+        {
+            if (freq[w] != freq[x])
+                return freq[w] < freq[x];
+            return w < x;
+        };
+
+    // sorted neighborhoods, and prefix lengths of the indexed sets
+    vector<size_t> pos(N + 1, 0), plen(N, 0);
+    for (auto v : vertices_range(g))
+        pos[v + 1] = out_degree(v, g);
+    for (size_t v = 0; v < N; ++v)
+        pos[v + 1] += pos[v];
+    vector<size_t> nbr(pos[N]);
+
+    bool multigraph = false;
+    #pragma omp parallel if (N > OPENMP_MIN_THRESH) reduction(||:multigraph)
+    parallel_vertex_loop_no_spawn
+        (g,
+         [&](auto v)
+         {
+             auto begin = nbr.begin() + pos[v];
+             auto end = begin;
+             for (auto w : adjacent_vertices_range(v, g))
+                 *(end++) = w;
+             std::sort(begin, end, cmp);
+             if (std::adjacent_find(begin, end) != end)
+                 multigraph = true;
+             size_t k = end - begin;
+             size_t c = min_overlap(k - ((self_loop && k > 0) ? 1 : 0));
+             plen[v] = (c <= k) ? k - c + 1 : 0;
+         });
+    if (multigraph)
+        return false;
+
+    // inverted index of the prefixes
+    vector<size_t> ipos(N + 1, 0);
+    for (size_t v = 0; v < N; ++v)
+        for (size_t i = 0; i < plen[v]; ++i)
+            ipos[nbr[pos[v] + i] + 1]++;
+    for (size_t w = 0; w < N; ++w)
+        ipos[w + 1] += ipos[w];
+    vector<size_t> index(ipos[N]);
+    {
+        vector<size_t> ifill(ipos.begin(), ipos.end() - 1);
+        for (size_t v = 0; v < N; ++v)
+            for (size_t i = 0; i < plen[v]; ++i)
+                index[ifill[nbr[pos[v] + i]]++] = v;
+    }
+
+    ret.resize(N);
+    vector<bool> mark(N, false), seen(N, false);
+    vector<size_t> xs, cands;
+    #pragma omp parallel if (N > OPENMP_MIN_THRESH) \
+        firstprivate(mark, seen, xs, cands)
+    parallel_vertex_loop_no_spawn
+        (g,
+         [&](auto u)
+         {
+             // the probing set also contains u itself, if self_loop == true
+             size_t k = pos[u + 1] - pos[u];
+             xs.assign(nbr.begin() + pos[u], nbr.begin() + pos[u + 1]);
+             if (self_loop &&
+                 std::find(xs.begin(), xs.end(), size_t(u)) == xs.end())
+                 xs.insert(std::upper_bound(xs.begin(), xs.end(), size_t(u),
+                                            cmp), u);
+             size_t c = min_overlap(k);
+             if (c > xs.size())
+                 return;
+             size_t p = xs.size() - c + 1;
+
+             for (size_t i = 0; i < p; ++i)
+             {
+                 size_t w = xs[i];
+                 for (size_t j = ipos[w]; j < ipos[w + 1]; ++j)
+                 {
+                     size_t v = index[j];
+                     if (v == size_t(u) || seen[v])
+                         continue;
+                     seen[v] = true;
+                     cands.push_back(v);
+                 }
+             }
+
+             auto& row = ret[u];
+             for (auto v : cands)
+             {
+                 double x = f(u, v, mark);
+                 if (x >= threshold)
+                     row.emplace_back(v, x);
+                 seen[v] = false;
+             }
+             cands.clear();
+             similarity_truncate(row, threshold, top);
+         });
+    return true;
+}
+
+// MinHash sketches of the neighborhoods: the probability that two sets have
+// the same minimum under a random hash function is their Jaccard similarity,
+// hence the fraction of equal minima over k hash functions estimates it with
+// O(k) work per pair, from sketches of constant size. Instead of k independent
+// hashes, each neighbor is hashed only once into one of k bins, keeping the
+// minimum of each bin (one permutation hashing [li-one-2012]), and the empty
+// bins are filled with the value of the nearest non-empty bin to the left or
+// to the right (the direction being random, but fixed per bin), marked with
+// the distance [shrivastava-improved-2014], which keeps the collision
+// probability equal to the Jaccard similarity. The whole sketch is then
+// computed in time O(k + d) for a vertex of degree d.
+//
+// With b < 64 only the lowest b bits of (a hash of) each value are stored,
+// packed in 64 bit words [li-b-bit-2010], so that the sketch has k * b / 64
+// words, and k must be a multiple of 64 / b. Two b-bit values collide by
+// chance with probability 2^-b, which is corrected for in the estimate.
+
+inline uint64_t minhash_mix(uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+inline uint64_t minhash_get(const vector<int64_t>& s, size_t i, size_t b)
+{
+    if (b == 64)
+        return s[i];
+    size_t pos = i * b;
+    return (uint64_t(s[pos / 64]) >> (pos % 64)) & ((uint64_t(1) << b) - 1);
+}
+
+template <class Graph, class SMap>
+void get_minhash(Graph& g, SMap sketch, size_t k, size_t b, bool self_loop,
+                 uint64_t seed)
+{
+    constexpr uint64_t empty = numeric_limits<uint64_t>::max();
+    size_t nwords = k * b / 64;
+    uint64_t mask = (b == 64) ? empty : (uint64_t(1) << b) - 1;
+
+    // densification direction of each bin
+    vector<uint8_t> right(k);
+    for (size_t i = 0; i < k; ++i)
+        right[i] = minhash_mix(seed + i + 1) & 1;
+
+    vector<uint64_t> bins(k), vals(k);
+    #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
+        firstprivate(bins, vals)
+    parallel_vertex_loop_no_spawn
+        (g,
+         [&](auto v)
+         {
+             std::fill(bins.begin(), bins.end(), empty);
+             size_t p = k;
+             auto put = [&](size_t w)
+                 {
+                     uint64_t h = minhash_mix(w ^ seed);
+                     size_t i = ((h >> 32) * k) >> 32;
+                     bins[i] = std::min(bins[i], h & 0xffffffff);
+                     p = i;
+                 };
+             for (auto w : adjacent_vertices_range(v, g))
+                 put(w);
+             if (self_loop)
+                 put(v);
+
+             if (p == k)
+             {
+                 // no neighbors
+                 std::fill(vals.begin(), vals.end(), empty);
+             }
+             else
+             {
+                 // p is a non-empty bin; walk around the circle from it
+                 size_t last = p + k;
+                 for (size_t j = p + k - 1; j > p; --j)
+                 {
+                     size_t i = j % k;
+                     if (bins[i] != empty)
+                         last = j;
+                     else if (right[i])
+                         vals[i] = bins[last % k] | ((last - j) << 33) |
+                             (uint64_t(1) << 32);
+                 }
+                 last = p;
+                 for (size_t j = p + 1; j < p + k; ++j)
+                 {
+                     size_t i = j % k;
+                     if (bins[i] != empty)
+                         last = j;
+                     else if (!right[i])
+                         vals[i] = bins[last % k] | ((j - last) << 33);
+                 }
+                 for (size_t i = 0; i < k; ++i)
+                 {
+                     if (bins[i] != empty)
+                         vals[i] = bins[i];
+                 }
+             }
+
+             auto& s = sketch[v];
+             s.resize(nwords);
+             if (b == 64)
+             {
+                 for (size_t i = 0; i < k; ++i)
+                     s[i] = vals[i];
+             }
+             else
+             {
+                 std::fill(s.begin(), s.end(), 0);
+                 for (size_t i = 0; i < k; ++i)
+                 {
+                     size_t pos = i * b;
+                     s[pos / 64] |= (minhash_mix(vals[i]) & mask) << (pos % 64);
+                 }
+             }
+         });
+}
+
+// Estimated Jaccard similarity from two sketches with k values of b bits.
+inline double minhash_jaccard(const vector<int64_t>& s1,
+                              const vector<int64_t>& s2, size_t k, size_t b)
+{
+    size_t m = 0;
+    if (b == 64)
+    {
+        for (size_t i = 0; i < k; ++i)
+            m += (s1[i] == s2[i]);
+        return m / double(k);
+    }
+
+    // count the b-bit groups where all bits are equal
+    uint64_t first = numeric_limits<uint64_t>::max() / ((uint64_t(1) << b) - 1);
+    size_t nwords = k * b / 64;
+    for (size_t i = 0; i < nwords; ++i)
+    {
+        uint64_t x = ~(uint64_t(s1[i]) ^ uint64_t(s2[i]));
+        for (size_t l = 1; l < b; l *= 2)
+            x &= x >> l;
+        m += __builtin_popcountll(x & first);
+    }
+    double c = 1. / (uint64_t(1) << b);
+    double p = m / double(k);
+    return std::max((p - c) / (1 - c), 0.);
+}
+
+// Sketches computed with a different size, or before a vertex was added, do
+// not have the k values of b bits expected for them.
+template <class SMap>
+void check_minhash_sketch(SMap& sketch, size_t v, size_t k, size_t b)
+{
+    if (sketch[v].size() != k * b / 64)
+        throw ValueException("the sketch of vertex " +
+                             lexical_cast<string>(v) + " has " +
+                             lexical_cast<string>(sketch[v].size()) +
+                             " values, instead of " +
+                             lexical_cast<string>(k * b / 64));
+}
+
+template <class Graph, class SMap, class Vlist, class Slist>
+void minhash_pairs_similarity(Graph& g, SMap sketch, size_t k, size_t b,
+                              Vlist& vlist, Slist& slist)
+{
+    size_t N = num_vertices(g);
+    for (size_t i = 0; i < vlist.shape()[0]; ++i)
+    {
+        for (size_t j = 0; j < 2; ++j)
+        {
+            int64_t v = vlist[i][j];
+            if (v < 0 || size_t(v) >= N || !is_valid_vertex(size_t(v), g))
+                throw ValueException("invalid vertex: " +
+                                     lexical_cast<string>(v));
+            check_minhash_sketch(sketch, v, k, b);
+        }
+    }
+
+    #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH)
+    parallel_loop_no_spawn
+        (vlist,
+         [&](size_t i, const auto& val)
+         {
+             size_t u = val[0];
+             size_t v = val[1];
+             slist[i] = minhash_jaccard(sketch[u], sketch[v], k, b);
+         });
+}
+
+// Candidate pairs by locality-sensitive hashing: the k values of the sketches
+// are split in bands of r = k / bands rows, and two vertices become candidates
+// if all the values in at least one band are equal, which happens with
+// probability 1 - (1 - J^r)^bands for Jaccard similarity J. Buckets with more
+// than max_bucket vertices are ignored, if max_bucket > 0. Vertices without
+// out-neighbors are ignored. The pairs (u, v) are returned with u < v, without
+// repetitions.
+template <class Graph, class SMap>
+void minhash_candidates(Graph& g, SMap sketch, size_t k, size_t b,
+                        size_t bands, size_t max_bucket,
+                        vector<std::array<int64_t, 2>>& pairs)
+{
+    size_t r = k / bands;
+    for (auto v : vertices_range(g))
+    {
+        if (out_degree(v, g) > 0)
+            check_minhash_sketch(sketch, v, k, b);
+    }
+
+    size_t nt = get_openmp_threads();
+    vector<vector<std::array<int64_t, 2>>> tpairs(nt);
+    vector<vector<pair<uint64_t, size_t>>> tkeys(nt);
+
+    #pragma omp parallel for schedule(runtime) num_threads(nt) \
+        if (num_vertices(g) > OPENMP_MIN_THRESH)
+    for (size_t t = 0; t < bands; ++t)
+    {
+        size_t tid = 0;
+        #ifdef _OPENMP
+        tid = omp_get_thread_num();
+        #endif
+        auto& keys = tkeys[tid];
+        auto& ps = tpairs[tid];
+        keys.clear();
+        for (auto v : vertices_range(g))
+        {
+            if (out_degree(v, g) == 0)
+                continue;
+            auto& s = sketch[v];
+            uint64_t h = t;
+            for (size_t i = t * r; i < (t + 1) * r; ++i)
+                h = minhash_mix(h ^ minhash_get(s, i, b));
+            keys.emplace_back(h, v);
+        }
+        std::sort(keys.begin(), keys.end());
+        for (size_t i = 0; i < keys.size();)
+        {
+            size_t j = i + 1;
+            while (j < keys.size() && keys[j].first == keys[i].first)
+                ++j;
+            if (max_bucket == 0 || j - i <= max_bucket)
+            {
+                for (size_t l = i; l < j; ++l)
+                    for (size_t m = l + 1; m < j; ++m)
+                        ps.push_back({int64_t(keys[l].second),
+                                      int64_t(keys[m].second)});
+            }
+            i = j;
+        }
+    }
+
+    for (auto& ps : tpairs)
+    {
+        pairs.insert(pairs.end(), ps.begin(), ps.end());
+        ps.clear();
+        ps.shrink_to_fit();
+    }
+    std::sort(pairs.begin(), pairs.end());
+    pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+}
+
 } // graph_tool namespace
 
 #endif // GRAPH_VERTEX_SIMILARITY_HH
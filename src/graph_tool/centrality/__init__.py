@@ -31,12 +31,15 @@ Summary
    :nosignatures:
 
    pagerank
+   personalized_pagerank
+   DynamicPageRank
    betweenness
    central_point_dominance
    closeness
    eigenvector
    katz
    hits
+   DynamicEigenvector
    eigentrust
    trust_transitivity
 
@@ -49,14 +52,17 @@ from __future__ import division, absolute_import, print_function
 from .. dl_import import dl_import
 dl_import("from . import libgraph_tool_centrality")
 
-from .. import _prop, ungroup_vector_property, Vector_size_t
+from .. import _prop, ungroup_vector_property, group_vector_property, \
+    Vector_size_t, _get_rng
 from .. topology import shortest_distance
 import sys
 import numpy
 import numpy.linalg
+import scipy.sparse
 
-__all__ = ["pagerank", "betweenness", "central_point_dominance", "closeness",
-           "eigentrust", "eigenvector", "katz", "hits", "trust_transitivity"]
+__all__ = ["pagerank", "personalized_pagerank", "betweenness", "central_point_dominance", "closeness",
+           "eigentrust", "eigenvector", "katz", "hits", "trust_transitivity",
+           "DynamicPageRank", "DynamicEigenvector"]
 
 
 def pagerank(g, damping=0.85, pers=None, weight=None, prop=None, epsilon=1e-6,
@@ -131,7 +137,13 @@ def pagerank(g, damping=0.85, pers=None, weight=None, prop=None, epsilon=1e-6,
 
     The implemented algorithm progressively iterates the above equations, until
     it no longer changes, according to the parameter epsilon. It has a
-    topology-dependent running time.
+    topology-dependent running time. Vertices with zero out-degree (or with
+    zero total out-going weight) contribute nothing to the sums above, hence
+    the values will not sum to one if such vertices are present.
+
+    Each iteration reads the in-edges of every vertex from a contiguous
+    structure, split into blocks of source vertices small enough for the
+    values being read to remain in cache.
 
     If enabled during compilation, this algorithm runs in parallel.
 
@@ -167,6 +179,18 @@ def pagerank(g, damping=0.85, pers=None, weight=None, prop=None, epsilon=1e-6,
 
        PageRank values of the a political blogs network of [adamic-polblogs]_.
 
+    The values are the fixed point of the relation above, which can be checked
+    with the transition matrix, for a graph without vertices of zero
+    out-degree:
+
+    .. doctest:: pagerank
+
+       >>> u = gt.collection.data["polbooks"]
+       >>> x = gt.pagerank(u, epsilon=1e-10).a
+       >>> T = gt.transition(u)
+       >>> print(numpy.allclose(x, 0.15 / u.num_vertices() + 0.85 * (T @ x)))
+       True
+
     Now with a personalization vector, and edge weights:
 
     .. doctest:: pagerank
@@ -228,7 +252,277 @@ def pagerank(g, damping=0.85, pers=None, weight=None, prop=None, epsilon=1e-6,
         return prop
 
 
-def betweenness(g, pivots=None, vprop=None, eprop=None, weight=None, norm=True):
+def personalized_pagerank(g, seeds, damping=0.85, weight=None, epsilon=None,
+                          top=None, method="push", max_iter=None,
+                          batch_size=64):
+    r"""Calculate the personalized PageRank of many seed sets at once.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Graph to be used.
+    seeds : iterable
+        Seed sets for which the personalized PageRank will be computed. Each
+        element can be either a single vertex, or a list of vertices, in which
+        case the personalization is uniform over them.
+    damping : float, optional (default: 0.85)
+        Damping factor.
+    weight : :class:`~graph_tool.PropertyMap`, optional (default: None)
+        Edge weights. If omitted, a constant value of 1 will be used.
+    epsilon : float, optional (default: ``None``)
+        Convergence condition. For ``method == "push"`` the computation stops
+        when the residual of every vertex is below ``epsilon`` times its
+        out-degree (default: ``1e-4``). For ``method == "batch"`` the iteration
+        stops when the sum of the absolute changes of every vector falls below
+        ``epsilon`` (default: ``1e-6``).
+    top : int, optional (default: ``None``)
+        If provided, only the ``top`` largest values are kept for each seed set.
+    method : ``"push"`` or ``"batch"`` (optional, default: ``"push"``)
+        Algorithm to be used. See notes below.
+    max_iter : int, optional (default: None)
+        If supplied, this will limit the total number of iterations of the
+        ``"batch"`` method.
+    batch_size : int, optional (default: 64)
+        Number of vectors computed together by the ``"batch"`` method.
+
+    Returns
+    -------
+    ppr : :class:`~scipy.sparse.csr_matrix`
+        Sparse matrix of shape ``(len(seeds), N)``, where row ``i`` contains
+        the nonzero (or the ``top`` largest) PageRank values for seed set
+        ``i``.
+
+    See Also
+    --------
+    pagerank: PageRank centrality
+
+    Notes
+    -----
+    The personalized PageRank of a seed set :math:`S` is the solution of
+
+    .. math::
+
+        PR_S(v) = (1-d)\frac{[v \in S]}{|S|} + d \sum_{u \in \Gamma^{-}(v)}
+                  \frac{PR_S (u) w_{u\to v}}{d^{+}(u)},
+
+    i.e. the same as :func:`~graph_tool.centrality.pagerank` with a
+    personalization vector concentrated on :math:`S`.
+
+    With ``method == "push"``, the forward push algorithm of
+    [andersen-local-2006]_ is used, where the residual probability of each
+    vertex is repeatedly pushed to its out-neighbours. This touches only the
+    vicinity of the seeds, and requires :math:`O(1/((1-d)\epsilon))` time per
+    seed set, independently of the size of the graph.
+
+    With ``method == "batch"``, the power iteration is performed simultaneously
+    for ``batch_size`` personalization vectors, stored as an :math:`N\times k`
+    dense matrix, so that each edge is read once per iteration for all of
+    them. This requires :math:`O(Nk)` memory, and time :math:`O(E)` per
+    iteration and batch.
+
+    If enabled during compilation, this algorithm runs in parallel, over the
+    seed sets for the ``"push"`` method, and over the vertices for the
+    ``"batch"`` method.
+
+    Examples
+    --------
+
+    Each row matches :func:`~graph_tool.centrality.pagerank` with the
+    corresponding personalization vector, for both methods:
+
+    >>> g = gt.collection.data["polbooks"]
+    >>> ppr = gt.personalized_pagerank(g, [0, [2, 3]], epsilon=1e-9)
+    >>> p = g.new_vertex_property("double")
+    >>> p.a[[2, 3]] = 1 / 2
+    >>> pr = gt.pagerank(g, pers=p, epsilon=1e-10)
+    >>> print(abs(ppr.getrow(1).toarray()[0] - pr.a).max() < 1e-6)
+    True
+    >>> ppr_b = gt.personalized_pagerank(g, [0, [2, 3]], epsilon=1e-10,
+    ...                                  method="batch")
+    >>> print(abs(ppr_b - ppr).max() < 1e-6)
+    True
+
+    References
+    ----------
+    .. [andersen-local-2006] R. Andersen, F. Chung, K. Lang, "Local graph
+       partitioning using PageRank vectors", FOCS 2006.
+       :DOI:`10.1109/FOCS.2006.44`
+    """
+
+    if method not in ["push", "batch"]:
+        raise ValueError("invalid method: " + str(method))
+    if batch_size < 1:
+        raise ValueError("batch_size must be positive: " + str(batch_size))
+    if epsilon is None:
+        epsilon = 1e-4 if method == "push" else 1e-6
+    seed_ptr = [0]
+    seed_vs = []
+    for s in seeds:
+        try:
+            seed_vs.extend(int(v) for v in s)
+        except TypeError:
+            seed_vs.append(int(s))
+        seed_ptr.append(len(seed_vs))
+    seed_ptr = numpy.asarray(seed_ptr, dtype="int64")
+    seed_vs = numpy.asarray(seed_vs, dtype="int64")
+    N = g.num_vertices(ignore_filter=True)
+    if len(seed_vs) > 0 and (seed_vs.min() < 0 or seed_vs.max() >= N):
+        raise ValueError("invalid seed vertex")
+    data, indices, indptr = libgraph_tool_centrality.\
+        get_personalized_pagerank(g._Graph__graph, _prop("e", g, weight),
+                                  seed_ptr, seed_vs, damping, epsilon,
+                                  max_iter if max_iter is not None else 0,
+                                  top if top is not None else 0,
+                                  method == "push", batch_size)
+    return scipy.sparse.csr_matrix((data, indices, indptr),
+                                   shape=(len(seed_ptr) - 1, N))
+
+
+def _edge_delta(edges, weight):
+    if edges is None:
+        return (numpy.zeros((0, 2), dtype="int64"),
+                numpy.zeros(0, dtype="double"))
+    edges = numpy.asarray(edges, dtype="double")
+    if len(edges) == 0:
+        return (numpy.zeros((0, 2), dtype="int64"),
+                numpy.zeros(0, dtype="double"))
+    if edges.ndim != 2 or edges.shape[1] not in [2, 3]:
+        raise ValueError("edge list must contain (source, target) or " +
+                         "(source, target, weight) rows")
+    if edges.shape[1] == 3:
+        if weight is None:
+            raise ValueError("edge weights given, but no weight property map")
+        w = numpy.array(edges[:, 2], dtype="double")
+    else:
+        w = numpy.ones(len(edges), dtype="double")
+    return numpy.array(edges[:, :2], dtype="int64"), w
+
+
+def _apply_edge_delta(g, weight, add, add_w, remove):
+    for s, t in remove:
+        e = g.edge(s, t)
+        if e is None:
+            raise ValueError("edge (%d, %d) does not exist" % (s, t))
+        g.remove_edge(e)
+    if len(add) > 0:
+        if weight is not None:
+            g.add_edge_list(numpy.column_stack((add, add_w)), eprops=[weight])
+        else:
+            g.add_edge_list(add)
+
+
+def _update_size(g, add):
+    N = g.num_vertices(ignore_filter=True)
+    if len(add) > 0:
+        N = max(N, int(add.max()) + 1)
+    return N
+
+
+class DynamicPageRank(object):
+    r"""PageRank values maintained under batches of edge insertions and
+    removals.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Graph to be used. It will be modified by :meth:`update`.
+    damping : float, optional (default: 0.85)
+        Damping factor.
+    pers : :class:`~graph_tool.PropertyMap`, optional (default: None)
+        Personalization vector. If omitted, a constant value of :math:`1/N`
+        will be used, which is kept up to date if the number of vertices
+        changes.
+    weight : :class:`~graph_tool.PropertyMap`, optional (default: None)
+        Edge weights. If omitted, a constant value of 1 will be used.
+    epsilon : float, optional (default: 1e-6)
+        Accuracy of the maintained values. The sum of the absolute errors of
+        all vertices is kept below :math:`\epsilon/(1-d)`.
+
+    See Also
+    --------
+    pagerank: PageRank centrality
+    DynamicEigenvector: eigenvector centrality under edge updates
+
+    Notes
+    -----
+    The PageRank values :math:`PR(v)` (with the same definition as
+    :func:`~graph_tool.centrality.pagerank`) are stored together with the
+    residuals :math:`r(v)`, the difference between the two sides of the
+    PageRank equation. Whenever the residual of a vertex exceeds
+    :math:`\epsilon/N`, it is pushed to the vertex itself and to its
+    out-neighbours [andersen-local-2006]_.
+
+    When the out-edges of a vertex :math:`u` change, only the terms involving
+    :math:`u` become invalid, and the residuals of its (old and new)
+    out-neighbours are corrected exactly, in time :math:`O(k_u)`
+    [zhang-approximate-2016]_. Pushing then proceeds from these vertices
+    only, and the work done per update is typically proportional to the
+    size of the batch, not of the graph. If the number of pushes exceeds
+    that of the equivalent global computation (which happens if the batch
+    affects a large fraction of the graph), the remaining residuals are
+    instead eliminated with a few global, parallel iterations.
+
+    Both :meth:`update` and the graph must always go together: the graph is
+    modified by :meth:`update`, and it should not be modified otherwise.
+
+    Examples
+    --------
+
+    >>> g = gt.Graph(gt.collection.data["polblogs"])
+    >>> dpr = gt.DynamicPageRank(g)
+    >>> rm = [(int(e.source()), int(e.target())) for e in list(g.edges())[:10]]
+    >>> info = dpr.update(add=[(0, 1), (2, 3), (4, 5)], remove=rm)
+    >>> pr = gt.pagerank(g, epsilon=1e-10)
+    >>> print(abs(dpr.get_pagerank().a - pr.a).sum() < 1e-5)
+    True
+
+    References
+    ----------
+    .. [zhang-approximate-2016] H. Zhang, P. Lofgren, A. Goel, "Approximate
+       personalized PageRank on dynamic graphs", in Proceedings of the 22nd
+       ACM SIGKDD International Conference on Knowledge Discovery and Data
+       Mining (KDD 2016), pp. 1315-1324, :doi:`10.1145/2939672.2939804`
+    """
+
+    def __init__(self, g, damping=0.85, pers=None, weight=None, epsilon=1e-6):
+        self.g = g
+        self.weight = weight
+        self._state = libgraph_tool_centrality.\
+            build_dynamic_pagerank(g._Graph__graph, _prop("e", g, weight),
+                                   _prop("v", g, pers), damping, epsilon)
+
+    def update(self, add=None, remove=None):
+        r"""Insert the edges in ``add`` and remove those in ``remove``, both
+        in the graph and in the maintained values.
+
+        Each element of ``add`` is either a ``(source, target)`` or a
+        ``(source, target, weight)`` tuple of vertex indexes, where the latter
+        requires a weight property map. New vertices are created if
+        necessary. Each element of ``remove`` is a ``(source, target)`` pair.
+        The removals are applied before the insertions.
+
+        A dictionary is returned with the number of pushes performed
+        (``"pushes"``), the number of edges traversed (``"work"``), and the
+        number of global iterations done as a fallback (``"global_iter"``).
+        """
+        add, add_w = _edge_delta(add, self.weight)
+        remove, remove_w = _edge_delta(remove, None)
+        N = _update_size(self.g, add)
+        pushes, work, niter = libgraph_tool_centrality.\
+            dynamic_pagerank_update(self._state, add, add_w, remove, remove_w,
+                                    N)
+        _apply_edge_delta(self.g, self.weight, add, add_w, remove)
+        return dict(pushes=pushes, work=work, global_iter=niter)
+
+    def get_pagerank(self):
+        """Return a vertex property map with the current PageRank values."""
+        pr = self.g.new_vertex_property("double")
+        pr.a[:] = self._state.get_rank()
+        return pr
+
+
+def betweenness(g, pivots=None, vprop=None, eprop=None, weight=None, norm=True,
+                epsilon=None, delta=.1):
     r"""Calculate the betweenness centrality for each vertex and edge.
 
     Parameters
@@ -248,6 +542,15 @@ def betweenness(g, pivots=None, vprop=None, eprop=None, weight=None, norm=True):
         Edge property map corresponding to the weight value of each edge.
     norm : bool, optional (default: True)
         Whether or not the betweenness values should be normalized.
+    epsilon : float, optional (default: None)
+        If provided, the betweenness will be estimated by sampling shortest
+        paths between random pairs of vertices, until the absolute error of
+        every value, divided by :math:`n(n-1)` (or the normalized value, if
+        ``norm == True``), is below ``epsilon`` with probability
+        ``1-delta``. This option is incompatible with ``pivots``.
+    delta : float, optional (default: 0.1)
+        Allowed failure probability of the error bound, if ``epsilon`` is
+        given.
 
     Returns
     -------
@@ -280,13 +583,29 @@ def betweenness(g, pivots=None, vprop=None, eprop=None, weight=None, norm=True):
 
     The algorithm used here is defined in [brandes-faster-2001]_, and has a
     complexity of :math:`O(VE)` for unweighted graphs and :math:`O(VE +
-    V(V+E)\log V)` for weighted graphs. The space complexity is :math:`O(VE)`.
+    V(V+E)\log V)` for weighted graphs. No predecessor lists are stored, and
+    the space complexity is :math:`O(TV + E)`, where :math:`T` is the number of
+    threads.
 
     If the ``pivots`` parameter is given, the complexity will be instead
     :math:`O(PE)` for unweighted graphs and :math:`O(PE + P(V+E)\log V)` for
     weighted graphs, where :math:`P` is the number of pivot vertices.
 
-    If enabled during compilation, this algorithm runs in parallel.
+    If ``epsilon`` is given, the values are instead estimated by sampling
+    uniformly chosen shortest paths between uniformly chosen pairs of vertices,
+    as described in [riondato-fast-2016]_. Samples are added in batches until
+    an empirical Bernstein bound on the error of all vertices and edges falls
+    below ``epsilon``, in the spirit of [borassi-kadabra-2016]_, or until the
+    sample size of [riondato-fast-2016]_ is reached, which depends only on the
+    vertex diameter. The paths are found with a balanced bidirectional search
+    for unweighted graphs, and with Dijkstra's algorithm stopped at the target
+    otherwise. The sample size is :math:`O(\epsilon^{-2}(\log D +
+    \log(1/\delta)))`, where :math:`D` is the vertex diameter, and does not
+    depend on the size of the graph.
+
+    If enabled during compilation, this algorithm runs in parallel, with each
+    thread processing a subset of the sources (or samples) and adding its
+    contributions to the shared centralities with atomic updates.
 
     Examples
     --------
@@ -322,6 +641,29 @@ def betweenness(g, pivots=None, vprop=None, eprop=None, weight=None, norm=True):
 
        Betweenness values of the a political blogs network of [adamic-polblogs]_.
 
+    On a path of :math:`n` vertices, vertex :math:`i` lies on the shortest
+    paths between :math:`i(n-1-i)` pairs, and the edge :math:`(i, i+1)` on
+    those between :math:`(i+1)(n-1-i)` pairs:
+
+    .. doctest:: betweenness
+
+       >>> n = 50
+       >>> u = gt.lattice([n])
+       >>> vb, eb = gt.betweenness(u, norm=False)
+       >>> print((vb.a == [i * (n - 1 - i) for i in range(n)]).all())
+       True
+       >>> print(all(eb[e] == (k + 1) * (n - 1 - k) for e in u.edges()
+       ...           for k in [min(int(e.source()), int(e.target()))]))
+       True
+
+    The same values can be estimated with a prescribed accuracy:
+
+    .. doctest:: betweenness
+
+       >>> vp_s, ep_s = gt.betweenness(g, epsilon=0.01)
+       >>> print(abs(vp_s.fa - vp.fa).max() < 0.01)
+       True
+
     References
     ----------
     .. [betweenness-wikipedia] http://en.wikipedia.org/wiki/Centrality#Betweenness_centrality
@@ -330,6 +672,12 @@ def betweenness(g, pivots=None, vprop=None, eprop=None, weight=None, norm=True):
     .. [brandes-centrality-2007] U. Brandes, C. Pich, "Centrality estimation in
        large networks", Int. J. Bifurcation Chaos 17, 2303 (2007).
        :DOI:`10.1142/S0218127407018403`
+    .. [riondato-fast-2016] M. Riondato, E. M. Kornaropoulos, "Fast
+       approximation of betweenness centrality through sampling", Data Mining
+       and Knowledge Discovery 30, 438 (2016). :DOI:`10.1007/s10618-015-0423-0`
+    .. [borassi-kadabra-2016] M. Borassi, E. Natale, "KADABRA is an ADaptive
+       Algorithm for Betweenness via Random Approximation", ESA 2016.
+       :DOI:`10.4230/LIPIcs.ESA.2016.20`
     .. [adamic-polblogs] L. A. Adamic and N. Glance, "The political blogosphere
        and the 2004 US Election", in Proceedings of the WWW-2005 Workshop on the
        Weblogging Ecosystem (2005). :DOI:`10.1145/1134271.1134277`
@@ -343,6 +691,15 @@ def betweenness(g, pivots=None, vprop=None, eprop=None, weight=None, norm=True):
         nw = g.new_edge_property(eprop.value_type())
         g.copy_property(weight, nw)
         weight = nw
+    if epsilon is not None:
+        if pivots is not None:
+            raise ValueError("the options 'pivots' and 'epsilon' cannot be " +
+                             "used together")
+        libgraph_tool_centrality.\
+            get_approx_betweenness(g._Graph__graph, _prop("e", g, weight),
+                                   _prop("e", g, eprop), _prop("v", g, vprop),
+                                   epsilon, delta, norm, _get_rng())
+        return vprop, eprop
     if pivots is not None:
         pivots = numpy.asarray(pivots, dtype="uint64")
     else:
@@ -545,7 +902,8 @@ def central_point_dominance(g, betweenness):
                                        _prop("v", g, betweenness))
 
 
-def eigenvector(g, weight=None, vprop=None, epsilon=1e-6, max_iter=None):
+def eigenvector(g, weight=None, vprop=None, epsilon=1e-6, max_iter=None,
+                method="power", k=1, ncv=None, ret_info=False):
     r"""
     Calculate the eigenvector centrality of each vertex in the graph, as well as
     the largest eigenvalue.
@@ -563,14 +921,41 @@ def eigenvector(g, weight=None, vprop=None, epsilon=1e-6, max_iter=None):
         Convergence condition. The iteration will stop if the total delta of all
         vertices are below this value.
     max_iter : int, optional (default: ``None``)
-        If supplied, this will limit the total number of iterations.
+        If supplied, this will limit the total number of iterations (or
+        restarts, if ``method == "krylov"``).
+    method : ``"power"`` or ``"krylov"``, optional (default: ``"power"``)
+        If ``"power"``, the power method is used. If ``"krylov"``, the
+        thick-restart Lanczos method is used for undirected graphs, and the
+        restarted Arnoldi method for directed graphs. In this case, the
+        iteration stops when the relative residual
+        :math:`\|\mathbf{A}\mathbf{x}-\lambda\mathbf{x}\|/|\lambda|` of every
+        requested eigenpair falls below ``epsilon``.
+    k : int, optional (default: ``1``)
+        Number of leading eigenpairs to compute (requires ``method ==
+        "krylov"``).
+    ncv : int, optional (default: ``None``)
+        Dimension of the Krylov subspace used by ``method == "krylov"``. If not
+        provided, ``max(20, 2 * k + 1)`` will be used.
+    ret_info : bool, optional (default: ``False``)
+        If ``True``, a dictionary with convergence diagnostics will also be
+        returned (requires ``method == "krylov"``), with keys ``"nmv"``
+        (number of matrix-vector products), ``"restarts"``, ``"converged"``
+        and ``"residuals"`` (the absolute residual of each eigenpair).
 
     Returns
     -------
-    eigenvalue : float
-        The largest eigenvalue of the (weighted) adjacency matrix.
-    eigenvector : :class:`~graph_tool.PropertyMap`
-        A vertex property map containing the eigenvector values.
+    eigenvalue : float or :class:`numpy.ndarray`
+        The largest eigenvalue of the (weighted) adjacency matrix. If ``k >
+        1``, an array with the ``k`` eigenvalues with largest real part, in
+        decreasing order, will be returned instead. For directed graphs these
+        may be complex.
+    eigenvector : :class:`~graph_tool.PropertyMap` or :class:`numpy.ndarray`
+        A vertex property map containing the eigenvector values. If ``k > 1``,
+        an array of shape ``(N, k)`` will be returned instead, where each
+        column is an eigenvector with entries indexed by vertex index. In this
+        case ``vprop`` only holds the leading eigenvector.
+    info : dict
+        Convergence diagnostics (only returned if ``ret_info == True``).
 
     See Also
     --------
@@ -600,6 +985,12 @@ def eigenvector(g, weight=None, vprop=None, epsilon=1e-6, max_iter=None):
     parameter, and :math:`\lambda_1` and :math:`\lambda_2` are the largest and
     second largest eigenvalues of the (weighted) adjacency matrix, respectively.
 
+    If ``method == "krylov"``, a restarted Krylov method is used instead
+    [lehoucq-arpack]_ [stewart-krylov-schur]_, where the number of required
+    matrix-vector products typically scales only with
+    :math:`\sqrt{\lambda_1/(\lambda_1-\lambda_2)}`, which makes a large
+    difference for graphs with a small spectral gap.
+
     If enabled during compilation, this algorithm runs in parallel.
 
     Examples
@@ -619,6 +1010,12 @@ def eigenvector(g, weight=None, vprop=None, epsilon=1e-6, max_iter=None):
        >>> ee, x = gt.eigenvector(g, w)
        >>> print(ee)
        724.302745922...
+       >>> ees, X = gt.eigenvector(g, w, method="krylov", k=3)
+       >>> print(abs(ees[0] - ee) < 1e-3 * ee)
+       True
+       >>> v = g.get_vertices()
+       >>> print(abs(X[v, 0] - x.a[v]).max() < 1e-3)
+       True
        >>> gt.graph_draw(g, pos=g.vp["pos"], vertex_fill_color=x,
        ...               vertex_size=gt.prop_to_size(x, mi=5, ma=15),
        ...               vcmap=matplotlib.cm.gist_heat,
@@ -648,6 +1045,12 @@ def eigenvector(g, weight=None, vprop=None, epsilon=1e-6, max_iter=None):
     .. [langville-survey-2005] A. N. Langville, C. D. Meyer, "A Survey of
        Eigenvector Methods for Web Information Retrieval", SIAM Review, vol. 47,
        no. 1, pp. 135-161, 2005, :DOI:`10.1137/S0036144503424786`
+    .. [lehoucq-arpack] R. B. Lehoucq, D. C. Sorensen, C. Yang, "ARPACK
+       Users' Guide: Solution of Large-Scale Eigenvalue Problems with Implicitly
+       Restarted Arnoldi Methods", SIAM, 1998, :DOI:`10.1137/1.9780898719628`
+    .. [stewart-krylov-schur] G. W. Stewart, "A Krylov--Schur Algorithm for
+       Large Eigenproblems", SIAM Journal on Matrix Analysis and Applications,
+       vol. 23, no. 3, pp. 601-614, 2002, :DOI:`10.1137/S0895479800371529`
     .. [adamic-polblogs] L. A. Adamic and N. Glance, "The political blogosphere
        and the 2004 US Election", in Proceedings of the WWW-2005 Workshop on the
        Weblogging Ecosystem (2005). :DOI:`10.1145/1134271.1134277`
@@ -659,14 +1062,42 @@ def eigenvector(g, weight=None, vprop=None, epsilon=1e-6, max_iter=None):
         vprop.fa = 1. / g.num_vertices()
     if max_iter is None:
         max_iter = 0
-    ee = libgraph_tool_centrality.\
-         get_eigenvector(g._Graph__graph, _prop("e", g, weight),
-                         _prop("v", g, vprop), epsilon, max_iter)
-    return ee, vprop
+    if method == "power":
+        if k != 1 or ret_info:
+            raise ValueError("parameters 'k' and 'ret_info' require " +
+                             "method == 'krylov'")
+        ee = libgraph_tool_centrality.\
+             get_eigenvector(g._Graph__graph, _prop("e", g, weight),
+                             _prop("v", g, vprop), epsilon, max_iter)
+        return ee, vprop
+    elif method != "krylov":
+        raise ValueError("invalid method: " + str(method))
+
+    er, ei, Xr, Xi, info = libgraph_tool_centrality.\
+        get_eigenvector_krylov(g._Graph__graph, _prop("e", g, weight),
+                               _prop("v", g, vprop), k, ncv or 0, epsilon,
+                               max_iter, _get_rng())
+    if k == 1:
+        ret = (er[0], vprop)
+    else:
+        X = Xr.reshape((len(er), -1)).T
+        if ei.any():
+            er = er + 1j * ei
+            X = X + 1j * Xi.reshape((len(ei), -1)).T
+        ret = (er, X)
+    if ret_info:
+        ret += (_krylov_info(info),)
+    return ret
+
+
+def _krylov_info(info):
+    nmv, restarts, converged, residuals = info
+    return dict(nmv=nmv, restarts=restarts, converged=converged,
+                residuals=residuals)
 
 
 def katz(g, alpha=0.01, beta=None, weight=None, vprop=None, epsilon=1e-6,
-         max_iter=None, norm=True):
+         max_iter=None, norm=True, method="power", ncv=None, ret_info=False):
     r"""
     Calculate the Katz centrality of each vertex in the graph.
 
@@ -692,11 +1123,27 @@ def katz(g, alpha=0.01, beta=None, weight=None, vprop=None, epsilon=1e-6,
         If supplied, this will limit the total number of iterations.
     norm : bool, optional (default: ``True``)
         Whether or not the centrality values should be normalized.
+    method : ``"power"`` or ``"krylov"``, optional (default: ``"power"``)
+        If ``"power"``, the fixed-point iteration is used. If ``"krylov"``, the
+        linear system is solved with conjugate gradients for undirected graphs,
+        and with restarted GMRES for directed graphs. In this case, the
+        iteration stops when the relative residual of the linear system falls
+        below ``epsilon``, and ``max_iter`` limits the number of matrix-vector
+        products.
+    ncv : int, optional (default: ``None``)
+        Restart length for GMRES. If not provided, ``30`` will be used.
+    ret_info : bool, optional (default: ``False``)
+        If ``True``, a dictionary with convergence diagnostics will also be
+        returned (requires ``method == "krylov"``), with keys ``"nmv"``
+        (number of matrix-vector products), ``"restarts"``, ``"converged"``
+        and ``"residuals"`` (the final relative residual).
 
     Returns
     -------
     centrality : :class:`~graph_tool.PropertyMap`
         A vertex property map containing the Katz centrality values.
+    info : dict
+        Convergence diagnostics (only returned if ``ret_info == True``).
 
     See Also
     --------
@@ -724,6 +1171,14 @@ def katz(g, alpha=0.01, beta=None, weight=None, vprop=None, epsilon=1e-6,
     The algorithm uses successive iterations of the equation above, which has a
     topology-dependent convergence complexity.
 
+    With ``method == "krylov"``, the system
+    :math:`(\mathbf{I}-\alpha\mathbf{A})\mathbf{x} = \mathbf{\beta}` is
+    solved directly with a Krylov method [saad-iterative]_, which requires far
+    fewer matrix-vector products if :math:`\alpha` is close to the inverse of
+    the largest eigenvalue. For undirected graphs the matrix is symmetric, and
+    conjugate gradients are used if it is also positive-definite, otherwise
+    restarted GMRES is used.
+
     If enabled during compilation, this algorithm runs in parallel.
 
     Examples
@@ -740,6 +1195,9 @@ def katz(g, alpha=0.01, beta=None, weight=None, vprop=None, epsilon=1e-6,
        >>> w = g.new_edge_property("double")
        >>> w.a = np.random.random(len(w.a))
        >>> x = gt.katz(g, weight=w)
+       >>> y = gt.katz(g, weight=w, method="krylov")
+       >>> print(abs(x.fa - y.fa).max() < 1e-4)
+       True
        >>> gt.graph_draw(g, pos=g.vp["pos"], vertex_fill_color=x,
        ...               vertex_size=gt.prop_to_size(x, mi=5, ma=15),
        ...               vcmap=matplotlib.cm.gist_heat,
@@ -767,6 +1225,8 @@ def katz(g, alpha=0.01, beta=None, weight=None, vprop=None, epsilon=1e-6,
     .. [katz-centrality] http://en.wikipedia.org/wiki/Katz_centrality
     .. [katz-new] L. Katz, "A new status index derived from sociometric analysis",
        Psychometrika 18, Number 1, 39-43, 1953, :DOI:`10.1007/BF02289026`
+    .. [saad-iterative] Y. Saad, "Iterative Methods for Sparse Linear Systems",
+       2nd edition, SIAM, 2003, :DOI:`10.1137/1.9780898718003`
     .. [adamic-polblogs] L. A. Adamic and N. Glance, "The political blogosphere
        and the 2004 US Election", in Proceedings of the WWW-2005 Workshop on the
        Weblogging Ecosystem (2005). :DOI:`10.1145/1134271.1134277`
@@ -776,15 +1236,30 @@ def katz(g, alpha=0.01, beta=None, weight=None, vprop=None, epsilon=1e-6,
         vprop = g.new_vertex_property("double")
     if max_iter is None:
         max_iter = 0
-    libgraph_tool_centrality.\
-         get_katz(g._Graph__graph, _prop("e", g, weight), _prop("v", g, vprop),
-                  _prop("v", g, beta), float(alpha), epsilon, max_iter)
+    if method == "power":
+        if ret_info:
+            raise ValueError("parameter 'ret_info' requires method == 'krylov'")
+        libgraph_tool_centrality.\
+             get_katz(g._Graph__graph, _prop("e", g, weight),
+                      _prop("v", g, vprop), _prop("v", g, beta), float(alpha),
+                      epsilon, max_iter)
+    elif method == "krylov":
+        info = libgraph_tool_centrality.\
+             get_katz_krylov(g._Graph__graph, _prop("e", g, weight),
+                             _prop("v", g, vprop), _prop("v", g, beta),
+                             float(alpha), epsilon, max_iter, ncv or 0,
+                             _get_rng())
+    else:
+        raise ValueError("invalid method: " + str(method))
     if norm:
         vprop.fa = vprop.fa / numpy.linalg.norm(vprop.fa)
+    if ret_info:
+        return vprop, _krylov_info(info)
     return vprop
 
 
-def hits(g, weight=None, xprop=None, yprop=None, epsilon=1e-6, max_iter=None):
+def hits(g, weight=None, xprop=None, yprop=None, epsilon=1e-6, max_iter=None,
+         method="power", k=1, ncv=None, ret_info=False):
     r"""
     Calculate the authority and hub centralities of each vertex in the graph.
 
@@ -802,16 +1277,39 @@ def hits(g, weight=None, xprop=None, yprop=None, epsilon=1e-6, max_iter=None):
         Convergence condition. The iteration will stop if the total delta of all
         vertices are below this value.
     max_iter : int, optional (default: ``None``)
-        If supplied, this will limit the total number of iterations.
+        If supplied, this will limit the total number of iterations (or
+        restarts, if ``method == "krylov"``).
+    method : ``"power"`` or ``"krylov"``, optional (default: ``"power"``)
+        If ``"power"``, the power method is used. If ``"krylov"``, the
+        thick-restart Lanczos method is applied to the symmetric matrix
+        :math:`\mathbf{A}^T\mathbf{A}`. In this case, the iteration stops when
+        the relative residual of every requested eigenpair falls below
+        ``epsilon``.
+    k : int, optional (default: ``1``)
+        Number of leading singular vector pairs to compute (requires ``method
+        == "krylov"``).
+    ncv : int, optional (default: ``None``)
+        Dimension of the Krylov subspace used by ``method == "krylov"``. If not
+        provided, ``max(20, 2 * k + 1)`` will be used.
+    ret_info : bool, optional (default: ``False``)
+        If ``True``, a dictionary with convergence diagnostics will also be
+        returned (requires ``method == "krylov"``). See :func:`eigenvector` for
+        its contents.
 
     Returns
     -------
-    eig : `float`
-        The largest eigenvalue of the cocitation matrix.
-    x : :class:`~graph_tool.PropertyMap`
-        A vertex property map containing the authority centrality values.
-    y : :class:`~graph_tool.PropertyMap`
-        A vertex property map containing the hub centrality values.
+    eig : `float` or :class:`numpy.ndarray`
+        The largest eigenvalue of the cocitation matrix. If ``k > 1``, an array
+        with the ``k`` largest values will be returned instead.
+    x : :class:`~graph_tool.PropertyMap` or :class:`numpy.ndarray`
+        A vertex property map containing the authority centrality values. If
+        ``k > 1``, an array of shape ``(N, k)`` will be returned instead, where
+        each column is indexed by vertex index.
+    y : :class:`~graph_tool.PropertyMap` or :class:`numpy.ndarray`
+        A vertex property map containing the hub centrality values. If ``k >
+        1``, an array of shape ``(N, k)`` will be returned instead.
+    info : dict
+        Convergence diagnostics (only returned if ``ret_info == True``).
 
     See Also
     --------
@@ -846,6 +1344,10 @@ def hits(g, weight=None, xprop=None, yprop=None, epsilon=1e-6, max_iter=None):
     parameter, and :math:`\lambda_1` and :math:`\lambda_2` are the largest and
     second largest eigenvalues of the (weighted) cocitation matrix, respectively.
 
+    If ``method == "krylov"``, the thick-restart Lanczos method
+    [stewart-krylov-schur]_ is used instead, which typically requires far
+    fewer matrix-vector products when the spectral gap is small.
+
     If enabled during compilation, this algorithm runs in parallel.
 
     Examples
@@ -860,6 +1362,9 @@ def hits(g, weight=None, xprop=None, yprop=None, epsilon=1e-6, max_iter=None):
        >>> g = gt.collection.data["polblogs"]
        >>> g = gt.GraphView(g, vfilt=gt.label_largest_component(g))
        >>> ee, x, y = gt.hits(g)
+       >>> ee_k, x_k, y_k = gt.hits(g, method="krylov")
+       >>> print(abs(ee_k - ee) < 1e-3 * ee)
+       True
        >>> gt.graph_draw(g, pos=g.vp["pos"], vertex_fill_color=x,
        ...               vertex_size=gt.prop_to_size(x, mi=5, ma=15),
        ...               vcmap=matplotlib.cm.gist_heat,
@@ -903,6 +1408,9 @@ def hits(g, weight=None, xprop=None, yprop=None, epsilon=1e-6, max_iter=None):
        hyperlinked environment", Journal of the ACM 46 (5): 604-632, 1999,
        :DOI:`10.1145/324133.324140`.
     .. [power-method] http://en.wikipedia.org/wiki/Power_iteration
+    .. [stewart-krylov-schur] G. W. Stewart, "A Krylov--Schur Algorithm for
+       Large Eigenproblems", SIAM Journal on Matrix Analysis and Applications,
+       vol. 23, no. 3, pp. 601-614, 2002, :DOI:`10.1137/S0895479800371529`
     .. [adamic-polblogs] L. A. Adamic and N. Glance, "The political blogosphere
        and the 2004 US Election", in Proceedings of the WWW-2005 Workshop on the
        Weblogging Ecosystem (2005). :DOI:`10.1145/1134271.1134277`
@@ -914,10 +1422,108 @@ def hits(g, weight=None, xprop=None, yprop=None, epsilon=1e-6, max_iter=None):
         yprop = g.new_vertex_property("double")
     if max_iter is None:
         max_iter = 0
-    l = libgraph_tool_centrality.\
-         get_hits(g._Graph__graph, _prop("e", g, weight), _prop("v", g, xprop),
-                  _prop("v", g, yprop), epsilon, max_iter)
-    return 1. / l, xprop, yprop
+    if method == "power":
+        if k != 1 or ret_info:
+            raise ValueError("parameters 'k' and 'ret_info' require " +
+                             "method == 'krylov'")
+        l = libgraph_tool_centrality.\
+             get_hits(g._Graph__graph, _prop("e", g, weight),
+                      _prop("v", g, xprop), _prop("v", g, yprop), epsilon,
+                      max_iter)
+        return 1. / l, xprop, yprop
+    elif method != "krylov":
+        raise ValueError("invalid method: " + str(method))
+
+    l, X, Y, info = libgraph_tool_centrality.\
+        get_hits_krylov(g._Graph__graph, _prop("e", g, weight),
+                        _prop("v", g, xprop), _prop("v", g, yprop), k,
+                        ncv or 0, epsilon, max_iter, _get_rng())
+    if k == 1:
+        ret = (1. / l[0], xprop, yprop)
+    else:
+        ret = (1. / l, X.reshape((len(l), -1)).T, Y.reshape((len(l), -1)).T)
+    if ret_info:
+        ret += (_krylov_info(info),)
+    return ret
+
+
+class DynamicEigenvector(object):
+    r"""Eigenvector centrality maintained under batches of edge insertions and
+    removals.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Graph to be used. It will be modified by :meth:`update`.
+    weight : :class:`~graph_tool.PropertyMap`, optional (default: None)
+        Edge weights. If omitted, a constant value of 1 will be used.
+    epsilon : float, optional (default: 1e-6)
+        Relative tolerance of the eigenvalue equation. After each update, the
+        residual :math:`\|A\boldsymbol x - \lambda\boldsymbol x\|` is kept
+        below :math:`\epsilon|\lambda|`.
+
+    See Also
+    --------
+    eigenvector: eigenvector centrality
+    DynamicPageRank: PageRank under edge updates
+
+    Notes
+    -----
+    After each batch of updates, the residual of the current eigenvector,
+    together with its Rayleigh quotient, is evaluated in time :math:`O(E)`. If
+    it exceeds the tolerance, the eigenvector is recomputed with the Krylov
+    method of :func:`~graph_tool.centrality.eigenvector`, started from the
+    current vector. Since small batches change the leading eigenvector only
+    slightly, this usually requires only a few matrix-vector products.
+
+    The graph is modified by :meth:`update`, and it should not be modified
+    otherwise.
+
+    Examples
+    --------
+
+    >>> g = gt.Graph(gt.collection.data["polblogs"])
+    >>> dev = gt.DynamicEigenvector(g)
+    >>> rm = [(int(e.source()), int(e.target())) for e in list(g.edges())[:10]]
+    >>> info = dev.update(add=[(0, 1), (2, 3), (4, 5)], remove=rm)
+    >>> ee, x = dev.get_eigenvector()
+    >>> ee2, x2 = gt.eigenvector(g, epsilon=1e-10, method="krylov")
+    >>> print(numpy.isclose(ee, ee2))
+    True
+    """
+
+    def __init__(self, g, weight=None, epsilon=1e-6):
+        self.g = g
+        self.weight = weight
+        self._state = libgraph_tool_centrality.\
+            build_dynamic_eigenvector(g._Graph__graph, _prop("e", g, weight),
+                                      epsilon, _get_rng())
+
+    def update(self, add=None, remove=None):
+        r"""Insert the edges in ``add`` and remove those in ``remove``, both in
+        the graph and in the maintained eigenvector, with the same format as
+        :meth:`DynamicPageRank.update`.
+
+        A dictionary is returned with the number of matrix-vector products
+        performed (``"nmv"``), which is one if no recomputation was
+        necessary, i.e. only the product used to check the residual of the
+        current vector.
+        """
+        add, add_w = _edge_delta(add, self.weight)
+        remove, remove_w = _edge_delta(remove, None)
+        N = _update_size(self.g, add)
+        nmv = libgraph_tool_centrality.\
+            dynamic_eigenvector_update(self._state, add, add_w, remove,
+                                       remove_w, N, _get_rng())
+        _apply_edge_delta(self.g, self.weight, add, add_w, remove)
+        return dict(nmv=nmv)
+
+    def get_eigenvector(self):
+        """Return the current leading eigenvalue, and a vertex property map
+        with the corresponding eigenvector."""
+        x = self.g.new_vertex_property("double")
+        x.a[:] = self._state.get_eigenvector()
+        return self._state.get_eigenvalue(), x
 
 
 def eigentrust(g, trust_map, vprop=None, norm=False, epsilon=1e-6, max_iter=0,
@@ -1037,7 +1643,8 @@ def eigentrust(g, trust_map, vprop=None, norm=False, epsilon=1e-6, max_iter=0,
         return vprop
 
 
-def trust_transitivity(g, trust_map, source=None, target=None, vprop=None):
+def trust_transitivity(g, trust_map, source=None, target=None, vprop=None,
+                       top=None, threshold=None, ret_matrix=False):
     r"""
     Calculate the pervasive trust transitivity between chosen (or all) vertices
     in the graph.
@@ -1058,10 +1665,21 @@ def trust_transitivity(g, trust_map, source=None, target=None, vprop=None):
     vprop : :class:`~graph_tool.PropertyMap` (optional, default: None)
         A vertex property map where the values of transitive trust must be
         stored.
+    top : int (optional, default: None)
+        If provided, only the ``top`` largest trust values from each source are
+        kept, and a sparse matrix is returned (see below). This is only used if
+        ``target`` is not given.
+    threshold : float (optional, default: None)
+        If provided, only the trust values above ``threshold`` are kept, and a
+        sparse matrix is returned (see below). This is only used if ``target``
+        is not given.
+    ret_matrix : bool (optional, default: False)
+        If ``True``, and ``target`` is not given, the trust values are returned
+        as a matrix, instead of a property map.
 
     Returns
     -------
-    trust_transitivity : :class:`~graph_tool.PropertyMap` or float
+    trust_transitivity : :class:`~graph_tool.PropertyMap` or float or :class:`numpy.ndarray` or :class:`scipy.sparse.csr_matrix`
         A vertex vector property map containing, for each source vertex, a
         vector with the trust values for the other vertices. If only one of
         `source` or `target` is specified, this will be a single-valued vertex
@@ -1070,6 +1688,12 @@ def trust_transitivity(g, trust_map, source=None, target=None, vprop=None):
         are specified, the result is a single float, with the corresponding
         trust value for the target.
 
+        If ``target`` is not given and ``ret_matrix == True``, a
+        :class:`numpy.ndarray` of shape ``(N, N)`` (or ``(1, N)`` if `source`
+        is given) is returned instead, where the entry ``[i, j]`` is the trust
+        from ``i`` to ``j``. If ``top`` or ``threshold`` are given, this will be
+        a :class:`scipy.sparse.csr_matrix` containing only the selected values.
+
     See Also
     --------
     eigentrust: eigentrust centrality
@@ -1100,9 +1724,17 @@ def trust_transitivity(g, trust_map, source=None, target=None, vprop=None):
     resulting complexity is therefore :math:`O(V^2\log V)` for all targets, and
     :math:`O(V\log V)` for a single target. For a given target, the complexity
     for obtaining the trust from all given sources is :math:`O(kV\log V)`, where
-    :math:`k` is the in-degree of the target. Thus, the complexity for obtaining
-    the complete trust matrix is :math:`O(EV\log V)`, where :math:`E` is the
-    number of edges in the network.
+    :math:`k` is the in-degree of the target.
+
+    If the target is not given, a single search is done from each source in
+    the full graph instead. The path weights to an in-neighbor :math:`m` of a
+    target :math:`j` only change in :math:`G\setminus\{j\}` if the best path
+    to :math:`m` passes through :math:`j`, in which case only the vertices
+    with such paths are searched again, starting from the unchanged weights
+    of the other vertices, and stopping as soon as all in-neighbors of
+    :math:`j` are reached. This requires :math:`O(E\log V)` time per source,
+    plus the time of these additional searches, which depends on how often
+    the best paths overlap.
 
     If enabled during compilation, this algorithm runs in parallel.
 
@@ -1145,6 +1777,26 @@ def trust_transitivity(g, trust_map, source=None, target=None, vprop=None):
        network of [adamic-polblogs]_, with random weights attributed to the
        edges.
 
+    The five largest trust values from every source can be obtained as a
+    sparse matrix:
+
+    .. doctest:: trust_transitivity
+
+       >>> T = gt.trust_transitivity(g, w, top=5)
+       >>> row = T.getrow(42)
+       >>> print(row.nnz)
+       5
+
+    These are the same values obtained by searching separately for each
+    target, without sharing the searches of the source:
+
+    .. doctest:: trust_transitivity
+
+       >>> print(all(abs(gt.trust_transitivity(g, w, source=g.vertex(42),
+       ...                                      target=g.vertex(j)) - x) < 1e-8
+       ...           for j, x in zip(row.indices, row.data)))
+       True
+
     References
     ----------
     .. [richters-trust-2010] Oliver Richters and Tiago P. Peixoto, "Trust
@@ -1156,13 +1808,43 @@ def trust_transitivity(g, trust_map, source=None, target=None, vprop=None):
 
     """
 
+    if target is None:
+        N = g.num_vertices(ignore_filter=True)
+        if source is None:
+            sources = numpy.arange(N, dtype="int64")
+        else:
+            sources = numpy.array([int(source)], dtype="int64")
+        if top is not None or threshold is not None:
+            data, indices, indptr = libgraph_tool_centrality.\
+                get_trust_transitivity_sparse(g._Graph__graph,
+                                              _prop("e", g, trust_map),
+                                              sources,
+                                              threshold if threshold is not None else 0,
+                                              top if top is not None else 0)
+            return scipy.sparse.csr_matrix((data, indices, indptr),
+                                           shape=(len(sources), N))
+        T = numpy.zeros((len(sources), N))
+        libgraph_tool_centrality.\
+            get_trust_transitivity_dense(g._Graph__graph,
+                                         _prop("e", g, trust_map), sources, T)
+        if ret_matrix:
+            return T
+        if source is None:
+            if vprop is None:
+                vprop = g.new_vertex_property("vector<double>")
+            idx = g.vertex_index.copy("int64_t").fa
+            vprop.set_2d_array(T.T[:, idx])
+            return vprop
+        t = g.new_vertex_property("double")
+        t.a = T[0]
+        if vprop is not None:
+            group_vector_property([t], vprop=vprop, pos=[0])
+        return t
+
     if vprop is None:
         vprop = g.new_vertex_property("vector<double>")
 
-    if target is None:
-        target = -1
-    else:
-        target = g.vertex_index[target]
+    target = g.vertex_index[target]
 
     if source is None:
         source = -1
@@ -1173,8 +1855,7 @@ def trust_transitivity(g, trust_map, source=None, target=None, vprop=None):
             get_trust_transitivity(g._Graph__graph, source, target,
                                    _prop("e", g, trust_map),
                                    _prop("v", g, vprop))
-    if target != -1 or source != -1:
-        vprop = ungroup_vector_property(vprop, [0])[0]
-    if target != -1 and source != -1:
+    vprop = ungroup_vector_property(vprop, [0])[0]
+    if source != -1:
         return vprop.a[target]
     return vprop
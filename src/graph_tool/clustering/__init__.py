@@ -33,6 +33,9 @@ Summary
 
    local_clustering
    global_clustering
+   approx_local_clustering
+   approx_global_clustering
+   stream_clustering
    extended_clustering
    motifs
    motif_significance
@@ -46,7 +49,8 @@ from __future__ import division, absolute_import, print_function
 from .. dl_import import dl_import
 dl_import("from . import libgraph_tool_clustering as _gt")
 
-from .. import _degree, _prop, Graph, GraphView, PropertyMap, _get_rng
+from .. import _degree, _prop, Graph, GraphView, PropertyMap, _get_rng, \
+    _c_str
 from .. topology import isomorphism
 from .. generation import random_rewire
 from .. stats import vertex_hist
@@ -56,8 +60,9 @@ from numpy import *
 from numpy import random
 import sys
 
-__all__ = ["local_clustering", "global_clustering", "extended_clustering",
-           "motifs", "motif_significance"]
+__all__ = ["local_clustering", "global_clustering", "approx_local_clustering",
+           "approx_global_clustering", "stream_clustering",
+           "extended_clustering", "motifs", "motif_significance"]
 
 
 def local_clustering(g, prop=None, undirected=True):
@@ -105,8 +110,11 @@ def local_clustering(g, prop=None, undirected=True):
     .. math::
        c'_i = 2c_i.
 
-    The implemented algorithm runs in :math:`O(|V|\left< k\right>^2)` time,
-    where :math:`\left< k\right>` is the average out-degree.
+    The triangles are listed after ordering the vertices by degree, so that
+    each one is found only once, by intersecting the sorted lists of the
+    neighbors with higher degree of two of its vertices. The implemented
+    algorithm runs in :math:`O(|E|^{3/2})` time in the worst case, and is
+    much faster than that for graphs with a broad degree distribution.
 
     If enabled during compilation, this algorithm runs in parallel.
 
@@ -123,6 +131,16 @@ def local_clustering(g, prop=None, undirected=True):
     >>> print(gt.vertex_average(g, clust))
     (0.008177777777777779, 0.00042080229075093...)
 
+    The values match the number of triangles :math:`t_i` obtained from the
+    adjacency matrix, as :math:`t_i = (\boldsymbol{A}^3)_{ii}/2`:
+
+    >>> u = gt.collection.data["polbooks"]
+    >>> A = gt.adjacency(u)
+    >>> t = (A @ A).multiply(A).sum(axis=0).A1 / 2
+    >>> k = u.degree_property_map("out").a
+    >>> print(numpy.allclose(gt.local_clustering(u).a, 2 * t / (k * (k - 1))))
+    True
+
     References
     ----------
     .. [watts-collective-1998] D. J. Watts and Steven Strogatz, "Collective
@@ -167,8 +185,10 @@ def global_clustering(g):
        c = 3 \times \frac{\text{number of triangles}}
                           {\text{number of connected triples}}
 
-    The implemented algorithm runs in :math:`O(|V|\left< k\right>^2)` time,
-    where :math:`\left< k\right>` is the average (total) degree.
+    The triangles are counted once per vertex, as in
+    :func:`~graph_tool.clustering.local_clustering`, and these counts are also
+    used for the jackknife estimate of the error. The implemented algorithm
+    runs in :math:`O(|E|^{3/2})` time in the worst case.
 
     If enabled during compilation, this algorithm runs in parallel.
 
@@ -184,6 +204,17 @@ def global_clustering(g):
     >>> print(gt.global_clustering(g))
     (0.008177777777777779, 0.0004212235142651...)
 
+    The same value follows from the adjacency matrix, with
+    :math:`\operatorname{Tr}(\boldsymbol{A}^3)/6` triangles:
+
+    >>> u = gt.collection.data["polbooks"]
+    >>> A = gt.adjacency(u)
+    >>> n_tri = (A @ A).multiply(A).sum() / 6
+    >>> k = u.degree_property_map("out").a
+    >>> c = 3 * n_tri / (k * (k - 1) / 2).sum()
+    >>> print(abs(gt.global_clustering(u)[0] - c) < 1e-12)
+    True
+
     References
     ----------
     .. [newman-structure-2003] M. E. J. Newman, "The structure and function of
@@ -197,6 +228,323 @@ def global_clustering(g):
     return c
 
 
+def _check_accuracy(epsilon, delta):
+    if not epsilon > 0:
+        raise ValueError("epsilon must be positive: " + str(epsilon))
+    if not 0 < delta < 1:
+        raise ValueError("delta must be in the interval (0, 1): " + str(delta))
+
+
+def approx_local_clustering(g, epsilon=0.05, delta=0.05, prop=None,
+                            err=None, undirected=True):
+    r"""
+    Return estimates of the local clustering coefficients for all vertices,
+    obtained by sampling wedges.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Graph to be used.
+    epsilon : float (optional, default: ``0.05``)
+        Maximum absolute error of each coefficient.
+    delta : float (optional, default: ``0.05``)
+        Probability that the error of a coefficient exceeds ``epsilon``.
+    prop : :class:`~graph_tool.PropertyMap` (optional, default: ``None``)
+        Vertex property map where the estimates will be stored.
+    err : :class:`~graph_tool.PropertyMap` (optional, default: ``None``)
+        Vertex property map, of the same type as ``prop``, where the errors
+        will be stored.
+    undirected : bool (default: True)
+        Calculate the *undirected* clustering coefficient, if graph is directed
+        (this option has no effect if the graph is undirected).
+
+    Returns
+    -------
+    prop : :class:`~graph_tool.PropertyMap`
+        Vertex property containing the estimated clustering coefficients.
+    err : :class:`~graph_tool.PropertyMap`
+        Vertex property containing the half-width of the confidence interval
+        of each coefficient, with probability ``1 - delta``. It is zero for the
+        values computed exactly.
+
+    See Also
+    --------
+    local_clustering: exact local clustering coefficient
+    approx_global_clustering: estimate of the global clustering coefficient
+
+    Notes
+    -----
+    For each vertex, :math:`s = \lceil\ln(2/\delta)/2\epsilon^2\rceil` pairs of
+    neighbors are sampled uniformly, and the fraction of them that are
+    adjacent is returned [seshadhri-wedge-2013]_. According to Hoeffding's
+    inequality, the error is smaller than :math:`\epsilon` with probability
+    at least :math:`1-\delta`. Vertices with fewer than :math:`s` pairs of
+    neighbors are computed exactly, so that the algorithm runs in time
+    :math:`O(V s \langle k\rangle)` in the worst case, independently of the
+    number of triangles.
+
+    The same conventions of :func:`~graph_tool.clustering.local_clustering`
+    are used.
+
+    If enabled during compilation, this algorithm runs in parallel.
+
+    Examples
+    --------
+    .. testcode::
+       :hide:
+
+       np.random.seed(42)
+       gt.seed_rng(42)
+
+    >>> g = gt.price_network(10000, m=10, directed=False)
+    >>> exact = gt.local_clustering(g)
+    >>> clust, err = gt.approx_local_clustering(g, epsilon=0.05)
+    >>> print(abs(exact.a - clust.a).max() <= 0.05)
+    True
+
+    References
+    ----------
+    .. [seshadhri-wedge-2013] C. Seshadhri, A. Pinar and T. G. Kolda, "Fast
+       triangle counting through wedge sampling", Proceedings of the SIAM
+       Conference on Data Mining, 2013. :arxiv:`1202.5230`
+    """
+
+    _check_accuracy(epsilon, delta)
+    if prop is None:
+        prop = g.new_vertex_property("double")
+    if err is None:
+        err = g.new_vertex_property(prop.value_type())
+    if g.is_directed() and undirected:
+        g = GraphView(g, directed=False, skip_properties=True)
+    _gt.local_clustering_sampled(g._Graph__graph, _prop("v", g, prop),
+                                 _prop("v", g, err), epsilon, delta,
+                                 _get_rng())
+    return prop, err
+
+
+def approx_global_clustering(g, epsilon=0.01, delta=0.05, method="wedge",
+                             max_samples=None, ret_triangles=False):
+    r"""
+    Return an estimate of the global clustering coefficient, together with a
+    confidence interval, obtained by sampling.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Graph to be used.
+    epsilon : float (optional, default: ``0.01``)
+        Target error. For ``method == "wedge"`` this is the absolute error of
+        the clustering coefficient, and for ``method == "edge"`` it is the
+        relative error of the number of triangles.
+    delta : float (optional, default: ``0.05``)
+        Probability that the true value lies outside the confidence interval.
+    method : ``"wedge"`` or ``"edge"`` (optional, default: ``"wedge"``)
+        If ``"wedge"``, uniformly sampled wedges are tested for closure. If
+        ``"edge"``, the number of triangles of uniformly sampled edges is
+        counted.
+    max_samples : int (optional, default: ``None``)
+        Maximum number of edges sampled with ``method == "edge"``. If not
+        given, the sampling proceeds until the target error is reached.
+    ret_triangles : bool (optional, default: ``False``)
+        If ``True``, the estimated number of triangles and its confidence
+        interval are also returned.
+
+    Returns
+    -------
+    c : float
+        Estimated global clustering coefficient.
+    interval : tuple of floats
+        Confidence interval of ``c`` with probability ``1 - delta``.
+    t : float
+        Estimated number of triangles (only if ``ret_triangles == True``).
+    t_interval : tuple of floats
+        Confidence interval of ``t`` (only if ``ret_triangles == True``).
+
+    See Also
+    --------
+    global_clustering: exact global clustering coefficient
+    stream_clustering: estimate from a stream of edges
+
+    Notes
+    -----
+    With ``method == "wedge"``, :math:`s = \lceil\ln(2/\delta)/2\epsilon^2\rceil`
+    wedges are sampled uniformly, by choosing their centers with probability
+    proportional to :math:`k_i(k_i-1)/2`, and the fraction of closed ones is
+    returned [seshadhri-wedge-2013]_. The confidence interval is given by
+    Hoeffding's inequality, and the algorithm runs in time
+    :math:`O(V + s\langle k\rangle)`.
+
+    With ``method == "edge"``, edges are sampled uniformly, and the number
+    of triangles :math:`t_e` to which each one belongs is counted by
+    intersecting the neighborhoods of its endpoints. The number of triangles
+    is estimated as :math:`|E|\langle t_e\rangle/3`, and the sample size is
+    doubled until the confidence interval given by the central limit theorem
+    is within the relative error ``epsilon``. The clustering coefficient is
+    obtained by dividing by the exact number of wedges.
+
+    The graph is always considered as undirected, and it is assumed not to
+    contain self-loops or parallel edges.
+
+    If enabled during compilation, this algorithm runs in parallel.
+
+    Examples
+    --------
+    .. testcode::
+       :hide:
+
+       np.random.seed(42)
+       gt.seed_rng(42)
+
+    >>> g = gt.price_network(10000, m=10, directed=False)
+    >>> c = gt.global_clustering(g)[0]
+    >>> c_est, (lo, hi) = gt.approx_global_clustering(g, epsilon=0.01)
+    >>> print(lo <= c <= hi)
+    True
+    """
+
+    _check_accuracy(epsilon, delta)
+    if g.is_directed():
+        g = GraphView(g, directed=False, skip_properties=True)
+    if method == "wedge":
+        c, c_err, W = _gt.global_clustering_sampled(g._Graph__graph, epsilon,
+                                                    delta, _get_rng())
+        t, t_err = c * W / 3, c_err * W / 3
+    elif method == "edge":
+        if max_samples is None:
+            max_samples = 0
+        t, t_err, W, n = _gt.triangles_edge_sampled(g._Graph__graph, epsilon,
+                                                    delta, max_samples,
+                                                    _get_rng())
+        c, c_err = (3 * t / W, 3 * t_err / W) if W > 0 else (0., 0.)
+    else:
+        raise ValueError("invalid method: " + str(method))
+    interval = (max(c - c_err, 0.), min(c + c_err, 1.))
+    if ret_triangles:
+        return c, interval, t, (max(t - t_err, 0.), t + t_err)
+    return c, interval
+
+
+def stream_clustering(edges, memory=1000000, copies=8, delta=0.05,
+                      ret_triangles=False, chunk_size=65536):
+    r"""
+    Return an estimate of the global clustering coefficient of the graph
+    given by a stream of edges, which is read only once, with a fixed amount of
+    memory.
+
+    Parameters
+    ----------
+    edges : iterable, string or file object
+        Edges of the graph, given either as an iterable of ``(source,
+        target)`` pairs of vertex indexes, or of arrays of shape ``(k, 2)``
+        containing them. Alternatively, it can be the name of a file (or an
+        open file object) in the ``gt`` format, from which the edges are read
+        directly, without constructing the graph.
+    memory : int (optional, default: ``1000000``)
+        Total number of edges kept in memory.
+    copies : int (optional, default: ``8``)
+        Number of independent estimators, among which the memory is split.
+    delta : float (optional, default: ``0.05``)
+        Probability that the true value lies outside the confidence interval.
+    ret_triangles : bool (optional, default: ``False``)
+        If ``True``, the estimated number of triangles and its confidence
+        interval are also returned.
+    chunk_size : int (optional, default: ``65536``)
+        Number of edges that are passed at once to the estimators, when they
+        are given as pairs.
+
+    Returns
+    -------
+    c : float
+        Estimated global clustering coefficient.
+    interval : tuple of floats
+        Confidence interval of ``c`` with probability ``1 - delta``.
+    t : float
+        Estimated number of triangles (only if ``ret_triangles == True``).
+    t_interval : tuple of floats
+        Confidence interval of ``t`` (only if ``ret_triangles == True``).
+
+    See Also
+    --------
+    global_clustering: exact global clustering coefficient
+    approx_global_clustering: estimate obtained by sampling
+
+    Notes
+    -----
+    The triangles are counted by ``copies`` independent instances of the
+    TRIÈST-IMPR algorithm [destefani-triest-2016]_, each keeping a uniform
+    sample of ``memory / copies`` edges via reservoir sampling. Every
+    incoming edge contributes with the number of triangles it closes with the
+    sampled edges, weighted by the inverse probability that they were
+    sampled, which gives an unbiased estimate. The confidence interval is
+    obtained from the spread of the independent estimates. The number of
+    wedges is computed exactly from the degrees, which requires memory
+    :math:`O(V)`.
+
+    The edges are considered undirected, and each one should appear only
+    once in the stream, otherwise it is counted as a parallel edge. Self-loops
+    are ignored. For directed graphs read from a file, reciprocal edges
+    should therefore be avoided.
+
+    The algorithm runs in time :math:`O(E\,m)` in the worst case, where
+    :math:`m` is the number of sampled edges, and typically much faster. The
+    independent estimates are updated in parallel, if enabled during
+    compilation.
+
+    Examples
+    --------
+    .. testcode::
+       :hide:
+
+       np.random.seed(42)
+       gt.seed_rng(42)
+
+    >>> g = gt.price_network(10000, m=10, directed=False)
+    >>> c = gt.global_clustering(g)[0]
+    >>> c_est, (lo, hi) = gt.stream_clustering(g.get_edges()[:, :2],
+    ...                                        memory=50000)
+    >>> print(lo <= c <= hi)
+    True
+
+    References
+    ----------
+    .. [destefani-triest-2016] L. De Stefani, A. Epasto, M. Riondato and E.
+       Upfal, "TRIÈST: Counting Local and Global Triangles in Fully-Dynamic
+       Streams with Fixed Memory Size", Proceedings of the 22nd ACM SIGKDD
+       International Conference on Knowledge Discovery and Data Mining,
+       2016. :doi:`10.1145/2939672.2939771`
+    """
+
+    state = _gt.TriangleStream(memory, copies, _get_rng())
+    if isinstance(edges, str):
+        state.read(_c_str(edges), None)
+    elif hasattr(edges, "read"):
+        state.read("", edges)
+    elif isinstance(edges, ndarray) and edges.ndim == 2:
+        edges = asarray(edges, dtype="int64")
+        for i in range(0, edges.shape[0], chunk_size):
+            state.add_edges(ascontiguousarray(edges[i:i + chunk_size]))
+    else:
+        buf = []
+        for e in edges:
+            if isinstance(e, ndarray) and e.ndim == 2:
+                state.add_edges(ascontiguousarray(e, dtype="int64"))
+                continue
+            buf.append(e)
+            if len(buf) >= chunk_size:
+                state.add_edges(array(buf, dtype="int64").reshape(-1, 2))
+                buf = []
+        if len(buf) > 0:
+            state.add_edges(array(buf, dtype="int64").reshape(-1, 2))
+
+    t, t_err = state.get_triangles(delta)
+    W = state.get_wedges()
+    c, c_err = (3 * t / W, 3 * t_err / W) if W > 0 else (0., 0.)
+    interval = (max(c - c_err, 0.), min(c + c_err, 1.))
+    if ret_triangles:
+        return c, interval, t, (max(t - t_err, 0.), t + t_err)
+    return c, interval
+
+
 def extended_clustering(g, props=None, max_depth=3, undirected=False):
     r"""
     Return the extended clustering coefficients for all vertices.
@@ -246,7 +594,9 @@ def extended_clustering(g, props=None, max_depth=3, undirected=False):
 
     The implemented algorithm runs in
     :math:`O(|V|\left<k\right>^{2+\text{max-depth}})` worst time, where
-    :math:`\left< k\right>` is the average out-degree.
+    :math:`\left< k\right>` is the average out-degree. For ``max_depth == 1``
+    the triangle listing of
+    :func:`~graph_tool.clustering.local_clustering` is used instead.
 
     If enabled during compilation, this algorithm runs in parallel.
 
@@ -336,7 +686,15 @@ def motifs(g, k, p=1.0, motif_list=None, return_maps=False):
     This functions implements the ESU and RAND-ESU algorithms described in
     [wernicke-efficient-2006]_.
 
-    If enabled during compilation, this algorithm runs in parallel.
+    For :math:`k \le 8`, the subgraphs are identified by a canonical
+    labelling, obtained by refining the vertex partition according to the
+    degrees and choosing the lexicographically smallest adjacency matrix
+    compatible with it, so that no pairwise isomorphism tests are necessary.
+    For larger subgraphs, they are compared with the motifs with the same
+    degree sequence via subgraph isomorphism.
+
+    If enabled during compilation, this algorithm runs in parallel, with
+    independent random number streams and motif tables for each thread.
 
     Examples
     --------
@@ -353,6 +711,20 @@ def motifs(g, k, p=1.0, motif_list=None, return_maps=False):
     >>> print(counts)
     [115557, 390005, 627, 700, 1681, 2815, 820, 12, 27, 44, 15, 7, 12, 4, 6, 1, 2, 1]
 
+    For :math:`k=3` in a simple undirected graph the counts can be obtained
+    from the adjacency matrix, since the only motifs are the triangles and
+    the open wedges:
+
+    >>> u = gt.collection.data["polbooks"]
+    >>> motifs, counts = gt.motifs(u, 3)
+    >>> A = gt.adjacency(u)
+    >>> n_tri = (A @ A).multiply(A).sum() / 6
+    >>> k = u.degree_property_map("out").a
+    >>> n_wedge = (k * (k - 1) / 2).sum() - 3 * n_tri
+    >>> print({m.num_edges(): c for m, c in zip(motifs, counts)} ==
+    ...       {3: n_tri, 2: n_wedge})
+    True
+
     References
     ----------
     .. [wernicke-efficient-2006] S. Wernicke, "Efficient detection of network
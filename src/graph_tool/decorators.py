@@ -100,8 +100,9 @@ def _limit_args(allowed_vals):
             for a in arguments:
                 if a[0] in allowed_vals:
                     if a[1] not in allowed_vals[a[0]]:
+                        vals = [str(x) for x in allowed_vals[a[0]]]
                         raise TypeError("value for '%s' must be one of: %s" % \
-                                         (a[0], ", ".join(allowed_vals[a[0]])))
+                                         (a[0], ", ".join(vals)))
             return func(*args, **kwargs)
         return wrap
     return decorate
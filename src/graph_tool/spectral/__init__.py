@@ -33,6 +33,10 @@ Summary
    incidence
    transition
    modularity_matrix
+   AdjacencyOperator
+   LaplacianOperator
+   IncidenceOperator
+   TransitionOperator
 
 Contents
 ++++++++
@@ -42,6 +46,7 @@ from __future__ import division, absolute_import, print_function
 
 from .. import _degree, _prop, Graph, GraphView, _limit_args
 from .. stats import label_self_loops
+import copy
 import numpy
 import scipy.sparse
 import scipy.sparse.linalg
@@ -49,10 +54,12 @@ import scipy.sparse.linalg
 from .. dl_import import dl_import
 dl_import("from . import libgraph_tool_spectral")
 
-__all__ = ["adjacency", "laplacian", "incidence", "transition", "modularity_matrix"]
+__all__ = ["adjacency", "laplacian", "incidence", "transition", "modularity_matrix",
+           "AdjacencyOperator", "LaplacianOperator", "IncidenceOperator",
+           "TransitionOperator"]
 
 
-def adjacency(g, weight=None, index=None):
+def adjacency(g, weight=None, index=None, operator=False):
     r"""Return the adjacency matrix of the graph.
 
     Parameters
@@ -64,10 +71,14 @@ def adjacency(g, weight=None, index=None):
     index : :class:`~graph_tool.PropertyMap` (optional, default: None)
         Vertex property map specifying the row/column indexes. If not provided, the
         internal vertex index is used.
+    operator : bool (optional, default: ``False``)
+        If ``True``, a :class:`~graph_tool.spectral.AdjacencyOperator` is
+        returned instead, which computes the products with vectors directly
+        from the graph, without storing the matrix.
 
     Returns
     -------
-    a : :class:`~scipy.sparse.csr_matrix`
+    a : :class:`~scipy.sparse.csr_matrix` or :class:`~graph_tool.spectral.AdjacencyOperator`
         The (sparse) adjacency matrix.
 
     Notes
@@ -135,6 +146,9 @@ def adjacency(g, weight=None, index=None):
     .. [wikipedia-adjacency] http://en.wikipedia.org/wiki/Adjacency_matrix
     """
 
+    if operator:
+        return AdjacencyOperator(g, weight=weight, index=index)
+
     if index is None:
         if g.get_vertex_filter()[0] is not None:
             index = g.new_vertex_property("int64_t")
@@ -145,8 +159,8 @@ def adjacency(g, weight=None, index=None):
     E = g.num_edges() if g.is_directed() else 2 * g.num_edges()
 
     data = numpy.zeros(E, dtype="double")
-    i = numpy.zeros(E, dtype="int32")
-    j = numpy.zeros(E, dtype="int32")
+    i = numpy.zeros(E, dtype="int64")
+    j = numpy.zeros(E, dtype="int64")
 
     libgraph_tool_spectral.adjacency(g._Graph__graph, _prop("v", g, index),
                                      _prop("e", g, weight), data, i, j)
@@ -162,7 +176,8 @@ def adjacency(g, weight=None, index=None):
 
 
 @_limit_args({"deg": ["total", "in", "out"]})
-def laplacian(g, deg="total", normalized=False, weight=None, index=None):
+def laplacian(g, deg="total", normalized=False, weight=None, index=None,
+              operator=False):
     r"""Return the Laplacian matrix of the graph.
 
     Parameters
@@ -178,10 +193,14 @@ def laplacian(g, deg="total", normalized=False, weight=None, index=None):
     index : :class:`~graph_tool.PropertyMap` (optional, default: None)
         Vertex property map specifying the row/column indexes. If not provided, the
         internal vertex index is used.
+    operator : bool (optional, default: ``False``)
+        If ``True``, a :class:`~graph_tool.spectral.LaplacianOperator` is
+        returned instead, which computes the products with vectors directly
+        from the graph, without storing the matrix.
 
     Returns
     -------
-    l : :class:`~scipy.sparse.csr_matrix`
+    l : :class:`~scipy.sparse.csr_matrix` or :class:`~graph_tool.spectral.LaplacianOperator`
         The (sparse) Laplacian matrix.
 
     Notes
@@ -284,6 +303,10 @@ def laplacian(g, deg="total", normalized=False, weight=None, index=None):
     .. [wikipedia-laplacian] http://en.wikipedia.org/wiki/Laplacian_matrix
     """
 
+    if operator:
+        return LaplacianOperator(g, deg=deg, normalized=normalized,
+                                 weight=weight, index=index)
+
     if index is None:
         if g.get_vertex_filter()[0] is not None:
             index = g.new_vertex_property("int64_t")
@@ -299,8 +322,8 @@ def laplacian(g, deg="total", normalized=False, weight=None, index=None):
 
     N = E + g.num_vertices()
     data = numpy.zeros(N, dtype="double")
-    i = numpy.zeros(N, dtype="int32")
-    j = numpy.zeros(N, dtype="int32")
+    i = numpy.zeros(N, dtype="int64")
+    j = numpy.zeros(N, dtype="int64")
 
     if normalized:
         libgraph_tool_spectral.norm_laplacian(g._Graph__graph, _prop("v", g, index),
@@ -318,7 +341,7 @@ def laplacian(g, deg="total", normalized=False, weight=None, index=None):
     return m
 
 
-def incidence(g, vindex=None, eindex=None):
+def incidence(g, vindex=None, eindex=None, operator=False):
     r"""Return the incidence matrix of the graph.
 
     Parameters
@@ -331,10 +354,14 @@ def incidence(g, vindex=None, eindex=None):
     eindex : :class:`~graph_tool.PropertyMap` (optional, default: None)
         Edge property map specifying the column indexes. If not provided, the
         internal edge index is used.
+    operator : bool (optional, default: ``False``)
+        If ``True``, a :class:`~graph_tool.spectral.IncidenceOperator` is
+        returned instead, which computes the products with vectors directly
+        from the graph, without storing the matrix.
 
     Returns
     -------
-    a : :class:`~scipy.sparse.csr_matrix`
+    a : :class:`~scipy.sparse.csr_matrix` or :class:`~graph_tool.spectral.IncidenceOperator`
         The (sparse) incidence matrix.
 
     Notes
@@ -382,6 +409,9 @@ def incidence(g, vindex=None, eindex=None):
     .. [wikipedia-incidence] http://en.wikipedia.org/wiki/Incidence_matrix
     """
 
+    if operator:
+        return IncidenceOperator(g, vindex=vindex, eindex=eindex)
+
     if vindex is None:
         if g.get_edge_filter()[0] is not None:
             vindex = g.new_vertex_property("int64_t")
@@ -402,8 +432,8 @@ def incidence(g, vindex=None, eindex=None):
         raise ValueError("Cannot construct incidence matrix for a graph with no edges.")
 
     data = numpy.zeros(2 * E, dtype="double")
-    i = numpy.zeros(2 * E, dtype="int32")
-    j = numpy.zeros(2 * E, dtype="int32")
+    i = numpy.zeros(2 * E, dtype="int64")
+    j = numpy.zeros(2 * E, dtype="int64")
 
     libgraph_tool_spectral.incidence(g._Graph__graph, _prop("v", g, vindex),
                                      _prop("e", g, eindex), data, i, j)
@@ -411,7 +441,7 @@ def incidence(g, vindex=None, eindex=None):
     m = m.tocsr()
     return m
 
-def transition(g, weight=None, index=None):
+def transition(g, weight=None, index=None, operator=False):
     r"""Return the transition matrix of the graph.
 
     Parameters
@@ -423,10 +453,14 @@ def transition(g, weight=None, index=None):
     index : :class:`~graph_tool.PropertyMap` (optional, default: None)
         Vertex property map specifying the row/column indexes. If not provided, the
         internal vertex index is used.
+    operator : bool (optional, default: ``False``)
+        If ``True``, a :class:`~graph_tool.spectral.TransitionOperator` is
+        returned instead, which computes the products with vectors directly
+        from the graph, without storing the matrix.
 
     Returns
     -------
-    T : :class:`~scipy.sparse.csr_matrix`
+    T : :class:`~scipy.sparse.csr_matrix` or :class:`~graph_tool.spectral.TransitionOperator`
         The (sparse) transition matrix.
 
     Notes
@@ -488,6 +522,9 @@ def transition(g, weight=None, index=None):
     .. [wikipedia-transition] https://en.wikipedia.org/wiki/Stochastic_matrix
     """
 
+    if operator:
+        return TransitionOperator(g, weight=weight, index=index)
+
     if index is None:
         if g.get_vertex_filter()[0] is not None:
             index = g.new_vertex_property("int64_t")
@@ -497,8 +534,8 @@ def transition(g, weight=None, index=None):
 
     E = g.num_edges() if g.is_directed() else 2 * g.num_edges()
     data = numpy.zeros(E, dtype="double")
-    i = numpy.zeros(E, dtype="int32")
-    j = numpy.zeros(E, dtype="int32")
+    i = numpy.zeros(E, dtype="int64")
+    j = numpy.zeros(E, dtype="int64")
 
     libgraph_tool_spectral.transition(g._Graph__graph, _prop("v", g, index),
                                       _prop("e", g, weight), data, i, j)
@@ -616,3 +653,224 @@ def modularity_matrix(g, weight=None, index=None):
                                            dtype="float")
 
     return B
+
+
+def _get_vindex(g, index):
+    if index is None:
+        if g.get_vertex_filter()[0] is not None:
+            index = g.new_vertex_property("int64_t")
+            index.fa = numpy.arange(g.num_vertices())
+        else:
+            index = g.vertex_index
+    N = g.num_vertices()
+    if N > 0:
+        N = max(N, int(index.fa.max()) + 1)
+    return index, N
+
+
+class _GraphOperator(scipy.sparse.linalg.LinearOperator):
+    """Base class of the matrix-free operators, which implement the products
+    via :meth:`_product` with two-dimensional arrays."""
+
+    def __init__(self, g, shape, transpose=False):
+        self.g = g
+        self.transpose = transpose
+        if transpose:
+            shape = (shape[1], shape[0])
+        scipy.sparse.linalg.LinearOperator.__init__(self,
+                                                    dtype=numpy.dtype("double"),
+                                                    shape=shape)
+
+    def _matvec(self, x):
+        return self._matmat(x.reshape((-1, 1))).reshape(-1)
+
+    def _matmat(self, x):
+        x = numpy.ascontiguousarray(x, dtype="double")
+        ret = numpy.zeros((self.shape[0], x.shape[1]), dtype="double")
+        self._product(x, ret)
+        return ret
+
+    def _rmatvec(self, x):
+        return self._adjoint()._matvec(x)
+
+    def _rmatmat(self, x):
+        return self._adjoint()._matmat(x)
+
+    def _transpose(self):
+        op = copy.copy(self)
+        op.transpose = not self.transpose
+        op.shape = (self.shape[1], self.shape[0])
+        return op
+
+    _adjoint = _transpose
+
+
+class AdjacencyOperator(_GraphOperator):
+    r"""A :class:`~scipy.sparse.linalg.LinearOperator` representing the
+    adjacency matrix of a graph (see :func:`~graph_tool.spectral.adjacency`
+    for the parameters and the definition).
+
+    The products :math:`\boldsymbol A\boldsymbol x`, :math:`\boldsymbol
+    A^T\boldsymbol x`, and with matrices of several column vectors, are
+    computed directly from the graph, in parallel over the rows, without
+    storing the matrix.
+
+    Examples
+    --------
+
+    >>> g = gt.collection.data["polblogs"]
+    >>> A = gt.adjacency(g, operator=True)
+    >>> x = np.ones(A.shape[1])
+    >>> print((A * x - gt.adjacency(g) * x).max())
+    0.0
+    >>> X = np.random.random((A.shape[1], 4))
+    >>> print(abs(A @ X - gt.adjacency(g) @ X).max() < 1e-12)
+    True
+    >>> print(abs(A.T @ X - gt.adjacency(g).T @ X).max() < 1e-12)
+    True
+    """
+
+    def __init__(self, g, weight=None, index=None, transpose=False):
+        self.weight = weight
+        self.index, N = _get_vindex(g, index)
+        _GraphOperator.__init__(self, g, (N, N), transpose)
+
+    def _product(self, x, ret):
+        g = self.g
+        libgraph_tool_spectral.adjacency_matmat(g._Graph__graph,
+                                                _prop("v", g, self.index),
+                                                _prop("e", g, self.weight),
+                                                x, ret, self.transpose)
+
+
+class LaplacianOperator(_GraphOperator):
+    r"""A :class:`~scipy.sparse.linalg.LinearOperator` representing the
+    (normalized) Laplacian matrix of a graph (see
+    :func:`~graph_tool.spectral.laplacian` for the parameters and the
+    definition).
+
+    The products :math:`\boldsymbol L\boldsymbol x`, :math:`\boldsymbol
+    L^T\boldsymbol x`, and with matrices of several column vectors, are
+    computed directly from the graph, in parallel over the rows, without
+    storing the matrix. Only the vertex degrees are kept in memory.
+
+    Examples
+    --------
+
+    >>> g = gt.collection.data["polbooks"]
+    >>> X = np.random.random((g.num_vertices(), 4))
+    >>> L = gt.laplacian(g, operator=True)
+    >>> print(abs(L @ X - gt.laplacian(g) @ X).max() < 1e-12)
+    True
+    >>> L = gt.laplacian(g, normalized=True, operator=True)
+    >>> print(abs(L @ X - gt.laplacian(g, normalized=True) @ X).max() < 1e-12)
+    True
+    """
+
+    @_limit_args({"deg": ["total", "in", "out"]})
+    def __init__(self, g, deg="total", normalized=False, weight=None,
+                 index=None, transpose=False):
+        self.weight = weight
+        self.normalized = normalized
+        self.index, N = _get_vindex(g, index)
+        self.d = numpy.zeros(N, dtype="double")
+        libgraph_tool_spectral.laplacian_degrees(g._Graph__graph,
+                                                 _prop("v", g, self.index),
+                                                 _prop("e", g, weight), deg,
+                                                 self.d)
+        _GraphOperator.__init__(self, g, (N, N), transpose)
+
+    def _product(self, x, ret):
+        g = self.g
+        if self.normalized:
+            matmat = libgraph_tool_spectral.norm_laplacian_matmat
+        else:
+            matmat = libgraph_tool_spectral.laplacian_matmat
+        matmat(g._Graph__graph, _prop("v", g, self.index),
+               _prop("e", g, self.weight), self.d, x, ret, self.transpose)
+
+
+class IncidenceOperator(_GraphOperator):
+    r"""A :class:`~scipy.sparse.linalg.LinearOperator` representing the
+    incidence matrix of a graph (see :func:`~graph_tool.spectral.incidence`
+    for the parameters and the definition).
+
+    The products :math:`\boldsymbol B\boldsymbol x` and :math:`\boldsymbol
+    B^T\boldsymbol x`, and with matrices of several column vectors, are
+    computed directly from the graph, in parallel over the vertices or the
+    edges, respectively, without storing the matrix.
+
+    Examples
+    --------
+
+    >>> g = gt.collection.data["polbooks"]
+    >>> B = gt.incidence(g, operator=True)
+    >>> x = np.random.random(B.shape[1])
+    >>> y = np.random.random(B.shape[0])
+    >>> print(abs(B @ x - gt.incidence(g) @ x).max() < 1e-12)
+    True
+    >>> print(abs(B.T @ y - gt.incidence(g).T @ y).max() < 1e-12)
+    True
+    """
+
+    def __init__(self, g, vindex=None, eindex=None, transpose=False):
+        self.vindex, N = _get_vindex(g, vindex)
+        if eindex is None:
+            if g.get_edge_filter()[0] is not None:
+                eindex = g.new_edge_property("int64_t")
+                eindex.fa = numpy.arange(g.num_edges())
+            else:
+                eindex = g.edge_index
+        self.eindex = eindex
+        E = g.num_edges()
+        if E > 0:
+            E = max(E, int(eindex.fa.max()) + 1)
+        _GraphOperator.__init__(self, g, (N, E), transpose)
+
+    def _product(self, x, ret):
+        g = self.g
+        libgraph_tool_spectral.incidence_matmat(g._Graph__graph,
+                                                _prop("v", g, self.vindex),
+                                                _prop("e", g, self.eindex),
+                                                x, ret, self.transpose)
+
+
+class TransitionOperator(_GraphOperator):
+    r"""A :class:`~scipy.sparse.linalg.LinearOperator` representing the
+    transition matrix of a graph (see :func:`~graph_tool.spectral.transition`
+    for the parameters and the definition).
+
+    The products :math:`\boldsymbol T\boldsymbol x`, :math:`\boldsymbol
+    T^T\boldsymbol x`, and with matrices of several column vectors, are
+    computed directly from the graph, in parallel over the rows, without
+    storing the matrix. Only the vertex out-degrees are kept in memory.
+
+    Examples
+    --------
+
+    >>> g = gt.collection.data["polbooks"]
+    >>> T = gt.transition(g, operator=True)
+    >>> X = np.random.random((T.shape[1], 4))
+    >>> print(abs(T @ X - gt.transition(g) @ X).max() < 1e-12)
+    True
+    >>> print(abs(T.T @ X - gt.transition(g).T @ X).max() < 1e-12)
+    True
+    """
+
+    def __init__(self, g, weight=None, index=None, transpose=False):
+        self.weight = weight
+        self.index, N = _get_vindex(g, index)
+        self.d = numpy.zeros(N, dtype="double")
+        libgraph_tool_spectral.laplacian_degrees(g._Graph__graph,
+                                                 _prop("v", g, self.index),
+                                                 _prop("e", g, weight), "out",
+                                                 self.d)
+        _GraphOperator.__init__(self, g, (N, N), transpose)
+
+    def _product(self, x, ret):
+        g = self.g
+        libgraph_tool_spectral.transition_matmat(g._Graph__graph,
+                                                 _prop("v", g, self.index),
+                                                 _prop("e", g, self.weight),
+                                                 self.d, x, ret,
+                                                 self.transpose)
@@ -30,13 +30,18 @@ Summary
 
    shortest_distance
    shortest_path
+   ContractionHierarchy
    all_shortest_paths
    all_predecessors
    all_paths
    all_circuits
    pseudo_diameter
+   diameter
    similarity
    vertex_similarity
+   vertex_minhash
+   minhash_similarity
+   minhash_candidates
    isomorphism
    subgraph_isomorphism
    mark_subgraph
@@ -44,18 +49,24 @@ Summary
    max_independent_vertex_set
    min_spanning_tree
    random_spanning_tree
+   random_spanning_trees
    dominator_tree
    topological_sort
    transitive_closure
+   ReachabilityIndex
    tsp_tour
    sequential_vertex_coloring
+   parallel_vertex_coloring
    label_components
    label_biconnected_components
    label_largest_component
    label_out_component
    vertex_percolation
    edge_percolation
+   vertex_percolation_batch
+   edge_percolation_batch
    kcore_decomposition
+   DynamicKCore
    is_bipartite
    is_DAG
    is_planar
@@ -77,18 +88,24 @@ from .. import _prop, Vector_int32_t, _check_prop_writable, \
      libcore, _get_rng, _degree, perfect_prop_hash, _limit_args
 from .. stats import label_self_loops
 import random, sys, numpy, collections
+import scipy.sparse
 
 __all__ = ["isomorphism", "subgraph_isomorphism", "mark_subgraph",
            "max_cardinality_matching", "max_independent_vertex_set",
-           "min_spanning_tree", "random_spanning_tree", "dominator_tree",
-           "topological_sort", "transitive_closure", "tsp_tour",
-           "sequential_vertex_coloring", "label_components",
+           "min_spanning_tree", "random_spanning_tree",
+           "random_spanning_trees", "dominator_tree",
+           "topological_sort", "transitive_closure", "ReachabilityIndex", "tsp_tour",
+           "sequential_vertex_coloring", "parallel_vertex_coloring",
+           "label_components",
            "label_largest_component", "label_biconnected_components",
            "label_out_component", "vertex_percolation", "edge_percolation",
-           "kcore_decomposition", "shortest_distance", "shortest_path",
+           "vertex_percolation_batch", "edge_percolation_batch",
+           "kcore_decomposition", "DynamicKCore", "shortest_distance", "shortest_path",
+           "ContractionHierarchy",
            "all_shortest_paths", "all_predecessors", "all_paths",
-           "all_circuits", "pseudo_diameter", "is_bipartite", "is_DAG",
+           "all_circuits", "pseudo_diameter", "diameter", "is_bipartite", "is_DAG",
            "is_planar", "make_maximal_planar", "similarity", "vertex_similarity",
+           "vertex_minhash", "minhash_similarity", "minhash_candidates",
            "edge_reciprocity"]
 
 def similarity(g1, g2, eweight1=None, eweight2=None, label1=None, label2=None,
@@ -233,7 +250,7 @@ def similarity(g1, g2, eweight1=None, eweight2=None, label1=None, label2=None,
 
 @_limit_args({"sim_type": ["dice", "jaccard", "inv-log-weight"]})
 def vertex_similarity(g, sim_type="jaccard", vertex_pairs=None, self_loops=True,
-                      sim_map=None):
+                      sim_map=None, top=None, threshold=None):
     r"""Return the similarity between pairs of vertices.
 
     Parameters
@@ -253,14 +270,24 @@ def vertex_similarity(g, sim_type="jaccard", vertex_pairs=None, self_loops=True,
         If provided, and ``vertex_pairs is None``, the vertex similarities will
         be stored in this vector-valued property. Otherwise, a new one will be
         created.
+    top : ``int`` (optional, default: ``None``)
+        If provided, and ``vertex_pairs is None``, only the ``top`` largest
+        similarities of each vertex to the other vertices are returned, as a
+        sparse matrix.
+    threshold : ``float`` (optional, default: ``None``)
+        If provided, and ``vertex_pairs is None``, only the similarities larger
+        or equal to ``threshold`` are returned, as a sparse matrix.
 
     Returns
     -------
-    similarities : :class:`numpy.ndarray` or :class:`~graph_tool.PropertyMap`
+    similarities : :class:`numpy.ndarray` or :class:`~graph_tool.PropertyMap` or :class:`scipy.sparse.csr_matrix`
         If ``vertex_pairs`` was supplied, this will be a :class:`numpy.ndarray`
         with the corresponding similarities, otherwise it will be a
         vector-valued vertex :class:`~graph_tool.PropertyMap`, with the
-        similarities to all other vertices.
+        similarities to all other vertices. If ``top`` or ``threshold`` are
+        given, this will be instead a :class:`scipy.sparse.csr_matrix` where
+        row ``u`` contains only the selected nonzero similarities of ``u`` to
+        the other vertices (the similarity of ``u`` to itself is not included).
 
     Notes
     -----
@@ -296,6 +323,20 @@ def vertex_similarity(g, sim_type="jaccard", vertex_pairs=None, self_loops=True,
     ``vertex_pairs is None``, otherwise with :math:`O(\left<k\right>P)` where
     :math:`P` is the length of ``vertex_pairs``.
 
+    If ``top`` or ``threshold`` are given, only the pairs of vertices that
+    share at least one neighbor are considered, since all others have zero
+    similarity. These are obtained by traversing the neighbors of the
+    neighbors of every vertex, with an overall complexity
+    :math:`O(\sum_v k_v^2)` and memory proportional to the size of the result,
+    rather than :math:`O(N^2)`. For the ``"dice"`` and ``"jaccard"``
+    similarities with a nonzero ``threshold``, the candidate pairs are further
+    reduced by prefix filtering [bayardo-scaling-2007]_, where the neighbors
+    are ordered by increasing degree, and only the first few of them need to
+    be compared to guarantee that no pair above the threshold is missed. In
+    this way the high-degree neighbors are mostly ignored, which gives large
+    speedups on graphs with broad degree distributions. (Prefix filtering is
+    not used if the graph has parallel edges.)
+
     If enabled during compilation, this algorithm runs in parallel.
 
     Examples
@@ -328,6 +369,25 @@ def vertex_similarity(g, sim_type="jaccard", vertex_pairs=None, self_loops=True,
 
        Jaccard similarities to vertex ``0`` in a political books network.
 
+    The five most similar books of every book can be obtained as a sparse
+    matrix:
+
+    >>> S = gt.vertex_similarity(g, "jaccard", top=5)
+    >>> print(S.shape, S.getrow(0).nnz)
+    (105, 105) 5
+
+    These are the largest values of the full similarity matrix, excluding
+    the diagonal, and likewise for a threshold:
+
+    >>> D = s.get_2d_array(range(g.num_vertices()))
+    >>> numpy.fill_diagonal(D, 0)
+    >>> print(numpy.allclose(numpy.sort(S.toarray(), axis=1)[:, -5:],
+    ...                      numpy.sort(D, axis=1)[:, -5:]))
+    True
+    >>> S = gt.vertex_similarity(g, "jaccard", threshold=0.5)
+    >>> print(numpy.allclose(S.toarray(), numpy.where(D >= 0.5, D, 0)))
+    True
+
     References
     ----------
     .. [sorensen-dice] https://en.wikipedia.org/wiki/S%C3%B8rensen%E2%80%93Dice_coefficient
@@ -339,8 +399,34 @@ def vertex_similarity(g, sim_type="jaccard", vertex_pairs=None, self_loops=True,
        "The link-prediction problem for social networks", Journal of the
        American Society for Information Science and Technology, Volume 58, Issue
        7, pages 1019–1031 (2007), :doi:`10.1002/asi.20591`
+    .. [bayardo-scaling-2007] Roberto J. Bayardo, Yiming Ma and Ramakrishnan
+       Srikant, "Scaling up all pairs similarity search", Proceedings of the
+       16th International Conference on World Wide Web, 131-140 (2007),
+       :doi:`10.1145/1242572.1242591`
     """
 
+    if vertex_pairs is None and (top is not None or threshold is not None):
+        if threshold is None:
+            threshold = 0
+        if top is None:
+            top = 0
+        if sim_type == "dice":
+            data, indices, indptr = libgraph_tool_topology.\
+                dice_similarity_sparse(g._Graph__graph, self_loops,
+                                       threshold, top)
+        elif sim_type == "jaccard":
+            data, indices, indptr = libgraph_tool_topology.\
+                jaccard_similarity_sparse(g._Graph__graph, self_loops,
+                                          threshold, top)
+        elif sim_type == "inv-log-weight":
+            data, indices, indptr = libgraph_tool_topology.\
+                inv_log_weight_similarity_sparse(g._Graph__graph, threshold,
+                                                 top)
+        else:
+            raise ValueError("invalid similarity type: " + str(sim_type))
+        N = g.num_vertices(ignore_filter=True)
+        return scipy.sparse.csr_matrix((data, indices, indptr), shape=(N, N))
+
     if vertex_pairs is None:
         if sim_map is None:
             s = g.new_vp("vector<double>")
@@ -375,6 +461,240 @@ def vertex_similarity(g, sim_type="jaccard", vertex_pairs=None, self_loops=True,
     return s
 
 
+def vertex_minhash(g, k=128, bits=64, self_loops=True, sketch=None):
+    r"""Return MinHash sketches of the neighborhoods of all vertices.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        The graph to be used.
+    k : ``int`` (optional, default: ``128``)
+        Number of hash values in each sketch. If ``bits < 64`` this is rounded
+        up to a multiple of ``64 / bits``.
+    bits : ``int`` (optional, default: ``64``)
+        Number of bits stored for each hash value. This must be one of ``1``,
+        ``2``, ``4``, ``8``, ``16``, ``32`` or ``64``.
+    self_loops : bool (optional, default: ``True``)
+        If ``True``, vertices will be considered adjacent to themselves, as in
+        :func:`~graph_tool.topology.vertex_similarity`.
+    sketch : :class:`~graph_tool.VertexPropertyMap` (optional, default: ``None``)
+        If provided, the sketches will be stored in this property map, which
+        must be of type ``vector<int64_t>``.
+
+    Returns
+    -------
+    sketch : :class:`~graph_tool.VertexPropertyMap`
+        Vector-valued vertex property map of type ``vector<int64_t>``
+        containing the sketches, with ``k * bits / 64`` values each.
+
+    Notes
+    -----
+    The Jaccard similarity between the neighborhoods of two vertices (see
+    :func:`~graph_tool.topology.vertex_similarity`) is equal to the probability
+    that their minimum values under a random hash function are the same. The
+    sketches contain ``k`` such values, obtained by hashing the neighbors only
+    once into ``k`` bins and keeping the minimum of each bin [li-one-2012]_,
+    with the empty bins being filled from the non-empty ones
+    [shrivastava-improved-2014]_. The similarities can then be estimated with
+    :func:`~graph_tool.topology.minhash_similarity` in time :math:`O(k)` per
+    pair, and pairs of similar vertices can be found with
+    :func:`~graph_tool.topology.minhash_candidates`. The estimates are
+    unbiased, with a standard deviation of approximately
+    :math:`\sqrt{J(1-J)/k}` for neighborhoods with more than :math:`k`
+    vertices. For smaller neighborhoods most bins are filled from the same few
+    non-empty ones, so that the error decreases with the size of the
+    neighborhoods, but not further with :math:`k`.
+
+    If ``bits < 64``, only the lowest ``bits`` bits of each value are kept
+    [li-b-bit-2010]_, which reduces the memory requirements at the expense of
+    some accuracy.
+
+    For directed graphs, only the out-neighbors are considered. Parallel edges
+    are ignored.
+
+    The algorithm runs with complexity :math:`O(N k + E)`.
+
+    If enabled during compilation, this algorithm runs in parallel.
+
+    Examples
+    --------
+    >>> g = gt.collection.data["polbooks"]
+    >>> s = gt.vertex_minhash(g, k=256)
+    >>> N = g.num_vertices()
+    >>> pairs = [(u, v) for u in range(N) for v in range(u + 1, N)]
+    >>> J = gt.vertex_similarity(g, "jaccard", pairs)
+    >>> J_est = gt.minhash_similarity(g, s, pairs)
+    >>> print(abs(J - J_est).mean() < 0.05)
+    True
+
+    References
+    ----------
+    .. [li-one-2012] Ping Li, Art Owen and Cun-Hui Zhang, "One Permutation
+       Hashing", Advances in Neural Information Processing Systems 25 (2012),
+       :arxiv:`1208.1259`
+    .. [shrivastava-improved-2014] Anshumali Shrivastava and Ping Li, "Improved
+       Densification of One Permutation Hashing", Proceedings of the 30th
+       Conference on Uncertainty in Artificial Intelligence (2014),
+       :arxiv:`1406.4784`
+    .. [li-b-bit-2010] Ping Li and Arnd Christian König, "b-Bit Minwise
+       Hashing", Proceedings of the 19th International Conference on World
+       Wide Web, 671-680 (2010), :doi:`10.1145/1772690.1772759`
+    """
+
+    if bits not in [1, 2, 4, 8, 16, 32, 64]:
+        raise ValueError("invalid number of bits: " + str(bits))
+    if k < 1:
+        raise ValueError("invalid number of hash values: " + str(k))
+    step = 64 // bits
+    k = ((k + step - 1) // step) * step
+    if sketch is None:
+        sketch = g.new_vp("vector<int64_t>")
+    elif sketch.value_type() != "vector<int64_t>":
+        raise ValueError("sketch property map must be of type vector<int64_t>")
+    libgraph_tool_topology.vertex_minhash(g._Graph__graph,
+                                          _prop("v", g, sketch), k, bits,
+                                          self_loops, _get_rng())
+    return sketch
+
+
+def _minhash_size(g, sketch, bits):
+    if bits not in [1, 2, 4, 8, 16, 32, 64]:
+        raise ValueError("invalid number of bits: " + str(bits))
+    if sketch.value_type() != "vector<int64_t>":
+        raise ValueError("sketch property map must be of type vector<int64_t>")
+    for v in g.vertices():
+        return len(sketch[v]) * 64 // bits
+    return 0
+
+
+def minhash_similarity(g, sketch, vertex_pairs, bits=64):
+    r"""Return the estimated Jaccard similarity between pairs of vertices,
+    from their MinHash sketches.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        The graph to be used.
+    sketch : :class:`~graph_tool.VertexPropertyMap`
+        Sketches obtained with :func:`~graph_tool.topology.vertex_minhash`.
+    vertex_pairs : iterable of pairs of integers
+        Pairs of vertices to compute the similarity.
+    bits : ``int`` (optional, default: ``64``)
+        Number of bits per hash value, which must be the same as used in
+        :func:`~graph_tool.topology.vertex_minhash`.
+
+    Returns
+    -------
+    similarities : :class:`numpy.ndarray`
+        Estimated Jaccard similarities of the pairs.
+
+    Notes
+    -----
+    The similarity is estimated as the fraction :math:`p` of equal values in
+    the sketches. If ``bits < 64``, this is corrected for accidental
+    collisions as :math:`\max(0, (p - 2^{-b}) / (1 - 2^{-b}))`.
+
+    The algorithm runs with complexity :math:`O(kP)` where :math:`P` is the
+    length of ``vertex_pairs`` and :math:`k` is the size of the sketches.
+
+    If enabled during compilation, this algorithm runs in parallel.
+
+    Examples
+    --------
+    >>> g = gt.collection.data["polbooks"]
+    >>> s = gt.vertex_minhash(g, k=1024)
+    >>> N = g.num_vertices()
+    >>> pairs = [(u, v) for u in range(N) for v in range(u + 1, N)]
+    >>> J = gt.vertex_similarity(g, "jaccard", pairs)
+    >>> J_est = gt.minhash_similarity(g, s, pairs)
+    >>> print(abs((J_est - J).mean()) < 0.02)
+    True
+    """
+
+    k = _minhash_size(g, sketch, bits)
+    vertex_pairs = numpy.asarray(vertex_pairs, dtype="int64")
+    s = numpy.zeros(vertex_pairs.shape[0], dtype="double")
+    libgraph_tool_topology.minhash_similarity_pairs(g._Graph__graph,
+                                                    _prop("v", g, sketch),
+                                                    k, bits, vertex_pairs, s)
+    return s
+
+
+def minhash_candidates(g, sketch, bands=32, bits=64, max_bucket=None):
+    r"""Return candidate pairs of similar vertices, obtained by
+    locality-sensitive hashing of their MinHash sketches.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        The graph to be used.
+    sketch : :class:`~graph_tool.VertexPropertyMap`
+        Sketches obtained with :func:`~graph_tool.topology.vertex_minhash`.
+    bands : ``int`` (optional, default: ``32``)
+        Number of bands in which the sketches are divided.
+    bits : ``int`` (optional, default: ``64``)
+        Number of bits per hash value, which must be the same as used in
+        :func:`~graph_tool.topology.vertex_minhash`.
+    max_bucket : ``int`` (optional, default: ``None``)
+        If provided, buckets with more than this number of vertices are
+        ignored.
+
+    Returns
+    -------
+    pairs : :class:`numpy.ndarray`
+        Array of shape ``(P, 2)`` containing the candidate pairs ``(u, v)``,
+        with ``u < v``.
+
+    Notes
+    -----
+    The sketches of size :math:`k` are divided into :math:`m` bands (given by
+    ``bands``) of :math:`r = k / m` consecutive values, and two vertices are
+    considered candidates if they have the same values in at least one of the
+    bands
+    [leskovec-mining-2014]_. This happens with probability :math:`1 - (1 -
+    J^r)^m`, where :math:`J` is their Jaccard similarity, which is a steep
+    function around :math:`J \approx (1/m)^{1/r}`, so that the number of bands
+    controls the similarity above which the pairs are found with high
+    probability. The candidates can then be passed as the ``vertex_pairs``
+    parameter of :func:`~graph_tool.topology.vertex_similarity` or
+    :func:`~graph_tool.topology.minhash_similarity`, which avoids considering
+    all pairs of vertices. Vertices with no out-neighbors are ignored.
+
+    The algorithm runs with complexity :math:`O(m N\log N + P)`, where
+    :math:`P` is the number of pairs returned.
+
+    If enabled during compilation, this algorithm runs in parallel.
+
+    Examples
+    --------
+    >>> g = gt.collection.data["polbooks"]
+    >>> s = gt.vertex_minhash(g, k=128)
+    >>> pairs = gt.minhash_candidates(g, s, bands=64)
+    >>> J = gt.vertex_similarity(g, "jaccard", pairs)
+
+    All the pairs with high similarity are among the candidates:
+
+    >>> S = gt.vertex_similarity(g, "jaccard")
+    >>> S = numpy.triu(S.get_2d_array(range(g.num_vertices())), 1)
+    >>> print((J >= 0.7).sum() == (S >= 0.7).sum())
+    True
+
+    References
+    ----------
+    .. [leskovec-mining-2014] Jure Leskovec, Anand Rajaraman and Jeffrey
+       D. Ullman, "Mining of Massive Datasets", Chapter 3, Cambridge University
+       Press (2014), :doi:`10.1017/CBO9781139924801`
+    """
+
+    k = _minhash_size(g, sketch, bits)
+    if bands < 1 or bands > k:
+        raise ValueError("number of bands must be between 1 and %d" % k)
+    pairs = libgraph_tool_topology.\
+        minhash_candidates(g._Graph__graph, _prop("v", g, sketch), k, bits,
+                           bands, max_bucket if max_bucket is not None else 0)
+    return numpy.asarray(pairs, dtype="int64").reshape((-1, 2))
+
+
 def isomorphism(g1, g2, vertex_inv1=None, vertex_inv2=None, isomap=False):
     r"""Check whether two graphs are isomorphic.
 
@@ -501,11 +821,21 @@ def subgraph_isomorphism(sub, g, max_n=0, vertex_label=None, edge_label=None,
 
     Notes
     -----
-    The implementation is based on the VF2 algorithm, introduced by Cordella et al.
-    [cordella-improved-2001]_ [cordella-subgraph-2004]_. The spatial complexity
-    is of order :math:`O(V)`, where :math:`V` is the (maximum) number of vertices
-    of the two graphs. Time complexity is :math:`O(V^2)` in the best case and
-    :math:`O(V!\times V)` in the worst case.
+    The implementation is a backtracking search in the spirit of the VF2, VF3
+    and RI algorithms [cordella-improved-2001]_ [cordella-subgraph-2004]_
+    [bonnici-subgraph-2013]_ [carletti-vf3-2018]_. The candidates of each
+    vertex of ``sub`` are computed in advance, as the vertices of ``g`` with the
+    same label, large enough degrees and compatible labels of their
+    neighbors. The vertices of ``sub`` are then matched in an order such that
+    each one is adjacent to as many of the previous ones as possible, and its
+    candidates are taken from the neighbors of a vertex already matched. The
+    spatial complexity is of order :math:`O(V)`, where :math:`V` is the
+    (maximum) number of vertices of the two graphs. Time complexity is
+    :math:`O(V^2)` in the best case and :math:`O(V!\times V)` in the worst
+    case.
+
+    If enabled during compilation, and ``generator == False``, the search
+    runs in parallel.
 
     Examples
     --------
@@ -548,6 +878,22 @@ def subgraph_isomorphism(sub, g, max_n=0, vertex_label=None, edge_label=None,
 
     **Left:** Subgraph searched, **Right:** One isomorphic subgraph found in main graph.
 
+    The number of mappings can be checked against the adjacency matrix. Each
+    triangle is found once for each of its six automorphisms, and each
+    induced path of length two twice:
+
+    >>> u = gt.collection.data["polbooks"]
+    >>> A = gt.adjacency(u)
+    >>> n_tri = (A @ A).multiply(A).sum() / 6
+    >>> k = u.degree_property_map("out").a
+    >>> n_wedge = (k * (k - 1) / 2).sum() - 3 * n_tri
+    >>> vm = gt.subgraph_isomorphism(gt.complete_graph(3), u)
+    >>> print(len(vm) == 6 * n_tri)
+    True
+    >>> vm = gt.subgraph_isomorphism(gt.lattice([3]), u, induced=True)
+    >>> print(len(vm) == 2 * n_wedge)
+    True
+
     References
     ----------
     .. [cordella-improved-2001] L. P. Cordella, P. Foggia, C. Sansone, and M. Vento,
@@ -558,7 +904,14 @@ def subgraph_isomorphism(sub, g, max_n=0, vertex_label=None, edge_label=None,
        "A (Sub)Graph Isomorphism Algorithm for Matching Large Graphs.",
        IEEE Trans. Pattern Anal. Mach. Intell., vol. 26, no. 10, pp. 1367-1372, 2004.
        :doi:`10.1109/TPAMI.2004.75`
-    .. [boost-subgraph-iso] http://www.boost.org/libs/graph/doc/vf2_sub_graph_iso.html
+    .. [bonnici-subgraph-2013] V. Bonnici, R. Giugno, A. Pulvirenti, D. Shasha
+       and A. Ferro, "A subgraph isomorphism algorithm and its application to
+       biochemical data", BMC Bioinformatics, vol. 14, S13, 2013.
+       :doi:`10.1186/1471-2105-14-S7-S13`
+    .. [carletti-vf3-2018] V. Carletti, P. Foggia, A. Saggese and M. Vento,
+       "Challenging the Time Complexity of Exact Subgraph Isomorphism for Huge
+       and Dense Graphs with VF3", IEEE Trans. Pattern Anal. Mach. Intell.,
+       vol. 40, no. 4, pp. 804-818, 2018. :doi:`10.1109/TPAMI.2017.2696940`
     .. [subgraph-isormophism-wikipedia] http://en.wikipedia.org/wiki/Subgraph_isomorphism_problem
 
     """
@@ -637,7 +990,7 @@ def min_spanning_tree(g, weights=None, root=None, tree_map=None):
         the edge weights.
     root : :class:`~graph_tool.Vertex` (optional, default: `None`)
         Root of the minimum spanning tree. If this is provided, Prim's algorithm
-        is used. Otherwise, Kruskal's algorithm is used.
+        is used. Otherwise, Borůvka's algorithm is used.
     tree_map : :class:`~graph_tool.PropertyMap` (optional, default: `None`)
         If provided, the edge tree map will be written in this property map.
 
@@ -649,8 +1002,15 @@ def min_spanning_tree(g, weights=None, root=None, tree_map=None):
 
     Notes
     -----
-    The algorithm runs with :math:`O(E\log E)` complexity, or :math:`O(E\log V)`
-    if `root` is specified.
+    The algorithm runs with :math:`O(E\log V)` complexity.
+
+    If `root` is not specified, the minimum spanning forest is computed with
+    Borůvka's algorithm [boruvka-o-1926]_ [chung-parallel-1996]_, where in each
+    round all components select their lightest edge at the same time, and are
+    contracted along them. This is done in parallel, and edges that fall inside
+    a single component are discarded as the algorithm progresses. Ties between
+    edges of the same weight are broken consistently, so the result does not
+    depend on the number of threads.
 
     Examples
     --------
@@ -686,6 +1046,13 @@ def min_spanning_tree(g, weights=None, root=None, tree_map=None):
 
     *Left:* Original graph, *Right:* The minimum spanning tree.
 
+    Since the weights are all distinct, the tree is unique, and is the same as
+    the one found by Prim's algorithm:
+
+    >>> ptree = gt.min_spanning_tree(g, weights=weight, root=g.vertex(0))
+    >>> print((tree.a == ptree.a).all(), tree.a.sum() == g.num_vertices() - 1)
+    True True
+
     References
     ----------
     .. [kruskal-shortest-1956] J. B. Kruskal.  "On the shortest spanning subtree
@@ -694,6 +1061,12 @@ def min_spanning_tree(g, weights=None, root=None, tree_map=None):
        :doi:`10.1090/S0002-9939-1956-0078686-7`
     .. [prim-shortest-1957] R. Prim.  "Shortest connection networks and some
        generalizations",  Bell System Technical Journal, 36:1389-1401, 1957.
+    .. [boruvka-o-1926] O. Borůvka, "O jistém problému minimálním", Práce
+       Moravské Přírodovědecké Společnosti 3, pp. 37-58 (1926).
+    .. [chung-parallel-1996] S. Chung, A. Condon, "Parallel implementation of
+       Borůvka's minimum spanning tree algorithm", Proceedings of the 10th
+       International Parallel Processing Symposium, pp. 302-308 (1996),
+       :doi:`10.1109/IPPS.1996.508073`
     .. [boost-mst] http://www.boost.org/libs/graph/doc/graph_theory_review.html#sec:minimum-spanning-tree
     .. [mst-wiki] http://en.wikipedia.org/wiki/Minimum_spanning_tree
     """
@@ -705,7 +1078,7 @@ def min_spanning_tree(g, weights=None, root=None, tree_map=None):
     u = GraphView(g, directed=False)
     if root is None:
         libgraph_tool_topology.\
-               get_kruskal_spanning_tree(u._Graph__graph,
+               get_boruvka_spanning_tree(u._Graph__graph,
                                          _prop("e", g, weights),
                                          _prop("e", g, tree_map))
     else:
@@ -741,12 +1114,19 @@ def random_spanning_tree(g, weights=None, root=None, tree_map=None):
     Notes
     -----
 
+    The tree is sampled with Wilson's algorithm [wilson-generating-1996]_, i.e.
+    it is built from loop-erased random walks towards the root. For directed
+    graphs, the tree edges point towards the root.
+
     The running time for this algorithm is :math:`O(\tau)`, with :math:`\tau`
     being the mean hitting time of a random walk on the graph. In the worse case,
     we have :math:`\tau \sim O(V^3)`, with :math:`V` being the number of
     vertices in the graph. However, in much more typical cases (e.g. sparse
     random graphs) the running time is simply :math:`O(V)`.
 
+    To sample many trees of the same graph, :func:`random_spanning_trees` is
+    faster.
+
     Examples
     --------
     .. testcode::
@@ -796,28 +1176,128 @@ def random_spanning_tree(g, weights=None, root=None, tree_map=None):
        trees more quickly than the cover time", Proceedings of the twenty-eighth
        annual ACM symposium on Theory of computing, Pages 296-303, ACM New York,
        1996, :doi:`10.1145/237814.237880`
-    .. [boost-rst] http://www.boost.org/libs/graph/doc/random_spanning_tree.html
     """
     if tree_map is None:
         tree_map = g.new_edge_property("bool")
     if tree_map.value_type() != "bool":
         raise ValueError("edge property 'tree_map' must be of value type bool.")
 
+    root = _spanning_tree_root(g, weights, root)
+
+    libgraph_tool_topology.\
+        random_spanning_tree(g._Graph__graph, int(root),
+                             _prop("e", g, weights),
+                             _prop("e", g, tree_map), _get_rng())
+    return tree_map
+
+
+def _spanning_tree_root(g, weights, root):
     if root is None:
         root = g.vertex(numpy.random.randint(0, g.num_vertices()),
                         use_index=False)
 
-    # we need to restrict ourselves to the in-component of root
-    l = label_out_component(GraphView(g, reversed=True), root)
+    # we need to restrict ourselves to the in-component of root, through the
+    # edges that can be chosen
+    u = g
+    if weights is not None:
+        active = g.new_edge_property("bool")
+        active.fa = weights.fa > 0
+        u = GraphView(g, efilt=active)
+    l = label_out_component(GraphView(u, reversed=True), root)
     u = GraphView(g, vfilt=l)
     if u.num_vertices() != g.num_vertices():
         raise ValueError("There must be a path from all vertices to the root vertex: %d" % int(root) )
+    return root
+
+
+def random_spanning_trees(g, n=1000, weights=None, root=None, counts=False):
+    r"""Sample many random spanning trees of a given graph, in parallel.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Graph to be used.
+    n : ``int`` (optional, default: ``1000``)
+        Number of trees to be sampled.
+    weights : :class:`~graph_tool.PropertyMap` (optional, default: `None`)
+        The edge weights. If provided, the probability of a particular spanning
+        tree being selected is the product of its edge weights.
+    root : :class:`~graph_tool.Vertex` (optional, default: `None`)
+        Root of the spanning trees. If not provided, it will be selected
+        randomly. It is the same for all trees.
+    counts : ``bool`` (optional, default: ``False``)
+        If ``True``, only the number of sampled trees to which each edge belongs
+        is returned, instead of the trees themselves.
+
+    Returns
+    -------
+    trees : :class:`numpy.ndarray`
+        If ``counts == False``, array of shape ``(n, V - 1)`` where each row
+        contains the edge indexes of a spanning tree. The edges are listed in
+        the order of the vertices from which they leave towards the root.
+    counts : :class:`~graph_tool.PropertyMap`
+        If ``counts == True``, edge property map with the number of sampled
+        trees to which each edge belongs.
+
+    Notes
+    -----
+    This samples from the same distribution as :func:`random_spanning_tree`,
+    with Wilson's algorithm [wilson-batch-1996]_. The random walks are
+    done on a compact copy of the graph, which is built only once, with the
+    weighted steps chosen in constant time with alias tables. The trees are
+    sampled in parallel, each with its own random number stream, so that the
+    result does not depend on the number of threads.
+
+    For undirected graphs, the fraction of trees to which an edge :math:`e`
+    belongs approaches :math:`w_eR_e`, where :math:`w_e` is its weight and
+    :math:`R_e` is the effective resistance between its endpoints.
+
+    The running time is :math:`O(n\tau)`, with :math:`\tau` being the mean
+    hitting time of a random walk on the graph (see
+    :func:`random_spanning_tree`).
+
+    If enabled during compilation, this algorithm runs in parallel.
+
+    Examples
+    --------
+    >>> g = gt.lattice([5, 5])
+    >>> trees = gt.random_spanning_trees(g, n=100)
+    >>> print(trees.shape)
+    (100, 24)
+
+    The fraction of trees containing each edge can be compared with the
+    effective resistances, obtained from the pseudo-inverse of the Laplacian:
+
+    >>> counts = gt.random_spanning_trees(g, n=10000, counts=True)
+    >>> Lp = numpy.linalg.pinv(gt.laplacian(g).todense())
+    >>> es = g.get_edges()
+    >>> R = [Lp[s, s] + Lp[t, t] - 2 * Lp[s, t] for s, t in es[:, :2]]
+    >>> print(abs(counts.a[es[:, 2]] / 10000 - R).max() < 0.03)
+    True
+
+    References
+    ----------
+    .. [wilson-batch-1996] David Bruce Wilson, "Generating random spanning
+       trees more quickly than the cover time", Proceedings of the twenty-eighth
+       annual ACM symposium on Theory of computing, Pages 296-303, ACM New York,
+       1996, :doi:`10.1145/237814.237880`
+    """
+
+    root = _spanning_tree_root(g, weights, root)
 
+    if counts:
+        c = g.new_edge_property("int64_t")
+        libgraph_tool_topology.\
+            random_spanning_tree_counts(g._Graph__graph, int(root),
+                                        _prop("e", g, weights), n, c.a,
+                                        _get_rng())
+        return c
+
+    trees = numpy.zeros((n, max(g.num_vertices() - 1, 0)), dtype="int64")
     libgraph_tool_topology.\
-        random_spanning_tree(g._Graph__graph, int(root),
-                             _prop("e", g, weights),
-                             _prop("e", g, tree_map), _get_rng())
-    return tree_map
+        random_spanning_trees(g._Graph__graph, int(root),
+                              _prop("e", g, weights), trees, _get_rng())
+    return trees
 
 
 def dominator_tree(g, root, dom_map=None):
@@ -940,6 +1420,10 @@ def transitive_closure(g):
 
     The time complexity (worst-case) is :math:`O(VE)`.
 
+    If only reachability queries are needed, :class:`ReachabilityIndex`
+    answers them without materializing the closure, which can have
+    :math:`O(V^2)` edges.
+
     Examples
     --------
     .. testcode::
@@ -967,6 +1451,112 @@ def transitive_closure(g):
     return tg
 
 
+class ReachabilityIndex(object):
+    r"""Index for fast repeated reachability queries.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Graph to be used.
+    k : ``int`` (optional, default: ``5``)
+        Number of interval labels per vertex, if the closure is not stored
+        explicitly.
+    max_closure_size : ``int`` (optional, default: ``2**28``)
+        Maximum size in bytes of the explicit transitive closure (one bit per
+        pair of strong components).
+
+    Notes
+    -----
+    A vertex :math:`v` is reachable from :math:`u` if there is a directed path
+    from :math:`u` to :math:`v`. Every vertex is reachable from itself. For
+    undirected graphs, this is the same as belonging to the same component.
+
+    The strong components of the graph are contracted first, which results
+    in a directed acyclic graph (DAG). If its transitive closure fits in
+    ``max_closure_size`` bytes, it is stored as a bitset for each component,
+    computed in parallel, and each query takes :math:`O(1)` time.
+
+    Otherwise, ``k`` interval labels are assigned to each component from
+    randomized depth-first traversals of the DAG, such that the label of
+    :math:`v` is contained in the label of :math:`u` if :math:`v` is
+    reachable from :math:`u` [yildirim-grail-2010]_. Together with the
+    topological levels of the components, this answers most negative queries
+    immediately, and the remaining ones with a depth-first search which is
+    pruned with the same criteria. This requires only :math:`O(kV)` memory,
+    instead of the :math:`O(V^2)` of the full transitive closure.
+
+    The index is built once, and the queries will be invalid if the graph is
+    modified afterwards.
+
+    If enabled during compilation, the preprocessing and batched queries run
+    in parallel.
+
+    Examples
+    --------
+    .. testcode::
+       :hide:
+
+       import numpy.random
+       numpy.random.seed(42)
+       gt.seed_rng(42)
+
+    >>> g = gt.price_network(10000)
+    >>> idx = gt.ReachabilityIndex(g)
+    >>> print(idx.reachable(g.vertex(10), g.vertex(0)))
+    True
+    >>> print(idx.reachable(g.vertex(0), g.vertex(10)))
+    False
+    >>> sources = numpy.random.randint(0, g.num_vertices(), 5)
+    >>> targets = numpy.random.randint(0, 10, 5)
+    >>> r = idx.reachable(sources, targets)
+    >>> tc = gt.transitive_closure(g)
+    >>> print(all(r[i] == (tc.edge(s, t) is not None or s == t)
+    ...           for i, (s, t) in enumerate(zip(sources, targets))))
+    True
+
+    References
+    ----------
+    .. [yildirim-grail-2010] H. Yildirim, V. Chaoji, M. J. Zaki, "GRAIL:
+       scalable reachability index for large graphs", Proceedings of the VLDB
+       Endowment 3(1-2), pp. 276-284 (2010), :doi:`10.14778/1920841.1920879`
+    """
+
+    def __init__(self, g, k=5, max_closure_size=2**28):
+        self.g = g
+        self._idx = libgraph_tool_topology.\
+            build_reachability_index(g._Graph__graph, k, max_closure_size,
+                                     _get_rng())
+
+    def num_components(self):
+        """Return the number of strong components, i.e. the number of nodes of
+        the contracted DAG."""
+        return self._idx.num_components()
+
+    def reachable(self, source, target):
+        """Return whether ``target`` is reachable from ``source``.
+
+        If both ``source`` and ``target`` are iterables of the same length, a
+        boolean :class:`numpy.ndarray` is returned instead, with the answers
+        for each corresponding pair, which are computed in parallel.
+        """
+        src_list = isinstance(source, collections.Iterable)
+        tgt_list = isinstance(target, collections.Iterable)
+        if not src_list and not tgt_list:
+            return libgraph_tool_topology.reachability_query(self._idx,
+                                                             int(source),
+                                                             int(target))
+        if not src_list or not tgt_list:
+            raise ValueError("source and target must be both vertices or both lists")
+        sources = numpy.asarray([int(v) for v in source], dtype="int64")
+        targets = numpy.asarray([int(v) for v in target], dtype="int64")
+        if len(sources) != len(targets):
+            raise ValueError("source and target lists must have the same length")
+        result = numpy.zeros(len(sources), dtype="uint8")
+        libgraph_tool_topology.reachability_query_pairs(self._idx, sources,
+                                                        targets, result)
+        return numpy.asarray(result, dtype="bool")
+
+
 def label_components(g, vprop=None, directed=None, attractors=False):
     """
     Label the components to which each vertex in the graph belongs. If the
@@ -1008,6 +1598,17 @@ def label_components(g, vprop=None, directed=None, attractors=False):
 
     The algorithm runs in :math:`O(V + E)` time.
 
+    For undirected graphs, the components are found in parallel with the
+    Afforest algorithm [sutton-optimizing-2018]_, which processes only a
+    fraction of the edges in the largest component. For directed graphs, the
+    strongly connected components are found in parallel with the Multistep
+    method [slota-bfs-2014]_, which trims the trivial components, extracts the
+    giant component with forward and backward searches, and splits the rest by
+    coloring. When running in parallel, the components are labeled in the
+    order of their vertex with smallest index.
+
+    If enabled during compilation, this algorithm runs in parallel.
+
     Examples
     --------
     .. testcode::
@@ -1030,6 +1631,37 @@ def label_components(g, vprop=None, directed=None, attractors=False):
     [ True  True  True  True  True  True  True  True  True False  True False
      False False False False False False False False False False False False
      False False False False  True False  True False False]
+
+    The labels agree with those found by :mod:`scipy.sparse.csgraph`, which
+    also numbers the components in the order of their vertex with smallest
+    index:
+
+    >>> from scipy.sparse.csgraph import connected_components
+    >>> u = gt.random_graph(10000, lambda: poisson(1), directed=False)
+    >>> comp, hist = gt.label_components(u)
+    >>> n, labels = connected_components(gt.adjacency(u), directed=False)
+    >>> print(len(hist) == n, (comp.a == labels).all())
+    True True
+
+    For directed graphs the numbering differs, but the partition is the same:
+
+    >>> g = gt.random_graph(10000, lambda: (poisson(1.5), poisson(1.5)))
+    >>> comp, hist = gt.label_components(g)
+    >>> n, labels = connected_components(gt.adjacency(g), connection="strong")
+    >>> print(len(hist) == n == len(set(zip(comp.a, labels))))
+    True
+
+    References
+    ----------
+    .. [sutton-optimizing-2018] Michael Sutton, Tal Ben-Nun and Amnon Barak,
+       "Optimizing Parallel Graph Connectivity Computation via Subgraph
+       Sampling", IEEE International Parallel and Distributed Processing
+       Symposium, 12-21 (2018), :doi:`10.1109/IPDPS.2018.00012`
+    .. [slota-bfs-2014] George M. Slota, Sivasankaran Rajamanickam and
+       Kamesh Madduri, "BFS and Coloring-Based Parallel Algorithms for
+       Strongly Connected Components and Related Problems", IEEE International
+       Parallel and Distributed Processing Symposium, 550-559 (2014),
+       :doi:`10.1109/IPDPS.2014.64`
     """
 
     if vprop is None:
@@ -1280,7 +1912,10 @@ def vertex_percolation(g, vertices):
     Notes
     -----
 
-    The algorithm runs in :math:`O(V + E)` time.
+    The algorithm runs in :math:`O(V + E)` time. If more than one thread is
+    available, the edges that do not join different clusters are identified
+    in parallel, and only the remaining ones are processed in order, which
+    yields exactly the same result.
 
     Examples
     --------
@@ -1365,7 +2000,10 @@ def edge_percolation(g, edges):
     Notes
     -----
 
-    The algorithm runs in :math:`O(E)` time.
+    The algorithm runs in :math:`O(E)` time. If more than one thread is
+    available, the edges that do not join different clusters are identified
+    in parallel, and only the remaining ones are processed in order, which
+    yields exactly the same result.
 
     Examples
     --------
@@ -1424,6 +2062,150 @@ def edge_percolation(g, edges):
                        edges, max_size)
     return max_size, tree
 
+def vertex_percolation_batch(g, orders=None, runs=100):
+    """Compute the size of the largest component as vertices are (virtually)
+    removed from the graph, for many removal orders at once.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Graph to be used.
+    orders : :class:`numpy.ndarray` (optional, default: ``None``)
+        Two-dimensional array, where each row is a list of vertex indexes in
+        reversed order of removal. If not supplied, ``runs`` uniformly random
+        orders of all the vertices are used.
+    runs : int (optional, default: ``100``)
+        Number of random orders, if ``orders`` is not supplied.
+
+    Returns
+    -------
+    size : :class:`numpy.ndarray`
+        Two-dimensional array, where ``size[r, i]`` is the size of the largest
+        component prior to removal of vertex ``i`` in order ``r``.
+
+    Notes
+    -----
+
+    This gives the same result as calling :func:`vertex_percolation` for
+    each order, but the orders are processed in parallel, each by a single
+    thread, which reuses its memory for the next one.
+
+    The algorithm runs in :math:`O(R(V + E))` time, for :math:`R` orders.
+
+    Examples
+    --------
+    .. testcode::
+       :hide:
+
+       import numpy.random
+       numpy.random.seed(42)
+       gt.seed_rng(42)
+
+    >>> g = gt.random_graph(10000, lambda: geometric(1./4) + 1, directed=False)
+    >>> sizes = gt.vertex_percolation_batch(g, runs=100)
+    >>> figure()
+    <...>
+    >>> plot(sizes.mean(axis=0))
+    [...]
+    >>> xlabel("Vertices remaining")
+    Text(...)
+    >>> ylabel("Average size of largest component")
+    Text(...)
+    >>> savefig("vertex-percolation-batch.svg")
+
+    .. figure:: vertex-percolation-batch.*
+        :align: center
+
+        Average size of the largest component for 100 random vertex removal
+        orders of a random graph with an exponential degree distribution.
+
+    Each row matches :func:`vertex_percolation` for the same order, and
+    starts from the largest component of the full graph:
+
+    >>> orders = [numpy.random.permutation(g.num_vertices()) for r in range(10)]
+    >>> sizes = gt.vertex_percolation_batch(g, orders)
+    >>> sizes1, comp = gt.vertex_percolation(g, orders[0])
+    >>> print((sizes[0] == sizes1).all())
+    True
+    >>> comp, hist = gt.label_components(g)
+    >>> print((sizes[:, -1] == hist.max()).all())
+    True
+
+    """
+    u = GraphView(g, directed=False)
+    if orders is None:
+        orders = numpy.zeros((0, 0), dtype="uint64")
+        max_size = numpy.zeros((runs, g.num_vertices()), dtype="uint64")
+    else:
+        orders = numpy.array(orders, dtype="uint64", ndmin=2)
+        max_size = numpy.zeros(orders.shape, dtype="uint64")
+    libgraph_tool_topology.\
+        percolate_vertex_batch(u._Graph__graph, orders, max_size,
+                               len(orders) == 0, _get_rng())
+    return max_size
+
+def edge_percolation_batch(g, orders=None, runs=100):
+    """Compute the size of the largest component as edges are (virtually)
+    removed from the graph, for many removal orders at once.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Graph to be used.
+    orders : :class:`numpy.ndarray` (optional, default: ``None``)
+        Two-dimensional array, where each row is a list of edge indexes (as
+        given by :attr:`~graph_tool.Graph.edge_index`) in reversed order of
+        removal. If not supplied, ``runs`` uniformly random orders of all the
+        edges are used.
+    runs : int (optional, default: ``100``)
+        Number of random orders, if ``orders`` is not supplied.
+
+    Returns
+    -------
+    size : :class:`numpy.ndarray`
+        Two-dimensional array, where ``size[r, i]`` is the size of the largest
+        component prior to removal of edge ``i`` in order ``r``.
+
+    Notes
+    -----
+
+    This gives the same result as calling :func:`edge_percolation` for each
+    order, but the orders are processed in parallel, each by a single thread,
+    which reuses its memory for the next one.
+
+    The algorithm runs in :math:`O(RE)` time, for :math:`R` orders.
+
+    Examples
+    --------
+    .. testcode::
+       :hide:
+
+       import numpy.random
+       numpy.random.seed(42)
+       gt.seed_rng(42)
+
+    >>> g = gt.random_graph(10000, lambda: geometric(1./4) + 1, directed=False)
+    >>> es = g.get_edges()
+    >>> es = es[es[:, 2].argsort()]
+    >>> orders = [numpy.random.permutation(es[:, 2]) for r in range(10)]
+    >>> sizes = gt.edge_percolation_batch(g, orders)
+    >>> sizes1, comp = gt.edge_percolation(g, es[orders[0], :2])
+    >>> print((sizes[0] == sizes1).all())
+    True
+
+    """
+    u = GraphView(g, directed=False)
+    if orders is None:
+        orders = numpy.zeros((0, 0), dtype="uint64")
+        max_size = numpy.zeros((runs, g.num_edges()), dtype="uint64")
+    else:
+        orders = numpy.array(orders, dtype="uint64", ndmin=2)
+        max_size = numpy.zeros(orders.shape, dtype="uint64")
+    libgraph_tool_topology.\
+        percolate_edge_batch(u._Graph__graph, orders, max_size,
+                             len(orders) == 0, _get_rng())
+    return max_size
+
 def kcore_decomposition(g, vprop=None):
     """Perform a k-core decomposition of the given graph.
 
@@ -1454,7 +2236,12 @@ def kcore_decomposition(g, vprop=None):
     case these edges contribute to the degree in the usual fashion.
 
     This algorithm is described in [batagelk-algorithm]_ and runs in :math:`O(V + E)`
-    time.
+    time. If more than one thread is available, the vertices are instead
+    peeled level by level, with all vertices of the current level removed in
+    parallel [kabir-parallel-2017]_. This yields the same result, but the
+    remaining vertices are scanned once for every nonempty level, so that it
+    runs in :math:`O(LV + E)` time, where :math:`L` is the number of distinct
+    core values.
 
     Examples
     --------
@@ -1475,6 +2262,18 @@ def kcore_decomposition(g, vprop=None):
 
         K-core decomposition of a network of network scientists.
 
+    The core number of each vertex is the largest :math:`h` such that it has
+    at least :math:`h` neighbors with core number :math:`h` or larger
+    [lu-h-index-2016]_, which can be verified directly:
+
+    >>> u = gt.random_graph(10000, lambda: poisson(4), directed=False)
+    >>> kcore = gt.kcore_decomposition(u)
+    >>> def h_index(v):
+    ...     c = sorted((kcore[w] for w in v.out_neighbors()), reverse=True)
+    ...     return sum(x >= i + 1 for i, x in enumerate(c))
+    >>> print(all(kcore[v] == h_index(v) for v in u.vertices()))
+    True
+
     References
     ----------
     .. [k-core] http://en.wikipedia.org/wiki/Degeneracy_%28graph_theory%29
@@ -1483,6 +2282,14 @@ def kcore_decomposition(g, vprop=None):
        networks", Advances in Data Analysis and Classification
        Volume 5, Issue 2, pp 129-145 (2011), :DOI:`10.1007/s11634-010-0079-y`,
        :arxiv:`cs/0310049`
+    .. [kabir-parallel-2017] Humayun Kabir, Kamesh Madduri, "Parallel k-core
+       decomposition on multicore platforms", IEEE International Parallel and
+       Distributed Processing Symposium Workshops (IPDPSW), pp. 1482-1491
+       (2017), :DOI:`10.1109/IPDPSW.2017.151`
+    .. [lu-h-index-2016] Linyuan Lü, Tao Zhou, Qian-Ming Zhang, H. Eugene
+       Stanley, "The H-index of a network node and its relation to degree and
+       coreness", Nature Communications 7, 10168 (2016),
+       :DOI:`10.1038/ncomms10168`
 
     """
 
@@ -1498,6 +2305,125 @@ def kcore_decomposition(g, vprop=None):
     return vprop
 
 
+def _edge_list(edges):
+    if edges is None:
+        return numpy.zeros((0, 2), dtype="int64")
+    edges = numpy.asarray(edges, dtype="int64")
+    if len(edges) == 0:
+        return numpy.zeros((0, 2), dtype="int64")
+    if edges.ndim != 2 or edges.shape[1] != 2:
+        raise ValueError("edge list must contain (source, target) rows")
+    return numpy.array(edges, dtype="int64")
+
+
+class DynamicKCore(object):
+    r"""K-core decomposition maintained under batches of edge insertions and
+    removals.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Graph to be used. It will be modified by :meth:`update`.
+
+    See Also
+    --------
+    kcore_decomposition: k-core decomposition of a static graph
+
+    Notes
+    -----
+    The core numbers are the same as those given by
+    :func:`~graph_tool.topology.kcore_decomposition`, with the degree of
+    directed graphs taken as the total (in + out) degree.
+
+    Inserting or removing a single edge :math:`(u, v)` changes the core
+    number by at most one, and only of the vertices with core number
+    :math:`r = \min(k_u, k_v)` that are reachable from the edge through other
+    such vertices. An insertion only needs to visit those that have more than
+    :math:`r` neighbours with core number at least :math:`r`, and a removal
+    only those whose number of such neighbours falls below :math:`r`
+    [sariyuce-streaming-2013]_. The work done is therefore typically
+    proportional to the size of the affected region, not of the graph. If the
+    work done on a batch exceeds that of a full decomposition, the core
+    numbers are instead recomputed from scratch, in parallel.
+
+    Both :meth:`update` and the graph must always go together: the graph is
+    modified by :meth:`update`, and it should not be modified otherwise.
+
+    Examples
+    --------
+
+    >>> g = gt.Graph(gt.collection.data["netscience"])
+    >>> dkc = gt.DynamicKCore(g)
+    >>> rm = [(int(e.source()), int(e.target())) for e in list(g.edges())[:10]]
+    >>> info = dkc.update(add=[(0, 1), (2, 3), (4, 5)], remove=rm)
+    >>> kcore = gt.kcore_decomposition(g)
+    >>> print((dkc.get_kcore().a == kcore.a).all())
+    True
+
+    References
+    ----------
+    .. [sariyuce-streaming-2013] Ahmet Erdem Sarıyüce, Buğra Gedik, Gabriela
+       Jacques-Silva, Kun-Lung Wu, Ümit V. Çatalyürek, "Streaming algorithms
+       for k-core decomposition", Proceedings of the VLDB Endowment 6(6),
+       pp. 433-444 (2013), :DOI:`10.14778/2536336.2536344`
+    """
+
+    def __init__(self, g):
+        self.g = g
+        self._state = libgraph_tool_topology.\
+            build_dynamic_kcore(g._Graph__graph)
+
+    def update(self, add=None, remove=None):
+        r"""Insert the edges in ``add`` and remove those in ``remove``, both
+        in the graph and in the maintained core numbers.
+
+        Each element of ``add`` and ``remove`` is a ``(source, target)`` pair
+        of vertex indexes. New vertices are created if necessary. The
+        removals are applied before the insertions.
+
+        A dictionary is returned with the number of adjacency entries
+        visited (``"work"``), and whether the core numbers were recomputed
+        from scratch as a fallback (``"global_recompute"``).
+        """
+        add = _edge_list(add)
+        remove = _edge_list(remove)
+        N = self.g.num_vertices(ignore_filter=True)
+        if len(add) > 0:
+            N = max(N, int(add.max()) + 1)
+
+        # the removed edges must exist in the graph, with their direction,
+        # before anything is modified
+        es = []
+        used = collections.defaultdict(int)
+        for s, t in remove:
+            s, t = int(s), int(t)
+            if s < 0 or t < 0 or max(s, t) >= self.g.num_vertices(ignore_filter=True):
+                raise ValueError("edge (%d, %d) does not exist" % (s, t))
+            key = (s, t) if self.g.is_directed() else (min(s, t), max(s, t))
+            # self-loops may be listed twice in undirected graphs
+            candidates = list(collections.OrderedDict(
+                (int(self.g.edge_index[e]), e)
+                for e in self.g.edge(s, t, all_edges=True)).values())
+            if used[key] >= len(candidates):
+                raise ValueError("edge (%d, %d) does not exist" % (s, t))
+            es.append(candidates[used[key]])
+            used[key] += 1
+
+        work, recompute = libgraph_tool_topology.\
+            dynamic_kcore_update(self._state, add, remove, N)
+        for e in es:
+            self.g.remove_edge(e)
+        if len(add) > 0:
+            self.g.add_edge_list(add)
+        return dict(work=work, global_recompute=recompute)
+
+    def get_kcore(self):
+        """Return a vertex property map with the current core numbers."""
+        kcore = self.g.new_vertex_property("int32_t")
+        kcore.a[:] = self._state.get_core()[:len(kcore.a)]
+        return kcore
+
+
 def shortest_distance(g, source=None, target=None, weights=None,
                       negative_weights=False, max_dist=None, directed=None,
                       dense=False, dist_map=None, pred_map=False,
@@ -1855,6 +2781,133 @@ def shortest_path(g, source, target, weights=None, negative_weights=False,
         v = p
     return vlist, elist
 
+class ContractionHierarchy(object):
+    r"""Contraction hierarchy for fast repeated shortest-path queries.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Graph to be used.
+    weights : :class:`~graph_tool.PropertyMap` (optional, default: None)
+        The edge weights, which must be non-negative. If omitted, a constant
+        value of 1 will be used.
+    max_settled : ``int`` (optional, default: ``500``)
+        Maximum number of vertices settled in each local witness search during
+        preprocessing. Smaller values make the preprocessing faster, at the
+        expense of more shortcuts.
+
+    Notes
+    -----
+    The vertices are ordered by importance and contracted one by one (in this
+    case, in parallel rounds of independent sets), with shortcut edges being
+    added between the neighbors whenever this is necessary to preserve the
+    shortest distances [geisberger-contraction-2008]_. The resulting hierarchy
+    is stored separately from the graph, which itself is not modified, and
+    answers each query with a bidirectional search that only moves upwards
+    in the hierarchy. In road networks and similar graphs this visits only a
+    few hundred vertices, independently of the size of the graph.
+
+    The preprocessing is done once, and the queries will be invalid if the
+    graph or the weights are modified afterwards.
+
+    If enabled during compilation, the preprocessing and batched queries run
+    in parallel.
+
+    Examples
+    --------
+    .. testcode::
+       :hide:
+
+       import numpy.random
+       numpy.random.seed(43)
+       gt.seed_rng(43)
+
+    >>> g = gt.lattice([50, 50])
+    >>> w = g.new_edge_property("double")
+    >>> w.a = numpy.random.random(g.num_edges())
+    >>> ch = gt.ContractionHierarchy(g, weights=w)
+    >>> d = ch.distance(g.vertex(0), g.vertex(2499))
+    >>> print(numpy.isclose(d, gt.shortest_distance(g, g.vertex(0), g.vertex(2499), weights=w)))
+    True
+    >>> vlist, elist = ch.path(g.vertex(0), g.vertex(2499))
+    >>> print(numpy.isclose(sum(w[e] for e in elist), d))
+    True
+    >>> dist = ch.distance(g.vertex(0), g.get_vertices())
+    >>> print(numpy.allclose(dist, gt.shortest_distance(g, g.vertex(0), weights=w).a))
+    True
+
+    References
+    ----------
+    .. [geisberger-contraction-2008] R. Geisberger, P. Sanders, D. Schultes,
+       D. Delling, "Contraction hierarchies: faster and simpler hierarchical
+       routing in road networks", in Proceedings of the 7th International
+       Workshop on Experimental Algorithms (WEA 2008), pp. 319-333,
+       :doi:`10.1007/978-3-540-68552-4_24`
+    """
+
+    def __init__(self, g, weights=None, max_settled=500):
+        self.g = g
+        self.weights = weights
+        self._ch = libgraph_tool_topology.\
+            build_contraction_hierarchy(g._Graph__graph,
+                                        _prop("e", g, weights),
+                                        max_settled)
+
+    def num_shortcuts(self):
+        """Return the number of shortcut arcs added during preprocessing."""
+        return self._ch.num_shortcuts()
+
+    def get_rank(self):
+        """Return a vertex property map with the contraction order of each
+        vertex."""
+        rank = self.g.new_vertex_property("int64_t")
+        rank.a[:] = self._ch.get_rank()
+        return rank
+
+    def distance(self, source, target):
+        """Return the distance from ``source`` to ``target``.
+
+        If ``target`` is an iterable of vertices, the distances from ``source``
+        to each of them are returned as a :class:`numpy.ndarray` (one-to-many
+        query). If both ``source`` and ``target`` are iterables of the same
+        length, the distances between each corresponding pair are returned
+        instead, and if only ``source`` is an iterable, the distances from each
+        of them to ``target`` are returned. In all cases the queries are run in
+        parallel. If there is no path, the distance is ``inf``.
+        """
+        src_list = isinstance(source, collections.Iterable)
+        tgt_list = isinstance(target, collections.Iterable)
+        if not src_list and not tgt_list:
+            return libgraph_tool_topology.ch_distance(self._ch, int(source),
+                                                      int(target))
+        if not src_list:
+            targets = numpy.asarray([int(v) for v in target], dtype="int64")
+            dist = numpy.empty(len(targets), dtype="double")
+            libgraph_tool_topology.ch_distance_many(self._ch, int(source),
+                                                    targets, dist)
+            return dist
+        sources = numpy.asarray([int(v) for v in source], dtype="int64")
+        if tgt_list:
+            targets = numpy.asarray([int(v) for v in target], dtype="int64")
+            if len(sources) != len(targets):
+                raise ValueError("source and target lists must have the same length")
+        else:
+            targets = numpy.full(len(sources), int(target), dtype="int64")
+        dist = numpy.empty(len(sources), dtype="double")
+        libgraph_tool_topology.ch_distance_pairs(self._ch, sources, targets,
+                                                 dist)
+        return dist
+
+    def path(self, source, target):
+        """Return the shortest path from ``source`` to ``target``, as a list of
+        vertices and a list of the original edges of the graph, with the same
+        format as :func:`~graph_tool.topology.shortest_path`. Empty lists are
+        returned if there is no path."""
+        vs, elist = libgraph_tool_topology.ch_path(self.g._Graph__graph,
+                                                   self._ch, int(source),
+                                                   int(target))
+        return [self.g.vertex(v) for v in vs], list(elist)
+
 def all_predecessors(g, dist_map, pred_map, weights=None, epsilon=1e-8):
     """Return a property map with all possible predecessors in the search tree
         determined by ``dist_map`` and ``pred_map``.
@@ -2158,6 +3211,115 @@ def pseudo_diameter(g, source=None, weights=None):
     return dist, (g.vertex(source), g.vertex(target))
 
 
+def diameter(g, weights=None, eccentricity=False):
+    r"""Compute the exact diameter and radius of an undirected graph.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Graph to be used. It must be undirected, or a directed graph
+        filtered with ``GraphView(g, directed=False)``.
+    weights : :class:`~graph_tool.PropertyMap` (optional, default: `None`)
+        The edge weights, which must be non-negative.
+    eccentricity : bool (optional, default: `False`)
+        If ``True``, the eccentricities of all vertices are also returned.
+
+    Returns
+    -------
+    diameter : int or float
+        The diameter of the graph, i.e. the largest eccentricity.
+    radius : int or float
+        The radius of the graph, i.e. the smallest eccentricity.
+    ecc : :class:`~graph_tool.PropertyMap`
+        Vertex property map with the eccentricities, i.e. the largest
+        distance from each vertex to any other one. Only returned if
+        ``eccentricity == True``.
+
+    Notes
+    -----
+
+    The eccentricities are obtained exactly from a small number of
+    breadth-first searches (or Dijkstra searches, if weights are given), with
+    the algorithm of [takes-computing-2013]_. After a search from vertex
+    :math:`v`, the eccentricity :math:`e(w)` of every other vertex :math:`w`
+    is bounded as
+
+    .. math::
+
+        \max(d(v, w), e(v) - d(v, w)) \le e(w) \le e(v) + d(v, w),
+
+    and the searches are repeated, alternating between the vertices with the
+    smallest lower bound and the largest upper bound, until the bounds
+    coincide (or, if ``eccentricity == False``, until the remaining vertices
+    cannot change the diameter or the radius). For real-world graphs this
+    requires only a handful of searches, while for some regular graphs (e.g.
+    cycles) it may require a search from every vertex.
+
+    For disconnected graphs, the eccentricity of a vertex is computed only
+    with respect to the vertices in the same component, and isolated vertices
+    have an eccentricity of zero.
+
+    Each breadth-first search is done in parallel, and if weights are given,
+    several Dijkstra searches are run at the same time. The worst-case
+    complexity is :math:`O(V(V + E))`, or :math:`O(V(E + V\log V))` if weights
+    are given.
+
+    Examples
+    --------
+
+    >>> g = gt.collection.data["power"]
+    >>> d, r, ecc = gt.diameter(g, eccentricity=True)
+    >>> print(d, r)
+    46 23
+    >>> print(ecc.a.max(), ecc.a.min())
+    46 23
+
+    The eccentricities are the same as those obtained from the distances
+    between all pairs of vertices, with or without weights:
+
+    >>> u = gt.collection.data["polbooks"]
+    >>> d, r, ecc = gt.diameter(u, eccentricity=True)
+    >>> dist = gt.shortest_distance(u)
+    >>> e = [dist[v].a.max() for v in u.vertices()]
+    >>> print((ecc.a == e).all(), d == max(e), r == min(e))
+    True True True
+    >>> w = u.new_edge_property("double")
+    >>> w.a = numpy.random.random(len(w.a))
+    >>> d, r, ecc = gt.diameter(u, weights=w, eccentricity=True)
+    >>> dist = gt.shortest_distance(u, weights=w)
+    >>> e = [dist[v].a.max() for v in u.vertices()]
+    >>> print(numpy.allclose(ecc.a, e))
+    True
+
+    References
+    ----------
+    .. [takes-computing-2013] Frank W. Takes, Walter A. Kosters, "Computing
+       the eccentricity distribution of large graphs", Algorithms 6(1),
+       pp. 100-118 (2013), :doi:`10.3390/a6010100`
+    """
+
+    if g.is_directed():
+        raise ValueError("the graph must be undirected; use " +
+                         "GraphView(g, directed=False) to ignore the edge " +
+                         "directions")
+    if weights is not None and (weights.fa < 0).any():
+        raise ValueError("the edge weights must be non-negative")
+    diam, radius, ecc_a = \
+        libgraph_tool_topology.get_exact_diameter(g._Graph__graph,
+                                                  _prop("e", g, weights),
+                                                  eccentricity)
+    if not eccentricity:
+        return diam, radius
+    if weights is None:
+        ecc = g.new_vertex_property("int32_t")
+    elif weights.fa.dtype.kind == "f":
+        ecc = g.new_vertex_property("double")
+    else:
+        ecc = g.new_vertex_property("int64_t")
+    ecc.a[:] = ecc_a[:len(ecc.a)]
+    return diam, radius, ecc
+
+
 def is_bipartite(g, partition=False, find_odd_cycle=False):
     """Test if the graph is bipartite.
 
@@ -2564,8 +3726,20 @@ def max_independent_vertex_set(g, high_deg=False, mivs=None):
     other vertex to the set forces the set to contain an edge between two
     vertices of the set.
 
-    This implements the algorithm described in [mivs-luby]_, which runs in time
-    :math:`O(V + E)`.
+    This implements the random-priority variant of the algorithm described
+    in [mivs-luby]_: In each round, the undecided vertices with higher priority
+    than all their undecided neighbors are included in the set, and their
+    neighbors are excluded. The priorities are given by the degree (see
+    ``high_deg``) with ties broken randomly, so that the result depends only
+    on the random seed, and not on the number of threads. The result is the
+    same as the greedy independent set obtained in order of priority, in as
+    many rounds as the longest chain of neighbors with decreasing priorities.
+    Since the randomness only breaks ties between vertices of equal degree,
+    this chain can be as long as :math:`\Theta(\sqrt{V})`, instead of the
+    :math:`O(\log V)` rounds of fully random priorities. The algorithm runs in
+    time :math:`O(V + E)` per round.
+
+    If enabled during compilation, this algorithm runs in parallel.
 
     Examples
     --------
@@ -2590,6 +3764,17 @@ def max_independent_vertex_set(g, high_deg=False, mivs=None):
 
         Vertices belonging to the set are in yellow.
 
+    No edge joins two vertices of the set, and every other vertex has a
+    neighbor in it:
+
+    >>> u = gt.random_graph(10000, lambda: poisson(5), directed=False)
+    >>> x = gt.max_independent_vertex_set(u).a
+    >>> es = u.get_edges()
+    >>> print((x[es[:, 0]] & x[es[:, 1]]).any())
+    False
+    >>> print(((gt.adjacency(u) @ x > 0) | (x == 1)).all())
+    True
+
     References
     ----------
     .. [mivs-wikipedia] http://en.wikipedia.org/wiki/Independent_set_%28graph_theory%29
@@ -2764,4 +3949,98 @@ def sequential_vertex_coloring(g, order=None, color=None):
     return color
 
 
+@_limit_args({"method": ["jones_plassmann", "speculative"],
+              "priority": ["largest_first", "smallest_last", "random"],
+              "distance": [1, 2]})
+def parallel_vertex_coloring(g, method="jones_plassmann",
+                             priority="largest_first", distance=1, color=None):
+    r"""Returns a vertex coloring of the graph, computed in parallel.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Graph to be used.
+    method : ``str`` (optional, default: ``"jones_plassmann"``)
+        Coloring algorithm, either ``"jones_plassmann"`` [jones-parallel-1993]_
+        or ``"speculative"`` [gebremedhin-scalable-2000]_ (see below).
+    priority : ``str`` (optional, default: ``"largest_first"``)
+        Order in which the vertices are preferably colored. It can be
+        ``"largest_first"`` (by decreasing degree), ``"smallest_last"`` (in the
+        reverse order in which the vertices are removed with the smallest
+        remaining degree [matula-smallest-last-1983]_) or ``"random"``. Ties
+        are broken randomly.
+    distance : ``int`` (optional, default: ``1``)
+        If ``1``, adjacent vertices get different colors. If ``2``, also the
+        vertices with a common neighbor get different colors.
+    color : :class:`~graph_tool.PropertyMap` (optional, default: None)
+        Integer-valued vertex property map to store the colors.
+
+    Returns
+    -------
+    color : :class:`~graph_tool.PropertyMap`
+        Integer-valued vertex property map with the vertex colors.
+    ncolors : ``int``
+        Number of colors used.
+
+    Notes
+    -----
+    The edge directions are ignored.
+
+    With ``method == "jones_plassmann"``, a vertex is colored greedily as soon
+    as all its neighbors with higher priority have been colored, and all the
+    vertices which become ready at the same time are colored in parallel. The
+    result is the same as with :func:`sequential_vertex_coloring` using the
+    same order, and does not depend on the number of threads.
+
+    With ``method == "speculative"``, all vertices are colored greedily at the
+    same time, and the conflicts that appear between adjacent vertices colored
+    concurrently are resolved by recoloring the vertex with lower priority, in
+    successive rounds. This needs less synchronization, but the result
+    depends on the thread scheduling, and may use slightly more colors.
+
+    For distance-1 colorings, the time complexity is :math:`O(V + E)` per
+    round, and :math:`O(V + \sum_v k_v^2)` for distance-2 colorings, where
+    :math:`k_v` is the degree of vertex :math:`v`.
+
+    If enabled during compilation, this algorithm runs in parallel.
+
+    Examples
+    --------
+    >>> g = gt.lattice([50, 50])
+    >>> color, nc = gt.parallel_vertex_coloring(g)
+    >>> print(all(color[e.source()] != color[e.target()] for e in g.edges()))
+    True
+    >>> color, nc = gt.parallel_vertex_coloring(g, method="speculative",
+    ...                                         priority="smallest_last",
+    ...                                         distance=2)
+    >>> print(all(color[u] != color[w] for v in g.vertices()
+    ...           for u in v.all_neighbors() for w in v.all_neighbors()
+    ...           if u != w))
+    True
+    >>> print(all(color[e.source()] != color[e.target()] for e in g.edges()))
+    True
+
+    References
+    ----------
+    .. [jones-parallel-1993] Mark T. Jones and Paul E. Plassmann, "A parallel
+       graph coloring heuristic", SIAM Journal on Scientific Computing 14,
+       654-669 (1993), :doi:`10.1137/0914041`
+    .. [gebremedhin-scalable-2000] Assefaw Hadish Gebremedhin and Fredrik
+       Manne, "Scalable parallel graph coloring algorithms", Concurrency:
+       Practice and Experience 12, 1131-1146 (2000),
+       :doi:`10.1002/1096-9128(200010)12:12<1131::AID-CPE528>3.0.CO;2-2`
+    .. [matula-smallest-last-1983] David W. Matula and Leland L. Beck,
+       "Smallest-last ordering and clustering and graph coloring algorithms",
+       Journal of the ACM 30, 417-427 (1983), :doi:`10.1145/2402.322385`
+    """
+
+    if color is None:
+        color = g.new_vertex_property("int")
+
+    nc = libgraph_tool_topology.\
+        parallel_coloring(g._Graph__graph, _prop("v", g, color), method,
+                          priority, distance == 2, _get_rng())
+    return color, nc
+
+
 from .. flow import libgraph_tool_flow
\ No newline at end of file